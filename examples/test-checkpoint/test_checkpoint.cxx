@@ -0,0 +1,163 @@
+/*
+ * Test MemoryCheckpoint
+ *
+ * A checkpoint is saved on all processors, then copies are corrupted
+ * and restored. restore() is called on one processor alone, so the
+ * test hangs if it communicates.
+ */
+
+#include <bout.hxx>
+
+#include <bout/checkpoint.hxx>
+#include <boutexception.hxx>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/// Gives access to the copies, so they can be corrupted
+class TestCheckpoint : public MemoryCheckpoint {
+public:
+  /// Flip a bit in this processor's copy
+  void corruptLocal() { flip(local); }
+  /// Flip a bit in the copy held for processor \p proc, if this
+  /// processor holds it
+  void corruptBuddy(int proc) {
+    if(proc == recv_from)
+      flip(buddy);
+  }
+private:
+  static void flip(std::vector<BoutReal> &copy) {
+    uint64_t v;
+    std::memcpy(&v, &copy.back(), sizeof(v));
+    v ^= 1;
+    std::memcpy(&copy.back(), &v, sizeof(v));
+  }
+};
+
+int main(int argc, char **argv) {
+  BoutInitialise(argc, argv);
+
+  Options *options = Options::getRoot()->getSection("checkpoint");
+  int n;
+  OPTION(options, n, 1000);
+
+  MPI_Comm comm = BoutComm::get();
+  int mype, npes;
+  MPI_Comm_rank(comm, &mype);
+  MPI_Comm_size(comm, &npes);
+
+  // Different values on each processor
+  std::vector<BoutReal> data(n);
+  for(int i=0;i<n;i++)
+    data[i] = mype*n + i + 0.5;
+  const BoutReal time = 1.5;
+  const int iter = 7;
+
+  int passed = 1;
+  std::vector<BoutReal> result(n);
+  BoutReal simtime;
+  int iteration;
+  auto check = [&](const char *name) {
+    if((simtime != time) || (iteration != iter) || (result != data)) {
+      output.write("FAILED: %s\n", name);
+      passed = 0;
+    }
+  };
+  auto clear = [&]() {
+    std::fill(result.begin(), result.end(), 0.0);
+    simtime = 0.0;
+    iteration = 0;
+  };
+
+  TestCheckpoint checkpoint;
+  checkpoint.save(comm, data.data(), n, time, iter);
+
+  // Only processor 0
+  if(mype == 0) {
+    clear();
+    if(!checkpoint.restore(result.data(), n, simtime, iteration)) {
+      output.write("FAILED: restore returned false\n");
+      passed = 0;
+    }
+    check("restore");
+  }
+  MPI_Barrier(comm);
+
+  // All copies valid
+  clear();
+  checkpoint.recover(result.data(), n, simtime, iteration);
+  check("recover");
+
+  // Processor 0's own copy corrupted
+  if(mype == 0) {
+    checkpoint.corruptLocal();
+    clear();
+    if(checkpoint.restore(result.data(), n, simtime, iteration)) {
+      output.write("FAILED: restore of corrupted copy returned true\n");
+      passed = 0;
+    }
+  }
+
+  clear();
+  bool thrown = false;
+  try {
+    checkpoint.recover(result.data(), n, simtime, iteration);
+  }catch(BoutException &e) {
+    thrown = true;
+  }
+  if(npes == 1) {
+    // No buddy copy
+    if(!thrown) {
+      output.write("FAILED: recover of corrupted copy didn't throw\n");
+      passed = 0;
+    }
+  }else {
+    if(thrown) {
+      output.write("FAILED: recover from buddy copy threw\n");
+      passed = 0;
+    }
+    check("recover from buddy");
+
+    // Both copies of processor 0's checkpoint corrupted
+    checkpoint.corruptBuddy(0);
+    clear();
+    thrown = false;
+    try {
+      checkpoint.recover(result.data(), n, simtime, iteration);
+    }catch(BoutException &e) {
+      thrown = true;
+    }
+    if(mype == 0) {
+      if(!thrown) {
+        output.write("FAILED: recover with no valid copy didn't throw\n");
+        passed = 0;
+      }
+    }else {
+      if(thrown) {
+        output.write("FAILED: recover threw on processor with valid copy\n");
+        passed = 0;
+      }
+      check("recover on other processors");
+    }
+  }
+
+  int allpassed;
+  MPI_Allreduce(&passed, &allpassed, 1, MPI_INT, MPI_MIN, comm);
+
+  SAVE_ONCE(allpassed);
+
+  output << "******* MemoryCheckpoint test case: ";
+  if(allpassed) {
+    output << "PASSED" << endl;
+  }else
+    output << "FAILED" << endl;
+
+  dump.write();
+  dump.close();
+
+  MPI_Barrier(comm);
+
+  BoutFinalise();
+  return 0;
+}
@@ -27,6 +27,8 @@ int main(int argc, char **argv) {
   OPTION(options, tol, 1e-10);
   bool periodic;
   OPTION(options, periodic, false);
+  bool pipeline; // Overlap two solves, as InvertParCR does
+  OPTION(options, pipeline, false);
 
   // Create a cyclic reduction object, operating on Ts
   CyclicReduce<T> *cr =
@@ -79,22 +81,52 @@ int main(int argc, char **argv) {
 
   cr->setPeriodic(periodic);
   cr->setCoefs(nsys, a, b, c);
-  cr->solve(nsys, rhs, x);
 
   // Check result
-
   int passed = 1;
-  for(int s=0;s<nsys;s++) {
-    output << "System " << s << endl;
-    for(int i=0;i<n;i++) {
-      T val = ((mype*n + i) % 4) - 2.;
-      output << "\t" << i << " : " << val << " ?= " << x[s][i] << endl;
-      if(abs(val - x[s][i]) > tol) {
-        passed = 0;
+  auto check = [&](T **x) {
+    for(int s=0;s<nsys;s++) {
+      output << "System " << s << endl;
+      for(int i=0;i<n;i++) {
+        T val = ((mype*n + i) % 4) - 2.;
+        output << "\t" << i << " : " << val << " ?= " << x[s][i] << endl;
+        if(abs(val - x[s][i]) > tol) {
+          passed = 0;
+        }
       }
     }
+  };
+
+  if(pipeline) {
+    // Two solvers on the same communicator, with the stages
+    // interleaved so that both have messages in flight at once
+    CyclicReduce<T> *cr2 = new CyclicReduce<T>(BoutComm::get(), n);
+    cr2->setPeriodic(periodic);
+    cr2->setCoefs(nsys, a, b, c);
+
+    T **x2 = matrix<T>(nsys, n);
+
+    cr->solveStart(nsys, rhs);
+    cr2->solveStart(nsys, rhs);
+    cr->solveInterface();
+    cr2->solveInterface();
+    cr->solveFinish(x);
+    cr2->solveFinish(x2);
+
+    check(x);
+    check(x2);
+
+    free_matrix(x2);
+    delete cr2;
+  }else {
+    cr->solve(nsys, rhs, x);
+    check(x);
   }
 
+  // Solve again with the same object
+  cr->solve(nsys, rhs, x);
+  check(x);
+
   int allpassed;
   MPI_Allreduce(&passed, &allpassed, 1, MPI_INT, MPI_MIN, BoutComm::get());
 
@@ -7,6 +7,10 @@
 
 #include <bout.hxx>
 #include <field_factory.hxx>
+#include <bout/constants.hxx>
+
+#include <cmath>
+#include <vector>
 
 int main(int argc, char **argv) {
 
@@ -21,6 +25,49 @@ int main(int argc, char **argv) {
   Field3D d = f.create3D("gauss(x-0.5,0.2)*gauss(y)*sin(z)");
   SAVE_ONCE4(a, b, c, d);
 
+  // Compare compiled programs against calling generate() at each point.
+  // Expressions are evaluated at several times, and on two grids, to
+  // check which registers are re-used between evaluations
+  const char* exprs[] = {"1 - x",
+                         "sin(3*z) + 2",
+                         "gauss(x-0.5,0.2)*gauss(y)*sin(z)",
+                         "sin(t - x) * cos(2*z) * y^2",
+                         "exp(-t) * (x + sqrt(y + 1)) / (2 + cos(z))",
+                         "tanh(x*t) + abs(y - 3) - h(z - pi)",
+                         "min(x, y) + max(x*t, z) + power(x + 1, 2)",
+                         "erf(x - t) + mixmode(z) + tanhhat(x, 0.5, 0.5, 0.1)"};
+  
+  int nx = 5, ny = 4, nz = 6;
+  std::vector<double> x(nx), y(ny), z(nz), result(nx*ny*nz);
+  int allpassed = 1;
+  for(const auto &expr : exprs) {
+    FieldGenerator *gen = f.parse(expr);
+    FieldProgram *prog = f.program(gen);
+    
+    BoutReal times[] = {0.0, 1.5, 1.5, 0.3};
+    for(int grid=0;grid<2;grid++) {
+      for(int i=0;i<nx;i++) x[i] = 0.1 + 0.2*i + 0.05*grid;
+      for(int i=0;i<ny;i++) y[i] = 1.3*i;
+      for(int i=0;i<nz;i++) z[i] = TWOPI*i/nz + 0.1*grid;
+      
+      for(BoutReal t : times) {
+        prog->evaluate(x.data(), nx, y.data(), ny, z.data(), nz, t, result.data());
+        
+        BoutReal maxerr = 0.0;
+        for(int i=0;i<nx;i++)
+          for(int j=0;j<ny;j++)
+            for(int k=0;k<nz;k++)
+              maxerr = std::max(maxerr, std::abs(result[(i*ny + j)*nz + k] -
+                                                 gen->generate(x[i], y[j], z[k], t)));
+        if(!(maxerr < 1e-12)) {
+          output.write("FAILED: '%s' at t = %e: maximum difference %e\n", expr, t, maxerr);
+          allpassed = 0;
+        }
+      }
+    }
+  }
+  SAVE_ONCE(allpassed);
+
   // Write data to file
   dump.write();
   dump.close();
@@ -1,14 +1,19 @@
 /*
  * Global fields for gather/scatter
  * 
- * 
+ * Run on several processors, with equal and unequal domain sizes
+ * (mesh:xsizes, mesh:ysizes and mesh:load_balance)
  */
 
 #include <bout.hxx>
-#include <boutmain.hxx>
 #include <bout/globalfield.hxx>
 
-int physics_init(bool restarting) {
+int main(int argc, char **argv) {
+  
+  // Initialise BOUT++, setting up mesh
+  BoutInitialise(argc, argv);
+  
+  int passed = 1;
   
   /////////////////////////////////////////////////////////////
   // 2D fields
@@ -43,6 +48,8 @@ int physics_init(bool restarting) {
         }
       }
     output << "2D GATHER TEST: " << gather_pass << endl;
+    if(!gather_pass)
+      passed = 0;
   }
   
   // Scatter back and check
@@ -59,6 +66,8 @@ int physics_init(bool restarting) {
       }
     }
   output << "2D SCATTER TEST: " << scatter_pass << endl;
+  if(!scatter_pass)
+    passed = 0;
   
   /////////////////////////////////////////////////////////////
   // 3D fields
@@ -95,6 +104,8 @@ int physics_init(bool restarting) {
           }
       }
     output << "3D GATHER TEST: " << gather_pass3D << endl;
+    if(!gather_pass3D)
+      passed = 0;
   }
   
   // Scatter back and check
@@ -111,13 +122,20 @@ int physics_init(bool restarting) {
           scatter_pass3D = false;
         }
       }
-  output << "2D SCATTER TEST: " << scatter_pass3D << endl;
+  output << "3D SCATTER TEST: " << scatter_pass3D << endl;
+  if(!scatter_pass3D)
+    passed = 0;
 
+  int allpassed;
+  MPI_Allreduce(&passed, &allpassed, 1, MPI_INT, MPI_MIN, BoutComm::get());
+  SAVE_ONCE(allpassed);
 
-  return 1; // Signal an error, so quits
-}
+  // Write data to file
+  dump.write();
+  dump.close();
+
+  MPI_Barrier(BoutComm::get());
 
-int physics_run(BoutReal t) {
-  // Doesn't do anything
-  return 1;
+  BoutFinalise();
+  return 0;
 }
@@ -5,10 +5,15 @@
  * the I/O routines are working.
  *
  * Test evolving and non-evolving variables
+ *
+ * Also writes and reads back a file in the native binary format,
+ * as used for restart files, and checks that corruption is detected
  */
 
 #include <bout.hxx>
 
+#include <cstdio>
+
 int main(int argc, char **argv) {
 
   // Initialise BOUT++, setting up mesh
@@ -31,6 +36,76 @@ int main(int argc, char **argv) {
   mesh->get(f2d, "f2d");
   mesh->get(f3d, "f3d");
 
+  // Native binary format. The second write replaces the first, as
+  // when restart files are written each output
+  string datadir;
+  Options::getRoot()->get("datadir", datadir, "data");
+
+  int bin_ivar = ivar + 1;
+  BoutReal bin_rvar = rvar + 1.0;
+  Field2D bin_f2d = f2d + 1.0;
+  Field3D bin_f3d = f3d + 1.0;
+
+  Datafile bin(Options::getRoot()->getSection("binary"));
+  bin.add(bin_ivar, "ivar", false);
+  bin.add(bin_rvar, "rvar", false);
+  bin.add(bin_f2d, "f2d", false);
+  bin.add(bin_f3d, "f3d", false);
+  bin.openw("%s/BOUT.test.bin", datadir.c_str());
+  bin.write();
+
+  bin_ivar = ivar;
+  bin_rvar = rvar;
+  bin_f2d = f2d;
+  bin_f3d = f3d;
+  bin.write();
+  bin.close();
+
+  // Read back into different variables
+  int in_ivar = 0;
+  BoutReal in_rvar = 0.0;
+  Field2D in_f2d = 0.0;
+  Field3D in_f3d = 0.0;
+
+  Datafile binr(Options::getRoot()->getSection("binary"));
+  binr.add(in_ivar, "ivar", false);
+  binr.add(in_rvar, "rvar", false);
+  binr.add(in_f2d, "f2d", false);
+  binr.add(in_f3d, "f3d", false);
+  binr.openr("%s/BOUT.test.bin", datadir.c_str());
+  binr.read();
+
+  bool binpassed = (in_ivar == ivar) && (in_rvar == rvar)
+    && (max(abs(in_f2d - f2d), true) < 1e-10) && (max(abs(in_f3d - f3d), true) < 1e-10);
+
+  int MYPE;
+  MPI_Comm_rank(BoutComm::get(), &MYPE);
+
+  // Flip one bit in the last variable, which should fail its checksum
+  char binname[256];
+  snprintf(binname, 256, "%s/BOUT.test.%d.bin", datadir.c_str(), MYPE);
+  FILE *fp = fopen(binname, "r+b");
+  if(fp) {
+    fseek(fp, -1, SEEK_END);
+    int c = fgetc(fp);
+    fseek(fp, -1, SEEK_END);
+    fputc(c ^ 1, fp);
+    fclose(fp);
+  }
+
+  bool detected = false;
+  try {
+    binr.read();
+  } catch(BoutException &e) {
+    detected = true;
+  }
+  if(!detected)
+    output.write("Corrupted binary file was not detected\n");
+
+  int bin_passed = (binpassed && detected) ? 1 : 0;
+  MPI_Allreduce(MPI_IN_PLACE, &bin_passed, 1, MPI_INT, MPI_MIN, BoutComm::get());
+  dump.add(bin_passed, "bin_passed", false);
+
   // Non-evolving variables
   dump.add(ivar, "ivar", false);
   dump.add(rvar, "rvar", false);
@@ -43,9 +118,6 @@ int main(int argc, char **argv) {
   dump.add(v2d, "v2d_evol", true);
   dump.add(v3d, "v3d_evol", true);
 
-  int MYPE;
-  MPI_Comm_rank(BoutComm::get(), &MYPE);
-
   for(int i=0;i<3;i++) {
     ivar_evol = ivar + i;
     rvar_evol = rvar + 0.5 * i;
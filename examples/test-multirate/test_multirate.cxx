@@ -0,0 +1,57 @@
+/*
+ * Test of the multirate solver
+ *
+ * A slow variable s decays as exp(-t), and a fast variable f
+ * relaxes towards s at a rate k >> 1. The fast variable is in
+ * rate group 1, so is subcycled. The number of evaluations of
+ * each group's terms is saved, so the runtest script can check
+ * that the slow terms are not calculated on every substep.
+ */
+
+#include <bout/physicsmodel.hxx>
+
+class TestMultirate : public PhysicsModel {
+protected:
+  int init(bool restarting) {
+    Options *opt = Options::getRoot()->getSection("multirate");
+    OPTION(opt, k, 50.0);
+    OPTION(opt, group_rhs, true); // Calculate single groups?
+    
+    SOLVE_FOR2(s, f);
+    
+    nslow = nfast = 0.0;
+    SAVE_REPEAT2(nslow, nfast);
+    return 0;
+  }
+  
+  int rhs(BoutReal time) {
+    ddt(s) = -s;
+    ddt(f) = -k*(f - s);
+    nslow++;
+    nfast++;
+    return 0;
+  }
+  
+  int rhs_group(BoutReal time, int group) {
+    if(!group_rhs) {
+      // Use the default, which calls rhs(time)
+      return PhysicsModel::rhs_group(time, group);
+    }
+    if(group == 0) {
+      ddt(s) = -s;
+      nslow++;
+    }else {
+      ddt(f) = -k*(f - s);
+      nfast++;
+    }
+    return 0;
+  }
+  
+private:
+  Field3D s, f;
+  BoutReal k;
+  bool group_rhs;
+  BoutReal nslow, nfast; // Number of evaluations of each group
+};
+
+BOUTMAIN(TestMultirate);
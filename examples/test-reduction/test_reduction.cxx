@@ -0,0 +1,113 @@
+/*
+ * Test FieldReduction
+ *
+ * Many reductions of several fields are performed together, and
+ * compared against min(f, true), max(f, true) and sums with one
+ * MPI_Allreduce each. The number of reductions can be made large,
+ * so that the combined buffer is large
+ */
+
+#include <bout.hxx>
+
+#include <bout/reduction.hxx>
+#include <field_factory.hxx>
+
+#include <cmath>
+#include <vector>
+
+/// Sum over the domain interior and all processors
+BoutReal globalSum(const Field3D &f, bool square) {
+  BoutReal local = 0.0;
+  for(int x=mesh->xstart;x<=mesh->xend;x++)
+    for(int y=mesh->ystart;y<=mesh->yend;y++)
+      for(int z=0;z<mesh->LocalNz;z++)
+        local += square ? SQ(f(x,y,z)) : f(x,y,z);
+  BoutReal result;
+  MPI_Allreduce(&local, &result, 1, MPI_DOUBLE, MPI_SUM, BoutComm::get());
+  return result;
+}
+
+BoutReal globalSum(const Field2D &f) {
+  BoutReal local = 0.0;
+  for(int x=mesh->xstart;x<=mesh->xend;x++)
+    for(int y=mesh->ystart;y<=mesh->yend;y++)
+      local += f(x,y);
+  BoutReal result;
+  MPI_Allreduce(&local, &result, 1, MPI_DOUBLE, MPI_SUM, BoutComm::get());
+  return result;
+}
+
+int main(int argc, char **argv) {
+  BoutInitialise(argc, argv);
+
+  Options *options = Options::getRoot()->getSection("reduction");
+  int nfields;
+  OPTION(options, nfields, 100);
+  BoutReal tol;
+  OPTION(options, tol, 1e-10);
+
+  Field3D f3d = FieldFactory::get()->create3D("f3d", options, mesh);
+  Field2D f2d = FieldFactory::get()->create2D("f2d", options, mesh);
+
+  int passed = 1;
+  auto check = [&](const char *name, int i, BoutReal value, BoutReal expected) {
+    if(std::abs(value - expected) > tol * (1.0 + std::abs(expected))) {
+      output.write("FAILED: %s %d : %e, expected %e\n", name, i, value, expected);
+      passed = 0;
+    }
+  };
+
+  // Do it twice, to check that the object can be re-used
+  FieldReduction red;
+  for(int repeat=0;repeat<2;repeat++) {
+    red.clear();
+
+    // Fields are copied by FieldReduction, so temporaries can be used
+    std::vector<int> imin3, imax3, isum3, inorm3, imin2, imax2, isum2;
+    for(int i=0;i<nfields;i++) {
+      BoutReal scale = (i % 2 == 0) ? i + 1.0 : -(i + 1.0);
+      imin3.push_back(red.min(scale*f3d + i));
+      imax3.push_back(red.max(scale*f3d + i));
+      isum3.push_back(red.sum(scale*f3d));
+      inorm3.push_back(red.norm2(scale*f3d));
+      imin2.push_back(red.min(scale*f2d));
+      imax2.push_back(red.max(scale*f2d));
+      isum2.push_back(red.sum(scale*f2d));
+    }
+    red.start();
+    red.finish();
+
+    for(int i=0;i<nfields;i++) {
+      BoutReal scale = (i % 2 == 0) ? i + 1.0 : -(i + 1.0);
+      Field3D g3d = scale*f3d + i;
+      Field2D g2d = scale*f2d;
+
+      check("min Field3D", i, red[imin3[i]], min(g3d, true));
+      check("max Field3D", i, red[imax3[i]], max(g3d, true));
+      check("sum Field3D", i, red[isum3[i]], scale*globalSum(f3d, false));
+      check("norm2 Field3D", i, red[inorm3[i]], std::abs(scale)*sqrt(globalSum(f3d, true)));
+      check("min Field2D", i, red[imin2[i]], min(g2d, true));
+      check("max Field2D", i, red[imax2[i]], max(g2d, true));
+      check("sum Field2D", i, red[isum2[i]], scale*globalSum(f2d));
+    }
+  }
+
+  int allpassed;
+  MPI_Allreduce(&passed, &allpassed, 1, MPI_INT, MPI_MIN, BoutComm::get());
+
+  SAVE_ONCE(allpassed);
+
+  output << "******* FieldReduction test case: ";
+  if(allpassed) {
+    output << "PASSED" << endl;
+  }else
+    output << "FAILED" << endl;
+
+  dump.write();
+  dump.close();
+
+  MPI_Barrier(BoutComm::get());
+
+  BoutFinalise();
+  return 0;
+}
@@ -0,0 +1,39 @@
+/*
+ * Test of restarting on a different processor decomposition
+ *
+ * The variables don't change in time, so after restarting they
+ * should be the same as the values written to the restart files.
+ * A variable which is not in the restart files can be added when
+ * restarting, and should be set to zero.
+ */
+
+#include <bout/physicsmodel.hxx>
+
+class TestRestartRedistribute : public PhysicsModel {
+protected:
+  int init(bool restarting) {
+    // Evolve a variable which is not in the restart files?
+    Options::getRoot()->getSection("test")->get("extra", extra, false);
+
+    SOLVE_FOR(f);
+    SOLVE_FOR(g);
+    if(extra)
+      SOLVE_FOR(h);
+    return 0;
+  }
+
+  int rhs(BoutReal time) {
+    ddt(f) = 0.0;
+    ddt(g) = 0.0;
+    if(extra)
+      ddt(h) = 0.0;
+    return 0;
+  }
+
+private:
+  Field3D f, h;
+  Field2D g;
+  bool extra;
+};
+
+BOUTMAIN(TestRestartRedistribute);
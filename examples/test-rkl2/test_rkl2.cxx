@@ -0,0 +1,31 @@
+/*
+ * Test of the RKL2 super time-stepping solver
+ *
+ * Diffusion in Y on a periodic domain. The runtest script checks that
+ * the solver is stable far beyond the explicit timestep limit, and
+ * that the error converges at second order in the timestep.
+ */
+
+#include <bout/physicsmodel.hxx>
+#include <derivs.hxx>
+
+class TestRKL2 : public PhysicsModel {
+protected:
+  int init(bool restarting) {
+    Options::getRoot()->getSection("diffusion")->get("D", D, 1.0);
+    SOLVE_FOR(f);
+    return 0;
+  }
+
+  int rhs(BoutReal time) {
+    mesh->communicate(f);
+    ddt(f) = D*D2DY2(f);
+    return 0;
+  }
+
+private:
+  Field3D f;
+  BoutReal D; // Diffusion coefficient
+};
+
+BOUTMAIN(TestRKL2);
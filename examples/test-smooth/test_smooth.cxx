@@ -7,6 +7,20 @@
 #include <smoothing.hxx>
 #include <field_factory.hxx>
 
+#include <cmath>
+
+/// Maximum difference over the domain interior, on all processors
+BoutReal maxDiff(const Field3D &a, const Field3D &b) {
+  BoutReal local = 0.0;
+  for(int x=mesh->xstart;x<=mesh->xend;x++)
+    for(int y=mesh->ystart;y<=mesh->yend;y++)
+      for(int z=0;z<mesh->LocalNz;z++)
+        local = std::max(local, std::abs(a(x,y,z) - b(x,y,z)));
+  BoutReal result;
+  MPI_Allreduce(&local, &result, 1, MPI_DOUBLE, MPI_MAX, BoutComm::get());
+  return result;
+}
+
 int main(int argc, char **argv) {
 
   // Initialise BOUT++, setting up mesh
@@ -28,6 +42,50 @@ int main(int argc, char **argv) {
   
   Field3D sm3d = smooth_y(input3d);
   SAVE_ONCE(sm3d);
+
+  // Checks which don't need benchmark values
+  int allpassed = 1;
+  auto check = [&](const char *name, BoutReal diff) {
+    output.write("%s: maximum difference %e\n", name, diff);
+    if(!(diff < 1e-12)) // Also fails if NaN
+      allpassed = 0;
+  };
+  
+  // Averaging several fields at once gives the same as one at a time
+  Field3D second = f.create3D("cos(x + 2*z) * y");
+  
+  auto yavgs = averageY({input3d, second});
+  check("averageY(vector)[0]", maxDiff(yavgs[0], yavg3d));
+  check("averageY(vector)[1]", maxDiff(yavgs[1], averageY(second)));
+  
+  auto xavgs = averageX({input3d, second});
+  check("averageX(vector)[0]", maxDiff(xavgs[0], averageX(input3d)));
+  check("averageX(vector)[1]", maxDiff(xavgs[1], averageX(second)));
+  
+  // The X average of a field independent of X is unchanged
+  Field3D noX = f.create3D("sin(y) * cos(z)");
+  check("averageX(sin(y)*cos(z))", maxDiff(averageX(noX), noX));
+  
+  // Nonlinear filters only change local extrema, so leave monotonic
+  // functions unchanged
+  Field3D mono = f.create3D("x + y + z");
+  check("nl_filter_x", maxDiff(nl_filter_x(mono), mono));
+  check("nl_filter_y", maxDiff(nl_filter_y(mono), mono));
+  Field3D noZ = f.create3D("x + y");
+  check("nl_filter_z", maxDiff(nl_filter_z(noZ), noZ));
+  
+  // Grid-scale oscillations in Z are reduced
+  Field3D zigzag = f.create3D("cos(4*z)"); // +1, -1, +1, ... since MZ = 8
+  if(max(abs(nl_filter_z(zigzag)), true) > 1.0 - 1e-3) {
+    output.write("nl_filter_z didn't reduce oscillations\n");
+    allpassed = 0;
+  }
+
+  // The 1-2-1 filter in X leaves linear functions of X unchanged
+  Field3D linx = f.create3D("x");
+  check("smooth_x", maxDiff(smooth_x(linx), linx));
+  
+  SAVE_ONCE(allpassed);
   
   // Output data
   dump.write();
@@ -66,6 +66,12 @@ public:
     apply(ddt(f));
   }
 
+  /// True if apply(Field3D&, BoutReal) and apply_ddt(Field3D&) can be
+  /// called for different fields at the same time. Such operations must loop over
+  /// bndry->points() rather than iterating with bndry->first() etc.
+  /// Staggered fields are always applied one at a time.
+  virtual bool threadSafe() const { return false; }
+
   BoundaryRegion *bndry;
   bool apply_to_ddt; // True if this boundary condition should be applied on the time derivatives, false if it should be applied to the field values
 };
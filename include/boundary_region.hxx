@@ -5,8 +5,11 @@ class BoundaryRegion;
 #define __BNDRY_REGION_H__
 
 #include <string>
+#include <vector>
 using std::string;
 
+#include "bout_types.hxx"
+
 enum BndryLoc {BNDRY_XIN=1,
                BNDRY_XOUT=2,
                BNDRY_YDOWN=4,
@@ -32,6 +35,12 @@ public:
   virtual bool isDone() = 0; // Returns true if outside domain. Can use this with nested nextX, nextY
 };
 
+/// A point on the innermost layer of a boundary region
+struct BoundaryPoint {
+  int x, y; ///< Indices of the guard cell next to the domain
+  BoutReal xnorm, ynorm; ///< Normalised coordinates (0 -> 1) half-way between the guard cell and grid cell
+};
+
 /// Describes a region of the boundary, and a means of iterating over it
 class BoundaryRegion : public BoundaryRegionBase {
 public:
@@ -48,6 +57,14 @@ public:
   virtual void next1d() = 0; // Loop over the innermost elements
   virtual void nextX() = 0; // Just loop over X
   virtual void nextY() = 0; // Just loop over Y
+
+  /// The innermost points, in the same order as next1d(). Calculated on
+  /// the first call, which changes x and y so must not be done in a
+  /// parallel region. After that this can be used by several threads.
+  const std::vector<BoundaryPoint>& points();
+private:
+  std::vector<BoundaryPoint> pts;
+  bool points_calculated = false;
 };
 
 class BoundaryRegionXIn : public BoundaryRegion {
@@ -8,6 +8,28 @@
 #include <field_factory.hxx>
 #include "unused.hxx"
 
+#include <vector>
+
+/// Values of a generator at all points in a boundary region, stored in
+/// the order [layer][point][z]. Layer 0 is half-way between the guard
+/// cells and grid cells; layer i > 0 is i cells outwards from the first
+/// guard cell. All points are evaluated together, and the values are kept
+/// until the generator or size changes, or the time changes and the
+/// generator depends on time.
+class BoundaryValues {
+public:
+  BoundaryValues() : gen(nullptr), nlayers(0), nz(0), time(0.0), valid(false) {}
+
+  /// Returns nullptr if \p g is null. nz = 1 gives values at z = 0, for a Field2D
+  const BoutReal* get(BoundaryRegion *bndry, FieldGenerator *g, int layers, int nz, BoutReal t);
+private:
+  FieldGenerator *gen;
+  int nlayers, nz;
+  BoutReal time;
+  bool valid;
+  std::vector<BoutReal> data;
+};
+
 /// Dirichlet boundary condition set half way between guard cell and grid cell at 2nd order accuracy
 class BoundaryDirichlet_2ndOrder : public BoundaryOp {
  public:
@@ -37,8 +59,11 @@ class BoundaryDirichlet : public BoundaryOp {
 
   void apply_ddt(Field2D &f);
   void apply_ddt(Field3D &f);
+
+  bool threadSafe() const { return true; }
  private:
   FieldGenerator* gen; // Generator
+  BoundaryValues values; // Values of the generator on the boundary
 };
 
 BoutReal default_func(BoutReal t, int x, int y, int z);
@@ -145,8 +170,11 @@ class BoundaryNeumann : public BoundaryOp {
 
   void apply_ddt(Field2D &f);
   void apply_ddt(Field3D &f);
+
+  bool threadSafe() const { return true; }
  private:
   FieldGenerator *gen;
+  BoundaryValues values; // Values of the generator on the boundary
 };
 
 /// Neumann boundary condition set half way between guard cell and grid cell at 4th order accuracy
@@ -284,6 +312,8 @@ public:
  void apply(Field3D &f);
  void apply_ddt(Field2D &f);
  void apply_ddt(Field3D &f);
+
+ bool threadSafe() const { return true; }
 };
 
 class BoundaryFree_O3 : public BoundaryOp {
@@ -296,6 +326,7 @@ public:
  void apply_ddt(Field2D &f);
  void apply_ddt(Field3D &f);
 
+ bool threadSafe() const { return true; }
 };
 // End L.Easy
 
@@ -65,6 +65,9 @@
 
 const BoutReal BOUT_VERSION = 4;  ///< Version number
 
+const char DEFAULT_DIR[] = "data";     ///< Default data directory
+const char DEFAULT_OPT[] = "BOUT.inp"; ///< Default input file in the data directory
+
 // BOUT++ main functions
 
 /*!
@@ -93,6 +96,13 @@ const BoutReal BOUT_VERSION = 4;  ///< Version number
  */
 int BoutInitialise(int &argc, char **&argv);
 
+/*!
+ * Open the global dump file in \p data_dir, and add the
+ * time, iteration and mesh variables to it. Called by
+ * BoutInitialise, or for each member of an ensemble
+ */
+void bout_open_dump(const char *data_dir);
+
 /*!
  * Run the given solver. This function is only used
  * for old-style physics models with standalone C functions
@@ -150,6 +150,24 @@ public:
     use_store = false;
   }
   
+  /*!
+   * Total number of arrays which have been requested, either
+   * from the store or newly allocated. The difference between
+   * two calls gives the number of allocations in between, e.g.
+   * the number of temporary fields created in an RHS call.
+   */
+  static long allocations() {
+    return nalloc;
+  }
+
+  /*!
+   * Number of arrays for which new memory was allocated,
+   * because no array of the right size was in the store
+   */
+  static long newAllocations() {
+    return nnew;
+  }
+
   /*!
    * Returns true if the Array is empty
    */
@@ -273,14 +291,18 @@ private:
    */
   static std::map< int, std::vector<ArrayData* > > store;
   static bool use_store; ///< Should the store be used?
+  static long nalloc; ///< Number of calls to get()
+  static long nnew;   ///< Number of ArrayData objects created
   
   /*!
    * Returns a pointer to an ArrayData object with no
    * references. This is either from the store, or newly allocated
    */
   ArrayData* get(int len) {
+    nalloc++;
     std::vector<ArrayData* >& st = store[len];
     if(st.empty()) {
+      nnew++;
       return new ArrayData(len);
     }
     ArrayData *p = st.back();
@@ -0,0 +1,102 @@
+/*!************************************************************************
+ * \file checkpoint.hxx
+ *
+ * @brief In-memory checkpoints, copied to a partner ("buddy") processor
+ *
+ * Writing restart files is slow, so they are usually written rarely. A
+ * MemoryCheckpoint keeps a copy of the evolving variables in memory
+ * instead, which is cheap enough to update every few minutes. Each
+ * processor keeps its own copy, and sends a second copy to a buddy
+ * processor, by preference on another node. Every copy has a checksum,
+ * so a corrupted copy is never used.
+ *
+ * The Solver takes checkpoints at output times if solver:checkpoint_interval
+ * (seconds of wall time) is set, and rolls back to the last checkpoint
+ * if the run fails (see Solver::solve).
+ *
+ * save() and recover() must be called on all processors. restore()
+ * does not communicate, so can be called by a processor on its own,
+ * for example after an error which other processors have not seen.
+ *
+ **************************************************************************
+ * Copyright 2017 B.D.Dudson
+ *
+ * Contact: Ben Dudson, bd512@york.ac.uk
+ *
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+class MemoryCheckpoint;
+
+#ifndef __CHECKPOINT_H__
+#define __CHECKPOINT_H__
+
+#include "bout_types.hxx"
+
+#include <mpi.h>
+#include <vector>
+
+class MemoryCheckpoint {
+public:
+  MemoryCheckpoint() : comm(MPI_COMM_NULL), send_to(-1), recv_from(-1) {}
+
+  /// Store \p n values from \p data, with the time and iteration.
+  /// Replaces any previous checkpoint
+  void save(MPI_Comm comm, const BoutReal *data, int n, BoutReal simtime, int iteration);
+
+  /// Has a checkpoint been saved?
+  bool valid() const { return !local.empty(); }
+
+  /// Iteration of the last checkpoint, or -1 if none
+  int iteration() const;
+
+  /// Copy this processor's last checkpoint into \p data, which must
+  /// have the size which was saved, and set the time and iteration.
+  /// Returns false, leaving the arguments unchanged, if the copy has
+  /// been corrupted. Doesn't communicate
+  bool restore(BoutReal *data, int n, BoutReal &simtime, int &iteration);
+
+  /// As restore(), but a processor whose copy has been corrupted gets
+  /// the copy held by its buddy. Copies are only exchanged if some
+  /// processor needs one. Must be called on all processors
+  void recover(BoutReal *data, int n, BoutReal &simtime, int &iteration);
+
+protected:
+  MPI_Comm comm;
+  int send_to, recv_from; ///< Processors holding our copy, and whose copy we hold
+
+  /// Copies are stored as (time, iteration, checksum, data...). The
+  /// checksum bits are stored in a BoutReal, so no other type is sent
+  std::vector<BoutReal> local; ///< This processor's copy
+  std::vector<BoutReal> buddy; ///< Copy belonging to processor recv_from
+
+  /// Choose send_to and recv_from
+  void findBuddy();
+
+  /// Send \p out to \p dest, receiving \p in from \p source
+  void exchange(const std::vector<BoutReal> &out, int dest, std::vector<BoutReal> &in, int source);
+
+  /// Checksum of a copy, excluding the checksum itself
+  static BoutReal checksum(const std::vector<BoutReal> &copy);
+  /// Does the checksum of \p copy match?
+  static bool check(const std::vector<BoutReal> &copy);
+  /// Copy the contents of \p copy, which must hold \p n values
+  static void unpack(const std::vector<BoutReal> &copy, BoutReal *data, int n,
+                     BoutReal &simtime, int &iteration);
+};
+
+#endif // __CHECKPOINT_H__
@@ -0,0 +1,149 @@
+/*!************************************************************************
+ * \file diagnostics.hxx
+ *
+ * @brief Reduced diagnostics calculated during a run, at high cadence
+ *
+ * Quantities such as energies, profiles and spectra are often all that
+ * is needed from a simulation at high time resolution, but calculating
+ * them afterwards needs full 3D output at that resolution. Diagnostics
+ * calculates them during the run instead, every few timesteps, and
+ * writes them to a small time-series file separate from the dump files.
+ *
+ *     class MyModel : public PhysicsModel {
+ *       Field3D n, energy;
+ *       Diagnostics diag;
+ *
+ *       int init(bool restarting) {
+ *         ...
+ *         diag.volumeIntegral("energy", energy); // Fields stored by reference
+ *         diag.fluxSurfaceAverage("n_profile", n);
+ *         diag.spectrum("n_spectrum", n);
+ *         diag.probe("n_probe", n, 10, 20, 0);
+ *         diag.attach(solver);
+ *         return 0;
+ *       }
+ *     };
+ *
+ * The fields are evaluated each time the diagnostics are calculated, so
+ * derived quantities (here energy) must be kept up to date in rhs().
+ *
+ * Diagnostics are calculated in a timestep monitor, so need
+ * solver:monitor_timestep = true. Settings are in the [diagnostics] section:
+ *
+ *   - frequency       Number of timesteps between calculations (default 1)
+ *   - flushfrequency  Number of calculations between flushing the file (default 100)
+ *   - file            File name in the data directory (default BOUT.diag.bin)
+ *
+ * All processors calculate their part of every diagnostic, which are
+ * then combined with a single MPI_Reduce onto processor 0, which writes
+ * one record of each quantity and the time "t_diag". Profiles and spectra
+ * are arrays, which only the "bin" file format supports (see
+ * boutdata.binfile); NetCDF and HDF5 files can be used for scalars only.
+ *
+ **************************************************************************
+ * Copyright 2017 B.D.Dudson
+ *
+ * Contact: Ben Dudson, bd512@york.ac.uk
+ *
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+class Diagnostics;
+
+#ifndef __DIAGNOSTICS_H__
+#define __DIAGNOSTICS_H__
+
+#include <list>
+#include <string>
+#include <vector>
+
+#include "field3d.hxx"
+#include "field2d.hxx"
+#include "options.hxx"
+#include "dataformat.hxx"
+
+class Solver;
+
+class Diagnostics {
+public:
+  /// Settings are read from \p opt, by default the [diagnostics] section
+  Diagnostics(Options *opt = nullptr);
+  ~Diagnostics();
+  Diagnostics(const Diagnostics&) = delete;
+  Diagnostics& operator=(const Diagnostics&) = delete;
+
+  /// Each of these adds a diagnostic called \p name. The field is stored
+  /// by reference, so must exist as long as this object
+  ///@{
+  /// Integral of f * J*dx*dy*dz over the domain interior. A scalar
+  void volumeIntegral(const std::string &name, const Field3D &f);
+  void volumeIntegral(const std::string &name, const Field2D &f);
+  /// Average over Y and Z, weighted by J*dy. A profile in X of
+  /// length nx - 2*MXG, over the interior X points
+  void fluxSurfaceAverage(const std::string &name, const Field3D &f);
+  void fluxSurfaceAverage(const std::string &name, const Field2D &f);
+  /// Mean over the interior of |f_k|^2 for each Z Fourier mode
+  /// k = 0 ... nz/2, where f_k is normalised so that f_0 is the Z average
+  void spectrum(const std::string &name, const Field3D &f);
+  /// Value at a point, given by global indices including guard cells.
+  /// The point must be in the domain interior
+  void probe(const std::string &name, const Field3D &f, int x, int y, int z);
+  ///@}
+
+  /// Calculate the diagnostics every few timesteps of \p solver
+  void attach(Solver *solver);
+
+  /// Calculate all diagnostics now, and write them to file with time \p t.
+  /// Must be called on all processors
+  void calculate(BoutReal t);
+
+private:
+  enum class DiagType {volume, average, spectrum, probe};
+
+  /// One diagnostic. One of f3d and f2d is null
+  struct Item {
+    DiagType type;
+    std::string name;
+    const Field3D *f3d;
+    const Field2D *f2d;
+    int x, y, z;     ///< Local indices of probe, or -1 if not on this processor
+    int offset;      ///< Start in the buffer
+    int nsum;        ///< Number of values in the buffer
+    int length;      ///< Number of values in the output
+  };
+
+  /// Add a diagnostic with \p nsum values in the buffer and \p length outputs
+  Item& add(DiagType type, const std::string &name, const Field3D *f3d, const Field2D *f2d,
+            int nsum, int length);
+
+  std::vector<Item> items;
+  std::vector<BoutReal> buffer; ///< Values to be summed over processors
+  int nbuffer;                  ///< Size of buffer
+
+  int frequency;   ///< Timesteps between calculations
+  int counter;     ///< Timesteps since the last calculation
+  int flushfrequency; ///< Calculations between flushing the file
+  int unflushed;      ///< Calculations since the last flush
+  std::string filename;
+  DataFormat *file; ///< Only on processor 0, once opened
+  Solver *solver;   ///< Solver attached to, or null
+
+  static std::list<Diagnostics*> active; ///< Attached to a solver
+  static int monitor(Solver *solver, BoutReal simtime, BoutReal lastdt);
+};
+
+#endif // __DIAGNOSTICS_H__
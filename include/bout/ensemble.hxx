@@ -0,0 +1,143 @@
+/*!************************************************************************
+ * \file ensemble.hxx
+ *
+ * @brief Run many independent cases (ensemble members) in one job
+ *
+ * MPI_COMM_WORLD is split into a number of groups, each of which is
+ * given to BOUT++ as its communicator. Every group then runs a share
+ * of the ensemble members one after another, re-using the mesh,
+ * geometry, FFT plans and memory pools set up in the first member.
+ *
+ * Input options, in the [ensemble] section:
+ *
+ *   members   Total number of cases to run (default 1)
+ *   groups    Number of processor groups (default min(members, NPES))
+ *             Must divide the number of processors exactly.
+ *
+ * While a member is running, the option ensemble:member is set to its
+ * index so that input expressions can vary parameters, e.g.
+ *
+ *   [mymodel]
+ *   nu = 1e-3 * (1 + ensemble:member)
+ *
+ * Output for member m goes to <datadir>/member<m>/, which is created
+ * if it does not exist.
+ *
+ **************************************************************************
+ * Copyright 2017 B.D.Dudson
+ *
+ * Contact: Ben Dudson, bd512@york.ac.uk
+ *
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+class BoutEnsemble;
+
+#ifndef __BOUT_ENSEMBLE_H__
+#define __BOUT_ENSEMBLE_H__
+
+#include <bout.hxx>
+#include <string>
+
+/// Static functions managing an ensemble of runs
+///
+/// Usually used through the BOUTENSEMBLE macro, but can be
+/// called directly:
+///
+///     int init_err = BoutEnsemble::initialise(argc, argv);
+///     ...
+///     for(int m = BoutEnsemble::first(); m < BoutEnsemble::members();
+///         m = BoutEnsemble::next(m)) {
+///       BoutEnsemble::beginMember(m);
+///       ... create model and solver, solve ...
+///       BoutEnsemble::endMember();
+///     }
+///     BoutEnsemble::finalise();
+class BoutEnsemble {
+public:
+  /// Initialise MPI, split the processors into groups,
+  /// then call BoutInitialise on each group.
+  /// Returns the same codes as BoutInitialise
+  static int initialise(int &argc, char **&argv);
+
+  /// Finalise BOUT++, then MPI
+  static int finalise();
+
+  static int members() {return nmembers;} ///< Total number of members
+  static int groups() {return ngroups;}   ///< Number of processor groups
+  static int group() {return mygroup;}    ///< Group this processor is in
+
+  /// First member run by this group
+  static int first() {return mygroup;}
+  /// Member run by this group after member \p m
+  static int next(int m) {return m + ngroups;}
+
+  /// Set up options and output files for member \p m
+  static void beginMember(int m);
+  /// Close output files for the current member
+  static void endMember();
+
+private:
+  static int nmembers, ngroups, mygroup;
+  static bool mpi_initialised; ///< MPI_Init called in initialise?
+  static std::string base_dir; ///< Data directory for the whole ensemble
+};
+
+/// Macro to replace BOUTMAIN, running an ensemble of simulations
+/// with the same physics model. The model and solver are created
+/// anew for each member.
+/*!
+ * Example
+ * -------
+ *
+ * class MyModel : public PhysicsModel {
+ *    ..
+ * };
+ *
+ * BOUTENSEMBLE(MyModel);
+ */
+#define BOUTENSEMBLE(ModelClass)                                  \
+  int main(int argc, char **argv) {                               \
+    int init_err = BoutEnsemble::initialise(argc, argv);          \
+    if (init_err < 0)                                             \
+      return 0;                                                   \
+    else if (init_err > 0)                                        \
+      return init_err;                                            \
+    try {                                                         \
+      for(int m = BoutEnsemble::first(); m < BoutEnsemble::members(); \
+          m = BoutEnsemble::next(m)) {                            \
+        BoutEnsemble::beginMember(m);                             \
+        ModelClass *model = new ModelClass();                     \
+        Solver *solver = Solver::create();                        \
+        solver->setModel(model);                                  \
+        solver->addMonitor(bout_monitor, Solver::BACK);           \
+        solver->outputVars(dump);                                 \
+        solver->solve();                                          \
+        delete model;                                             \
+        delete solver;                                            \
+        BoutEnsemble::endMember();                                \
+      }                                                           \
+    }catch (BoutException &e) {                                   \
+      output << "Error encountered\n";                            \
+      output << e.what() << endl;                                 \
+      MPI_Abort(MPI_COMM_WORLD, 1);                               \
+    }                                                             \
+    BoutEnsemble::finalise();                                     \
+    return 0;                                                     \
+  }
+
+#endif // __BOUT_ENSEMBLE_H__
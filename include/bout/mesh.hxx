@@ -210,6 +210,34 @@ class Mesh {
   /// @param g  The group of fields to communicate. Guard cells will be modified
   void communicateXZ(FieldGroup &g);
 
+  /// Communicate only some of the guard cells
+  ///
+  /// @param g       The group of fields to communicate. Guard cells will be modified
+  /// @param xwidth  Number of X guard cells to exchange, between 0 (none) and xstart
+  /// @param ywidth  Number of Y guard cells to exchange, between 0 (none) and ystart.
+  ///                If non-zero, the yup and ydown fields are also calculated
+  void communicate(FieldGroup &g, int xwidth, int ywidth);
+
+  /// If lazy communication is enabled (mesh:lazy_comms), communicate()
+  /// doesn't exchange guard cells straight away, but adds the fields
+  /// to a list. Fields whose guard cells are already valid are skipped.
+  /// The list is communicated in a single exchange when guard cells are
+  /// first needed: by X or Y derivatives, Delp2, bracket, smoothing,
+  /// Laplacian inversions, interpolation, or before output. Copying or
+  /// assigning a waiting field adds the copy to the list, but doesn't
+  /// communicate, since copies needn't be made on every processor.
+  /// Code which reads guard cells directly should call this first.
+  void communicatePending() {
+    if(!pending_comms.empty())
+      sendPending();
+  }
+
+  /// Remove a field from the list waiting to be communicated.
+  /// Called when fields are destroyed
+  void cancelCommunication(FieldData &f);
+
+  bool lazy_comms; ///< Delay communications until guard cells are needed?
+
   /*!
    * Communicate an X-Z field
    */
@@ -232,6 +260,14 @@ class Mesh {
   /// \param g Group of fields to communicate
   /// \returns handle to be used as input to wait()
   virtual comm_handle send(FieldGroup &g) = 0;  
+
+  /// Send only the \p xwidth guard cells nearest the domain in X, and
+  /// \p ywidth in Y. A width of zero means no communication in that
+  /// direction. Every processor must use the same widths.
+  /// The default sends all guard cells
+  virtual comm_handle sendWidth(FieldGroup &g, int UNUSED(xwidth), int UNUSED(ywidth)) {
+    return send(g);
+  }
   virtual int wait(comm_handle handle) = 0; ///< Wait for the handle, return error code
 
   // non-local communications
@@ -264,6 +300,14 @@ class Mesh {
   virtual int getNYPE() = 0; ///< The number of processors in the Y direction
   virtual int getXProcIndex() = 0; ///< This processor's index in X direction
   virtual int getYProcIndex() = 0; ///< This processor's index in Y direction
+
+  /// Global index of the first interior X point on processor \p xproc,
+  /// not counting boundary cells. Processor domains are not necessarily
+  /// all the same size, so the size of \p xproc's domain is
+  /// getXProcOffset(xproc+1) - getXProcOffset(xproc)
+  virtual int getXProcOffset(int xproc) { return xproc * (xend - xstart + 1); }
+  /// Global index of the first Y point on processor \p yproc
+  virtual int getYProcOffset(int yproc) { return yproc * (yend - ystart + 1); }
   
   // X communications
   virtual bool firstX() = 0;  ///< Is this processor first in X? i.e. is there a boundary to the left in X?
@@ -625,7 +669,8 @@ class Mesh {
   const Field3D applyZdiff(const Field3D &var, Mesh::deriv_func func, CELL_LOC loc = CELL_DEFAULT);
   
 private:
-  
+  FieldGroup pending_comms; ///< Fields waiting to be communicated
+  void sendPending(); ///< Communicate pending_comms
 };
 
 #endif // __MESH_H__
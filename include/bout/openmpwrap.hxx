@@ -0,0 +1,66 @@
+/*!
+ * \file openmpwrap.hxx
+ *
+ * Macros for OpenMP pragmas which can be used inside other macros,
+ * and which disappear if OpenMP is not enabled.
+ *
+ *   BOUT_OMP(parallel for)
+ *   for(...)
+ *
+ * expands to
+ *
+ *   #pragma omp parallel for
+ *   for(...)
+ *
+ * BOUT_OMP_SIMD asks the compiler to vectorise a loop, and
+ * BOUT_OMP_SIMD_FOR is a threaded loop which the compiler is also
+ * asked to vectorise, if OpenMP 4 is available. Vector versions of
+ * math functions (exp, log, pow, ...) are then used if the compiler
+ * and math library provide them (e.g. GCC and glibc with -ffast-math).
+ *
+ **************************************************************************
+ * Copyright 2017 B.D.Dudson
+ *
+ * Contact: Ben Dudson, bd512@york.ac.uk
+ *
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+#ifndef __OPENMPWRAP_H__
+#define __OPENMPWRAP_H__
+
+// Indirection needed so that _Pragma gets the string "omp <args>"
+#define BOUT_OMP_STRING0(a) #a
+#define BOUT_OMP_STRING(a) BOUT_OMP_STRING0(omp a)
+#define BOUT_OMP_PRAGMA(a) _Pragma(a)
+
+#ifdef _OPENMP
+#define BOUT_OMP(...) BOUT_OMP_PRAGMA(BOUT_OMP_STRING(__VA_ARGS__))
+#else
+#define BOUT_OMP(...)
+#endif
+
+#if defined(_OPENMP) && (_OPENMP >= 201307)
+// OpenMP 4.0 or later
+#define BOUT_OMP_SIMD BOUT_OMP(simd)
+#define BOUT_OMP_SIMD_FOR BOUT_OMP(parallel for simd)
+#else
+#define BOUT_OMP_SIMD
+#define BOUT_OMP_SIMD_FOR BOUT_OMP(parallel for)
+#endif
+
+#endif // __OPENMPWRAP_H__
@@ -52,7 +52,7 @@ public:
   typedef int (PhysicsModel::*jacobianfunc)(BoutReal t);
   
   PhysicsModel() : solver(0), splitop(false), 
-                   userprecon(0), userjacobian(0), initialised(false) {}
+                   userprecon(0), userjacobian(0), initialised(false), group_rhs(true) {}
   
   ~PhysicsModel();
   
@@ -88,6 +88,19 @@ public:
    * Returns a flag: 0 indicates success, non-zero an error flag
    */
   int runRHS(BoutReal time);
+
+  /*!
+   * Run the RHS function for a single rate group. Only the time
+   * derivatives of variables in this group will be used.
+   * Used by multirate solvers
+   */
+  int runRHS(BoutReal time, int group);
+
+  /*!
+   * True unless rhs_group(t, group) has been called and found to be the
+   * default, which calculates all time derivatives
+   */
+  bool hasGroupRHS() {return group_rhs;}
   
   /*!
    * True if this model uses split operators
@@ -159,6 +172,18 @@ protected:
    */
   virtual int rhs(BoutReal UNUSED(t)) {return 1;}
 
+  /*!
+   * Calculate the time derivatives of only the variables in the given
+   * rate group (set by the rate_group option for each variable).
+   * Multirate solvers call this so that fast groups can be subcycled
+   * without calculating the slow terms. By default calculates
+   * all time derivatives.
+   */
+  virtual int rhs_group(BoutReal t, int UNUSED(group)) {
+    group_rhs = false;
+    return rhs(t);
+  }
+
   /* 
      If split operator is set to true, then
      convective() and diffusive() are called instead of rhs()
@@ -232,6 +257,7 @@ private:
   jacobianfunc userjacobian; ///< Pointer to user-supplied Jacobian-vector multiply function
   
   bool initialised; ///< True if model already initialised
+  bool group_rhs;   ///< False if the default rhs_group(t, group) has been called
 };
 
 /*!
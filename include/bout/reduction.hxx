@@ -0,0 +1,129 @@
+/*!************************************************************************
+ * \file reduction.hxx
+ *
+ * @brief Several global reductions over several fields, with one collective
+ *
+ * Each call to min(f, true), max(f, true) etc. performs its own
+ * MPI_Allreduce. When many quantities are needed at the same time
+ * (e.g. in a monitor) they can be collected into a FieldReduction,
+ * which calculates all the local values in a single pass over the
+ * mesh, and then combines them with a single collective operation.
+ *
+ *     FieldReduction red;
+ *     int nmax = red.max(n);
+ *     int tmin = red.min(T);
+ *     int energy = red.volumeIntegral(0.5*SQ(v)); // Field stored by value
+ *     red.start();   // Local reduction, then start communication
+ *     ...            // Work not needing the results
+ *     red.finish();  // Wait for communication
+ *     output << red[nmax] << ", " << red[tmin] << ", " << red[energy] << endl;
+ *
+ * If MPI-3 is not available, start() uses a blocking MPI_Allreduce.
+ * The reductions are over the domain interior (RGN_NOBNDRY).
+ *
+ **************************************************************************
+ * Copyright 2017 B.D.Dudson
+ *
+ * Contact: Ben Dudson, bd512@york.ac.uk
+ *
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+class FieldReduction;
+
+#ifndef __FIELD_REDUCTION_H__
+#define __FIELD_REDUCTION_H__
+
+#include <mpi.h>
+#include <vector>
+
+#include "field3d.hxx"
+#include "field2d.hxx"
+#include "boutcomm.hxx"
+
+/// Collects reductions of fields, and performs them together
+///
+/// Fields are copied when added, which only shares the data (no copy),
+/// so temporary expressions can be passed.
+class FieldReduction {
+public:
+  /// Reductions are over all processors in \p comm
+  FieldReduction(MPI_Comm comm = BoutComm::get());
+  ~FieldReduction();
+  FieldReduction(const FieldReduction&) = delete;
+  FieldReduction& operator=(const FieldReduction&) = delete;
+
+  /// Each of these adds a reduction, returning the index of the result
+  ///@{
+  int min(const Field3D &f);
+  int min(const Field2D &f);
+  int max(const Field3D &f);
+  int max(const Field2D &f);
+  int sum(const Field3D &f);
+  int sum(const Field2D &f);
+  /// Sum of f * J*dx*dy*dz. For a Field2D the Z direction is included
+  /// by multiplying by the length of the Z domain
+  int volumeIntegral(const Field3D &f);
+  int volumeIntegral(const Field2D &f);
+  /// Square root of the sum of squares
+  int norm2(const Field3D &f);
+  int norm2(const Field2D &f);
+  ///@}
+
+  /// Number of reductions added
+  int size() const { return static_cast<int>(items.size()); }
+
+  /// Calculate local values, then start the collective operation.
+  void start();
+  /// Wait for the collective to complete. Calls start() if needed
+  void finish();
+  /// Calculate all reductions. Same as start() followed by finish()
+  void run() { start(); finish(); }
+
+  /// Result of reduction \p i. Throws if finish() has not been called
+  BoutReal operator[](int i) const;
+
+  /// Remove all reductions and results, so the object can be re-used
+  void clear();
+
+  /// Free the MPI operation shared by all FieldReductions.
+  /// Called by BoutFinalise, before MPI_Finalize
+  static void cleanup();
+
+private:
+  enum class ReduceOp {min, max, sum, volume, norm2};
+
+  /// One reduction. One of f3d and f2d is null
+  struct Item {
+    ReduceOp op;
+    const Field3D *f3d; ///< Copy of the input, sharing its data
+    const Field2D *f2d;
+    int slot; ///< Index into buffer
+  };
+
+  int add(ReduceOp op, const Field3D &f);
+  int add(ReduceOp op, const Field2D &f);
+
+  MPI_Comm comm;
+  std::vector<Item> items;
+  std::vector<BoutReal> sendbuf, recvbuf; ///< Local and global values
+  MPI_Datatype buftype; ///< Whole buffer, so MPI can't split it
+  MPI_Request request;
+  bool started, finished;
+};
+
+#endif // __FIELD_REDUCTION_H__
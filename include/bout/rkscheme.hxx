@@ -38,6 +38,7 @@ class RKScheme;
 #include <bout_types.hxx>
 #include <options.hxx>
 #include <utils.hxx>
+#include <unused.hxx>
 
 #include <iomanip>
 #include <string>
@@ -49,6 +50,8 @@ using std::setw;
 #define RKSCHEME_CASHKARP    "cashkarp"
 #define RKSCHEME_RK4         "rk4"
 #define RKSCHEME_RKF34       "rkf34"
+#define RKSCHEME_LSRK3       "lsrk3"
+#define RKSCHEME_LSRK4       "lsrk4"
 
 class RKScheme {
  public:
@@ -67,9 +70,16 @@ class RKScheme {
   virtual void setCurState(const BoutReal *start, BoutReal *out,int curStage, 
 			   const BoutReal dt);
 
-  //Calculate the output state and return the error estimate (if adaptive)
+  //Calculate the output state and return the error estimate (if adaptive).
+  //The alternative order solution is not stored, only used for the error
   virtual BoutReal setOutputStates(const BoutReal *start,BoutReal dt, BoutReal *resultFollow);
 
+  //Low-storage (2N) schemes are stepped by the solver in place, with
+  //  du = a*du + dt*F(u);  u = u + b*du
+  //at each stage. Returns false if this is not a low-storage scheme,
+  //otherwise sets the coefficients a and b of the given stage
+  virtual bool lowStorageCoeffs(int UNUSED(curStage), BoutReal &UNUSED(a), BoutReal &UNUSED(b)){return false;};
+
   //Update the timestep
   virtual BoutReal updateTimestep(BoutReal dt,BoutReal err);
 
@@ -97,8 +107,6 @@ class RKScheme {
   BoutReal **stageCoeffs;
   BoutReal **resultCoeffs;
   BoutReal *timeCoeffs;
-  
-  BoutReal *resultAlt;
 
   int nlocal;
   int neq;
@@ -108,15 +116,17 @@ class RKScheme {
 
   BoutReal dtfac;
 
+  //Allocate the stage storage
+  virtual void allocateStorage();
+
   virtual BoutReal getErr(BoutReal *solA, BoutReal *solB);
 
+  //Reduce the local error sum over all processors
+  BoutReal globalErr(BoutReal local_err);
+
   virtual void constructOutput(const BoutReal *start,BoutReal dt, 
 			       const int index, BoutReal *sol);
 
-  virtual void constructOutputs(const BoutReal *start,BoutReal dt, 
-				const int indexFollow,int indexAlt,
-				BoutReal *solFollow, BoutReal *solAlt);
-
  private:
   void verifyCoeffs();
   void printButcherTableau();
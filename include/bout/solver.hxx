@@ -68,6 +68,7 @@ typedef int (*TimestepMonitorFunc)(Solver *solver, BoutReal simtime, BoutReal la
 #include "vector3d.hxx"
 
 #include "physicsmodel.hxx"
+#include "bout/checkpoint.hxx"
 
 #include <string>
 #include <list>
@@ -88,8 +89,10 @@ using std::string;
 #define SOLVERIMEXBDF2    "imexbdf2"
 #define SOLVERSNES        "snes"
 #define SOLVERRKGENERIC   "rkgeneric"
+#define SOLVERRKL2        "rkl2"
+#define SOLVERMULTIRATE   "multirate"
 
-enum SOLVER_VAR_OP {LOAD_VARS, LOAD_DERIVS, SET_ID, SAVE_VARS, SAVE_DERIVS};
+enum SOLVER_VAR_OP {LOAD_VARS, LOAD_DERIVS, SET_ID, SET_GROUP, SAVE_VARS, SAVE_DERIVS, ADD_DERIVS};
 
 ///////////////////////////////////////////////////////////////////
 
@@ -333,6 +336,7 @@ protected:
       CELL_LOC location; // For fields and vector components
       bool covariant; // For vectors
       bool evolve_bndry; // Are the boundary regions being evolved?
+      int rate_group; // Rate group for multirate solvers (0 = slowest)
 
       string name;    // Name of the variable
     };
@@ -348,6 +352,8 @@ protected:
   string restartdir;  ///< Directory for restart files
   string restartext;  ///< Restart file extension
   int archive_restart;
+  int restart_interval;  ///< Outputs between restart file writes
+  int restart_iteration; ///< Iteration in the restart file, or -1 if not written
 
   bool has_constraints; ///< Can this solver.hxxandle constraints? Set to true if so.
   bool initialised; ///< Has init been called yet?
@@ -356,6 +362,7 @@ protected:
   int iteration; ///< Current iteration (output time-step) number
 
   int run_rhs(BoutReal t); ///< Run the user's RHS function
+  int run_rhs(BoutReal t, int group); ///< Calculate time derivatives for one rate group
   int run_convective(BoutReal t); ///< Calculate only the convective parts
   int run_diffusive(BoutReal t, bool linear=true); ///< Calculate only the diffusive parts
   
@@ -365,6 +372,7 @@ protected:
   int call_timestep_monitors(BoutReal simtime, BoutReal lastdt);
 
   bool have_user_precon(); // Do we have a user preconditioner?
+  bool have_group_rhs();   ///< Does the model calculate single rate groups? Call after run_rhs(t, group)
   int run_precon(BoutReal t, BoutReal gamma, BoutReal delta);
   
   // Loading data from BOUT++ to/from solver
@@ -372,7 +380,9 @@ protected:
   void load_derivs(BoutReal *udata);
   void save_vars(BoutReal *udata);
   void save_derivs(BoutReal *dudata);
+  void add_derivs(BoutReal *dudata); ///< Add time-derivatives to dudata
   void set_id(BoutReal *udata);
+  void set_group(BoutReal *udata); ///< Set the rate group of each variable
   
   // 
   const Field3D globalIndex(int localStart);
@@ -402,10 +412,24 @@ private:
   // Loading data from BOUT++ to/from solver
   void loop_vars_op(int jx, int jy, BoutReal *udata, int &p, SOLVER_VAR_OP op, bool bndry);
   void loop_vars(BoutReal *udata, SOLVER_VAR_OP op);
+  void prepare_derivs(); ///< Put time-derivatives in the basis and location of the variables
 
   bool varAdded(const string &name); // Check if a variable has already been added
   
   bool enablerestart; ///< Is restarting enabled?
+
+  MemoryCheckpoint checkpoint;  ///< State at the last in-memory checkpoint
+  BoutReal checkpoint_interval; ///< Wall time (seconds) between checkpoints. 0 to disable
+  BoutReal last_checkpoint;     ///< Wall time of the last checkpoint
+  /// Take an in-memory checkpoint if checkpoint_interval has passed
+  void take_checkpoint(BoutReal simtime);
+  /// True if the evolving variables are finite on all processors
+  bool state_finite();
+  /// Set if all processors have seen the error being handled, so they
+  /// can roll back to the in-memory checkpoint together
+  bool error_agreed;
+
+  int cacheLocalN; ///< Cached result of getLocalN(), -1 if not yet calculated
 };
 
 #endif // __SOLVER_H__
@@ -25,6 +25,7 @@
  **************************************************************************/
 
 class FieldGenerator;
+class FieldProgram;
 class ExpressionParser;
 class ParseException;
 
@@ -64,6 +65,11 @@ public:
 
   /// Create a string representation of the generator, for debugging output
   virtual const std::string str() {return std::string("?");}
+
+  /// Add operations calculating this generator to \p prog, returning the
+  /// register containing the result (see fieldprogram.hxx). The default
+  /// calls generate() at every point
+  virtual int compile(FieldProgram &prog);
 };
 
 /*!
@@ -110,6 +116,10 @@ protected:
 
   /// Parses a given string into a tree of FieldGenerator objects
   FieldGenerator* parseString(const std::string &input);
+
+  /// Delete all generators returned by parseString, which must
+  /// no longer be used
+  void freeGenerators();
   
 private:
   
@@ -155,6 +165,7 @@ public:
   FieldBinary(FieldGenerator* l, FieldGenerator* r, char o) : lhs(l), rhs(r), op(o) {}
   FieldGenerator* clone(const std::list<FieldGenerator*> args);
   double generate(double x, double y, double z, double t);
+  int compile(FieldProgram &prog);
 
   const std::string str() {return std::string("(")+lhs->str()+std::string(1,op)+rhs->str()+std::string(")");}
 private:
@@ -168,6 +179,7 @@ public:
   FieldValue(double val) : value(val) {}
   FieldGenerator* clone(const std::list<FieldGenerator*> UNUSED(args)) { return new FieldValue(value); }
   double generate(double UNUSED(x), double UNUSED(y), double UNUSED(z), double UNUSED(t)) { return value; }
+  int compile(FieldProgram &prog);
   const std::string str() {
     std::stringstream ss;
     ss << value;
@@ -0,0 +1,142 @@
+/*!************************************************************************
+ * \file fieldprogram.hxx
+ *
+ * Compiles a tree of FieldGenerator objects into a flat list of
+ * operations, which are evaluated over a whole grid at once.
+ *
+ * Each operation puts its result into a register. A register depends on
+ * a subset of (x,y,z,t), and only stores values over the dimensions it
+ * depends on, so sin(x) is calculated once for each x rather than at
+ * every (x,y,z). Operations on constants are evaluated when compiled.
+ * Operations which don't depend on t are only evaluated once for each
+ * grid, so only the time-dependent parts of an expression are
+ * recalculated. Of their registers, those used by time-dependent
+ * operations, or holding the result, are kept between evaluations. All
+ * other registers are released at the end of each evaluation.
+ *
+ * Generators which don't provide a compile() method are evaluated by
+ * calling generate() at every point, so any generator can be compiled.
+ *
+ *     FieldProgram prog(gen);
+ *     prog.evaluate(x, nx, y, ny, z, nz, t, result); // result[(ix*ny + iy)*nz + iz]
+ *
+ * evaluate() modifies the registers, so one FieldProgram can't be
+ * evaluated by several threads at once. Programs returned by
+ * FieldFactory::program() are shared, and are evaluated inside
+ * BOUT_OMP(critical(FieldProgram)).
+ *
+ **************************************************************************
+ * Copyright 2017 B.D.Dudson
+ *
+ * Contact: Ben Dudson, bd512@york.ac.uk
+ *
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+class FieldProgram;
+
+#ifndef __FIELD_PROGRAM_H__
+#define __FIELD_PROGRAM_H__
+
+#include "expressionparser.hxx"
+
+#include <vector>
+#include <map>
+#include <string>
+
+/// Function types which can be used in operations
+typedef double (*FieldFunc1)(double);
+typedef double (*FieldFunc2)(double, double);
+
+class FieldProgram {
+public:
+  /// Compile the expression tree \p gen
+  FieldProgram(FieldGenerator *gen);
+
+  /// Flags for the coordinates a register depends on
+  enum {DEP_X = 1, DEP_Y = 2, DEP_Z = 4, DEP_T = 8};
+
+  /*!
+   * Evaluate the expression at every point of the grid
+   * x[0..nx-1] by y[0..ny-1] by z[0..nz-1], at time \p t
+   *
+   * @param[out] result  Array of size nx*ny*nz, in the order [x][y][z]
+   */
+  void evaluate(const double *x, int nx, const double *y, int ny,
+                const double *z, int nz, double t, double *result);
+
+  /// Evaluate at a single point
+  double evaluate(double x, double y, double z, double t);
+
+  /// Does the result depend on time? Generators without
+  /// a compile() method are assumed to be time dependent
+  bool timeDependent() const { return (code[result].deps & DEP_T) != 0; }
+
+  /// Is the result a constant?
+  bool isConstant() const { return code[result].deps == 0; }
+
+  /// Number of operations
+  int size() const { return static_cast<int>(code.size()); }
+
+  /// List of operations, for debugging
+  std::string str() const;
+
+  ////////////////////////////////////////////////////
+  // Functions used by FieldGenerator::compile(). Each
+  // returns the register containing the result
+
+  /// Compile a generator. Each generator is only compiled once,
+  /// so generators appearing several times are only evaluated once
+  int compile(FieldGenerator *gen);
+
+  int constant(double value);  ///< A fixed value
+  int coordinate(int dep);     ///< One of DEP_X, DEP_Y, DEP_Z or DEP_T
+  int unary(FieldFunc1 func, int a); ///< func(a)
+  int binary(char op, int a, int b); ///< a op b, where op is one of +,-,*,/,^
+  int binary(FieldFunc2 func, int a, int b); ///< func(a, b)
+  int generator(FieldGenerator *gen); ///< Call gen->generate() at every point
+
+private:
+  enum class OpCode {constant, coordinate, add, sub, mul, div, pow, func1, func2, call};
+
+  struct Instruction {
+    OpCode op;
+    int a, b;             ///< Input registers
+    int deps;             ///< Combination of DEP_ flags
+    double value;         ///< For constants
+    FieldFunc1 func1;
+    FieldFunc2 func2;
+    FieldGenerator *gen;  ///< For calls
+  };
+
+  int add(const Instruction &ins);
+
+  /// Calculate the value of a constant instruction
+  double fold(const Instruction &ins) const;
+
+  std::vector<Instruction> code;
+  std::vector<std::vector<double> > reg;  ///< Register values
+  std::map<FieldGenerator*, int> compiled; ///< Register for each generator
+  int result;  ///< Register containing the result
+  std::vector<bool> keep; ///< Registers kept between evaluations
+
+  /// The grid on which time-independent registers were calculated
+  std::vector<double> gridx, gridy, gridz;
+  bool calculated;
+};
+
+#endif // __FIELD_PROGRAM_H__
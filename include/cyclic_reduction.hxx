@@ -124,10 +124,27 @@ public:
   /// Solve a set of tridiagonal systems
   /// 
   void solve(int nrhs, T **rhs, T **x) {
-    // Multiple RHS
-    
+    solveStart(nrhs, rhs);
+    solveInterface();
+    solveFinish(x);
+  }
+
+  /// The solve can be split into three stages, so that several
+  /// CyclicReduce objects (e.g. one per flux surface) can have
+  /// their communications in flight at the same time:
+  ///
+  ///   for each object: solveStart(nrhs, rhs)
+  ///   for each object: solveInterface()
+  ///   for each object: solveFinish(x)
+  ///
+  /// All processors in the communicator must call the stages of
+  /// different objects sharing a communicator in the same order.
+  
+  /// Reduce the local equations, and start sending interface
+  /// equations. Returns without waiting for communications.
+  void solveStart(int nrhs, T **rhs) {
     if(nrhs != Nsys)
-      throw new BoutException("Sorry, can't yet handle nrhs != nsys");
+      throw BoutException("Sorry, can't yet handle nrhs != nsys");
     
     // Insert RHS into coefs array. Ordered to allow efficient partitioning
     // for MPI send/receives
@@ -147,11 +164,11 @@ public:
     int ns = Nsys / nprocs; // Number of systems to assign to all processors
     int nsextra = Nsys % nprocs;  // Number of processors with 1 extra 
     
-    MPI_Request* req = new MPI_Request[nprocs];
-
+    for(int p=0;p<nprocs;p++)
+      req[p] = MPI_REQUEST_NULL;
+    
     if(myns > 0) {
       // Post receives from all other processors
-      req[myproc] = MPI_REQUEST_NULL;
       for(int p=0;p<nprocs;p++) { // Loop over processor
         // 2 interface equations per processor
         // myns systems to solve
@@ -190,15 +207,24 @@ public:
         for(int i=0;i<8;i++)
           output << "value " << i << " : " << myif[s0][i] << endl;
 #endif
-        MPI_Send(myif[s0],        // Data pointer
-                 8*nsp*sizeof(T), // Number
-                 MPI_BYTE,        // Type
-		 p,               // Destination
-                 myproc,          // Message identifier
-                 comm);           // Communicator
-      }
+        MPI_Isend(myif[s0],        // Data pointer
+                  8*nsp*sizeof(T), // Number
+                  MPI_BYTE,        // Type
+                  p,               // Destination
+                  myproc,          // Message identifier
+                  comm,            // Communicator
+                  &sendreq[p]);    // Request
+      }else
+        sendreq[p] = MPI_REQUEST_NULL;
       s0 += nsp;
     }
+  }
+
+  /// Wait for the interface equations, solve them, and
+  /// start returning the solutions to the other processors.
+  void solveInterface() {
+    int ns = Nsys / nprocs; // Number of systems to assign to all processors
+    int nsextra = Nsys % nprocs;  // Number of processors with 1 extra 
     
     if(myns > 0) {
       // Wait for data
@@ -268,6 +294,9 @@ public:
       back_solve(myns, 2*nprocs, ifcs, x1, xn, ifx);
     }
     
+    // Interface equations have been sent
+    MPI_Waitall(nprocs, sendreq, MPI_STATUSES_IGNORE);
+    
     if(nprocs > 1) { 
       ///////////////////////////////////////
       // Scatter back solution
@@ -293,36 +322,49 @@ public:
 #endif
 	  MPI_Irecv(recvbuffer[p],
 		    len,
-		    MPI_BYTE, // Just sending raw data, unknown type
-		    p,        // Destination processor
-		    p,        // Identifier
-		    comm,     // Communicator
-		    &req[p]); // Request
+		    MPI_BYTE,     // Just sending raw data, unknown type
+		    p,            // Destination processor
+		    nprocs + p,   // Identifier, distinct from the gather
+		    comm,         // Communicator
+		    &req[p]);     // Request
 	}else
           req[p] = MPI_REQUEST_NULL;
       }
       
+      for(int p=0;p<nprocs;p++)
+        sendreq[p] = MPI_REQUEST_NULL;
+      
       if(myns > 0) {
         // Send data
         for(int p=0;p<nprocs;p++) { // Loop over processor
           if(p != myproc) {
+            T *buffer = ifp + 2*myns*p; // Separate buffer for each processor
             for(int i=0;i<myns;i++) {
-              ifp[2*i]   = ifx[i][2*p];
-              ifp[2*i+1] = ifx[i][2*p+1];
+              buffer[2*i]   = ifx[i][2*p];
+              buffer[2*i+1] = ifx[i][2*p+1];
 #ifdef DIAGNOSE
-              output << "Returning: " << ifp[2*i] 
-                     << ", " << ifp[2*i+1] << " to " << p << endl;
+              output << "Returning: " << buffer[2*i] 
+                     << ", " << buffer[2*i+1] << " to " << p << endl;
 #endif
             }
-            MPI_Send(ifp,
-                     2*myns*sizeof(T),
-                     MPI_BYTE,
-                     p,
-                     myproc, // Message identifier
-                     comm);
+            MPI_Isend(buffer,
+                      2*myns*sizeof(T),
+                      MPI_BYTE,
+                      p,
+                      nprocs + myproc, // Message identifier
+                      comm,
+                      &sendreq[p]);
           }
         }
       }
+    }
+  }
+
+  /// Wait for the interface solutions, and solve the local equations
+  void solveFinish(T **x) {
+    if(nprocs > 1) {
+      int ns = Nsys / nprocs; // Number of systems to assign to all processors
+      int nsextra = Nsys % nprocs;  // Number of processors with 1 extra 
       
       // Wait for data
       int fromproc;
@@ -354,12 +396,14 @@ public:
 	  req[fromproc] = MPI_REQUEST_NULL;
 	}
       }while(fromproc != MPI_UNDEFINED);
+      
+      // Solutions have been sent
+      MPI_Waitall(nprocs, sendreq, MPI_STATUSES_IGNORE);
     }
     
     ///////////////////////////////////////
     // Solve local equations
     back_solve(Nsys, N, coefs, x1, xn, x);
-    delete[] req;
   }
   
 private:
@@ -380,9 +424,12 @@ private:
   T **ifcs;   ///< Coefficients for interface solve
   T **if2x2;  ///< 2x2 interface equations on this processor
   T **ifx;    ///< Solution of interface equations
-  T *ifp;     ///< Interface equations returned to processor p
+  T *ifp;     ///< Interface equations returned to processors [nprocs, 2*myns]
   T *x1, *xn; ///< Interface solutions for back-solving
 
+  MPI_Request *req;     ///< Receive requests, one per processor
+  MPI_Request *sendreq; ///< Send requests, one per processor
+
   /// Allocate memory arrays
   /// @param[in[ np   Number of processors
   /// @param[in] nsys  Number of independent systems to solve
@@ -410,9 +457,11 @@ private:
     }else
       sys0 += nsextra;
     
+    // Processors with no interface systems still receive
+    // solutions, so need non-empty buffers
     int my = myns;
     if(my == 0)
-      my = 0;
+      my = 1;
 
     coefs = matrix<T>(Nsys, 4*N);
       
@@ -423,9 +472,12 @@ private:
     if(nprocs > 1)
       if2x2 = matrix<T>(my, 2*4);         // 2x2 interface equations on this processor
     ifx  = matrix<T>(my, 2*nprocs);       // Solution of interface equations
-    ifp = new T[my*2];     // Solution to be sent to processor p
+    ifp = new T[my*2*nprocs]; // Solution to be sent to processors
     x1 = new T[Nsys];
     xn = new T[Nsys];
+
+    req = new MPI_Request[nprocs];
+    sendreq = new MPI_Request[nprocs];
     
   }
 
@@ -445,6 +497,8 @@ private:
     delete[] ifp;
     delete[] x1;
     delete[] xn;
+    delete[] req;
+    delete[] sendreq;
     
     N = Nsys = 0;
   }
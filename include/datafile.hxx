@@ -29,6 +29,50 @@ class Datafile;
 #include <vector>
 #include <string>
 
+/*!
+  Part of a field to write, to reduce the size of the output.
+  X and Y indices are global, including boundary cells. Each
+  processor writes only the points in its interior, or in the
+  boundary at the edge of the grid, so some write nothing.
+
+  Settings can be given in the input options, in a section named
+  after the Datafile's section and the variable, e.g.
+
+      [output:n]
+      xmin = 10       # Range of X indices
+      xmax = 20
+      ystride = 4     # Every 4th point in Y
+      zmodes = 8      # Keep Z modes 0...7, written on 16 points
+      floats = true   # Write in single precision
+      abs_error = 1e-4  # Round values to within this absolute error
+
+  Rounding (lossy compression) sets the low bits of each value to zero,
+  so the output compresses well with the Datafile's "compression" option,
+  but is still an ordinary array which needs no decoding when read.
+*/
+struct OutputSpec {
+  OutputSpec() : xmin(0), xmax(-1), xstride(1), ymin(0), ymax(-1), ystride(1),
+                 zmodes(0), floats(false), abs_error(0.0), rel_error(0.0) {}
+  /// Read the settings which are set in \p opt
+  OutputSpec(Options *opt);
+
+  int xmin, xmax; ///< X indices, inclusive. xmax < 0 for the last point
+  int xstride;    ///< Write every xstride'th point from xmin
+  int ymin, ymax; ///< Y indices, inclusive. ymax < 0 for the last point
+  int ystride;
+  int zmodes;     ///< Z Fourier modes to keep, written on 2*zmodes points. 0 for all
+  bool floats;    ///< Write in single precision
+  /// Error bounds for rounding, 0 for none. If both are set, each
+  /// value is within one of them. When written as floats rel_error
+  /// must be at least 2^-24, and defaults to this
+  BoutReal abs_error, rel_error;
+
+  /// True if all points are written, perhaps as floats or rounded
+  bool wholeField() const;
+  /// True if values are rounded
+  bool lossy() const { return (abs_error > 0.0) || (rel_error > 0.0); }
+};
+
 /*!
   Uses a generic interface to file formats (DataFormat)
   and provides an interface for reading/writing simulation data.
@@ -64,8 +108,22 @@ class Datafile {
   void add(Field3D &f, const char *name, bool save_repeat = false);
   void add(Vector2D &f, const char *name, bool save_repeat = false);
   void add(Vector3D &f, const char *name, bool save_repeat = false);
+
+  /// Write only part of Field2D or Field3D \p name, which must already
+  /// have been added. Overrides any settings in the input options.
+  /// Reduced fields are for output only, and can't be read back
+  void setOutput(const char *name, const OutputSpec &spec);
   
   bool read();  ///< Read data into added variables 
+
+  /// Read integer \p name from the file written by processor 0, and
+  /// send to all processors. Returns false if it's not in the file
+  bool readFromProc0(const char *name, int &value);
+
+  /// Read data from files written by \p npes processors, with \p nxpe
+  /// processors in X. Each processor reads the parts of the files which
+  /// overlap its domain, including guard cells. File names as in openr()
+  bool readRedistributed(int npes, int nxpe);
   bool write(); ///< Write added variables
 
   bool write(const char *filename, ...) const; ///< Opens, writes, closes file
@@ -76,14 +134,18 @@ class Datafile {
   
  private:
   bool parallel; // Use parallel formats?
-  bool flush;    // Flush after every write?
+  bool flush;    // Flush after writing records?
+  int flushfrequency; // Number of writes between flushes
+  int unflushed;  // Number of writes since the last flush
   bool guards;   // Write guard cells?
   bool floats;   // Low precision?
+  int compression; // Deflate level (0-9), if the format supports it
   bool openclose; // Open and close file for each write
   int Lx,Ly,Lz; // The sizes in the x-, y- and z-directions of the arrays to be written
   bool enabled;  // Enable / Disable writing
   bool init_missing; // Initialise missing variables?
   bool shiftOutput; //Do we want to write out in shifted space?
+  Options *options; // Settings, including reduced outputs
 
   DataFormat *file;
   int filenamelen;
@@ -98,6 +160,7 @@ class Datafile {
       string name;
       bool save_repeat;
       bool covar;
+      OutputSpec spec; ///< Part of a field to write
     };
 
   // one set per variable type
@@ -108,13 +171,37 @@ class Datafile {
   vector< VarStr<Vector2D> > v2d_arr;
   vector< VarStr<Vector3D> > v3d_arr;
 
+  void readScalars(DataFormat *df); ///< Read ints and BoutReals from \p df
+  /// Check that field \p name in the file has the size of the mesh
+  void checkSize(const string &name, bool save_repeat);
+  /// All fields, including components of vectors
+  void fieldList(vector< VarStr<Field2D> > &fields2d, vector< VarStr<Field3D> > &fields3d);
+  /// Open the file written by processor \p proc
+  DataFormat* openProc(int proc);
+  /// Size of field \p name in the file written by processor \p proc
+  vector<int> procSize(int proc, const string &name, bool save_repeat);
+
   bool read_f2d(const string &name, Field2D *f, bool save_repeat);
   bool read_f3d(const string &name, Field3D *f, bool save_repeat);
 
   bool write_int(const string &name, int *f, bool save_repeat);
   bool write_real(const string &name, BoutReal *f, bool save_repeat);
-  bool write_f2d(const string &name, Field2D *f, bool save_repeat);
-  bool write_f3d(const string &name, Field3D *f, bool save_repeat);
+  bool write_f2d(const string &name, Field2D *f, bool save_repeat,
+                 const OutputSpec &spec = OutputSpec());
+  bool write_f3d(const string &name, Field3D *f, bool save_repeat,
+                 const OutputSpec &spec = OutputSpec());
+  /// Write the part of \p data selected by \p spec. The data is
+  /// LocalNx x LocalNy x nz, with nz = 0 for 2D fields
+  bool writeReduced(const string &name, const BoutReal *data, int nz, bool save_repeat,
+                    const OutputSpec &spec);
+  /// Write a copy of \p data, of size lx x ly x lz, rounded as set in \p spec
+  bool writeRounded(const string &name, const BoutReal *data, bool save_repeat,
+                    const OutputSpec &spec, int lx, int ly, int lz);
+  /// Check that \p spec is valid for field \p name, with \p nz Z points
+  void checkSpec(const string &name, const OutputSpec &spec, int nz);
+  /// Relative error to round \p spec to. If written as floats and
+  /// rel_error isn't set, this is the precision of a float
+  BoutReal relError(const OutputSpec &spec) const;
 
   bool varAdded(const string &name); // Check if a variable has already been added
 };
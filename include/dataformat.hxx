@@ -34,6 +34,7 @@ class DataFormat;
 #define __DATAFORMAT_H__
 
 #include "bout_types.hxx"
+#include "unused.hxx"
 #include <string>
 using std::string;
 
@@ -96,7 +97,12 @@ class DataFormat {
 
   // Optional functions
   
-  virtual void setLowPrecision() { }  // By default doesn't do anything
+  /// Down-convert BoutReals to floats when creating new variables
+  virtual void setLowPrecision(bool UNUSED(low) = true) { }  // By default doesn't do anything
+
+  /// Losslessly compress new fields, with deflate \p level (1-9), or 0 for none.
+  /// Returns false if the format can't compress, so \p level is ignored
+  virtual bool setCompression(int UNUSED(level)) { return false; }
 };
 
 // For backwards compatability. In formatfactory.cxx
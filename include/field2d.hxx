@@ -73,6 +73,12 @@ class Field2D : public Field, public FieldData {
    */
   Field2D(const Field2D& f);
 
+  /*!
+   * Move constructor. Takes the data from the expiring field
+   * rather than sharing it, so the data stays unique
+   */
+  Field2D(Field2D&& f);
+
   /*!
    * Constructor. This creates a Field2D using the global Mesh pointer (mesh)
    * allocates data, and assigns the value \p val to all points including
@@ -91,6 +97,7 @@ class Field2D : public Field, public FieldData {
   /// Ensure data is allocated
   void allocate();
   bool isAllocated() const { return !data.empty(); } ///< Test if data is allocated
+  bool isUnique() const { return !data.empty() && data.unique(); } ///< Allocated and not shared, so can be modified in place
 
   /// Return a pointer to the time-derivative field
   Field2D* timeDeriv();
@@ -264,39 +271,74 @@ class Field2D : public Field, public FieldData {
 
 // Non-member overloaded operators
 
-const Field2D operator+(const Field2D &lhs, const Field2D &rhs);
-const Field2D operator-(const Field2D &lhs, const Field2D &rhs);
-const Field2D operator*(const Field2D &lhs, const Field2D &rhs);
-const Field2D operator/(const Field2D &lhs, const Field2D &rhs);
-
-const Field3D operator+(const Field2D &lhs, const Field3D &rhs);
-const Field3D operator-(const Field2D &lhs, const Field3D &rhs);
-const Field3D operator*(const Field2D &lhs, const Field3D &rhs);
-const Field3D operator/(const Field2D &lhs, const Field3D &rhs);
-
-const Field2D operator+(const Field2D &lhs, BoutReal rhs);
-const Field2D operator-(const Field2D &lhs, BoutReal rhs);
-const Field2D operator*(const Field2D &lhs, BoutReal rhs);
-const Field2D operator/(const Field2D &lhs, BoutReal rhs);
-
-const Field2D operator+(BoutReal lhs, const Field2D &rhs);
-const Field2D operator-(BoutReal lhs, const Field2D &rhs);
-const Field2D operator*(BoutReal lhs, const Field2D &rhs);
-const Field2D operator/(BoutReal lhs, const Field2D &rhs);
+Field2D operator+(const Field2D &lhs, const Field2D &rhs);
+Field2D operator-(const Field2D &lhs, const Field2D &rhs);
+Field2D operator*(const Field2D &lhs, const Field2D &rhs);
+Field2D operator/(const Field2D &lhs, const Field2D &rhs);
+
+Field3D operator+(const Field2D &lhs, const Field3D &rhs);
+Field3D operator-(const Field2D &lhs, const Field3D &rhs);
+Field3D operator*(const Field2D &lhs, const Field3D &rhs);
+Field3D operator/(const Field2D &lhs, const Field3D &rhs);
+
+Field2D operator+(const Field2D &lhs, BoutReal rhs);
+Field2D operator-(const Field2D &lhs, BoutReal rhs);
+Field2D operator*(const Field2D &lhs, BoutReal rhs);
+Field2D operator/(const Field2D &lhs, BoutReal rhs);
+
+Field2D operator+(BoutReal lhs, const Field2D &rhs);
+Field2D operator-(BoutReal lhs, const Field2D &rhs);
+Field2D operator*(BoutReal lhs, const Field2D &rhs);
+Field2D operator/(BoutReal lhs, const Field2D &rhs);
+
+// Operators re-using the data of an expiring temporary (rvalue) operand
+
+Field2D operator+(Field2D &&lhs, const Field2D &rhs);
+Field2D operator-(Field2D &&lhs, const Field2D &rhs);
+Field2D operator*(Field2D &&lhs, const Field2D &rhs);
+Field2D operator/(Field2D &&lhs, const Field2D &rhs);
+
+Field2D operator+(const Field2D &lhs, Field2D &&rhs);
+Field2D operator-(const Field2D &lhs, Field2D &&rhs);
+Field2D operator*(const Field2D &lhs, Field2D &&rhs);
+Field2D operator/(const Field2D &lhs, Field2D &&rhs);
+
+Field2D operator+(Field2D &&lhs, Field2D &&rhs);
+Field2D operator-(Field2D &&lhs, Field2D &&rhs);
+Field2D operator*(Field2D &&lhs, Field2D &&rhs);
+Field2D operator/(Field2D &&lhs, Field2D &&rhs);
+
+Field3D operator+(const Field2D &lhs, Field3D &&rhs);
+Field3D operator-(const Field2D &lhs, Field3D &&rhs);
+Field3D operator*(const Field2D &lhs, Field3D &&rhs);
+Field3D operator/(const Field2D &lhs, Field3D &&rhs);
+
+Field2D operator+(Field2D &&lhs, BoutReal rhs);
+Field2D operator-(Field2D &&lhs, BoutReal rhs);
+Field2D operator*(Field2D &&lhs, BoutReal rhs);
+Field2D operator/(Field2D &&lhs, BoutReal rhs);
+
+Field2D operator+(BoutReal lhs, Field2D &&rhs);
+Field2D operator-(BoutReal lhs, Field2D &&rhs);
+Field2D operator*(BoutReal lhs, Field2D &&rhs);
+Field2D operator/(BoutReal lhs, Field2D &&rhs);
 
 /*!
  * Unary minus. Returns the negative of given field,
  * iterates over whole domain including guard/boundary cells.
  */
-const Field2D operator-(const Field2D &f);
+Field2D operator-(const Field2D &f);
+Field2D operator-(Field2D &&f);
 
 // Non-member functions
 
 /// Square root
-const Field2D sqrt(const Field2D &f);
+Field2D sqrt(const Field2D &f);
+Field2D sqrt(Field2D &&f);
 
 /// Absolute value
-const Field2D abs(const Field2D &f);
+Field2D abs(const Field2D &f);
+Field2D abs(Field2D &&f);
 
 /*!
  * Calculates the minimum of a field, excluding
@@ -331,10 +373,12 @@ BoutReal max(const Field2D &f, bool allpe=false);
 bool finite(const Field2D &f);
 
 /// Exponential
-const Field2D exp(const Field2D &f);
+Field2D exp(const Field2D &f);
+Field2D exp(Field2D &&f);
 
 /// Natural logarithm
-const Field2D log(const Field2D &f);
+Field2D log(const Field2D &f);
+Field2D log(Field2D &&f);
 
 /*!
  * Sine trigonometric function. 
@@ -344,7 +388,8 @@ const Field2D log(const Field2D &f);
  * This loops over the entire domain, including guard/boundary cells
  * If CHECK >= 3 then the result will be checked for non-finite numbers
  */
-const Field2D sin(const Field2D &f);
+Field2D sin(const Field2D &f);
+Field2D sin(Field2D &&f);
 
 /*!
  * Cosine trigonometric function. 
@@ -354,7 +399,8 @@ const Field2D sin(const Field2D &f);
  * This loops over the entire domain, including guard/boundary cells
  * If CHECK >= 3 then the result will be checked for non-finite numbers
  */
-const Field2D cos(const Field2D &f);
+Field2D cos(const Field2D &f);
+Field2D cos(Field2D &&f);
 
 /*!
  * Tangent trigonometric function. 
@@ -364,7 +410,8 @@ const Field2D cos(const Field2D &f);
  * This loops over the entire domain, including guard/boundary cells
  * If CHECK >= 3 then the result will be checked for non-finite numbers
  */
-const Field2D tan(const Field2D &f);
+Field2D tan(const Field2D &f);
+Field2D tan(Field2D &&f);
 
 /*!
  * Hyperbolic sine function. 
@@ -372,7 +419,8 @@ const Field2D tan(const Field2D &f);
  * This loops over the entire domain, including guard/boundary cells
  * If CHECK >= 3 then the result will be checked for non-finite numbers
  */
-const Field2D sinh(const Field2D &f);
+Field2D sinh(const Field2D &f);
+Field2D sinh(Field2D &&f);
 
 /*!
  * Hyperbolic cosine function. 
@@ -380,7 +428,8 @@ const Field2D sinh(const Field2D &f);
  * This loops over the entire domain, including guard/boundary cells
  * If CHECK >= 3 then the result will be checked for non-finite numbers
  */
-const Field2D cosh(const Field2D &f);
+Field2D cosh(const Field2D &f);
+Field2D cosh(Field2D &&f);
 
 /*!
  * Hyperbolic tangent function. 
@@ -388,7 +437,8 @@ const Field2D cosh(const Field2D &f);
  * This loops over the entire domain, including guard/boundary cells
  * If CHECK >= 3 then the result will be checked for non-finite numbers
  */
-const Field2D tanh(const Field2D &f);
+Field2D tanh(const Field2D &f);
+Field2D tanh(Field2D &&f);
 
 /// Make an independent copy of field f
 const Field2D copy(const Field2D &f);
@@ -400,6 +450,9 @@ const Field2D floor(const Field2D &var, BoutReal f);
 Field2D pow(const Field2D &lhs, const Field2D &rhs);
 Field2D pow(const Field2D &lhs, BoutReal rhs);
 Field2D pow(BoutReal lhs, const Field2D &rhs);
+Field2D pow(Field2D &&lhs, const Field2D &rhs);
+Field2D pow(Field2D &&lhs, BoutReal rhs);
+Field2D pow(BoutReal lhs, Field2D &&rhs);
 
 #ifdef CHECK
 void checkData(const Field2D &f);
@@ -36,6 +36,7 @@ class Mesh;  // #include "bout/mesh.hxx"
 #include "bout/dataiterator.hxx"
 
 #include "bout/array.hxx"
+#include "dcomplex.hxx"
 
 #include "bout/deprecated.hxx"
 #include "bout/assert.hxx"
@@ -112,6 +113,25 @@ class Mesh;  // #include "bout/mesh.hxx"
 
   `data` now points to `f(0,1,0)` and can be incremented to move in Z.
 
+  Spectral representation
+  -----------------------
+
+  Operators which work in Fourier space in Z (DDZ, D2DZ2, filter,
+  lowPass, shiftZ, Delp2, some Laplacian solvers) get the Fourier
+  coefficients of each (x,y) row using zSpectrum. If the option
+  fft:cache_spectrum is true, the coefficients are stored in the field
+  the first time they are needed and re-used by later operators until
+  the field is next modified. The stored coefficients are discarded
+  by allocate(), assignment, the in-place arithmetic operators,
+  communications (via setData) and applyBoundary. The element
+  accessors don't discard them (they're on the hot path, and may be
+  called from several threads), so code which writes through them
+  must call allocate() first.
+
+  Note that writing to a field which shares its data with another
+  (see Copy-on-Write above) does not discard the coefficients stored
+  in the other field, so call allocate() before modifying a copy.
+
   Indexing can also be done using DataIterator or Indices objects,
   defined in bout/dataiterator.hxx:
 
@@ -180,6 +200,12 @@ class Field3D : public Field, public FieldData {
    * Copy constructor
    */
   Field3D(const Field3D& f);
+
+  /*!
+   * Move constructor. Takes the data from the expiring field
+   * rather than sharing it, so the data stays unique
+   */
+  Field3D(Field3D&& f);
   
   /// Constructor from 2D field
   Field3D(const Field2D& f);
@@ -200,6 +226,55 @@ class Field3D : public Field, public FieldData {
    * Test if data is allocated
    */
   bool isAllocated() const { return !data.empty(); } 
+
+  /*!
+   * Test if data is allocated and not shared with any other field,
+   * so that it can be modified in place
+   */
+  bool isUnique() const { return !data.empty() && data.unique(); }
+
+  /// Array sizes. Data is stored contiguously, in the order [x][y][z]
+  int getNx() const { return nx; }
+  int getNy() const { return ny; }
+  int getNz() const { return nz; }
+
+  /*!
+   * Fourier transform in Z of every (x,y) point, including guard cells.
+   * Stored in the order [x][y][kz], with getNz()/2 + 1 coefficients
+   * for each (x,y). Normalised as rfft() in fft.hxx
+   *
+   * If caching is enabled (fft:cache_spectrum) then the result is
+   * stored and returned by later calls until the field is modified.
+   */
+  const Array<dcomplex> zSpectrum() const;
+
+  /*!
+   * Fourier coefficients of the (jx,jy) row, written to \p out
+   * which must have space for getNz()/2 + 1 values.
+   * Uses the stored spectrum if available, otherwise calls rfft.
+   * Doesn't modify the field, so can be called from multiple threads
+   */
+  void zSpectrum(int jx, int jy, dcomplex *out) const;
+
+  /*!
+   * If caching is enabled, calculate and store the Fourier
+   * coefficients so that zSpectrum(jx,jy,out) doesn't need to
+   * perform FFTs. Call before a (threaded) loop over (x,y).
+   */
+  void prepareZSpectrum() const;
+
+  /*!
+   * Set the stored Fourier coefficients, as returned by zSpectrum().
+   * Only stored if caching is enabled. Must be called after the
+   * data has been set, since allocate() discards them
+   */
+  void setZSpectrum(const Array<dcomplex> &spectrum);
+
+  /// True if Fourier coefficients are currently stored
+  bool hasZSpectrum() const { return zspectrum_valid; }
+
+  /// Is caching of the Z spectrum enabled? Set by option fft:cache_spectrum
+  static bool cacheZSpectrum();
   
   /*!
    * Return a pointer to the time-derivative field
@@ -473,7 +548,16 @@ class Field3D : public Field, public FieldData {
   void applyBoundary(const string &condition);
   void applyBoundary(const char* condition) { applyBoundary(string(condition)); }
   void applyBoundary(const string &region, const string &condition);
+
+  /// Apply boundary conditions to several fields at time \p t. Fields
+  /// whose boundary operations are all threadSafe() are done in one
+  /// threaded pass; the others are done one at a time
+  static void applyBoundaries(const std::vector<Field3D*> &fields, BoutReal t);
+
   void applyTDerivBoundary();
+  /// Apply boundary conditions to the time derivatives of several
+  /// fields, threading them in the same way as applyBoundaries
+  static void applyTDerivBoundaries(const std::vector<Field3D*> &fields);
   void setBoundaryTo(const Field3D &f3d); ///< Copy the boundary region
 
   void applyParallelBoundary();
@@ -493,6 +577,10 @@ private:
   /// Internal data array. Handles allocation/freeing of memory
   Array<BoutReal> data;
 
+  /// Fourier coefficients in Z, valid only if zspectrum_valid is true
+  mutable Array<dcomplex> zspectrum;
+  mutable bool zspectrum_valid;
+
   CELL_LOC location; ///< Location of the variable in the cell
   
   Field3D *deriv; ///< Time derivative (may be NULL)
@@ -509,31 +597,67 @@ const FieldPerp operator-(const Field3D &lhs, const FieldPerp &rhs);
 const FieldPerp operator*(const Field3D &lhs, const FieldPerp &rhs);
 const FieldPerp operator/(const Field3D &lhs, const FieldPerp &rhs);
 
-const Field3D operator+(const Field3D &lhs, const Field3D &rhs);
-const Field3D operator-(const Field3D &lhs, const Field3D &rhs);
-const Field3D operator*(const Field3D &lhs, const Field3D &rhs);
-const Field3D operator/(const Field3D &lhs, const Field3D &rhs);
-
-const Field3D operator+(const Field3D &lhs, const Field2D &rhs);
-const Field3D operator-(const Field3D &lhs, const Field2D &rhs);
-const Field3D operator*(const Field3D &lhs, const Field2D &rhs);
-const Field3D operator/(const Field3D &lhs, const Field2D &rhs);
-
-const Field3D operator+(const Field3D &lhs, BoutReal rhs);
-const Field3D operator-(const Field3D &lhs, BoutReal rhs);
-const Field3D operator*(const Field3D &lhs, BoutReal rhs);
-const Field3D operator/(const Field3D &lhs, BoutReal rhs);
-
-const Field3D operator+(BoutReal lhs, const Field3D &rhs);
-const Field3D operator-(BoutReal lhs, const Field3D &rhs);
-const Field3D operator*(BoutReal lhs, const Field3D &rhs);
-const Field3D operator/(BoutReal lhs, const Field3D &rhs);
+Field3D operator+(const Field3D &lhs, const Field3D &rhs);
+Field3D operator-(const Field3D &lhs, const Field3D &rhs);
+Field3D operator*(const Field3D &lhs, const Field3D &rhs);
+Field3D operator/(const Field3D &lhs, const Field3D &rhs);
+
+Field3D operator+(const Field3D &lhs, const Field2D &rhs);
+Field3D operator-(const Field3D &lhs, const Field2D &rhs);
+Field3D operator*(const Field3D &lhs, const Field2D &rhs);
+Field3D operator/(const Field3D &lhs, const Field2D &rhs);
+
+Field3D operator+(const Field3D &lhs, BoutReal rhs);
+Field3D operator-(const Field3D &lhs, BoutReal rhs);
+Field3D operator*(const Field3D &lhs, BoutReal rhs);
+Field3D operator/(const Field3D &lhs, BoutReal rhs);
+
+Field3D operator+(BoutReal lhs, const Field3D &rhs);
+Field3D operator-(BoutReal lhs, const Field3D &rhs);
+Field3D operator*(BoutReal lhs, const Field3D &rhs);
+Field3D operator/(BoutReal lhs, const Field3D &rhs);
+
+/*
+ * Operators taking an expiring temporary (rvalue) operand re-use its
+ * data for the result if it is not shared, avoiding an allocation
+ * in expressions like a*b + c
+ */
+Field3D operator+(Field3D &&lhs, const Field3D &rhs);
+Field3D operator-(Field3D &&lhs, const Field3D &rhs);
+Field3D operator*(Field3D &&lhs, const Field3D &rhs);
+Field3D operator/(Field3D &&lhs, const Field3D &rhs);
+
+Field3D operator+(const Field3D &lhs, Field3D &&rhs);
+Field3D operator-(const Field3D &lhs, Field3D &&rhs);
+Field3D operator*(const Field3D &lhs, Field3D &&rhs);
+Field3D operator/(const Field3D &lhs, Field3D &&rhs);
+
+Field3D operator+(Field3D &&lhs, Field3D &&rhs);
+Field3D operator-(Field3D &&lhs, Field3D &&rhs);
+Field3D operator*(Field3D &&lhs, Field3D &&rhs);
+Field3D operator/(Field3D &&lhs, Field3D &&rhs);
+
+Field3D operator+(Field3D &&lhs, const Field2D &rhs);
+Field3D operator-(Field3D &&lhs, const Field2D &rhs);
+Field3D operator*(Field3D &&lhs, const Field2D &rhs);
+Field3D operator/(Field3D &&lhs, const Field2D &rhs);
+
+Field3D operator+(Field3D &&lhs, BoutReal rhs);
+Field3D operator-(Field3D &&lhs, BoutReal rhs);
+Field3D operator*(Field3D &&lhs, BoutReal rhs);
+Field3D operator/(Field3D &&lhs, BoutReal rhs);
+
+Field3D operator+(BoutReal lhs, Field3D &&rhs);
+Field3D operator-(BoutReal lhs, Field3D &&rhs);
+Field3D operator*(BoutReal lhs, Field3D &&rhs);
+Field3D operator/(BoutReal lhs, Field3D &&rhs);
 
 /*!
  * Unary minus. Returns the negative of given field,
  * iterates over whole domain including guard/boundary cells.
  */
-const Field3D operator-(const Field3D &f);
+Field3D operator-(const Field3D &f);
+Field3D operator-(Field3D &&f);
 
 // Non-member functions
 
@@ -574,6 +698,10 @@ Field3D pow(const Field3D &lhs, const Field2D &rhs);
 Field3D pow(const Field3D &lhs, const FieldPerp &rhs);
 Field3D pow(const Field3D &f, BoutReal rhs);
 Field3D pow(BoutReal lhs, const Field3D &rhs);
+Field3D pow(Field3D &&lhs, const Field3D &rhs);
+Field3D pow(Field3D &&lhs, const Field2D &rhs);
+Field3D pow(Field3D &&f, BoutReal rhs);
+Field3D pow(BoutReal lhs, Field3D &&rhs);
 
 /*!
  * Square root
@@ -581,7 +709,8 @@ Field3D pow(BoutReal lhs, const Field3D &rhs);
  * This loops over the entire domain, including guard/boundary cells
  * If CHECK >= 3 then the result will be checked for non-finite numbers
  */
-const Field3D sqrt(const Field3D &f);
+Field3D sqrt(const Field3D &f);
+Field3D sqrt(Field3D &&f);
 
 /*!
  * Absolute value (modulus, |f|)
@@ -589,7 +718,8 @@ const Field3D sqrt(const Field3D &f);
  * This loops over the entire domain, including guard/boundary cells
  * If CHECK >= 3 then the result will be checked for non-finite numbers
  */
-const Field3D abs(const Field3D &f);
+Field3D abs(const Field3D &f);
+Field3D abs(Field3D &&f);
 
 /*!
  * Exponential: exp(f) is e to the power of f
@@ -597,7 +727,8 @@ const Field3D abs(const Field3D &f);
  * This loops over the entire domain, including guard/boundary cells
  * If CHECK >= 3 then the result will be checked for non-finite numbers
  */
-const Field3D exp(const Field3D &f);
+Field3D exp(const Field3D &f);
+Field3D exp(Field3D &&f);
 
 /*!
  * Natural logarithm, inverse of exponential
@@ -607,7 +738,8 @@ const Field3D exp(const Field3D &f);
  * This loops over the entire domain, including guard/boundary cells
  * If CHECK >= 3 then the result will be checked for non-finite numbers
  */
-const Field3D log(const Field3D &f);
+Field3D log(const Field3D &f);
+Field3D log(Field3D &&f);
 
 /*!
  * Sine trigonometric function. 
@@ -617,7 +749,8 @@ const Field3D log(const Field3D &f);
  * This loops over the entire domain, including guard/boundary cells
  * If CHECK >= 3 then the result will be checked for non-finite numbers
  */
-const Field3D sin(const Field3D &f);
+Field3D sin(const Field3D &f);
+Field3D sin(Field3D &&f);
 
 /*!
  * Cosine trigonometric function. 
@@ -627,7 +760,8 @@ const Field3D sin(const Field3D &f);
  * This loops over the entire domain, including guard/boundary cells
  * If CHECK >= 3 then the result will be checked for non-finite numbers
  */
-const Field3D cos(const Field3D &f);
+Field3D cos(const Field3D &f);
+Field3D cos(Field3D &&f);
 
 /*!
  * Tangent trigonometric function. 
@@ -637,7 +771,8 @@ const Field3D cos(const Field3D &f);
  * This loops over the entire domain, including guard/boundary cells
  * If CHECK >= 3 then the result will be checked for non-finite numbers
  */
-const Field3D tan(const Field3D &f);
+Field3D tan(const Field3D &f);
+Field3D tan(Field3D &&f);
 
 /*!
  * Hyperbolic sine function. 
@@ -645,7 +780,8 @@ const Field3D tan(const Field3D &f);
  * This loops over the entire domain, including guard/boundary cells
  * If CHECK >= 3 then the result will be checked for non-finite numbers
  */
-const Field3D sinh(const Field3D &f);
+Field3D sinh(const Field3D &f);
+Field3D sinh(Field3D &&f);
 
 /*!
  * Hyperbolic cosine function. 
@@ -653,7 +789,8 @@ const Field3D sinh(const Field3D &f);
  * This loops over the entire domain, including guard/boundary cells
  * If CHECK >= 3 then the result will be checked for non-finite numbers
  */
-const Field3D cosh(const Field3D &f);
+Field3D cosh(const Field3D &f);
+Field3D cosh(Field3D &&f);
 
 /*!
  * Hyperbolic tangent function. 
@@ -661,7 +798,8 @@ const Field3D cosh(const Field3D &f);
  * This loops over the entire domain, including guard/boundary cells
  * If CHECK >= 3 then the result will be checked for non-finite numbers
  */
-const Field3D tanh(const Field3D &f);
+Field3D tanh(const Field3D &f);
+Field3D tanh(Field3D &&f);
 
 /*!
  * Check if all values of a field are finite.
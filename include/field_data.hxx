@@ -84,6 +84,17 @@ public:
 #ifdef CHECK
   virtual void doneComms() { }; // Notifies that communications done
 #endif
+
+  /// Are the guard cells up to date? Set when the guard cells are
+  /// communicated, and cleared when the field is assigned, updated or
+  /// allocate()d. Code which writes into a field without calling
+  /// allocate() first should call setGuardsValid(false)
+  bool guardsValid() const { return guards_valid; }
+  void setGuardsValid(bool valid) { guards_valid = valid; }
+
+  /// Is this field waiting to be communicated? See Mesh::communicatePending()
+  bool commsPending() const { return comms_pending; }
+  void setCommsPending(bool pending) { comms_pending = pending; }
   
   // Boundary conditions
   void setBoundary(const string &name); ///< Set the boundary conditions
@@ -103,6 +114,8 @@ protected:
   vector<BoundaryOp*> bndry_op; // Boundary conditions
   bool boundaryIsCopy; // True if bndry_op is a copy
   bool boundaryIsSet; // Set to true when setBoundary called
+  bool guards_valid; // Guard cells have been communicated
+  bool comms_pending; // In the list of fields to be communicated
   // Parallel boundaries
   vector<BoundaryOpPar*> bndry_op_par; // Boundary conditions
 
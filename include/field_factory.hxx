@@ -33,6 +33,7 @@ class FieldFactory;
 #include "bout/mesh.hxx"
 
 #include "bout/sys/expressionparser.hxx"
+#include "bout/sys/fieldprogram.hxx"
 
 #include "field2d.hxx"
 #include "field3d.hxx"
@@ -63,8 +64,18 @@ public:
   // Parse a string into a tree of generators
   FieldGenerator* parse(const std::string &input, Options *opt=NULL);
 
+  /// Compiled version of a generator, used to evaluate it over a whole field.
+  /// Programs are kept until cleanCache() is called. They are shared,
+  /// so evaluate inside BOUT_OMP(critical(FieldProgram))
+  FieldProgram* program(FieldGenerator *gen);
+
   // Singleton object
   static FieldFactory *get();
+
+  /// Clear the cache of parsed option values, so that changes to
+  /// options are picked up (e.g. between ensemble members).
+  /// Generators returned by parse() are deleted, so must not be used after this
+  void cleanCache();
 protected:
   // These functions called by the parser
   FieldGenerator* resolve(std::string &name);
@@ -77,6 +88,9 @@ private:
   
   // Cache parsed strings
   std::map<std::string, FieldGenerator* > cache;
+
+  // Compiled generators
+  std::map<FieldGenerator*, FieldProgram* > programs;
   
   Options* findOption(Options *opt, const std::string &name, std::string &val);
 };
@@ -107,6 +121,9 @@ public:
   FieldGenerator* clone(const std::list<FieldGenerator*> UNUSED(args)) {
     return this;
   }
+  int compile(FieldProgram &prog) {
+    return prog.constant(0.0);
+  }
   /// Singeton
   static FieldGenerator* get() {
     static FieldNull *instance = 0;
@@ -30,6 +30,8 @@
 
 #include "field3d.hxx"
 
+#include <vector>
+
 /// Smooth in X using simple 1-2-1 filter
 const Field3D smooth_x(const Field3D &f, bool BoutRealspace = true);
 
@@ -60,19 +62,29 @@ const Field2D averageY(const Field2D &f);
  * 
  * Important: Only works if there are no branch cuts
  *
- * Creates static arrays
- * 
- * Not thread safe
- *
  * Assumes every processor has the same domain shape
  * 
  */
 const Field3D averageY(const Field3D &f);
 
+/*!
+ * Average several fields in Y, with a single communication.
+ * Returns the averages in the same order as the input
+ *
+ *     auto avg = averageY({n, T, phi});
+ *     Field3D n_zonal = avg[0];
+ *
+ * Same issues as averageY(Field3D)
+ */
+std::vector<Field3D> averageY(const std::vector<Field3D> &fields);
+
 /// Average over X
 const Field2D averageX(const Field2D &f);
 const Field3D averageX(const Field3D &f);
 
+/// Average several fields in X, with a single communication
+std::vector<Field3D> averageX(const std::vector<Field3D> &fields);
+
 /*!
   Volume integral of Field2D variable
   Developed by T. Rhee and S. S. Kim
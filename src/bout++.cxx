@@ -25,9 +25,6 @@
  *
  **************************************************************************/
 
-const char DEFAULT_DIR[] = "data";
-const char DEFAULT_OPT[] = "BOUT.inp";
-
 // MD5 Checksum passed at compile-time
 #define CHECKSUM1_(x) #x
 #define CHECKSUM_(x) CHECKSUM1_(x)
@@ -56,6 +53,8 @@ const char DEFAULT_OPT[] = "BOUT.inp";
 
 #include <invert_laplace.hxx>
 
+#include <bout/reduction.hxx>
+
 #include <bout/slepclib.hxx>
 #include <bout/petsclib.hxx>
 
@@ -109,8 +108,6 @@ char get_spin();                    // Produces a spinning bar
  */
 int BoutInitialise(int &argc, char **&argv) {
 
-  string dump_ext; ///< Extensions for restart and dump files
-
   const char *data_dir; ///< Directory for data input/output
   const char *opt_file; ///< Filename for the options file
 
@@ -186,9 +183,15 @@ int BoutInitialise(int &argc, char **&argv) {
   if (MYPE == 0) output.enable(); // Enable writing to stdout
   else output.disable(); // No writing to stdout
 
+  /// If the communicator has been set (e.g. ensemble runs) then
+  /// several processors may have the same MYPE, so use the global rank
+  int log_rank = MYPE;
+  if (BoutComm::getInstance()->isSet())
+    MPI_Comm_rank(MPI_COMM_WORLD, &log_rank);
+
   /// Open an output file to echo everything to
   /// On processor 0 anything written to output will go to stdout and the file
-  if (output.open("%s/BOUT.log.%d", data_dir, MYPE)) {
+  if (output.open("%s/BOUT.log.%d", data_dir, log_rank)) {
     return 1;
   }
 
@@ -273,37 +276,10 @@ int BoutInitialise(int &argc, char **&argv) {
     mesh->load();           ///< Load from sources. Required for Field initialisation
     mesh->setParallelTransform(); ///< Set the parallel transform from options
     /////////////////////////////////////////////
-    /// Get some settings
-
-    // Check if restarting
-    bool append;
-    OPTION(options, append, false);
-
-    /// Get file extensions
-    options->get("dump_format", dump_ext, "nc");
-    
-    ////////////////////////////////////////////
 
-    // Set up the "dump" data output file
-    output << "Setting up output (dump) file\n";
-
-    dump = Datafile(options->getSection("output"));
-    
-    /// Open a file for the output
-    if(append) {
-      dump.opena("%s/BOUT.dmp.%s", data_dir, dump_ext.c_str());
-    }else {
-      dump.openw("%s/BOUT.dmp.%s", data_dir, dump_ext.c_str());
-    }
-
-    /// Add book-keeping variables to the output files
-    dump.add(const_cast<BoutReal&>(BOUT_VERSION), "BOUT_VERSION", false);
-    dump.add(simtime, "t_array", true); // Appends the time of dumps into an array
-    dump.add(iteration, "iteration", false);
-
-    ////////////////////////////////////////////
-
-    mesh->outputVars(dump); ///< Save mesh configuration into output file
+    // Ensemble members each open their own dump file
+    if(!options->getSection("ensemble")->isSet("group"))
+      bout_open_dump(data_dir);
     
   }catch(BoutException &e) {
     output.write("Error encountered during initialisation: %s\n", e.what());
@@ -313,6 +289,43 @@ int BoutInitialise(int &argc, char **&argv) {
   return 0;
 }
 
+void bout_open_dump(const char *data_dir) {
+  Options *options = Options::getRoot();
+
+  /// Get some settings
+
+  // Check if restarting
+  bool append;
+  OPTION(options, append, false);
+
+  /// Get file extensions
+  string dump_ext;
+  options->get("dump_format", dump_ext, "nc");
+  
+  ////////////////////////////////////////////
+
+  // Set up the "dump" data output file
+  output << "Setting up output (dump) file\n";
+
+  dump = Datafile(options->getSection("output"));
+  
+  /// Open a file for the output
+  if(append) {
+    dump.opena("%s/BOUT.dmp.%s", data_dir, dump_ext.c_str());
+  }else {
+    dump.openw("%s/BOUT.dmp.%s", data_dir, dump_ext.c_str());
+  }
+
+  /// Add book-keeping variables to the output files
+  dump.add(const_cast<BoutReal&>(BOUT_VERSION), "BOUT_VERSION", false);
+  dump.add(simtime, "t_array", true); // Appends the time of dumps into an array
+  dump.add(iteration, "iteration", false);
+
+  ////////////////////////////////////////////
+
+  mesh->outputVars(dump); ///< Save mesh configuration into output file
+}
+
 int bout_run(Solver *solver, rhsfunc physics_run) {
   
   /// Set the RHS function
@@ -339,6 +352,9 @@ int BoutFinalise() {
   // Laplacian inversion
   Laplacian::cleanup();
 
+  // MPI operation used by FieldReduction
+  FieldReduction::cleanup();
+
   // Delete field memory
   Array<double>::cleanup();
 
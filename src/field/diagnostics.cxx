@@ -0,0 +1,282 @@
+/**************************************************************************
+ * Reduced diagnostics calculated during a run
+ *
+ **************************************************************************
+ * Copyright 2017 B.D.Dudson
+ *
+ * Contact: Ben Dudson, bd512@york.ac.uk
+ *
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+#include <bout/diagnostics.hxx>
+
+#include <globals.hxx>
+#include <bout/mesh.hxx>
+#include <bout/coordinates.hxx>
+#include <bout/solver.hxx>
+#include <boutcomm.hxx>
+#include <boutexception.hxx>
+#include <msg_stack.hxx>
+#include <output.hxx>
+#include <fft.hxx>
+#include <dcomplex.hxx>
+#include <unused.hxx>
+
+std::list<Diagnostics*> Diagnostics::active;
+
+Diagnostics::Diagnostics(Options *opt) : nbuffer(0), counter(0), unflushed(0), file(nullptr),
+                                         solver(nullptr) {
+  if(opt == nullptr)
+    opt = Options::getRoot()->getSection("diagnostics");
+
+  OPTION(opt, frequency, 1);
+  if(frequency < 1)
+    throw BoutException("Diagnostics: frequency must be at least 1 (got %d)", frequency);
+  // Files are synced to disk when flushed, and the bin format
+  // writes the records since the last flush as one entry
+  OPTION(opt, flushfrequency, 100);
+
+  string name;
+  opt->get("file", name, "BOUT.diag.bin");
+  string datadir;
+  Options::getRoot()->get("datadir", datadir, "data");
+  filename = datadir + "/" + name;
+}
+
+Diagnostics::~Diagnostics() {
+  // The timestep monitor is left in the solver, which may
+  // already have been deleted. It does nothing once no
+  // Diagnostics are attached
+  active.remove(this);
+
+  if(file) {
+    file->close();
+    delete file;
+  }
+}
+
+void Diagnostics::volumeIntegral(const std::string &name, const Field3D &f) {
+  add(DiagType::volume, name, &f, nullptr, 1, 1);
+}
+
+void Diagnostics::volumeIntegral(const std::string &name, const Field2D &f) {
+  add(DiagType::volume, name, nullptr, &f, 1, 1);
+}
+
+void Diagnostics::fluxSurfaceAverage(const std::string &name, const Field3D &f) {
+  // Sum of f*J*dy and of J*dy for each X point
+  int nx = mesh->GlobalNx - 2*mesh->xstart;
+  add(DiagType::average, name, &f, nullptr, 2*nx, nx);
+}
+
+void Diagnostics::fluxSurfaceAverage(const std::string &name, const Field2D &f) {
+  int nx = mesh->GlobalNx - 2*mesh->xstart;
+  add(DiagType::average, name, nullptr, &f, 2*nx, nx);
+}
+
+void Diagnostics::spectrum(const std::string &name, const Field3D &f) {
+  int nmodes = mesh->LocalNz/2 + 1;
+  add(DiagType::spectrum, name, &f, nullptr, nmodes, nmodes);
+}
+
+void Diagnostics::probe(const std::string &name, const Field3D &f, int x, int y, int z) {
+  if((x < mesh->xstart) || (x >= mesh->GlobalNx - mesh->xstart) ||
+     (y < mesh->ystart) || (y >= mesh->GlobalNy - mesh->ystart) ||
+     (z < 0) || (z >= mesh->LocalNz))
+    throw BoutException("Diagnostics: Probe %s at (%d, %d, %d) is not in the domain interior",
+                        name.c_str(), x, y, z);
+
+  Item &it = add(DiagType::probe, name, &f, nullptr, 1, 1);
+
+  // Only the processor whose interior contains the point
+  // contributes to the sum
+  int lx = x - mesh->OffsetX, ly = y - mesh->OffsetY;
+  if((lx >= mesh->xstart) && (lx <= mesh->xend) && (ly >= mesh->ystart) && (ly <= mesh->yend)) {
+    it.x = lx;
+    it.y = ly;
+    it.z = z;
+  }
+}
+
+void Diagnostics::attach(Solver *s) {
+  if(solver)
+    throw BoutException("Diagnostics already attached to a solver");
+  solver = s;
+
+  // Only one monitor, however many Diagnostics there are
+  solver->removeTimestepMonitor(monitor);
+  solver->addTimestepMonitor(monitor);
+  active.push_back(this);
+
+  bool monitor_timestep;
+  Options::getRoot()->getSection("solver")->get("monitor_timestep", monitor_timestep, false);
+  if(!monitor_timestep)
+    output.write("WARNING: Diagnostics need solver:monitor_timestep = true\n");
+}
+
+void Diagnostics::calculate(BoutReal t) {
+  TRACE("Diagnostics::calculate");
+
+  buffer.assign(nbuffer, 0.0);
+
+  Coordinates *coord = mesh->coordinates();
+  int nz = mesh->LocalNz;
+  std::vector<dcomplex> fz(nz/2 + 1);
+
+  for(const auto &it : items) {
+    if((it.f3d && !it.f3d->isAllocated()) || (it.f2d && !it.f2d->isAllocated()))
+      throw BoutException("Diagnostics: Field for %s is not allocated", it.name.c_str());
+
+    BoutReal *buf = &buffer[it.offset];
+
+    switch(it.type) {
+    case DiagType::volume: {
+      BoutReal sum = 0.0;
+      for(int x=mesh->xstart;x<=mesh->xend;x++)
+        for(int y=mesh->ystart;y<=mesh->yend;y++) {
+          BoutReal dv = coord->J(x,y)*coord->dx(x,y)*coord->dy(x,y);
+          if(it.f3d) {
+            const BoutReal *f = (*it.f3d)(x,y);
+            BoutReal s = 0.0;
+            for(int z=0;z<nz;z++)
+              s += f[z];
+            sum += s * dv * coord->dz;
+          }else {
+            sum += (*it.f2d)(x,y) * dv * coord->zlength();
+          }
+        }
+      buf[0] = sum;
+      break;
+    }
+    case DiagType::average: {
+      int nx = it.length;
+      for(int x=mesh->xstart;x<=mesh->xend;x++) {
+        int gx = mesh->OffsetX + x - mesh->xstart; // Index in profile
+        for(int y=mesh->ystart;y<=mesh->yend;y++) {
+          BoutReal w = coord->J(x,y)*coord->dy(x,y);
+          BoutReal fav;
+          if(it.f3d) {
+            const BoutReal *f = (*it.f3d)(x,y);
+            fav = 0.0;
+            for(int z=0;z<nz;z++)
+              fav += f[z];
+            fav /= nz;
+          }else {
+            fav = (*it.f2d)(x,y);
+          }
+          buf[gx] += fav * w;
+          buf[nx + gx] += w;
+        }
+      }
+      break;
+    }
+    case DiagType::spectrum: {
+      for(int x=mesh->xstart;x<=mesh->xend;x++)
+        for(int y=mesh->ystart;y<=mesh->yend;y++) {
+          rfft((*it.f3d)(x,y), nz, fz.data()); // Normalised, so fz[0] is the average
+          for(int k=0;k<it.length;k++)
+            buf[k] += std::norm(fz[k]);
+        }
+      break;
+    }
+    case DiagType::probe: {
+      if(it.x >= 0)
+        buf[0] = (*it.f3d)(it.x, it.y, it.z);
+      break;
+    }
+    }
+  }
+
+  // Combine on processor 0
+  MPI_Comm comm = BoutComm::get();
+  int MYPE;
+  MPI_Comm_rank(comm, &MYPE);
+  if(MYPE != 0) {
+    MPI_Reduce(buffer.data(), nullptr, nbuffer, MPI_DOUBLE, MPI_SUM, 0, comm);
+    return;
+  }
+  MPI_Reduce(MPI_IN_PLACE, buffer.data(), nbuffer, MPI_DOUBLE, MPI_SUM, 0, comm);
+
+  if(!file) {
+    bool append;
+    Options::getRoot()->get("append", append, false);
+    file = data_format(filename.c_str());
+    if(!file->openw(filename.c_str(), append))
+      throw BoutException("Diagnostics: Could not open file '%s'", filename.c_str());
+  }
+
+  // Number of interior points, for the mean over the domain
+  BoutReal npoints = static_cast<BoutReal>(mesh->GlobalNx - 2*mesh->xstart) *
+    (mesh->GlobalNy - 2*mesh->ystart);
+
+  file->setRecord(-1); // Append
+  file->write_rec(&t, "t_diag");
+  for(const auto &it : items) {
+    BoutReal *buf = &buffer[it.offset];
+    switch(it.type) {
+    case DiagType::average: {
+      for(int i=0;i<it.length;i++)
+        buf[i] /= buf[it.length + i];
+      break;
+    }
+    case DiagType::spectrum: {
+      for(int k=0;k<it.length;k++)
+        buf[k] /= npoints;
+      break;
+    }
+    default:
+      break;
+    }
+
+    if(it.length == 1) {
+      file->write_rec(buf, it.name);
+    }else {
+      file->write_rec(buf, it.name, it.length);
+    }
+  }
+
+  if(++unflushed >= flushfrequency) {
+    file->flush();
+    unflushed = 0;
+  }
+}
+
+Diagnostics::Item& Diagnostics::add(DiagType type, const std::string &name,
+                                    const Field3D *f3d, const Field2D *f2d,
+                                    int nsum, int length) {
+  for(const auto &it : items)
+    if(it.name == name)
+      throw BoutException("Diagnostics: %s already added", name.c_str());
+
+  items.push_back({type, name, f3d, f2d, -1, -1, -1, nbuffer, nsum, length});
+  nbuffer += nsum;
+  return items.back();
+}
+
+int Diagnostics::monitor(Solver *solver, BoutReal simtime, BoutReal UNUSED(lastdt)) {
+  for(auto &d : active) {
+    if(d->solver != solver)
+      continue;
+    d->counter++;
+    if(d->counter >= d->frequency) {
+      d->calculate(simtime);
+      d->counter = 0;
+    }
+  }
+  return 0;
+}
@@ -41,6 +41,7 @@
 #include <msg_stack.hxx>
 
 #include <cmath>
+#include <utility>
 #include <output.hxx>
 
 #include <bout/assert.hxx>
@@ -71,6 +72,24 @@ Field2D::Field2D(const Field2D& f) : fieldmesh(f.fieldmesh), // The mesh contain
   *this = f;
 }
 
+Field2D::Field2D(Field2D&& f) : fieldmesh(f.fieldmesh),
+                                data(std::move(f.data)), // f no longer has data
+                                deriv(nullptr) {
+  nx = f.nx; ny = f.ny;
+  guards_valid = f.guards_valid;
+  
+#ifdef TRACK
+  name = f.name;
+#endif
+  
+  boundaryIsSet = false;
+  if(f.comms_pending) {
+    // Take f's place in the list of fields to be communicated
+    fieldmesh->cancelCommunication(f);
+    fieldmesh->communicate(*this);
+  }
+}
+
 Field2D::Field2D(BoutReal val) : fieldmesh(nullptr), deriv(nullptr) {
   boundaryIsSet = false;
   
@@ -82,6 +101,8 @@ Field2D::Field2D(BoutReal val) : fieldmesh(nullptr), deriv(nullptr) {
 }
 
 Field2D::~Field2D() {
+  if(comms_pending)
+    fieldmesh->cancelCommunication(*this);
   if(deriv)
     delete deriv;
 }
@@ -97,6 +118,7 @@ void Field2D::allocate() {
     data = Array<BoutReal>(nx*ny);
   }else
     data.ensureUnique();
+  guards_valid = false; // About to be modified
 }
 
 Field2D* Field2D::timeDeriv() {
@@ -116,6 +138,9 @@ Field2D & Field2D::operator=(const Field2D &rhs) {
 
   checkData(rhs);
   
+  if(comms_pending)
+    fieldmesh->cancelCommunication(*this); // Data replaced
+  
 #ifdef TRACK
   name = rhs.name;
 #endif
@@ -126,6 +151,10 @@ Field2D & Field2D::operator=(const Field2D &rhs) {
 
   // Copy reference to data
   data = rhs.data;
+  guards_valid = rhs.guards_valid;
+
+  if(rhs.comms_pending)
+    fieldmesh->communicate(*this); // Waits for rhs's guard cells
 
   return *this;
 }
@@ -207,6 +236,7 @@ const IndexRange Field2D::region(REGION rgn) const {
       /* This is the only reference to this data */          \
       for(auto i : (*this))                                  \
         (*this)[i] op rhs[i];                                \
+      guards_valid = false;                                  \
     }else {                                                  \
       /* Shared data */                                      \
       (*this) = (*this) bop rhs;                             \
@@ -231,6 +261,7 @@ F2D_UPDATE_FIELD(/=, /, Field2D); // operator/=(const Field2D &rhs)
       /* This is the only reference to this data */          \
       for(auto i : (*this))                                  \
         (*this)[i] op rhs;                                   \
+      guards_valid = false;                                  \
     }else {                                                  \
       /* Need to put result in a new block */                \
       (*this) = (*this) bop rhs;                             \
@@ -524,7 +555,7 @@ void Field2D::setBoundaryTo(const Field2D &f2d) {
 ////////////// NON-MEMBER OVERLOADED OPERATORS //////////////
 
 #define F2D_OP_F2D(op)                                     \
-  const Field2D operator op(const Field2D &lhs, const Field2D &rhs) { \
+  Field2D operator op(const Field2D &lhs, const Field2D &rhs) {       \
     Field2D result;                                                 \
     result.allocate();                                              \
     for(auto i : result)                                            \
@@ -538,7 +569,7 @@ F2D_OP_F2D(*);  // Field2D * Field2D
 F2D_OP_F2D(/);  // Field2D / Field2D
 
 #define F2D_OP_F3D(op)                                     \
-  const Field3D operator op(const Field2D &lhs, const Field3D &rhs) { \
+  Field3D operator op(const Field2D &lhs, const Field3D &rhs) {       \
     Field3D result;                                                 \
     result.allocate();                                              \
     for(auto i : result)                                            \
@@ -552,7 +583,7 @@ F2D_OP_F3D(*);  // Field2D * Field3D
 F2D_OP_F3D(/);  // Field2D / Field3D
 
 #define F2D_OP_REAL(op)                                     \
-  const Field2D operator op(const Field2D &lhs, BoutReal rhs) {     \
+  Field2D operator op(const Field2D &lhs, BoutReal rhs) {           \
     Field2D result;                                                 \
     result.allocate();                                              \
     for(auto i : result)                                            \
@@ -566,7 +597,7 @@ F2D_OP_REAL(*);  // Field2D * BoutReal
 F2D_OP_REAL(/);  // Field2D / BoutReal
 
 #define REAL_OP_F2D(op)                                     \
-  const Field2D operator op(BoutReal lhs, const Field2D &rhs) {     \
+  Field2D operator op(BoutReal lhs, const Field2D &rhs) {           \
     Field2D result;                                                 \
     result.allocate();                                              \
     for(auto i : result)                                            \
@@ -579,11 +610,80 @@ REAL_OP_F2D(-);  // BoutReal - Field2D
 REAL_OP_F2D(*);  // BoutReal * Field2D
 REAL_OP_F2D(/);  // BoutReal / Field2D
 
+// Operators on temporaries. If the data of the rvalue operand is not
+// shared then it is overwritten with the result
+
+#define F2D_OP_F2D_MOVE(op)                                         \
+  Field2D operator op(Field2D &&lhs, const Field2D &rhs) {          \
+    if(!lhs.isUnique())                                             \
+      return static_cast<const Field2D&>(lhs) op rhs;               \
+    for(auto i : lhs)                                               \
+      lhs[i] = lhs[i] op rhs[i];                                    \
+    return std::move(lhs);                                          \
+  }                                                                 \
+  Field2D operator op(const Field2D &lhs, Field2D &&rhs) {          \
+    if(!rhs.isUnique())                                             \
+      return lhs op static_cast<const Field2D&>(rhs);               \
+    for(auto i : rhs)                                               \
+      rhs[i] = lhs[i] op rhs[i];                                    \
+    return std::move(rhs);                                          \
+  }                                                                 \
+  Field2D operator op(Field2D &&lhs, Field2D &&rhs) {               \
+    if(lhs.isUnique())                                              \
+      return std::move(lhs) op static_cast<const Field2D&>(rhs);    \
+    return static_cast<const Field2D&>(lhs) op std::move(rhs);      \
+  }
+
+F2D_OP_F2D_MOVE(+);  // Field2D + Field2D
+F2D_OP_F2D_MOVE(-);  // Field2D - Field2D
+F2D_OP_F2D_MOVE(*);  // Field2D * Field2D
+F2D_OP_F2D_MOVE(/);  // Field2D / Field2D
+
+#define F2D_OP_F3D_MOVE(op)                                         \
+  Field3D operator op(const Field2D &lhs, Field3D &&rhs) {          \
+    if(!rhs.isUnique())                                             \
+      return lhs op static_cast<const Field3D&>(rhs);               \
+    for(auto i : rhs)                                               \
+      rhs[i] = lhs[i] op rhs[i];                                    \
+    rhs.setLocation(CELL_CENTRE);                                   \
+    return std::move(rhs);                                          \
+  }
+
+F2D_OP_F3D_MOVE(+);  // Field2D + Field3D&&
+F2D_OP_F3D_MOVE(-);  // Field2D - Field3D&&
+F2D_OP_F3D_MOVE(*);  // Field2D * Field3D&&
+F2D_OP_F3D_MOVE(/);  // Field2D / Field3D&&
+
+#define F2D_OP_REAL_MOVE(op)                                        \
+  Field2D operator op(Field2D &&lhs, BoutReal rhs) {                \
+    if(!lhs.isUnique())                                             \
+      return static_cast<const Field2D&>(lhs) op rhs;               \
+    for(auto i : lhs)                                               \
+      lhs[i] = lhs[i] op rhs;                                       \
+    return std::move(lhs);                                          \
+  }                                                                 \
+  Field2D operator op(BoutReal lhs, Field2D &&rhs) {                \
+    if(!rhs.isUnique())                                             \
+      return lhs op static_cast<const Field2D&>(rhs);               \
+    for(auto i : rhs)                                               \
+      rhs[i] = lhs op rhs[i];                                       \
+    return std::move(rhs);                                          \
+  }
+
+F2D_OP_REAL_MOVE(+);  // Field2D&& + BoutReal, BoutReal + Field2D&&
+F2D_OP_REAL_MOVE(-);  // Field2D&& - BoutReal, BoutReal - Field2D&&
+F2D_OP_REAL_MOVE(*);  // Field2D&& * BoutReal, BoutReal * Field2D&&
+F2D_OP_REAL_MOVE(/);  // Field2D&& / BoutReal, BoutReal / Field2D&&
+
 // Unary minus
-const Field2D operator-(const Field2D &f) {
+Field2D operator-(const Field2D &f) {
   return -1.0*f;
 }
 
+Field2D operator-(Field2D &&f) {
+  return -1.0*std::move(f);
+}
+
 //////////////// NON-MEMBER FUNCTIONS //////////////////
 
 BoutReal min(const Field2D &f, bool allpe) {
@@ -656,7 +756,7 @@ bool finite(const Field2D &f) {
  *
  */
 #define F2D_FUNC(name, func)                               \
-  const Field2D name(const Field2D &f) {                   \
+  Field2D name(const Field2D &f) {                         \
     msg_stack.push(#name "(Field2D)");                     \
     /* Check if the input is allocated */                  \
     ASSERT1(f.isAllocated());                              \
@@ -671,6 +771,18 @@ bool finite(const Field2D &f) {
     }                                                      \
     msg_stack.pop();                                       \
     return result;                                         \
+  }                                                        \
+  Field2D name(Field2D &&f) {                              \
+    /* If the data is shared then can't modify in place */ \
+    if(!f.isUnique())                                      \
+      return name(static_cast<const Field2D&>(f));         \
+    msg_stack.push(#name "(Field2D&&)");                   \
+    for(auto d : f) {                                      \
+      f[d] = func(f[d]);                                   \
+      ASSERT3(finite(f[d]));                               \
+    }                                                      \
+    msg_stack.pop();                                       \
+    return std::move(f);                                   \
   }
 
 F2D_FUNC(abs, ::fabs);
@@ -756,6 +868,46 @@ Field2D pow(BoutReal lhs, const Field2D &rhs) {
   return result;
 }
 
+Field2D pow(Field2D &&lhs, const Field2D &rhs) {
+  if(!lhs.isUnique())
+    return pow(static_cast<const Field2D&>(lhs), rhs);
+  
+  TRACE("pow(Field2D&&, Field2D)");
+  ASSERT1(rhs.isAllocated());
+  
+  for(auto i: lhs) {
+    lhs[i] = ::pow(lhs[i], rhs[i]);
+    ASSERT3(finite(lhs[i]));
+  }
+  return std::move(lhs);
+}
+
+Field2D pow(Field2D &&lhs, BoutReal rhs) {
+  if(!lhs.isUnique())
+    return pow(static_cast<const Field2D&>(lhs), rhs);
+  
+  TRACE("pow(Field2D&&, BoutReal)");
+  
+  for(auto i: lhs) {
+    lhs[i] = ::pow(lhs[i], rhs);
+    ASSERT3(finite(lhs[i]));
+  }
+  return std::move(lhs);
+}
+
+Field2D pow(BoutReal lhs, Field2D &&rhs) {
+  if(!rhs.isUnique())
+    return pow(lhs, static_cast<const Field2D&>(rhs));
+  
+  TRACE("pow(lhs, Field2D&&)");
+  
+  for(auto i: rhs) {
+    rhs[i] = ::pow(lhs, rhs[i]);
+    ASSERT3(finite(rhs[i]));
+  }
+  return std::move(rhs);
+}
+
 #ifdef CHECK
 /// Check if the data is valid
 void checkData(const Field2D &f) {
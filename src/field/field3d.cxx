@@ -24,6 +24,8 @@
 #include <globals.hxx>
 
 #include <cmath>
+#include <utility>
+#include <set>
 
 #include <field3d.hxx>
 #include <utils.hxx>
@@ -35,11 +37,14 @@
 #include <boutexception.hxx>
 #include <output.hxx>
 #include <msg_stack.hxx>
+#include <options.hxx>
 #include <bout/constants.hxx>
 #include <bout/assert.hxx>
+#include <bout/openmpwrap.hxx>
 
 /// Constructor
-Field3D::Field3D(Mesh *msh) : background(nullptr), fieldmesh(msh), deriv(nullptr), yup_field(nullptr), ydown_field(nullptr) {
+Field3D::Field3D(Mesh *msh) : background(nullptr), fieldmesh(msh), zspectrum_valid(false),
+                              deriv(nullptr), yup_field(nullptr), ydown_field(nullptr) {
 #ifdef TRACK
   name = "<F3D>";
 #endif
@@ -66,6 +71,7 @@ Field3D::Field3D(Mesh *msh) : background(nullptr), fieldmesh(msh), deriv(nullptr
 Field3D::Field3D(const Field3D& f) : background(nullptr),
 				     fieldmesh(f.fieldmesh), // The mesh containing array sizes
 				     data(f.data),   // This handles references to the data array
+				     zspectrum(f.zspectrum), zspectrum_valid(f.zspectrum_valid),
 				     deriv(nullptr),
 				     yup_field(nullptr), ydown_field(nullptr) {
 
@@ -89,11 +95,48 @@ Field3D::Field3D(const Field3D& f) : background(nullptr),
 #endif
 
   location = f.location;
+  guards_valid = f.guards_valid;
  
   boundaryIsSet = false;
+
+  if(f.comms_pending)
+    fieldmesh->communicate(*this); // Waits for f's guard cells
+}
+
+Field3D::Field3D(Field3D&& f) : background(nullptr),
+                                fieldmesh(f.fieldmesh),
+                                data(std::move(f.data)), // f no longer has data
+                                zspectrum(std::move(f.zspectrum)),
+                                zspectrum_valid(f.zspectrum_valid),
+                                deriv(nullptr),
+                                yup_field(nullptr), ydown_field(nullptr) {
+  f.zspectrum_valid = false;
+
+  if(fieldmesh) {
+    nx = fieldmesh->LocalNx;
+    ny = fieldmesh->LocalNy;
+    nz = fieldmesh->LocalNz;
+  }
+#ifdef CHECK
+  else {
+    nx=-1;
+    ny=-1;
+    nz=-1;
+  }
+#endif
+
+  location = f.location;
+  guards_valid = f.guards_valid;
+ 
+  boundaryIsSet = false;
+  if(f.comms_pending) {
+    // Take f's place in the list of fields to be communicated
+    fieldmesh->cancelCommunication(f);
+    fieldmesh->communicate(*this);
+  }
 }
 
-Field3D::Field3D(const Field2D& f) : background(nullptr), fieldmesh(nullptr), deriv(nullptr), yup_field(nullptr), ydown_field(nullptr) {
+Field3D::Field3D(const Field2D& f) : background(nullptr), fieldmesh(nullptr), zspectrum_valid(false), deriv(nullptr), yup_field(nullptr), ydown_field(nullptr) {
   
   TRACE("Field3D: Copy constructor from Field2D");
   
@@ -109,7 +152,7 @@ Field3D::Field3D(const Field2D& f) : background(nullptr), fieldmesh(nullptr), de
   *this = f;
 }
 
-Field3D::Field3D(const BoutReal val) : background(nullptr), fieldmesh(nullptr), deriv(nullptr), yup_field(nullptr), ydown_field(nullptr) {
+Field3D::Field3D(const BoutReal val) : background(nullptr), fieldmesh(nullptr), zspectrum_valid(false), deriv(nullptr), yup_field(nullptr), ydown_field(nullptr) {
   
   TRACE("Field3D: Copy constructor from value");
 
@@ -126,6 +169,9 @@ Field3D::Field3D(const BoutReal val) : background(nullptr), fieldmesh(nullptr),
 }
 
 Field3D::~Field3D() {
+  if(comms_pending)
+    fieldmesh->cancelCommunication(*this);
+  
   /// Delete the time derivative variable if allocated
   if(deriv != NULL) {
     // The ddt of the yup/ydown_fields point to the same place as ddt.yup_field
@@ -159,6 +205,68 @@ void Field3D::allocate() {
     data = Array<BoutReal>(nx*ny*nz);
   }else
     data.ensureUnique();
+  guards_valid = false; // About to be modified
+  zspectrum_valid = false;
+}
+
+/////////////////// SPECTRAL REPRESENTATION ///////////////////
+
+bool Field3D::cacheZSpectrum() {
+  static bool cache = [] {
+    bool value;
+    Options::getRoot()->getSection("fft")->get("cache_spectrum", value, false);
+    return value;
+  }();
+  return cache;
+}
+
+const Array<dcomplex> Field3D::zSpectrum() const {
+  TRACE("Field3D::zSpectrum");
+  
+  ASSERT1(isAllocated());
+  
+  if(zspectrum_valid)
+    return zspectrum;
+  
+  int nk = nz/2 + 1;
+  // New array, since the old one may be shared with other fields
+  Array<dcomplex> spectrum(nx*ny*nk);
+  
+  BOUT_OMP(parallel for)
+  for(int j=0;j<nx*ny;j++) {
+    rfft(&data[j*nz], nz, &spectrum[j*nk]);
+  }
+  
+  if(cacheZSpectrum()) {
+    zspectrum = spectrum;
+    zspectrum_valid = true;
+  }
+  return spectrum;
+}
+
+void Field3D::zSpectrum(int jx, int jy, dcomplex *out) const {
+  ASSERT1(isAllocated());
+  
+  if(zspectrum_valid) {
+    int nk = nz/2 + 1;
+    const dcomplex *in = &zspectrum[(jx*ny + jy)*nk];
+    for(int k=0;k<nk;k++)
+      out[k] = in[k];
+  }else
+    rfft(operator()(jx,jy), nz, out);
+}
+
+void Field3D::prepareZSpectrum() const {
+  if(cacheZSpectrum())
+    zSpectrum();
+}
+
+void Field3D::setZSpectrum(const Array<dcomplex> &spectrum) {
+  if(!cacheZSpectrum())
+    return;
+  ASSERT1(spectrum.size() == nx*ny*(nz/2 + 1));
+  zspectrum = spectrum;
+  zspectrum_valid = true;
 }
 
 Field3D* Field3D::timeDeriv() {
@@ -297,13 +405,22 @@ Field3D & Field3D::operator=(const Field3D &rhs) {
   /// Check that the data is valid
   checkData(rhs);
   
+  if(comms_pending)
+    fieldmesh->cancelCommunication(*this); // Data replaced
+  
   // Copy the data and data sizes
   fieldmesh = rhs.fieldmesh;
   nx = rhs.nx; ny = rhs.ny; nz = rhs.nz; 
   
   data = rhs.data;
+  zspectrum = rhs.zspectrum;
+  zspectrum_valid = rhs.zspectrum_valid;
+  guards_valid = rhs.guards_valid;
   
   location = rhs.location;
+
+  if(rhs.comms_pending)
+    fieldmesh->communicate(*this); // Waits for rhs's guard cells
   
   return *this;
 }
@@ -388,6 +505,8 @@ BoutReal Field3D::operator=(const BoutReal val) {
       /* This is the only reference to this data */          \
       for(auto i : (*this))                                  \
         (*this)[i] op rhs[i];                                \
+      guards_valid = false;                                  \
+      zspectrum_valid = false;                               \
     }else {                                                  \
       /* Shared data */                                      \
       (*this) = (*this) bop rhs;                             \
@@ -417,6 +536,8 @@ F3D_UPDATE_FIELD(/=, /, Field2D);    // operator/= Field2D
       /* This is the only reference to this data */          \
       for(auto i : (*this))                                  \
         (*this)[i] op rhs;                                   \
+      guards_valid = false;                                  \
+      zspectrum_valid = false;                               \
     }else {                                                  \
       /* Need to put result in a new block */                \
       (*this) = (*this) bop rhs;                             \
@@ -775,6 +896,7 @@ void Field3D::applyBoundary(bool init) {
   TRACE("Field3D::applyBoundary()");
 
   ASSERT1(isAllocated());
+  zspectrum_valid = false; // Boundary values modified
   
   if(background != NULL) {
     // Apply boundary to the total of this and background
@@ -800,6 +922,7 @@ void Field3D::applyBoundary(BoutReal t) {
 #endif
 
   ASSERT1(isAllocated())
+  zspectrum_valid = false;
 
   if(background != NULL) {
     // Apply boundary to the total of this and background
@@ -815,10 +938,52 @@ void Field3D::applyBoundary(BoutReal t) {
   }
 }
 
+void Field3D::applyBoundaries(const std::vector<Field3D*> &fields, BoutReal t) {
+  TRACE("Field3D::applyBoundaries()");
+
+  // Fields which can be done in parallel. Boundary operations can be
+  // shared between fields (see copyBoundary), so each may only be used once
+  std::vector<Field3D*> threaded;
+  std::set<BoundaryOp*> used;
+
+  for(const auto &f : fields) {
+    ASSERT1(f->isAllocated());
+    f->zspectrum_valid = false;
+
+    bool safe = (f->background == nullptr)
+      && (!mesh->StaggerGrids || (f->getLocation() == CELL_CENTRE));
+    for(const auto &bndry : f->bndry_op)
+      safe &= bndry->threadSafe() && (used.count(bndry) == 0);
+
+    if(safe) {
+#ifdef CHECK
+      if(!f->boundaryIsSet)
+        output << "WARNING: Call to Field3D::applyBoundary(t), but no boundary set." << endl;
+#endif
+      for(const auto &bndry : f->bndry_op)
+        used.insert(bndry);
+      threaded.push_back(f);
+    }else
+      f->applyBoundary(t);
+  }
+
+  // Boundary points are calculated on first use, which isn't thread-safe
+  for(const auto &reg : mesh->getBoundaries())
+    reg->points();
+
+  int n = static_cast<int>(threaded.size());
+  BOUT_OMP(parallel for schedule(dynamic))
+  for(int i=0;i<n;i++) {
+    for(const auto &bndry : threaded[i]->bndry_op)
+      bndry->apply(*threaded[i], t);
+  }
+}
+
 void Field3D::applyBoundary(const string &condition) {
   TRACE("Field3D::applyBoundary(condition)");
   
   ASSERT1(isAllocated());
+  zspectrum_valid = false;
   
   if(background != NULL) {
     // Apply boundary to the total of this and background
@@ -842,6 +1007,7 @@ void Field3D::applyBoundary(const string &condition) {
 
 void Field3D::applyBoundary(const string &region, const string &condition) {
   ASSERT1(isAllocated());
+  zspectrum_valid = false;
 
   /// Get the boundary factory (singleton)
   BoundaryFactory *bfact = BoundaryFactory::getInstance();
@@ -863,6 +1029,7 @@ void Field3D::applyTDerivBoundary() {
   ASSERT1(isAllocated());
   ASSERT1(deriv != NULL);
   ASSERT1(deriv->isAllocated());
+  deriv->zspectrum_valid = false;
   
   if(background != NULL)
     *this += *background;
@@ -874,6 +1041,42 @@ void Field3D::applyTDerivBoundary() {
     *this -= *background;
 }
 
+void Field3D::applyTDerivBoundaries(const std::vector<Field3D*> &fields) {
+  TRACE("Field3D::applyTDerivBoundaries()");
+
+  // Same rules as applyBoundaries
+  std::vector<Field3D*> threaded;
+  std::set<BoundaryOp*> used;
+
+  for(const auto &f : fields) {
+    bool safe = (f->background == nullptr)
+      && (!mesh->StaggerGrids || (f->getLocation() == CELL_CENTRE));
+    for(const auto &bndry : f->bndry_op)
+      safe &= bndry->threadSafe() && (used.count(bndry) == 0);
+
+    if(safe) {
+      ASSERT1(f->isAllocated());
+      ASSERT1(f->deriv != NULL);
+      ASSERT1(f->deriv->isAllocated());
+      f->deriv->zspectrum_valid = false;
+      for(const auto &bndry : f->bndry_op)
+        used.insert(bndry);
+      threaded.push_back(f);
+    }else
+      f->applyTDerivBoundary();
+  }
+
+  for(const auto &reg : mesh->getBoundaries())
+    reg->points();
+
+  int n = static_cast<int>(threaded.size());
+  BOUT_OMP(parallel for schedule(dynamic))
+  for(int i=0;i<n;i++) {
+    for(const auto &bndry : threaded[i]->bndry_op)
+      bndry->apply_ddt(*threaded[i]);
+  }
+}
+
 void Field3D::setBoundaryTo(const Field3D &f3d) {
   TRACE("Field3D::setBoundary(const Field3D&)");
   
@@ -1022,10 +1225,14 @@ void Field3D::applyParallelBoundary(const string &region, const string &conditio
  ***************************************************************/
 
 
-const Field3D operator-(const Field3D &f) {
+Field3D operator-(const Field3D &f) {
   return -1.0*f;
 }
 
+Field3D operator-(Field3D &&f) {
+  return -1.0*std::move(f);
+}
+
 #define F3D_OP_FPERP(op)                     	                          \
   const FieldPerp operator op(const Field3D &lhs, const FieldPerp &rhs) { \
     FieldPerp result;                                                     \
@@ -1042,7 +1249,7 @@ F3D_OP_FPERP(/);
 F3D_OP_FPERP(*);
 
 #define F3D_OP_FIELD(op, ftype)                                     \
-  const Field3D operator op(const Field3D &lhs, const ftype &rhs) { \
+  Field3D operator op(const Field3D &lhs, const ftype &rhs) {       \
     Field3D result;                                                 \
     result.allocate();                                              \
     for(auto i : lhs)                                               \
@@ -1062,7 +1269,7 @@ F3D_OP_FIELD(*, Field2D);   // Field3D * Field2D
 F3D_OP_FIELD(/, Field2D);   // Field3D / Field2D
 
 #define F3D_OP_REAL(op)                                         \
-  const Field3D operator op(const Field3D &lhs, BoutReal rhs) { \
+  Field3D operator op(const Field3D &lhs, BoutReal rhs) {       \
     Field3D result;                                             \
     result.allocate();                                          \
     for(auto i : lhs)                                           \
@@ -1077,7 +1284,7 @@ F3D_OP_REAL(*); // Field3D * BoutReal
 F3D_OP_REAL(/); // Field3D / BoutReal
 
 #define REAL_OP_F3D(op)                                         \
-  const Field3D operator op(BoutReal lhs, const Field3D &rhs) { \
+  Field3D operator op(BoutReal lhs, const Field3D &rhs) {       \
     Field3D result;                                             \
     result.allocate();                                          \
     for(auto i : rhs)                                           \
@@ -1091,8 +1298,109 @@ REAL_OP_F3D(-); // BoutReal - Field3D
 REAL_OP_F3D(*); // BoutReal * Field3D
 REAL_OP_F3D(/); // BoutReal / Field3D
 
+// Operators on temporaries. If the data of the rvalue operand is not
+// shared then it is overwritten with the result, rather than
+// allocating a new array. The data is unique, so allocate() only marks
+// the guard cells and Z spectrum as out of date
+
+#define F3D_OP_FIELD_MOVE(op, ftype)                                \
+  Field3D operator op(Field3D &&lhs, const ftype &rhs) {            \
+    if(!lhs.isUnique())                                             \
+      return static_cast<const Field3D&>(lhs) op rhs;               \
+    lhs.allocate();                                                 \
+    for(auto i : lhs)                                               \
+      lhs[i] = lhs[i] op rhs[i];                                    \
+    return std::move(lhs);                                          \
+  }
+
+F3D_OP_FIELD_MOVE(+, Field3D);   // Field3D&& + Field3D
+F3D_OP_FIELD_MOVE(-, Field3D);   // Field3D&& - Field3D
+F3D_OP_FIELD_MOVE(*, Field3D);   // Field3D&& * Field3D
+F3D_OP_FIELD_MOVE(/, Field3D);   // Field3D&& / Field3D
+
+F3D_OP_FIELD_MOVE(+, Field2D);   // Field3D&& + Field2D
+F3D_OP_FIELD_MOVE(-, Field2D);   // Field3D&& - Field2D
+F3D_OP_FIELD_MOVE(*, Field2D);   // Field3D&& * Field2D
+F3D_OP_FIELD_MOVE(/, Field2D);   // Field3D&& / Field2D
+
+#define F3D_OP_MOVE_FIELD(op)                                       \
+  Field3D operator op(const Field3D &lhs, Field3D &&rhs) {          \
+    if(!rhs.isUnique())                                             \
+      return lhs op static_cast<const Field3D&>(rhs);               \
+    rhs.allocate();                                                 \
+    for(auto i : rhs)                                               \
+      rhs[i] = lhs[i] op rhs[i];                                    \
+    rhs.setLocation( lhs.getLocation() );                           \
+    return std::move(rhs);                                          \
+  }                                                                 \
+  Field3D operator op(Field3D &&lhs, Field3D &&rhs) {               \
+    if(lhs.isUnique())                                              \
+      return std::move(lhs) op static_cast<const Field3D&>(rhs);    \
+    return static_cast<const Field3D&>(lhs) op std::move(rhs);      \
+  }
+
+F3D_OP_MOVE_FIELD(+);   // Field3D + Field3D&&
+F3D_OP_MOVE_FIELD(-);   // Field3D - Field3D&&
+F3D_OP_MOVE_FIELD(*);   // Field3D * Field3D&&
+F3D_OP_MOVE_FIELD(/);   // Field3D / Field3D&&
+
+#define F3D_OP_REAL_MOVE(op)                                    \
+  Field3D operator op(Field3D &&lhs, BoutReal rhs) {            \
+    if(!lhs.isUnique())                                         \
+      return static_cast<const Field3D&>(lhs) op rhs;           \
+    lhs.allocate();                                             \
+    for(auto i : lhs)                                           \
+      lhs[i] = lhs[i] op rhs;                                   \
+    return std::move(lhs);                                      \
+  }                                                             \
+  Field3D operator op(BoutReal lhs, Field3D &&rhs) {            \
+    if(!rhs.isUnique())                                         \
+      return lhs op static_cast<const Field3D&>(rhs);           \
+    rhs.allocate();                                             \
+    for(auto i : rhs)                                           \
+      rhs[i] = lhs op rhs[i];                                   \
+    return std::move(rhs);                                      \
+  }
+
+F3D_OP_REAL_MOVE(+); // Field3D&& + BoutReal, BoutReal + Field3D&&
+F3D_OP_REAL_MOVE(-); // Field3D&& - BoutReal, BoutReal - Field3D&&
+F3D_OP_REAL_MOVE(*); // Field3D&& * BoutReal, BoutReal * Field3D&&
+F3D_OP_REAL_MOVE(/); // Field3D&& / BoutReal, BoutReal / Field3D&&
+
 //////////////// NON-MEMBER FUNCTIONS //////////////////
 
+// The pow functions loop over the contiguous data arrays, so that
+// the loops can be threaded and vectorised. Arrays may be the same
+// for in-place operations on temporaries
+
+/// Number of points in the data array of a field
+static int nPoints(const Field3D &f) {
+  return f.getNx()*f.getNy()*f.getNz();
+}
+
+/// result = pow(lhs, rhs) elementwise
+static void powArray(const BoutReal *lhs, const BoutReal *rhs, BoutReal *result, int n) {
+  BOUT_OMP_SIMD_FOR
+  for(int i=0;i<n;i++)
+    result[i] = ::pow(lhs[i], rhs[i]);
+}
+
+/// result = pow(lhs, rhs) where rhs is constant in z
+static void powArray(const Field3D &lhs, const Field2D &rhs, Field3D &result) {
+  const int ny = result.getNy(), nz = result.getNz();
+  const int nxy = result.getNx()*ny;
+  
+  BOUT_OMP(parallel for)
+  for(int j=0;j<nxy;j++) {
+    const BoutReal *l = lhs(j / ny, j % ny);
+    BoutReal *r = result(j / ny, j % ny);
+    const BoutReal p = rhs(j / ny, j % ny);
+    BOUT_OMP_SIMD
+    for(int jz=0;jz<nz;jz++)
+      r[jz] = ::pow(l[jz], p);
+  }
+}
+
 Field3D pow(const Field3D &lhs, const Field3D &rhs) {
   TRACE("pow(Field3D, Field3D)");
 
@@ -1104,11 +1412,8 @@ Field3D pow(const Field3D &lhs, const Field3D &rhs) {
   Field3D result;
   result.allocate();
 
-  // Iterate over indices
-  for(auto i : result) {
-    result[i] = ::pow(lhs[i], rhs[i]);
-    ASSERT2( ::finite( result[i] ) );
-  }
+  powArray(lhs(0,0), rhs(0,0), result(0,0), nPoints(result));
+  ASSERT2( finite(result) );
   
   result.setLocation( lhs.getLocation() );
   
@@ -1121,11 +1426,8 @@ Field3D pow(const Field3D &lhs, const Field2D &rhs) {
   Field3D result;
   result.allocate();
 
-  // Iterate over indices
-  for(auto i : result) {
-    result[i] = ::pow(lhs[i], rhs[i]);
-    ASSERT2( ::finite( result[i] ) );
-  }
+  powArray(lhs, rhs, result);
+  ASSERT2( finite(result) );
 
   result.setLocation( lhs.getLocation() );
   
@@ -1149,25 +1451,101 @@ Field3D pow(const Field3D &lhs, const FieldPerp &rhs) {
 }
 
 Field3D pow(const Field3D &f, BoutReal rhs) {
+  TRACE("pow(Field3D, BoutReal)");
+
   Field3D result;
   result.allocate();
-  for(auto i : result)
-    result[i] = ::pow(f[i], rhs);
+  
+  const BoutReal *fd = f(0,0);
+  BoutReal *rd = result(0,0);
+  const int n = nPoints(result);
+  BOUT_OMP_SIMD_FOR
+  for(int i=0;i<n;i++)
+    rd[i] = ::pow(fd[i], rhs);
+  ASSERT1( finite(result) );
   
   result.setLocation( f.getLocation() );
   return result;
 }
 
 Field3D pow(BoutReal lhs, const Field3D &rhs) {
+  TRACE("pow(BoutReal, Field3D)");
+
   Field3D result;
   result.allocate();
-  for(auto i : result)
-    result[i] = ::pow(lhs, rhs[i]);
+  
+  const BoutReal *fd = rhs(0,0);
+  BoutReal *rd = result(0,0);
+  const int n = nPoints(result);
+  BOUT_OMP_SIMD_FOR
+  for(int i=0;i<n;i++)
+    rd[i] = ::pow(lhs, fd[i]);
+  ASSERT1( finite(result) );
   
   result.setLocation( rhs.getLocation() );
   return result;
 }
 
+Field3D pow(Field3D &&lhs, const Field3D &rhs) {
+  if(!lhs.isUnique() || (mesh->StaggerGrids && (lhs.getLocation() != rhs.getLocation())))
+    return pow(static_cast<const Field3D&>(lhs), rhs);
+  
+  TRACE("pow(Field3D&&, Field3D)");
+  
+  lhs.allocate(); // Unique, so only marks guards and spectrum invalid
+  powArray(lhs(0,0), rhs(0,0), lhs(0,0), nPoints(lhs));
+  ASSERT2( finite(lhs) );
+  
+  return std::move(lhs);
+}
+
+Field3D pow(Field3D &&lhs, const Field2D &rhs) {
+  if(!lhs.isUnique())
+    return pow(static_cast<const Field3D&>(lhs), rhs);
+  
+  TRACE("pow(Field3D&&, Field2D)");
+  
+  lhs.allocate(); // Unique, so only marks guards and spectrum invalid
+  powArray(lhs, rhs, lhs);
+  ASSERT2( finite(lhs) );
+  
+  return std::move(lhs);
+}
+
+Field3D pow(Field3D &&f, BoutReal rhs) {
+  if(!f.isUnique())
+    return pow(static_cast<const Field3D&>(f), rhs);
+  
+  TRACE("pow(Field3D&&, BoutReal)");
+
+  f.allocate(); // Unique, so only marks guards and spectrum invalid
+  BoutReal *fd = f(0,0);
+  const int n = nPoints(f);
+  BOUT_OMP_SIMD_FOR
+  for(int i=0;i<n;i++)
+    fd[i] = ::pow(fd[i], rhs);
+  ASSERT1( finite(f) );
+  
+  return std::move(f);
+}
+
+Field3D pow(BoutReal lhs, Field3D &&rhs) {
+  if(!rhs.isUnique())
+    return pow(lhs, static_cast<const Field3D&>(rhs));
+  
+  TRACE("pow(BoutReal, Field3D&&)");
+
+  rhs.allocate(); // Unique, so only marks guards and spectrum invalid
+  BoutReal *fd = rhs(0,0);
+  const int n = nPoints(rhs);
+  BOUT_OMP_SIMD_FOR
+  for(int i=0;i<n;i++)
+    fd[i] = ::pow(lhs, fd[i]);
+  ASSERT1( finite(rhs) );
+  
+  return std::move(rhs);
+}
+
 BoutReal min(const Field3D &f, bool allpe) {
 #ifdef CHECK
   if(!f.isAllocated())
@@ -1230,8 +1608,11 @@ BoutReal max(const Field3D &f, bool allpe) {
 /////////////////////////////////////////////////////////////////////
 // Friend functions
 
+// Elementwise functions loop over the contiguous data arrays, so
+// that the loops can be threaded and vectorised. Checking for
+// non-finite results is done in a separate pass
 #define F3D_FUNC(name, func)                               \
-  const Field3D name(const Field3D &f) {                   \
+  Field3D name(const Field3D &f) {                         \
     msg_stack.push(#name "(Field3D)");                     \
     /* Check if the input is allocated */                  \
     ASSERT1(f.isAllocated());                              \
@@ -1239,14 +1620,33 @@ BoutReal max(const Field3D &f, bool allpe) {
     Field3D result;                                        \
     result.allocate();                                     \
     /* Loop over domain */                                 \
-    for(auto d : result) {                                 \
-      result[d] = func(f[d]);                              \
-      /* If checking is set to 3 or higher, test result */ \
-      ASSERT3(finite(result[d]));                          \
-    }                                                      \
+    const BoutReal *fd = f(0,0);                           \
+    BoutReal *rd = result(0,0);                            \
+    const int n = nPoints(result);                         \
+    BOUT_OMP_SIMD_FOR                                      \
+    for(int i=0;i<n;i++)                                   \
+      rd[i] = func(fd[i]);                                 \
+    /* If checking is set to 3 or higher, test result */   \
+    ASSERT3(finite(result));                               \
     result.setLocation(f.getLocation());                   \
     msg_stack.pop();                                       \
     return result;                                         \
+  }                                                        \
+  Field3D name(Field3D &&f) {                              \
+    /* If the data is shared then can't modify in place */ \
+    if(!f.isUnique())                                      \
+      return name(static_cast<const Field3D&>(f));         \
+    msg_stack.push(#name "(Field3D&&)");                   \
+    /* Unique, so only marks guards and spectrum invalid */\
+    f.allocate();                                          \
+    BoutReal *fd = f(0,0);                                 \
+    const int n = nPoints(f);                              \
+    BOUT_OMP_SIMD_FOR                                      \
+    for(int i=0;i<n;i++)                                   \
+      fd[i] = func(fd[i]);                                 \
+    ASSERT3(finite(f));                                    \
+    msg_stack.pop();                                       \
+    return std::move(f);                                   \
   }
 
 F3D_FUNC(sqrt, ::sqrt);
@@ -1269,27 +1669,35 @@ const Field3D filter(const Field3D &var, int N0) {
   ASSERT1(var.isAllocated());
   
   int ncz = mesh->LocalNz;
-  Array<dcomplex> f(ncz/2 + 1);
+  int nk = ncz/2 + 1;
+  
+  // If the coefficients of var are stored, keep those of the
+  // result too. Otherwise only one row is needed at a time
+  bool store = var.hasZSpectrum();
+  Array<dcomplex> f(store ? mesh->LocalNx*mesh->LocalNy*nk : nk);
   
   Field3D result;
   result.allocate();
   
   for(int jx=0;jx<mesh->LocalNx;jx++) {
     for(int jy=0;jy<mesh->LocalNy;jy++) {
-
-      rfft(&(var(jx, jy, 0)), ncz, f.begin()); // Forward FFT
-
+      dcomplex *fxy = store ? &f[(jx*mesh->LocalNy + jy)*nk] : f.begin();
+      
+      var.zSpectrum(jx, jy, fxy); // Forward FFT (or stored)
+      
       for(int jz=0;jz<=ncz/2;jz++) {
 	
 	if(jz != N0) {
 	  // Zero this component
-	  f[jz] = 0.0;
+	  fxy[jz] = 0.0;
 	}
       }
 
-      irfft(f.begin(), ncz, &(result(jx, jy, 0))); // Reverse FFT
+      irfft(fxy, ncz, &(result(jx, jy, 0))); // Reverse FFT
     }
   }
+  if(store)
+    result.setZSpectrum(f);
   
 #ifdef TRACK
   result.name = "filter("+var.name+")";
@@ -1302,90 +1710,105 @@ const Field3D filter(const Field3D &var, int N0) {
 
 // Fourier filter in z
 const Field3D lowPass(const Field3D &var, int zmax) {
-  
-  msg_stack.push("lowPass(Field3D, %d)", zmax);
+  TRACE("lowPass(Field3D, int)");
 
   ASSERT1(var.isAllocated());
   
   int ncz = mesh->LocalNz;
-  
-  // Create an array 
-  Array<dcomplex> f(ncz/2 + 1);
+  int nk = ncz/2 + 1;
   
   if((zmax >= ncz/2) || (zmax < 0)) {
     // Removing nothing
     return var;
   }
 
+  // Keep the result's coefficients if those of var are stored
+  bool store = var.hasZSpectrum();
+  Array<dcomplex> f(store ? mesh->LocalNx*mesh->LocalNy*nk : nk);
+
   Field3D result;
   result.allocate();
   
   for(int jx=0;jx<mesh->LocalNx;jx++) {
     for(int jy=0;jy<mesh->LocalNy;jy++) {
-      // Take FFT in the Z direction
-      rfft(&(var(jx,jy,0)), ncz, f.begin());
+      dcomplex *fxy = store ? &f[(jx*mesh->LocalNy + jy)*nk] : f.begin();
+      
+      // Take FFT in the Z direction (or use stored coefficients)
+      var.zSpectrum(jx, jy, fxy);
       
       // Filter in z
       for(int jz=zmax+1;jz<=ncz/2;jz++)
-	f[jz] = 0.0;
+	fxy[jz] = 0.0;
 
-      irfft(f.begin(), ncz, &(result(jx,jy,0))); // Reverse FFT
+      irfft(fxy, ncz, &(result(jx,jy,0))); // Reverse FFT
     }
   }
+  if(store)
+    result.setZSpectrum(f);
   
   result.setLocation(var.getLocation());
-
-  msg_stack.pop();
   
   return result;
 }
 
 // Fourier filter in z with zmin
 const Field3D lowPass(const Field3D &var, int zmax, int zmin) {
-
-#ifdef CHECK
-  msg_stack.push("lowPass(Field3D, %d, %d)", zmax, zmin);
-#endif
+  TRACE("lowPass(Field3D, int, int)");
 
   ASSERT1(var.isAllocated());
 
   int ncz = mesh->LocalNz;
-  Array<dcomplex> f(ncz/2 + 1);
+  int nk = ncz/2 + 1;
  
   if(((zmax >= ncz/2) || (zmax < 0)) && (zmin < 0)) {
     // Removing nothing
     return var;
   }
 
+  // Keep the result's coefficients if those of var are stored
+  bool store = var.hasZSpectrum();
+  Array<dcomplex> f(store ? mesh->LocalNx*mesh->LocalNy*nk : nk);
+
   Field3D result;
   result.allocate();
   
   for(int jx=0;jx<mesh->LocalNx;jx++) {
     for(int jy=0;jy<mesh->LocalNy;jy++) {
-      // Take FFT in the Z direction
-      rfft(&(var(jx,jy,0)), ncz, f.begin());
+      dcomplex *fxy = store ? &f[(jx*mesh->LocalNy + jy)*nk] : f.begin();
+      
+      // Take FFT in the Z direction (or use stored coefficients)
+      var.zSpectrum(jx, jy, fxy);
       
       // Filter in z
       for(int jz=zmax+1;jz<=ncz/2;jz++)
-	f[jz] = 0.0;
+	fxy[jz] = 0.0;
 
       // Filter zonal mode
       if(zmin==0) {
-	f[0] = 0.0;
+	fxy[0] = 0.0;
       }
-      irfft(f.begin(), ncz, &(result(jx,jy,0))); // Reverse FFT
+      irfft(fxy, ncz, &(result(jx,jy,0))); // Reverse FFT
     }
   }
+  if(store)
+    result.setZSpectrum(f);
   
   result.setLocation(var.getLocation());
   
-#ifdef CHECK
-  msg_stack.pop();
-#endif
-  
   return result;
 }
 
+/*!
+ * Apply phase shift to Fourier coefficients \p v
+ */
+static void shiftZSpectrum(dcomplex *v, int ncz, double zangle) {
+  BoutReal zlength = mesh->coordinates()->zlength();
+  for(int jz=1;jz<=ncz/2;jz++) {
+    BoutReal kwave=jz*2.0*PI/zlength; // wave number is 1/[rad]
+    v[jz] *= dcomplex(cos(kwave*zangle) , -sin(kwave*zangle));
+  }
+}
+
 /* 
  * Use FFT to shift by an angle in the Z direction
  */
@@ -1400,22 +1823,46 @@ void shiftZ(Field3D &var, int jx, int jy, double zangle) {
   
   Array<dcomplex> v(ncz/2 + 1);
   
-  rfft(&(var(jx,jy,0)), ncz, v.begin()); // Forward FFT
+  var.zSpectrum(jx, jy, v.begin()); // Forward FFT (or stored)
 
-  BoutReal zlength = mesh->coordinates()->zlength();
   // Apply phase shift
-  for(int jz=1;jz<=ncz/2;jz++) {
-    BoutReal kwave=jz*2.0*PI/zlength; // wave number is 1/[rad]
-    v[jz] *= dcomplex(cos(kwave*zangle) , -sin(kwave*zangle));
-  }
+  shiftZSpectrum(v.begin(), ncz, zangle);
 
   irfft(v.begin(), ncz, &(var(jx,jy,0))); // Reverse FFT
 }
 
 void shiftZ(Field3D &var, double zangle) {
-  for(int x=0;x<mesh->LocalNx;x++) 
-    for(int y=0;mesh->LocalNy;y++)
-      shiftZ(var, x, y, zangle);
+  TRACE("shiftZ");
+  ASSERT1(var.isAllocated());
+  
+  int ncz = mesh->LocalNz;
+  if(ncz == 1)
+    return;
+  int nk = ncz/2 + 1;
+  
+  if(!var.hasZSpectrum()) {
+    // Shift one row at a time
+    for(int x=0;x<mesh->LocalNx;x++) 
+      for(int y=0;y<mesh->LocalNy;y++)
+        shiftZ(var, x, y, zangle);
+    return;
+  }
+  
+  // Stored coefficients for all (x,y), taken before var is modified.
+  // Copied, since zSpectrum returns the stored array
+  Array<dcomplex> v = var.zSpectrum();
+  v.ensureUnique();
+  
+  var.allocate(); // Ensure that var is unique
+  
+  for(int x=0;x<mesh->LocalNx;x++) {
+    for(int y=0;y<mesh->LocalNy;y++) {
+      dcomplex *vxy = &v[(x*mesh->LocalNy + y)*nk];
+      shiftZSpectrum(vxy, ncz, zangle);
+      irfft(vxy, ncz, var(x,y)); // Reverse FFT
+    }
+  }
+  var.setZSpectrum(v);
 }
 
 bool finite(const Field3D &f) {
@@ -5,7 +5,8 @@
 #include <output.hxx>
 #include <field_factory.hxx>
 
-FieldData::FieldData() : boundaryIsCopy(false), boundaryIsSet(true) {
+FieldData::FieldData() : boundaryIsCopy(false), boundaryIsSet(true),
+                         guards_valid(false), comms_pending(false) {
   
 }
 
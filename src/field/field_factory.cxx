@@ -23,6 +23,8 @@
 
 #include <field_factory.hxx>
 
+#include <bout/openmpwrap.hxx>
+
 #include <cmath>
 
 #include <output.hxx>
@@ -93,7 +95,25 @@ FieldFactory::FieldFactory(Mesh *m, Options *opt) : fieldmesh(m), options(opt) {
 }
 
 FieldFactory::~FieldFactory() {
+  for(auto &it : programs)
+    delete it.second;
+
+}
 
+/// Fill \p xpos and \p ypos with the coordinates used in expressions
+static void gridXY(Mesh *m, CELL_LOC loc, Array<BoutReal> &xpos, Array<BoutReal> &ypos) {
+  for(int x=0;x<m->LocalNx;x++) {
+    if(loc == CELL_XLOW) {
+      xpos[x] = 0.5*(m->GlobalX(x-1) + m->GlobalX(x));
+    }else
+      xpos[x] = m->GlobalX(x);
+  }
+  for(int y=0;y<m->LocalNy;y++) {
+    if(loc == CELL_YLOW) {
+      ypos[y] = TWOPI*0.5*(m->GlobalY(y-1) + m->GlobalY(y));
+    }else
+      ypos[y] = TWOPI*m->GlobalY(y);
+  }
 }
 
 const Field2D FieldFactory::create2D(const string &value, Options *opt, Mesh *m, CELL_LOC loc, BoutReal t) {
@@ -117,36 +137,18 @@ const Field2D FieldFactory::create2D(const string &value, Options *opt, Mesh *m,
     return result;
   }
 
-  switch(loc)  {
-  case CELL_XLOW: {
-    for(auto i : result) {
-      BoutReal xpos = 0.5*(m->GlobalX(i.x-1) + m->GlobalX(i.x));
-      result[i] = gen->generate(xpos,
-                                TWOPI*m->GlobalY(i.y),
-                                0.0,  // Z
-                                t); // T
-    }
-    break;
-  }
-  case CELL_YLOW: {
-    for(auto i : result) {
-      BoutReal ypos = TWOPI*0.5*(m->GlobalY(i.y-1) + m->GlobalY(i.y));
-      result[i] = gen->generate(m->GlobalX(i.x),
-                                ypos,
-                                0.0,  // Z
-                                t); // T
-    }
-    break;
-  }
-  default: {// CELL_CENTRE or CELL_ZLOW
-    for(auto i : result) {
-      result[i] = gen->generate(m->GlobalX(i.x),
-                                TWOPI*m->GlobalY(i.y),
-                                0.0,  // Z
-                                t); // T
-    }
-  }
-  };
+  int nx = m->LocalNx, ny = m->LocalNy;
+  Array<BoutReal> xpos(nx), ypos(ny), values(nx*ny);
+  gridXY(m, loc, xpos, ypos);
+  BoutReal zpos = 0.0;
+  
+  // Evaluate over the whole grid. Programs are shared, and not thread-safe
+  BOUT_OMP(critical(FieldProgram))
+  program(gen)->evaluate(xpos.begin(), nx, ypos.begin(), ny, &zpos, 1, t, values.begin());
+
+  for(int x=0;x<nx;x++)
+    for(int y=0;y<ny;y++)
+      result(x,y) = values[x*ny + y];
 
   // Don't delete the generator, as will be cached
 
@@ -177,45 +179,21 @@ const Field3D FieldFactory::create3D(const string &value, Options *opt, Mesh *m,
     throw BoutException("FieldFactory error: Couldn't create 3D field from '%s'", value.c_str());
   }
 
-  switch(loc)  {
-  case CELL_XLOW: {
-    for(auto i : result) {
-      BoutReal xpos = 0.5*(m->GlobalX(i.x-1) + m->GlobalX(i.x));
-      result[i] = gen->generate(xpos,
-                                TWOPI*m->GlobalY(i.y),
-                                TWOPI*((BoutReal) i.z) / ((BoutReal) (m->LocalNz)),  // Z
-                                t); // T
-    }
-    break;
+  int nx = m->LocalNx, ny = m->LocalNy, nz = m->LocalNz;
+  Array<BoutReal> xpos(nx), ypos(ny), zpos(nz);
+  gridXY(m, loc, xpos, ypos);
+  for(int z=0;z<nz;z++) {
+    if(loc == CELL_ZLOW) {
+      zpos[z] = TWOPI*(((BoutReal) z) - 0.5) / ((BoutReal) nz);
+    }else
+      zpos[z] = TWOPI*((BoutReal) z) / ((BoutReal) nz);
   }
-  case CELL_YLOW: {
-    for(auto i : result) {
-      BoutReal ypos = TWOPI*0.5*(m->GlobalY(i.y-1) + m->GlobalY(i.y));
-      result[i] = gen->generate(m->GlobalX(i.x),
-                                ypos,
-                                TWOPI*((BoutReal) i.z) / ((BoutReal) (m->LocalNz)),  // Z
-                                t); // T
-    }
-    break;
-  }
-  case CELL_ZLOW: {
-    for(auto i : result) {
-      result[i] = gen->generate(m->GlobalX(i.x),
-                                TWOPI*m->GlobalY(i.y),
-                                TWOPI*(((BoutReal) i.z) - 0.5) / ((BoutReal) (m->LocalNz)),  // Z
-                                t); // T
-    }
-    break;
-  }
-  default: {// CELL_CENTRE
-    for(auto i : result) {
-      result[i] = gen->generate(m->GlobalX(i.x),
-                                TWOPI*m->GlobalY(i.y),
-                                TWOPI*((BoutReal) i.z) / ((BoutReal) (m->LocalNz)),  // Z
-                                t); // T
-    }
-  }
-  };
+  
+  // Evaluate over the whole grid, straight into the field data.
+  // Programs are shared, and not thread-safe
+  BOUT_OMP(critical(FieldProgram))
+  program(gen)->evaluate(xpos.begin(), nx, ypos.begin(), ny, zpos.begin(), nz, t,
+                         &result(0,0,0));
 
   // Don't delete generator
   
@@ -374,3 +352,24 @@ FieldFactory* FieldFactory::get() {
 
   return &instance;
 }
+
+FieldProgram* FieldFactory::program(FieldGenerator *gen) {
+  auto it = programs.find(gen);
+  if(it != programs.end())
+    return it->second;
+
+  FieldProgram *prog = new FieldProgram(gen);
+  programs[gen] = prog;
+  return prog;
+}
+
+void FieldFactory::cleanCache() {
+  cache.clear();
+  
+  for(auto &it : programs)
+    delete it.second;
+  programs.clear();
+
+  // Cached generators are owned by the parser
+  freeGenerators();
+}
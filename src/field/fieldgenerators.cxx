@@ -18,6 +18,10 @@ BoutReal FieldSin::generate(double x, double y, double z, double t) {
   return sin(gen->generate(x,y,z,t));
 }
 
+int FieldSin::compile(FieldProgram &prog) {
+  return prog.unary(static_cast<FieldFunc1>(sin), prog.compile(gen));
+}
+
 FieldGenerator* FieldCos::clone(const list<FieldGenerator*> args) {
   if(args.size() != 1) {
     throw ParseException("Incorrect number of arguments to cos function. Expecting 1, got %d", args.size());
@@ -30,6 +34,10 @@ BoutReal FieldCos::generate(double x, double y, double z, double t) {
   return cos(gen->generate(x,y,z,t));
 }
 
+int FieldCos::compile(FieldProgram &prog) {
+  return prog.unary(static_cast<FieldFunc1>(cos), prog.compile(gen));
+}
+
 FieldGenerator* FieldSinh::clone(const list<FieldGenerator*> args) {
   if(args.size() != 1) {
     throw ParseException("Incorrect number of arguments to sinh function. Expecting 1, got %d", args.size());
@@ -42,6 +50,10 @@ BoutReal FieldSinh::generate(double x, double y, double z, double t) {
   return sinh(gen->generate(x,y,z,t));
 }
 
+int FieldSinh::compile(FieldProgram &prog) {
+  return prog.unary(static_cast<FieldFunc1>(sinh), prog.compile(gen));
+}
+
 FieldGenerator* FieldCosh::clone(const list<FieldGenerator*> args) {
   if(args.size() != 1) {
     throw ParseException("Incorrect number of arguments to cosh function. Expecting 1, got %d", args.size());
@@ -54,6 +66,10 @@ BoutReal FieldCosh::generate(double x, double y, double z, double t) {
   return cosh(gen->generate(x,y,z,t));
 }
 
+int FieldCosh::compile(FieldProgram &prog) {
+  return prog.unary(static_cast<FieldFunc1>(cosh), prog.compile(gen));
+}
+
 FieldGenerator* FieldTanh::clone(const list<FieldGenerator*> args) {
   if(args.size() != 1) {
     throw ParseException("Incorrect number of arguments to tanh function. Expecting 1, got ", args.size());
@@ -65,6 +81,10 @@ BoutReal FieldTanh::generate(double x, double y, double z, double t) {
   return tanh(gen->generate(x,y,z,t));
 }
 
+int FieldTanh::compile(FieldProgram &prog) {
+  return prog.unary(static_cast<FieldFunc1>(tanh), prog.compile(gen));
+}
+
 FieldGenerator* FieldGaussian::clone(const list<FieldGenerator*> args) {
   if((args.size() < 1) || (args.size() > 2)) {
     throw ParseException("Incorrect number of arguments to gaussian function. Expecting 1 or 2, got ", args.size());
@@ -85,6 +105,15 @@ BoutReal FieldGaussian::generate(double x, double y, double z, double t) {
   return exp(-SQ(X->generate(x,y,z,t)/sigma)/2.) / (sqrt(TWOPI) * sigma);
 }
 
+int FieldGaussian::compile(FieldProgram &prog) {
+  // exp(-(X/s)^2 / 2) / (sqrt(2pi) * s)
+  int sigma = prog.compile(s);
+  int xs = prog.binary('/', prog.compile(X), sigma);
+  int arg = prog.binary('*', prog.constant(-0.5), prog.binary('*', xs, xs));
+  return prog.binary('/', prog.unary(static_cast<FieldFunc1>(exp), arg),
+                     prog.binary('*', prog.constant(sqrt(TWOPI)), sigma));
+}
+
 FieldGenerator* FieldAbs::clone(const list<FieldGenerator*> args) {
   if(args.size() != 1) {
     throw ParseException("Incorrect number of arguments to abs function. Expecting 1, got %d", args.size());
@@ -97,6 +126,10 @@ BoutReal FieldAbs::generate(double x, double y, double z, double t) {
   return fabs(gen->generate(x,y,z,t));
 }
 
+int FieldAbs::compile(FieldProgram &prog) {
+  return prog.unary(static_cast<FieldFunc1>(fabs), prog.compile(gen));
+}
+
 FieldGenerator* FieldSqrt::clone(const list<FieldGenerator*> args) {
   if(args.size() != 1) {
     throw ParseException("Incorrect number of arguments to sqrt function. Expecting 1, got %d", args.size());
@@ -109,6 +142,10 @@ BoutReal FieldSqrt::generate(double x, double y, double z, double t) {
   return sqrt(gen->generate(x,y,z,t));
 }
 
+int FieldSqrt::compile(FieldProgram &prog) {
+  return prog.unary(static_cast<FieldFunc1>(sqrt), prog.compile(gen));
+}
+
 FieldGenerator* FieldHeaviside::clone(const list<FieldGenerator*> args) {
   if(args.size() != 1) {
     throw ParseException("Incorrect number of arguments to heaviside function. Expecting 1, got %d", args.size());
@@ -121,6 +158,14 @@ BoutReal FieldHeaviside::generate(double x, double y, double z, double t) {
   return (gen->generate(x,y,z,t) > 0.0) ? 1.0 : 0.0;
 }
 
+static BoutReal heaviside(BoutReal val) {
+  return (val > 0.0) ? 1.0 : 0.0;
+}
+
+int FieldHeaviside::compile(FieldProgram &prog) {
+  return prog.unary(heaviside, prog.compile(gen));
+}
+
 FieldGenerator* FieldErf::clone(const list<FieldGenerator*> args) {
   if(args.size() != 1) {
     throw ParseException("Incorrect number of arguments to erf function. Expecting 1, got %d", args.size());
@@ -133,6 +178,10 @@ BoutReal FieldErf::generate(double x, double y, double z, double t) {
   return erf(gen->generate(x,y,z,t));
 }
 
+int FieldErf::compile(FieldProgram &prog) {
+  return prog.unary(static_cast<FieldFunc1>(erf), prog.compile(gen));
+}
+
 //////////////////////////////////////////////////////////
 // Ballooning transform
 // Use a truncated Ballooning transform to enforce periodicity in y and z
@@ -8,6 +8,7 @@
 #define __FIELDGENERATORS_H__
 
 #include <field_factory.hxx>
+#include <bout/sys/fieldprogram.hxx>
 #include <boutexception.hxx>
 #include <unused.hxx>
 
@@ -39,6 +40,7 @@ public:
 
   FieldGenerator* clone(const list<FieldGenerator*> args);
   BoutReal generate(double x, double y, double z, double t);
+  int compile(FieldProgram &prog);
   const std::string str() {return std::string("sin(")+gen->str()+std::string(")");}
 private:
   FieldGenerator *gen;
@@ -51,6 +53,7 @@ public:
 
   FieldGenerator* clone(const list<FieldGenerator*> args);
   BoutReal generate(double x, double y, double z, double t);
+  int compile(FieldProgram &prog);
 
   const std::string str() {return std::string("cos(")+gen->str()+std::string(")");}
 private:
@@ -72,6 +75,9 @@ public:
   BoutReal generate(double x, double y, double z, double t) {
     return Op(gen->generate(x,y,z,t));
   }
+  int compile(FieldProgram &prog) {
+    return prog.unary(Op, prog.compile(gen));
+  }
   const std::string str() {return std::string("func(")+gen->str()+std::string(")");}
 private:
   FieldGenerator *gen;
@@ -92,6 +98,9 @@ public:
   BoutReal generate(double x, double y, double z, double t) {
     return Op(A->generate(x,y,z,t), B->generate(x,y,z,t));
   }
+  int compile(FieldProgram &prog) {
+    return prog.binary(Op, prog.compile(A), prog.compile(B));
+  }
   const std::string str() {return std::string("cos(")+A->str()+","+B->str()+std::string(")");}
 private:
   FieldGenerator *A, *B;
@@ -114,6 +123,11 @@ public:
       return atan(A->generate(x,y,z,t));
     return atan2(A->generate(x,y,z,t), B->generate(x,y,z,t));
   }
+  int compile(FieldProgram &prog) {
+    if(B == NULL)
+      return prog.unary(static_cast<FieldFunc1>(atan), prog.compile(A));
+    return prog.binary(static_cast<FieldFunc2>(atan2), prog.compile(A), prog.compile(B));
+  }
 private:
   FieldGenerator *A, *B;
 };
@@ -125,6 +139,7 @@ public:
 
   FieldGenerator* clone(const list<FieldGenerator*> args);
   BoutReal generate(double x, double y, double z, double t);
+  int compile(FieldProgram &prog);
 private:
   FieldGenerator *gen;
 };
@@ -136,6 +151,7 @@ public:
 
   FieldGenerator* clone(const list<FieldGenerator*> args);
   BoutReal generate(double x, double y, double z, double t);
+  int compile(FieldProgram &prog);
 private:
   FieldGenerator *gen;
 };
@@ -147,6 +163,7 @@ public:
 
   FieldGenerator* clone(const list<FieldGenerator*> args);
   BoutReal generate(double x, double y, double z, double t);
+  int compile(FieldProgram &prog);
 private:
   FieldGenerator *gen;
 };
@@ -158,6 +175,7 @@ public:
 
   FieldGenerator* clone(const list<FieldGenerator*> args);
   BoutReal generate(double x, double y, double z, double t);
+  int compile(FieldProgram &prog);
 private:
   FieldGenerator *X, *s;
 };
@@ -169,6 +187,7 @@ public:
 
   FieldGenerator* clone(const list<FieldGenerator*> args);
   BoutReal generate(double x, double y, double z, double t);
+  int compile(FieldProgram &prog);
 private:
   FieldGenerator *gen;
 };
@@ -180,6 +199,7 @@ public:
 
   FieldGenerator* clone(const list<FieldGenerator*> args);
   BoutReal generate(double x, double y, double z, double t);
+  int compile(FieldProgram &prog);
 private:
   FieldGenerator *gen;
 };
@@ -191,6 +211,7 @@ public:
 
   FieldGenerator* clone(const list<FieldGenerator*> args);
   BoutReal generate(double x, double y, double z, double t);
+  int compile(FieldProgram &prog);
   const std::string str() {return std::string("H(")+gen->str()+std::string(")");}
 private:
   FieldGenerator *gen;
@@ -203,6 +224,7 @@ public:
 
   FieldGenerator* clone(const list<FieldGenerator*> args);
   BoutReal generate(double x, double y, double z, double t);
+  int compile(FieldProgram &prog);
 private:
   FieldGenerator *gen;
 };
@@ -228,8 +250,16 @@ public:
     }
     return result;
   }
+  int compile(FieldProgram &prog) {
+    list<FieldGenerator*>::iterator it=input.begin();
+    int result = prog.compile(*it);
+    for(it++; it != input.end(); it++)
+      result = prog.binary(minimum, result, prog.compile(*it));
+    return result;
+  }
 private:
   list<FieldGenerator*> input;
+  static BoutReal minimum(BoutReal a, BoutReal b) { return (b < a) ? b : a; }
 };
 
 /// Maximum
@@ -253,8 +283,16 @@ public:
     }
     return result;
   }
+  int compile(FieldProgram &prog) {
+    list<FieldGenerator*>::iterator it=input.begin();
+    int result = prog.compile(*it);
+    for(it++; it != input.end(); it++)
+      result = prog.binary(maximum, result, prog.compile(*it));
+    return result;
+  }
 private:
   list<FieldGenerator*> input;
+  static BoutReal maximum(BoutReal a, BoutReal b) { return (b > a) ? b : a; }
 };
 
 /// Generator to round to the nearest integer
@@ -274,8 +312,17 @@ public:
     }
     return static_cast<int>(val - 0.5);
   }
+  int compile(FieldProgram &prog) {
+    return prog.unary(round, prog.compile(gen));
+  }
 private:
   FieldGenerator *gen;
+  static BoutReal round(BoutReal val) {
+    if(val > 0.0) {
+      return static_cast<int>(val + 0.5);
+    }
+    return static_cast<int>(val - 0.5);
+  }
 };
 
 //////////////////////////////////////////////////////////
@@ -42,8 +42,6 @@ void GlobalField::proc_local_origin(int proc, int *x, int *y, int *z) const {
 }
 
 void GlobalField::proc_origin(int proc, int *x, int *y, int *z) const {
-  // This is a hack, and should be improved with a better Mesh interface
-  
   // Get the number of processors in X and Y
   int nxpe = mesh->getNXPE();
   
@@ -51,13 +49,9 @@ void GlobalField::proc_origin(int proc, int *x, int *y, int *z) const {
   int pex = proc % nxpe;
   int pey = proc / nxpe;
   
-  // Get the size of the processor domain
-  int nx = mesh->xend - mesh->xstart + 1;
-  int ny = mesh->yend - mesh->ystart + 1;
-
-  // Set the origin values
-  *x = pex * nx;
-  *y = pey * ny;
+  // Set the origin values. Processor domains can have different sizes
+  *x = mesh->getXProcOffset(pex);
+  *y = mesh->getYProcOffset(pey);
   if(z != NULL)
     *z = 0;
 
@@ -67,15 +61,15 @@ void GlobalField::proc_origin(int proc, int *x, int *y, int *z) const {
 
 void GlobalField::proc_size(int proc, int *lx, int *ly, int *lz) const {
   // Get the size of the processor domain. 
-  // Assumes every processor has the same size domain
+  int nxpe = mesh->getNXPE();
+  int pex = proc % nxpe;
+  int pey = proc / nxpe;
   
-  *lx = mesh->xend - mesh->xstart + 1;
-  *ly = mesh->yend - mesh->ystart + 1;
+  *lx = mesh->getXProcOffset(pex+1) - mesh->getXProcOffset(pex);
+  *ly = mesh->getYProcOffset(pey+1) - mesh->getYProcOffset(pey);
   if(lz != NULL)
     *lz = mesh->LocalNz;
   
-  int nxpe = mesh->getNXPE();
-  int pex = proc % nxpe;
   if(pex == 0)
     *lx += mesh->xstart;
   if(pex == (nxpe-1))
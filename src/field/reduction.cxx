@@ -0,0 +1,291 @@
+/**************************************************************************
+ * Several global reductions over several fields, with one collective
+ *
+ **************************************************************************
+ * Copyright 2017 B.D.Dudson
+ *
+ * Contact: Ben Dudson, bd512@york.ac.uk
+ *
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+#include <bout/reduction.hxx>
+
+#include <globals.hxx>
+#include <bout/mesh.hxx>
+#include <bout/coordinates.hxx>
+#include <bout/openmpwrap.hxx>
+#include <boutexception.hxx>
+#include <msg_stack.hxx>
+#include <unused.hxx>
+
+#include <cmath>
+#include <limits>
+
+/*
+ * All values are combined in one buffer, which starts with the
+ * number of sums N. Elements 1..N are summed, and the remainder
+ * are maxima. Minima are stored as the maximum of -f.
+ *
+ * The buffer is sent as a single element of a contiguous datatype,
+ * so that MPI can't split it and each call sees the whole buffer
+ * including N.
+ */
+static void sumMaxReduce(void *invec, void *inoutvec, int *len, MPI_Datatype *type) {
+  int size;
+  MPI_Type_size(*type, &size);
+  int n = size / static_cast<int>(sizeof(BoutReal)); // Values in each element
+
+  for(int e=0;e<*len;e++) {
+    BoutReal *in = static_cast<BoutReal*>(invec) + e*n;
+    BoutReal *inout = static_cast<BoutReal*>(inoutvec) + e*n;
+
+    int nsum = static_cast<int>(in[0]);
+    for(int i=1;i<=nsum;i++)
+      inout[i] += in[i];
+    for(int i=nsum+1;i<n;i++)
+      if(in[i] > inout[i])
+        inout[i] = in[i];
+  }
+}
+
+static MPI_Op sum_max_op = MPI_OP_NULL;
+
+static MPI_Op sumMaxOp() {
+  if(sum_max_op == MPI_OP_NULL)
+    MPI_Op_create(sumMaxReduce, 1, &sum_max_op); // Commutative
+  return sum_max_op;
+}
+
+void FieldReduction::cleanup() {
+  if(sum_max_op != MPI_OP_NULL)
+    MPI_Op_free(&sum_max_op);
+}
+
+FieldReduction::FieldReduction(MPI_Comm comm) : comm(comm), buftype(MPI_DATATYPE_NULL),
+                                                 started(false), finished(false) {}
+
+FieldReduction::~FieldReduction() {
+  clear();
+}
+
+int FieldReduction::min(const Field3D &f) { return add(ReduceOp::min, f); }
+int FieldReduction::min(const Field2D &f) { return add(ReduceOp::min, f); }
+int FieldReduction::max(const Field3D &f) { return add(ReduceOp::max, f); }
+int FieldReduction::max(const Field2D &f) { return add(ReduceOp::max, f); }
+int FieldReduction::sum(const Field3D &f) { return add(ReduceOp::sum, f); }
+int FieldReduction::sum(const Field2D &f) { return add(ReduceOp::sum, f); }
+int FieldReduction::volumeIntegral(const Field3D &f) { return add(ReduceOp::volume, f); }
+int FieldReduction::volumeIntegral(const Field2D &f) { return add(ReduceOp::volume, f); }
+int FieldReduction::norm2(const Field3D &f) { return add(ReduceOp::norm2, f); }
+int FieldReduction::norm2(const Field2D &f) { return add(ReduceOp::norm2, f); }
+
+int FieldReduction::add(ReduceOp op, const Field3D &f) {
+  if(started)
+    throw BoutException("FieldReduction: Can't add a reduction after start()");
+  if(!f.isAllocated())
+    throw BoutException("FieldReduction: Reduction of empty Field3D");
+
+  items.push_back({op, new Field3D(f), nullptr, 0});
+  return size() - 1;
+}
+
+int FieldReduction::add(ReduceOp op, const Field2D &f) {
+  if(started)
+    throw BoutException("FieldReduction: Can't add a reduction after start()");
+  if(!f.isAllocated())
+    throw BoutException("FieldReduction: Reduction of empty Field2D");
+
+  items.push_back({op, nullptr, new Field2D(f), 0});
+  return size() - 1;
+}
+
+void FieldReduction::start() {
+  if(started)
+    return;
+  TRACE("FieldReduction::start");
+
+  int n = size();
+
+  // Sums go first in the buffer, then maxima
+  int nsum = 0;
+  for(const auto &it : items)
+    if((it.op != ReduceOp::min) && (it.op != ReduceOp::max))
+      nsum++;
+  int isum = 1, imax = nsum + 1;
+  for(auto &it : items)
+    it.slot = ((it.op == ReduceOp::min) || (it.op == ReduceOp::max)) ? imax++ : isum++;
+
+  sendbuf.assign(n + 1, 0.0);
+  sendbuf[0] = nsum;
+  for(int i=nsum+1;i<=n;i++)
+    sendbuf[i] = std::numeric_limits<BoutReal>::lowest();
+  recvbuf.resize(n + 1);
+
+  // Single pass over the domain, calculating all local values
+  Coordinates *coord = mesh->coordinates();
+  BoutReal zlength = coord->zlength();
+  int xs = mesh->xstart, ys = mesh->ystart;
+  int nx = mesh->xend - xs + 1, ny = mesh->yend - ys + 1;
+
+  BOUT_OMP(parallel)
+  {
+    std::vector<BoutReal> local(sendbuf); // Values for this thread
+
+    BOUT_OMP(for)
+    for(int j=0;j<nx*ny;j++) {
+      int x = xs + j / ny;
+      int y = ys + j % ny;
+      BoutReal dv = coord->J(x,y)*coord->dx(x,y)*coord->dy(x,y); // Volume / dz
+
+      for(const auto &it : items) {
+        BoutReal &val = local[it.slot];
+        if(it.f3d) {
+          const Field3D &f = *it.f3d;
+          const BoutReal *fz = f(x,y);
+          int nz = f.getNz();
+          switch(it.op) {
+          case ReduceOp::min: {
+            for(int z=0;z<nz;z++)
+              if(-fz[z] > val) val = -fz[z];
+            break;
+          }
+          case ReduceOp::max: {
+            for(int z=0;z<nz;z++)
+              if(fz[z] > val) val = fz[z];
+            break;
+          }
+          case ReduceOp::sum: {
+            for(int z=0;z<nz;z++)
+              val += fz[z];
+            break;
+          }
+          case ReduceOp::volume: {
+            BoutReal s = 0.0;
+            for(int z=0;z<nz;z++)
+              s += fz[z];
+            val += s * dv * coord->dz;
+            break;
+          }
+          case ReduceOp::norm2: {
+            for(int z=0;z<nz;z++)
+              val += fz[z]*fz[z];
+            break;
+          }
+          }
+        }else {
+          BoutReal fxy = (*it.f2d)(x,y);
+          switch(it.op) {
+          case ReduceOp::min: {
+            if(-fxy > val) val = -fxy;
+            break;
+          }
+          case ReduceOp::max: {
+            if(fxy > val) val = fxy;
+            break;
+          }
+          case ReduceOp::sum: {
+            val += fxy;
+            break;
+          }
+          case ReduceOp::volume: {
+            val += fxy * dv * zlength;
+            break;
+          }
+          case ReduceOp::norm2: {
+            val += fxy*fxy;
+            break;
+          }
+          }
+        }
+      }
+    }
+
+    // Combine values from each thread
+    BOUT_OMP(critical)
+    {
+      for(int i=1;i<=nsum;i++)
+        sendbuf[i] += local[i];
+      for(int i=nsum+1;i<=n;i++)
+        if(local[i] > sendbuf[i])
+          sendbuf[i] = local[i];
+    }
+  }
+
+  started = true;
+  finished = false;
+
+  MPI_Type_contiguous(n + 1, MPI_DOUBLE, &buftype);
+  MPI_Type_commit(&buftype);
+
+#if MPI_VERSION >= 3
+  MPI_Iallreduce(sendbuf.data(), recvbuf.data(), 1, buftype, sumMaxOp(), comm, &request);
+#else
+  MPI_Allreduce(sendbuf.data(), recvbuf.data(), 1, buftype, sumMaxOp(), comm);
+#endif
+}
+
+void FieldReduction::finish() {
+  if(finished)
+    return;
+  start();
+
+  TRACE("FieldReduction::finish");
+
+#if MPI_VERSION >= 3
+  MPI_Wait(&request, MPI_STATUS_IGNORE);
+#endif
+  MPI_Type_free(&buftype);
+
+  // Convert to final values
+  for(const auto &it : items) {
+    if(it.op == ReduceOp::min) {
+      recvbuf[it.slot] = -recvbuf[it.slot];
+    }else if(it.op == ReduceOp::norm2) {
+      recvbuf[it.slot] = sqrt(recvbuf[it.slot]);
+    }
+  }
+  finished = true;
+
+  // Release the fields, since their data is no longer needed
+  for(auto &it : items) {
+    delete it.f3d;
+    it.f3d = nullptr;
+    delete it.f2d;
+    it.f2d = nullptr;
+  }
+}
+
+BoutReal FieldReduction::operator[](int i) const {
+  if(!finished)
+    throw BoutException("FieldReduction: result requested before finish()");
+  if((i < 0) || (i >= size()))
+    throw BoutException("FieldReduction: index %d out of range (%d reductions)", i, size());
+  return recvbuf[items[i].slot];
+}
+
+void FieldReduction::clear() {
+  if(started && !finished)
+    finish(); // Must complete the communication
+
+  for(auto &it : items) {
+    delete it.f3d;
+    delete it.f2d;
+  }
+  items.clear();
+  started = finished = false;
+}
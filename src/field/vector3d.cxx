@@ -33,6 +33,8 @@
 #include <vector3d.hxx>
 #include <boundary_op.hxx>
 #include <boutexception.hxx>
+#include <bout/assert.hxx>
+#include <bout/openmpwrap.hxx>
 
 Vector3D::Vector3D() : covariant(true), deriv(NULL) { }
 
@@ -55,39 +57,76 @@ Vector3D::~Vector3D() {
   }
 }
 
+/*!
+ * Multiply the components (x,y,z) by a symmetric 3x3 matrix
+ * in a single pass over the mesh. Components are modified in place
+ * if their data is not shared, otherwise new arrays are used
+ */
+static void applyMetric(Field3D &x, Field3D &y, Field3D &z,
+                        const Field2D &m11, const Field2D &m12, const Field2D &m13,
+                        const Field2D &m22, const Field2D &m23, const Field2D &m33) {
+  ASSERT1(x.isAllocated() && y.isAllocated() && z.isAllocated());
+  
+  // Shared components need new arrays for the results. These are
+  // only assigned to the components once they have been written
+  Field3D xout, yout, zout;
+  Field3D *out[3] = {&x, &y, &z};
+  Field3D *tmp[3] = {&xout, &yout, &zout};
+  for(int i=0;i<3;i++) {
+    if(!out[i]->isUnique()) {
+      tmp[i]->allocate();
+      tmp[i]->setLocation(out[i]->getLocation());
+      out[i] = tmp[i];
+    }else
+      out[i]->allocate(); // Modified in place
+  }
+  
+  int ny = x.getNy(), nz = x.getNz();
+  
+  const BoutReal *px = &x(0,0,0), *py = &y(0,0,0), *pz = &z(0,0,0);
+  BoutReal *rx = &(*out[0])(0,0,0), *ry = &(*out[1])(0,0,0), *rz = &(*out[2])(0,0,0);
+  
+  BOUT_OMP(parallel for)
+  for(int j=0;j<x.getNx()*ny;j++) {
+    int jx = j / ny, jy = j % ny;
+    BoutReal g11 = m11(jx,jy), g12 = m12(jx,jy), g13 = m13(jx,jy);
+    BoutReal g22 = m22(jx,jy), g23 = m23(jx,jy), g33 = m33(jx,jy);
+    
+    BOUT_OMP_SIMD
+    for(int jz=j*nz;jz<(j+1)*nz;jz++) {
+      BoutReal vx = px[jz], vy = py[jz], vz = pz[jz];
+      rx[jz] = g11*vx + g12*vy + g13*vz;
+      ry[jz] = g12*vx + g22*vy + g23*vz;
+      rz[jz] = g13*vx + g23*vy + g33*vz;
+    }
+  }
+  
+  // Replace shared data with the results
+  if(out[0] != &x) x = xout;
+  if(out[1] != &y) y = yout;
+  if(out[2] != &z) z = zout;
+}
+
 void Vector3D::toCovariant() {  
   if(!covariant) {
-    Field3D gx, gy, gz;
-
     Coordinates *metric = mesh->coordinates();
     
     // multiply by g_{ij}
-    gx = x*metric->g_11 + metric->g_12*y + metric->g_13*z;
-    gy = y*metric->g_22 + metric->g_12*x + metric->g_23*z;
-    gz = z*metric->g_33 + metric->g_13*x + metric->g_23*y;
-
-    x = gx;
-    y = gy;
-    z = gz;
+    applyMetric(x, y, z,
+                metric->g_11, metric->g_12, metric->g_13,
+                metric->g_22, metric->g_23, metric->g_33);
     
     covariant = true;
   }
 }
 void Vector3D::toContravariant() {  
   if(covariant) {
-    // multiply by g^{ij}
-    
-    Field3D gx, gy, gz;
-
     Coordinates *metric = mesh->coordinates();
 
-    gx = x*metric->g11 + metric->g12*y + metric->g13*z;
-    gy = y*metric->g22 + metric->g12*x + metric->g23*z;
-    gz = z*metric->g33 + metric->g13*x + metric->g23*y;
-
-    x = gx;
-    y = gy;
-    z = gz;
+    // multiply by g^{ij}
+    applyMetric(x, y, z,
+                metric->g11, metric->g12, metric->g13,
+                metric->g22, metric->g23, metric->g33);
     
     covariant = false;
   }
@@ -37,14 +37,71 @@
 
 #include <globals.hxx>
 #include <bout/sys/timer.hxx>
+#include <bout/openmpwrap.hxx>
 #include <datafile.hxx>
 #include <boutexception.hxx>
 #include <output.hxx>
 #include <boutcomm.hxx>
+#include <msg_stack.hxx>
 #include <utils.hxx>
+#include <fft.hxx>
 #include "formatfactory.hxx"
 
-Datafile::Datafile(Options *opt) : parallel(false), flush(true), guards(true), floats(false), openclose(true), enabled(true), shiftOutput(false), file(NULL) {
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+/// Largest relative error of rounding a BoutReal to a float
+const BoutReal float_rel_error = std::ldexp(1.0, -24);
+
+/// Round \p value to a multiple of \p step, a power of two
+BoutReal roundAbsolute(BoutReal value, BoutReal step) {
+  if(!std::isfinite(value) || (std::abs(value) >= step * 4503599627370496.0)) // 2^52
+    return value; // Already exact to better than step
+  return std::round(value / step) * step;
+}
+
+/// Round \p value to \p bits bits of mantissa
+BoutReal roundRelative(BoutReal value, int bits) {
+  if(!std::isfinite(value))
+    return value;
+  uint64_t i;
+  std::memcpy(&i, &value, sizeof(i));
+  int drop = 52 - bits; // Mantissa bits to set to zero
+  i += UINT64_C(1) << (drop - 1); // Round half away from zero
+  i &= ~((UINT64_C(1) << drop) - 1);
+  std::memcpy(&value, &i, sizeof(i));
+  return value;
+}
+
+/// Round \p n values so each is within \p abs_error or
+/// \p rel_error times its magnitude, whichever is larger
+void roundValues(BoutReal *data, int n, BoutReal abs_error, BoutReal rel_error) {
+  // Largest power of two step, and smallest number of mantissa bits,
+  // with a rounding error within the bounds
+  BoutReal step = (abs_error > 0.0) ? std::ldexp(1.0, std::ilogb(2.0*abs_error)) : 0.0;
+  int bits = (rel_error > 0.0) ? std::max(0, -std::ilogb(rel_error) - 1) : 52;
+  if(bits >= 52) {
+    if(step == 0.0)
+      return; // Nothing to do
+    rel_error = 0.0; // Too small to remove any bits
+  }
+
+  BOUT_OMP(parallel for)
+  for(int i=0;i<n;i++) {
+    if((step > 0.0) && ((rel_error <= 0.0) || (std::abs(data[i]) * rel_error < abs_error))) {
+      data[i] = roundAbsolute(data[i], step);
+    }else {
+      data[i] = roundRelative(data[i], bits);
+    }
+  }
+}
+}
+
+
+Datafile::Datafile(Options *opt) : parallel(false), flush(true), flushfrequency(1), unflushed(0), guards(true), floats(false), compression(0), openclose(true), enabled(true), shiftOutput(false), options(opt), file(NULL) {
   filenamelen=FILENAMELEN;
   filename=new char[filenamelen];
   if(opt == NULL)
@@ -53,8 +110,14 @@ Datafile::Datafile(Options *opt) : parallel(false), flush(true), guards(true), f
   
   OPTION(opt, parallel, false); // By default no parallel formats for now
   OPTION(opt, flush, true);     // Safer. Disable explicitly if required
+  OPTION(opt, flushfrequency, 1); // Flush every N writes, if not openclose
+  if(flushfrequency < 1)
+    throw BoutException("Datafile: flushfrequency must be at least 1 (got %d)", flushfrequency);
   OPTION(opt, guards, true);    // Compatible with old behavior
   OPTION(opt, floats, false); // High precision by default
+  OPTION(opt, compression, 0); // No compression by default
+  if((compression < 0) || (compression > 9))
+    throw BoutException("Datafile: compression must be between 0 and 9 (got %d)", compression);
   OPTION(opt, openclose, true); // Open and close every write or read
   OPTION(opt, enabled, true);
   OPTION(opt, init_missing, false); // Initialise missing variables?
@@ -62,9 +125,10 @@ Datafile::Datafile(Options *opt) : parallel(false), flush(true), guards(true), f
 }
 
 Datafile::Datafile(const Datafile &other) :
-  parallel(other.parallel), flush(other.flush), guards(other.guards), 
-  floats(other.floats), openclose(other.openclose), Lx(other.Lx), Ly(other.Ly), Lz(other.Lz), 
-  enabled(other.enabled), shiftOutput(other.shiftOutput), file(NULL), int_arr(other.int_arr), 
+  parallel(other.parallel), flush(other.flush), flushfrequency(other.flushfrequency),
+  unflushed(0), guards(other.guards), 
+  floats(other.floats), compression(other.compression), openclose(other.openclose), Lx(other.Lx), Ly(other.Ly), Lz(other.Lz), 
+  enabled(other.enabled), shiftOutput(other.shiftOutput), options(other.options), file(NULL), int_arr(other.int_arr), 
   BoutReal_arr(other.BoutReal_arr), f2d_arr(other.f2d_arr), 
   f3d_arr(other.f3d_arr), v2d_arr(other.v2d_arr), v3d_arr(other.v3d_arr) {
   filenamelen=FILENAMELEN;
@@ -75,12 +139,16 @@ Datafile::Datafile(const Datafile &other) :
 Datafile& Datafile::operator=(const Datafile &rhs) {
   parallel     = rhs.parallel;
   flush        = rhs.flush;
+  flushfrequency = rhs.flushfrequency;
+  unflushed    = 0;
   guards       = rhs.guards;
   floats     = rhs.floats;
+  compression  = rhs.compression;
   openclose    = rhs.openclose;
   enabled      = rhs.enabled;
   init_missing = rhs.init_missing;
   shiftOutput  = rhs.shiftOutput;
+  options      = rhs.options;
   file         = NULL; // All values copied except this
   int_arr      = rhs.int_arr;
   BoutReal_arr = rhs.BoutReal_arr;
@@ -142,6 +210,9 @@ bool Datafile::openw(const char *format, ...) {
   
   if(!file)
     throw BoutException("Datafile::open: Factory failed to create a DataFormat!");
+
+  if((compression > 0) && !file->setCompression(compression))
+    output.write("\tWARNING: Compression is not supported for '%s', so is ignored\n", filename);
   
   // If parallel do not want to write ghost points, and it is easier then to ignore the boundary guard cells as well
   if (parallel) {
@@ -184,6 +255,9 @@ bool Datafile::opena(const char *format, ...) {
   if(!file)
     throw BoutException("Datafile::open: Factory failed to create a DataFormat!");
 
+  if((compression > 0) && !file->setCompression(compression))
+    output.write("\tWARNING: Compression is not supported for '%s', so is ignored\n", filename);
+
   // If parallel do not want to write ghost points, and it is easier then to ignore the boundary guard cells as well
   if (parallel) {
     file->setLocalOrigin(0, 0, 0, mesh->xstart, mesh->ystart, 0);
@@ -223,7 +297,8 @@ void Datafile::close() {
   if(!file)
     return;
   if(!openclose)
-    file->close();
+    file->close(); // Also flushes any records not yet flushed
+  unflushed = 0;
   delete file;
   file = NULL;
 }
@@ -233,6 +308,12 @@ void Datafile::setLowPrecision() {
     return;
   floats = true;
   file->setLowPrecision();
+
+  // Error bounds set earlier may now be too small
+  for(const auto &var : f2d_arr)
+    checkSpec(var.name, var.spec, 0);
+  for(const auto &var : f3d_arr)
+    checkSpec(var.name, var.spec, mesh->LocalNz);
 }
 
 void Datafile::add(int &i, const char *name, bool save_repeat) {
@@ -270,6 +351,10 @@ void Datafile::add(Field2D &f, const char *name, bool save_repeat) {
   d.ptr = &f;
   d.name = string(name);
   d.save_repeat = save_repeat;
+  if(options) {
+    d.spec = OutputSpec(options->getSection(name));
+    checkSpec(d.name, d.spec, 0);
+  }
   
   f2d_arr.push_back(d);
 }
@@ -283,6 +368,10 @@ void Datafile::add(Field3D &f, const char *name, bool save_repeat) {
   d.ptr = &f;
   d.name = string(name);
   d.save_repeat = save_repeat;
+  if(options) {
+    d.spec = OutputSpec(options->getSection(name));
+    checkSpec(d.name, d.spec, mesh->LocalNz);
+  }
   
   f3d_arr.push_back(d);
 }
@@ -315,6 +404,24 @@ void Datafile::add(Vector3D &f, const char *name, bool save_repeat) {
   v3d_arr.push_back(d);
 }
 
+void Datafile::setOutput(const char *name, const OutputSpec &spec) {
+  for(auto& var : f2d_arr) {
+    if(var.name == name) {
+      checkSpec(var.name, spec, 0);
+      var.spec = spec;
+      return;
+    }
+  }
+  for(auto& var : f3d_arr) {
+    if(var.name == name) {
+      checkSpec(var.name, spec, mesh->LocalNz);
+      var.spec = spec;
+      return;
+    }
+  }
+  throw BoutException("Datafile::setOutput: No Field2D or Field3D '%s' added", name);
+}
+
 bool Datafile::read() {
   Timer timer("io");  ///< Start timer. Stops when goes out of scope
 
@@ -331,51 +438,7 @@ bool Datafile::read() {
 
   file->setRecord(-1); // Read the latest record
 
-  // Read integers
-  for(const auto& var : int_arr) {
-    if(var.save_repeat) {
-      if(!file->read_rec(var.ptr, var.name.c_str())) {
-        if(!init_missing) {
-          throw BoutException("Missing data for %s in input. Set init_missing=true to set to zero.", var.name.c_str());
-        }
-        output.write("\tWARNING: Could not read integer %s. Setting to zero\n", var.name.c_str());
-        *(var.ptr) = 0;
-        continue;
-      }
-    } else {
-      if(!file->read(var.ptr, var.name.c_str())) {
-        if(!init_missing) {
-          throw BoutException("Missing data for %s in input. Set init_missing=true to set to zero.", var.name.c_str());
-        }
-        output.write("\tWARNING: Could not read integer %s. Setting to zero\n", var.name.c_str());
-        *(var.ptr) = 0;
-        continue;
-      }
-    }
-  }
-
-  // Read BoutReals
-  for(const auto& var : BoutReal_arr) {
-    if(var.save_repeat) {
-      if(!file->read_rec(var.ptr, var.name)) {
-        if(!init_missing) {
-          throw BoutException("Missing data for %s in input. Set init_missing=true to set to zero.", var.name.c_str());
-        }
-        output.write("\tWARNING: Could not read BoutReal %s. Setting to zero\n", var.name.c_str());
-        *(var.ptr) = 0;
-        continue;
-      }
-    } else {
-      if(!file->read(var.ptr, var.name)) {
-        if(!init_missing) {
-          throw BoutException("Missing data for %s in input. Set init_missing=true to set to zero.", var.name.c_str());
-        }
-        output.write("\tWARNING: Could not read BoutReal %s. Setting to zero\n", var.name.c_str());
-        *(var.ptr) = 0;
-        continue;
-      }
-    }
-  }
+  readScalars(file);
   
   // Read 2D fields
   for(const auto& var : f2d_arr) {
@@ -427,6 +490,189 @@ bool Datafile::read() {
   return true;
 }
 
+bool Datafile::readFromProc0(const char *name, int &value) {
+  MPI_Comm comm = BoutComm::get();
+  int MYPE;
+  MPI_Comm_rank(comm, &MYPE);
+
+  int buffer[2] = {0, 0}; // Found, value
+  if(MYPE == 0) {
+    DataFormat *df;
+    if(parallel) {
+      // Only one file
+      df = FormatFactory::getInstance()->createDataFormat(filename, false);
+      if(!df->openr(filename)) {
+        delete df;
+        throw BoutException("Datafile: Could not open file '%s'", filename);
+      }
+    }else {
+      df = openProc(0);
+    }
+    if(df->read(&buffer[1], name))
+      buffer[0] = 1;
+    df->close();
+    delete df;
+  }
+  MPI_Bcast(buffer, 2, MPI_INT, 0, comm);
+
+  if(buffer[0] == 0)
+    return false;
+  value = buffer[1];
+  return true;
+}
+
+bool Datafile::readRedistributed(int npes, int nxpe) {
+  TRACE("Datafile::readRedistributed");
+  Timer timer("io");
+
+  if(parallel) {
+    // A shared file can be read by any number of processors
+    return read();
+  }
+
+  if((nxpe < 1) || (npes % nxpe != 0))
+    throw BoutException("Datafile: Invalid number of processors %d (%d in X)", npes, nxpe);
+  int nype = npes / nxpe;
+
+  MPI_Comm comm = BoutComm::get();
+  int MYPE;
+  MPI_Comm_rank(comm, &MYPE);
+
+  int MXG = mesh->xstart, MYG = mesh->ystart;
+
+  vector< VarStr<Field2D> > fields2d;
+  vector< VarStr<Field3D> > fields3d;
+  fieldList(fields2d, fields3d);
+
+  // Sizes of the domains in the files, including guard cells. The
+  // domains are a tensor product, so only the files along the X and Y
+  // edges are needed. Processor 0 reads them, then sends to the others
+  vector<int> xsize(nxpe, 0), ysize(nype, 0);
+  if(MYPE == 0) {
+    string probe; // A field to get the size of
+    bool probe_repeat = false;
+    if(!fields3d.empty()) {
+      probe = fields3d[0].name;
+      probe_repeat = fields3d[0].save_repeat;
+    }else if(!fields2d.empty()) {
+      probe = fields2d[0].name;
+      probe_repeat = fields2d[0].save_repeat;
+    }
+
+    if(!probe.empty()) {
+      for(int px=0;px<nxpe;px++)
+        xsize[px] = procSize(px, probe, probe_repeat)[0];
+      for(int py=0;py<nype;py++)
+        ysize[py] = procSize(py*nxpe, probe, probe_repeat)[1];
+    }
+  }
+  MPI_Bcast(xsize.data(), nxpe, MPI_INT, 0, comm);
+  MPI_Bcast(ysize.data(), nype, MPI_INT, 0, comm);
+
+  if(xsize[0] == 0) {
+    // No fields, so sizes don't matter. Assume uniform
+    for(auto &n : xsize)
+      n = (mesh->GlobalNx - 2*MXG)/nxpe + 2*MXG;
+    for(auto &n : ysize)
+      n = (mesh->GlobalNy - 2*MYG)/nype + 2*MYG;
+  }
+
+  // Global index of the first point in each file
+  vector<int> xoffset(nxpe + 1, 0), yoffset(nype + 1, 0);
+  for(int i=0;i<nxpe;i++)
+    xoffset[i+1] = xoffset[i] + xsize[i] - 2*MXG;
+  for(int i=0;i<nype;i++)
+    yoffset[i+1] = yoffset[i] + ysize[i] - 2*MYG;
+
+  if((xoffset[nxpe] + 2*MXG != mesh->GlobalNx) || (yoffset[nype] + 2*MYG != mesh->GlobalNy))
+    throw BoutException("Datafile: Input is for a %d x %d grid, but the mesh is %d x %d",
+                        xoffset[nxpe] + 2*MXG, yoffset[nype] + 2*MYG,
+                        mesh->GlobalNx, mesh->GlobalNy);
+
+  for(auto &var : fields2d)
+    var.ptr->allocate();
+  for(auto &var : fields3d)
+    var.ptr->allocate();
+
+  // Global indices needed on this processor, including guard cells
+  int gx0 = mesh->OffsetX, gx1 = gx0 + mesh->LocalNx;
+  int gy0 = mesh->OffsetY, gy1 = gy0 + mesh->LocalNy;
+  int nz = mesh->LocalNz;
+
+  bool scalars_read = false;
+  vector<BoutReal> buffer;
+  for(int py=0;py<nype;py++)
+    for(int px=0;px<nxpe;px++) {
+      // Points belonging to file (px,py): the interior, and the
+      // boundary cells at the edges of the grid. Guard cells between
+      // processors are taken from the neighbouring file's interior
+      int x0 = (px == 0) ? 0 : xoffset[px] + MXG;
+      int x1 = (px == nxpe-1) ? mesh->GlobalNx : xoffset[px+1] + MXG;
+      int y0 = (py == 0) ? 0 : yoffset[py] + MYG;
+      int y1 = (py == nype-1) ? mesh->GlobalNy : yoffset[py+1] + MYG;
+
+      // Overlap with this processor
+      x0 = std::max(x0, gx0); x1 = std::min(x1, gx1);
+      y0 = std::max(y0, gy0); y1 = std::min(y1, gy1);
+      if((x0 >= x1) || (y0 >= y1))
+        continue;
+      int nx = x1 - x0, ny = y1 - y0;
+
+      DataFormat *df = openProc(py*nxpe + px);
+
+      if(!scalars_read) {
+        // Scalars are the same in every file
+        readScalars(df);
+        scalars_read = true;
+      }
+
+      // Read only the overlapping part
+      df->setGlobalOrigin(x0 - xoffset[px], y0 - yoffset[py], 0);
+
+      for(const auto &var : fields2d) {
+        buffer.resize(nx*ny);
+        bool ok = var.save_repeat ? df->read_rec(buffer.data(), var.name, nx, ny)
+                                  : df->read(buffer.data(), var.name, nx, ny);
+        if(!ok) {
+          if(!init_missing)
+            throw BoutException("Missing 2D field %s in input. Set init_missing=true to set to zero.", var.name.c_str());
+          output.write("\tWARNING: Could not read 2D field %s. Setting to zero\n", var.name.c_str());
+          // Only the part from this file, which may be read from others
+          std::fill(buffer.begin(), buffer.end(), 0.0);
+        }
+        for(int x=0;x<nx;x++)
+          for(int y=0;y<ny;y++)
+            (*var.ptr)(x0 - gx0 + x, y0 - gy0 + y) = buffer[x*ny + y];
+      }
+
+      for(const auto &var : fields3d) {
+        buffer.resize(nx*ny*nz);
+        bool ok = var.save_repeat ? df->read_rec(buffer.data(), var.name, nx, ny, nz)
+                                  : df->read(buffer.data(), var.name, nx, ny, nz);
+        if(!ok) {
+          if(!init_missing)
+            throw BoutException("Missing 3D field %s in input. Set init_missing=true to set to zero.", var.name.c_str());
+          output.write("\tWARNING: Could not read 3D field %s. Setting to zero\n", var.name.c_str());
+          std::fill(buffer.begin(), buffer.end(), 0.0);
+        }
+        for(int x=0;x<nx;x++)
+          for(int y=0;y<ny;y++)
+            std::copy(&buffer[(x*ny + y)*nz], &buffer[(x*ny + y)*nz] + nz,
+                      &(*var.ptr)(x0 - gx0 + x, y0 - gy0 + y, 0));
+      }
+
+      df->close();
+      delete df;
+    }
+
+  for(const auto& var : v2d_arr)
+    var.ptr->covariant = var.covar;
+  for(const auto& var : v3d_arr)
+    var.ptr->covariant = var.covar;
+
+  return true;
+}
+
 bool Datafile::write() {
   if(!enabled)
     return true; // Just pretend it worked
@@ -446,8 +692,8 @@ bool Datafile::write() {
   if(!file->is_valid())
     throw BoutException("Datafile::open: File is not valid!");
 
-  if(floats)
-    file->setLowPrecision();
+  file->setLowPrecision(floats);
+  file->setCompression(compression);
   
   Timer timer("io");
   
@@ -465,13 +711,16 @@ bool Datafile::write() {
 
   // Write 2D fields
   for(const auto& var : f2d_arr) {
-    write_f2d(var.name, var.ptr, var.save_repeat);
+    file->setLowPrecision(floats || var.spec.floats);
+    write_f2d(var.name, var.ptr, var.save_repeat, var.spec);
   }
 
   // Write 3D fields
   for(const auto& var : f3d_arr) {
-    write_f3d(var.name, var.ptr, var.save_repeat);
+    file->setLowPrecision(floats || var.spec.floats);
+    write_f3d(var.name, var.ptr, var.save_repeat, var.spec);
   }
+  file->setLowPrecision(floats);
   
   // 2D vectors
   for(const auto& var : v2d_arr) {
@@ -515,8 +764,17 @@ bool Datafile::write() {
     }
   }
   
-  if(openclose)
+  if(openclose) {
     file->close();
+  }else if(flush) {
+    // Flush once all variables in the record have been written,
+    // so that the file on disk always ends with a complete record
+    unflushed++;
+    if(unflushed >= flushfrequency) {
+      file->flush();
+      unflushed = 0;
+    }
+  }
 
   return true;
 }
@@ -560,8 +818,115 @@ bool Datafile::writeVar(BoutReal r, const char *name) {
 
 /////////////////////////////////////////////////////////////
 
+void Datafile::readScalars(DataFormat *df) {
+  // Read integers
+  for(const auto& var : int_arr) {
+    if(var.save_repeat) {
+      if(!df->read_rec(var.ptr, var.name.c_str())) {
+        if(!init_missing) {
+          throw BoutException("Missing data for %s in input. Set init_missing=true to set to zero.", var.name.c_str());
+        }
+        output.write("\tWARNING: Could not read integer %s. Setting to zero\n", var.name.c_str());
+        *(var.ptr) = 0;
+        continue;
+      }
+    } else {
+      if(!df->read(var.ptr, var.name.c_str())) {
+        if(!init_missing) {
+          throw BoutException("Missing data for %s in input. Set init_missing=true to set to zero.", var.name.c_str());
+        }
+        output.write("\tWARNING: Could not read integer %s. Setting to zero\n", var.name.c_str());
+        *(var.ptr) = 0;
+        continue;
+      }
+    }
+  }
+
+  // Read BoutReals
+  for(const auto& var : BoutReal_arr) {
+    if(var.save_repeat) {
+      if(!df->read_rec(var.ptr, var.name)) {
+        if(!init_missing) {
+          throw BoutException("Missing data for %s in input. Set init_missing=true to set to zero.", var.name.c_str());
+        }
+        output.write("\tWARNING: Could not read BoutReal %s. Setting to zero\n", var.name.c_str());
+        *(var.ptr) = 0;
+        continue;
+      }
+    } else {
+      if(!df->read(var.ptr, var.name)) {
+        if(!init_missing) {
+          throw BoutException("Missing data for %s in input. Set init_missing=true to set to zero.", var.name.c_str());
+        }
+        output.write("\tWARNING: Could not read BoutReal %s. Setting to zero\n", var.name.c_str());
+        *(var.ptr) = 0;
+        continue;
+      }
+    }
+  }
+}
+
+void Datafile::checkSize(const string &name, bool save_repeat) {
+  if(parallel)
+    return; // Shared file for the whole grid
+
+  vector<int> size = file->getSize(name);
+  unsigned int ix = save_repeat ? 1 : 0; // Skip time dimension
+  if(size.size() < ix + 2)
+    return; // Missing, or not a field
+
+  if((size[ix] != mesh->LocalNx) || (size[ix+1] != mesh->LocalNy))
+    throw BoutException("Field %s in input is %d x %d, but the mesh is %d x %d",
+                        name.c_str(), size[ix], size[ix+1], mesh->LocalNx, mesh->LocalNy);
+}
+
+void Datafile::fieldList(vector< VarStr<Field2D> > &fields2d, vector< VarStr<Field3D> > &fields3d) {
+  fields2d = f2d_arr;
+  fields3d = f3d_arr;
+
+  // Vector components, named as in read() and write()
+  for(const auto& var : v2d_arr) {
+    string sep = var.covar ? string("_") : string("");
+    fields2d.push_back({&(var.ptr->x), var.name + sep + "x", var.save_repeat, false, OutputSpec()});
+    fields2d.push_back({&(var.ptr->y), var.name + sep + "y", var.save_repeat, false, OutputSpec()});
+    fields2d.push_back({&(var.ptr->z), var.name + sep + "z", var.save_repeat, false, OutputSpec()});
+  }
+  for(const auto& var : v3d_arr) {
+    string sep = var.covar ? string("_") : string("");
+    fields3d.push_back({&(var.ptr->x), var.name + sep + "x", var.save_repeat, false, OutputSpec()});
+    fields3d.push_back({&(var.ptr->y), var.name + sep + "y", var.save_repeat, false, OutputSpec()});
+    fields3d.push_back({&(var.ptr->z), var.name + sep + "z", var.save_repeat, false, OutputSpec()});
+  }
+}
+
+vector<int> Datafile::procSize(int proc, const string &name, bool save_repeat) {
+  DataFormat *df = openProc(proc);
+  vector<int> size = df->getSize(name);
+  df->close();
+  delete df;
+
+  unsigned int ix = save_repeat ? 1 : 0; // Skip time dimension
+  if(size.size() < ix + 2)
+    throw BoutException("Datafile: Could not get size of %s for processor %d", name.c_str(), proc);
+  return vector<int>(size.begin() + ix, size.end());
+}
+
+DataFormat* Datafile::openProc(int proc) {
+  DataFormat *df = FormatFactory::getInstance()->createDataFormat(filename, false);
+  if(!df)
+    throw BoutException("Datafile: Factory failed to create a DataFormat!");
+  if(!df->openr(filename, proc)) {
+    delete df;
+    throw BoutException("Datafile: Could not open file for processor %d of '%s'", proc, filename);
+  }
+  df->setGlobalOrigin(0, 0, 0);
+  df->setRecord(-1);
+  return df;
+}
+
 bool Datafile::read_f2d(const string &name, Field2D *f, bool save_repeat) {
   f->allocate();
+  checkSize(name, save_repeat);
   
   if(save_repeat) {
     if(!file->read_rec(&((*f)(0,0)), name, mesh->LocalNx, mesh->LocalNy)) {
@@ -589,6 +954,7 @@ bool Datafile::read_f2d(const string &name, Field2D *f, bool save_repeat) {
 
 bool Datafile::read_f3d(const string &name, Field3D *f, bool save_repeat) {
   f->allocate();
+  checkSize(name, save_repeat);
   
   if(save_repeat) {
     if(!file->read_rec(&((*f)(0,0,0)), name, mesh->LocalNx, mesh->LocalNy, mesh->LocalNz)) {
@@ -630,9 +996,19 @@ bool Datafile::write_real(const string &name, BoutReal *f, bool save_repeat) {
   }
 }
 
-bool Datafile::write_f2d(const string &name, Field2D *f, bool save_repeat) {
+bool Datafile::write_f2d(const string &name, Field2D *f, bool save_repeat,
+                         const OutputSpec &spec) {
   if(!f->isAllocated())
     throw BoutException("Datafile::write_f2d: Field2D is not allocated!");
+
+  if(!spec.wholeField())
+    return writeReduced(name, &((*f)(0,0)), 0, save_repeat, spec);
+
+  if(spec.lossy()) {
+    if(!writeRounded(name, &((*f)(0,0)), save_repeat, spec, mesh->LocalNx, mesh->LocalNy, 0))
+      throw BoutException("Datafile::write_f2d: Failed to write %s!",name.c_str());
+    return true;
+  }
   
   if(save_repeat) {
     if (!file->write_rec(&((*f)(0,0)), name, mesh->LocalNx, mesh->LocalNy))
@@ -644,7 +1020,8 @@ bool Datafile::write_f2d(const string &name, Field2D *f, bool save_repeat) {
   return true;
 }
 
-bool Datafile::write_f3d(const string &name, Field3D *f, bool save_repeat) {
+bool Datafile::write_f3d(const string &name, Field3D *f, bool save_repeat,
+                         const OutputSpec &spec) {
   if(!f->isAllocated()) {
     throw BoutException("Datafile::write_f3d: Field3D is not allocated!");
   }
@@ -657,6 +1034,13 @@ bool Datafile::write_f3d(const string &name, Field3D *f, bool save_repeat) {
     f_out = *f;
   }
 
+  if(!spec.wholeField())
+    return writeReduced(name, &(f_out(0,0,0)), mesh->LocalNz, save_repeat, spec);
+
+  if(spec.lossy())
+    return writeRounded(name, &(f_out(0,0,0)), save_repeat, spec,
+                        mesh->LocalNx, mesh->LocalNy, mesh->LocalNz);
+
   if(save_repeat) {
     return file->write_rec(&(f_out(0,0,0)), name, mesh->LocalNx, mesh->LocalNy, mesh->LocalNz);
   }else {
@@ -664,6 +1048,107 @@ bool Datafile::write_f3d(const string &name, Field3D *f, bool save_repeat) {
   }
 }
 
+bool Datafile::writeReduced(const string &name, const BoutReal *data, int nz, bool save_repeat,
+                            const OutputSpec &spec) {
+  if(parallel)
+    throw BoutException("Datafile: Can't write part of %s to a parallel file", name.c_str());
+
+  // Points in this processor's file: the interior, and the
+  // boundary cells at the edge of the grid
+  int gx0 = mesh->OffsetX + ((mesh->OffsetX == 0) ? 0 : mesh->xstart);
+  int gx1 = mesh->OffsetX + ((mesh->OffsetX + mesh->LocalNx == mesh->GlobalNx) ? mesh->LocalNx - 1 : mesh->xend);
+  int gy0 = mesh->OffsetY + ((mesh->OffsetY == 0) ? 0 : mesh->ystart);
+  int gy1 = mesh->OffsetY + ((mesh->OffsetY + mesh->LocalNy == mesh->GlobalNy) ? mesh->LocalNy - 1 : mesh->yend);
+
+  // First selected point in [g0, g1], and number of points
+  auto select = [](int g0, int g1, int min, int max, int stride, int &first) {
+    first = min + ((std::max(g0, min) - min + stride - 1) / stride) * stride;
+    int last = (max < 0) ? g1 : std::min(g1, max);
+    return (last < first) ? 0 : (last - first) / stride + 1;
+  };
+  int xfirst, yfirst;
+  int nx = select(gx0, gx1, spec.xmin, spec.xmax, spec.xstride, xfirst);
+  int ny = select(gy0, gy1, spec.ymin, spec.ymax, spec.ystride, yfirst);
+  if((nx == 0) || (ny == 0))
+    return true; // Nothing on this processor
+
+  int nzout = (spec.zmodes > 0) ? 2*spec.zmodes : nz;
+  vector<BoutReal> buffer(nx * ny * std::max(nzout, 1));
+  vector<dcomplex> fz((nz > 0) ? nz/2 + 1 : 0);
+
+  for(int i=0;i<nx;i++) {
+    int x = xfirst + i*spec.xstride - mesh->OffsetX;
+    for(int j=0;j<ny;j++) {
+      int y = yfirst + j*spec.ystride - mesh->OffsetY;
+      if(nz == 0) {
+        buffer[i*ny + j] = data[x*mesh->LocalNy + y];
+        continue;
+      }
+      const BoutReal *in = data + (x*mesh->LocalNy + y)*nz;
+      BoutReal *out = &buffer[(i*ny + j)*nzout];
+      if(spec.zmodes > 0) {
+        // Keep the lowest modes, and transform back onto fewer points
+        rfft(in, nz, fz.data());
+        fz[spec.zmodes] = 0.0;
+        irfft(fz.data(), nzout, out);
+      }else {
+        std::copy(in, in + nz, out);
+      }
+    }
+  }
+
+  // Global indices of the first point, and the strides
+  int region[4] = {xfirst, spec.xstride, yfirst, spec.ystride};
+  if(!file->write(region, name + "_region", 4))
+    throw BoutException("Datafile: Failed to write %s_region", name.c_str());
+
+  if(spec.lossy())
+    roundValues(buffer.data(), buffer.size(), spec.abs_error, relError(spec));
+
+  if(save_repeat) {
+    return file->write_rec(buffer.data(), name, nx, ny, (nz > 0) ? nzout : 0);
+  }else {
+    return file->write(buffer.data(), name, nx, ny, (nz > 0) ? nzout : 0);
+  }
+}
+
+bool Datafile::writeRounded(const string &name, const BoutReal *data, bool save_repeat,
+                            const OutputSpec &spec, int lx, int ly, int lz) {
+  vector<BoutReal> buffer(data, data + lx*ly*std::max(lz, 1));
+  roundValues(buffer.data(), buffer.size(), spec.abs_error, relError(spec));
+
+  if(save_repeat) {
+    return file->write_rec(buffer.data(), name, lx, ly, lz);
+  }else {
+    return file->write(buffer.data(), name, lx, ly, lz);
+  }
+}
+
+void Datafile::checkSpec(const string &name, const OutputSpec &spec, int nz) {
+  if((spec.xstride < 1) || (spec.ystride < 1))
+    throw BoutException("Datafile: Output strides for %s must be at least 1", name.c_str());
+  if((spec.xmin < 0) || (spec.xmax >= mesh->GlobalNx) || ((spec.xmax >= 0) && (spec.xmax < spec.xmin)))
+    throw BoutException("Datafile: Invalid output X range %d to %d for %s", spec.xmin, spec.xmax, name.c_str());
+  if((spec.ymin < 0) || (spec.ymax >= mesh->GlobalNy) || ((spec.ymax >= 0) && (spec.ymax < spec.ymin)))
+    throw BoutException("Datafile: Invalid output Y range %d to %d for %s", spec.ymin, spec.ymax, name.c_str());
+  if((spec.zmodes < 0) || (2*spec.zmodes > nz))
+    throw BoutException("Datafile: Can't keep %d Z modes of %s with %d points", spec.zmodes, name.c_str(), nz);
+  if((spec.abs_error < 0.0) || (spec.rel_error < 0.0) || (spec.rel_error >= 1.0))
+    throw BoutException("Datafile: Invalid error bounds %e, %e for %s", spec.abs_error, spec.rel_error, name.c_str());
+  if((floats || spec.floats) && (spec.rel_error > 0.0) && (spec.rel_error < float_rel_error)) {
+    // Values rounded to these bounds are exactly representable as
+    // floats, but converting to float would otherwise add its own error
+    throw BoutException("Datafile: %s is written as floats, which have a relative error of up to %e."
+                        " Set rel_error to at least this", name.c_str(), float_rel_error);
+  }
+}
+
+BoutReal Datafile::relError(const OutputSpec &spec) const {
+  if((floats || spec.floats) && (spec.rel_error < float_rel_error))
+    return float_rel_error; // Only abs_error set
+  return spec.rel_error;
+}
+
 bool Datafile::varAdded(const string &name) {
   for(const auto& var : int_arr ) {
     if(name == var.name)
@@ -696,3 +1181,24 @@ bool Datafile::varAdded(const string &name) {
   }
   return false;
 }
+
+/////////////////////////////////////////////////////////////
+
+OutputSpec::OutputSpec(Options *opt) : OutputSpec() {
+  // Only read settings which are set, so defaults aren't logged for every field
+  if(opt->isSet("xmin")) opt->get("xmin", xmin, 0);
+  if(opt->isSet("xmax")) opt->get("xmax", xmax, -1);
+  if(opt->isSet("xstride")) opt->get("xstride", xstride, 1);
+  if(opt->isSet("ymin")) opt->get("ymin", ymin, 0);
+  if(opt->isSet("ymax")) opt->get("ymax", ymax, -1);
+  if(opt->isSet("ystride")) opt->get("ystride", ystride, 1);
+  if(opt->isSet("zmodes")) opt->get("zmodes", zmodes, 0);
+  if(opt->isSet("floats")) opt->get("floats", floats, false);
+  if(opt->isSet("abs_error")) opt->get("abs_error", abs_error, 0.0);
+  if(opt->isSet("rel_error")) opt->get("rel_error", rel_error, 0.0);
+}
+
+bool OutputSpec::wholeField() const {
+  return (xmin == 0) && (xmax < 0) && (xstride == 1) &&
+    (ymin == 0) && (ymax < 0) && (ystride == 1) && (zmodes == 0);
+}
@@ -9,6 +9,7 @@
 #include "impls/netcdf/nc_format.hxx"
 #include "impls/hdf5/h5_format.hxx"
 #include "impls/pnetcdf/pnetcdf.hxx"
+#include "impls/binary/bin_format.hxx"
 
 #include <boutexception.hxx>
 #include <output.hxx>
@@ -108,6 +109,14 @@ DataFormat* FormatFactory::createDataFormat(const char *filename, bool parallel)
   }
 #endif
 
+  const char *bin_match[] = {"bin"};
+  if(matchString(s, 1, bin_match) != -1) {
+    if(parallel)
+      throw BoutException("\tBinary format does not support parallel I/O ('%s')\n", filename);
+    output.write("\tUsing binary format for file '%s'\n", filename);
+    return new BinFormat;
+  }
+
   throw BoutException("\tFile extension not recognised for '%s'\n", filename);
   return NULL;
 }
@@ -0,0 +1,769 @@
+/**************************************************************************
+ * Copyright 2017 B.D.Dudson
+ *
+ * Contact: Ben Dudson, bd512@york.ac.uk
+ *
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+#include "bin_format.hxx"
+
+#include <boutexception.hxx>
+#include <msg_stack.hxx>
+#include <output.hxx>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+/// Header at the start of the file
+struct FileHeader {
+  char magic[8];       ///< "BOUTBIN"
+  uint64_t version;
+  uint64_t byteorder;  ///< Used to check that the byte order is the same
+};
+
+const char file_magic[8] = "BOUTBIN";
+const char entry_magic[8] = "BOUTVAR";
+const uint64_t file_version = 2;
+const uint64_t byteorder_mark = 0x0102030405060708ULL;
+
+/// Records smaller than this are collected before writing
+const size_t batch_bytes = 1 << 20;
+
+/// Round up to a multiple of 8 bytes
+size_t pad8(size_t n) {
+  return (n + 7) & ~static_cast<size_t>(7);
+}
+
+/// Number of elements in an array with sizes lx, ly, lz.
+/// Sizes of zero mean the dimension is not used
+size_t numElements(int64_t lx, int64_t ly, int64_t lz) {
+  return ((lx > 0) ? lx : 1) * ((ly > 0) ? ly : 1) * ((lz > 0) ? lz : 1);
+}
+
+/// Wait until the data written to \p fd is on disk
+int syncData(int fd) {
+#if defined(_POSIX_SYNCHRONIZED_IO) && (_POSIX_SYNCHRONIZED_IO > 0)
+  return fdatasync(fd);
+#else
+  return fsync(fd);
+#endif
+}
+
+/// Wait until the directory containing \p path is on disk, so
+/// that a file renamed into it stays renamed
+void syncDirectory(const std::string &path) {
+  size_t slash = path.rfind('/');
+  std::string dir = (slash == std::string::npos) ? "." : path.substr(0, slash + 1);
+  int dirfd = ::open(dir.c_str(), O_RDONLY);
+  if(dirfd < 0)
+    return; // Only a precaution, so ignore errors
+  fsync(dirfd);
+  ::close(dirfd);
+}
+}
+
+BinFormat::BinFormat() : fd(-1), writable(false), rewriting(false), oldfd(-1),
+                         mapped(nullptr), mapsize(0), fileend(0),
+                         x0(0), y0(0), z0(0), t0(0) {}
+
+BinFormat::BinFormat(const char *name) : BinFormat() {
+  openr(name);
+}
+
+BinFormat::~BinFormat() {
+  try {
+    close();
+  } catch(BoutException &e) {
+    // Can't throw from a destructor
+    output.write("%s\n", e.what());
+  }
+}
+
+bool BinFormat::openr(const char *name) {
+  TRACE("BinFormat::openr");
+
+  close();
+
+  fd = ::open(name, O_RDONLY);
+  if(fd < 0)
+    return false;
+
+  struct stat st;
+  if((fstat(fd, &st) != 0) || (static_cast<size_t>(st.st_size) < sizeof(FileHeader))) {
+    close();
+    return false;
+  }
+  mapsize = st.st_size;
+
+  void *ptr = mmap(nullptr, mapsize, PROT_READ, MAP_PRIVATE, fd, 0);
+  if(ptr == MAP_FAILED) {
+    mapped = nullptr;
+    close();
+    return false;
+  }
+  mapped = static_cast<char*>(ptr);
+  madvise(mapped, mapsize, MADV_SEQUENTIAL); // Only a hint, so ignore errors
+
+  fname = name;
+  readIndex();
+
+  return true;
+}
+
+bool BinFormat::openw(const char *name, bool append) {
+  TRACE("BinFormat::openw");
+
+  close();
+
+  fname = name;
+  writable = true;
+
+  if(append) {
+    fd = ::open(name, O_RDWR);
+    struct stat st;
+    if((fd >= 0) && (fstat(fd, &st) == 0) && (st.st_size > 0)) {
+      // Get the existing entries
+      mapsize = st.st_size;
+      void *ptr = mmap(nullptr, mapsize, PROT_READ, MAP_SHARED, fd, 0);
+      if(ptr == MAP_FAILED) {
+        close();
+        return false;
+      }
+      mapped = static_cast<char*>(ptr);
+      readIndex();
+
+      // Remove any incomplete last entry, which would otherwise be
+      // left after shorter new entries
+      if((fileend < mapsize) && (ftruncate(fd, fileend) != 0)) {
+        close();
+        return false;
+      }
+
+      // Data is written with pwrite rather than through the map
+      munmap(mapped, mapsize);
+      mapped = nullptr;
+      mapsize = 0;
+      return true;
+    }
+    if(fd >= 0)
+      ::close(fd);
+    fd = -1;
+    // Otherwise create a new file
+  }
+
+  // Any existing file is kept until the new one is complete
+  if(!startRewrite()) {
+    writable = false;
+    return false;
+  }
+
+  return true;
+}
+
+bool BinFormat::is_valid() {
+  return fd >= 0;
+}
+
+void BinFormat::close() {
+  TRACE("BinFormat::close");
+
+  if(writable && (fd >= 0)) {
+    // Make sure everything is on disk. If this fails, the original
+    // file is left unchanged
+    try {
+      commit();
+    } catch(BoutException &) {
+      writable = false;
+      close();
+      throw;
+    }
+  }
+
+  if(mapped != nullptr) {
+    munmap(mapped, mapsize);
+    mapped = nullptr;
+  }
+  mapsize = 0;
+  if(fd >= 0) {
+    ::close(fd);
+    fd = -1;
+  }
+  if(oldfd >= 0) {
+    ::close(oldfd);
+    oldfd = -1;
+  }
+  entries.clear();
+  pending.clear();
+  writable = false;
+  rewriting = false;
+  fileend = 0;
+}
+
+void BinFormat::flush() {
+  TRACE("BinFormat::flush");
+
+  // Pending records are in memory, other data may still be in the
+  // operating system's cache, and a rewritten file is not yet in place
+  commit();
+}
+
+const vector<int> BinFormat::getSize(const char *name) {
+  return getSize(string(name));
+}
+
+const vector<int> BinFormat::getSize(const string &name) {
+  vector<int> size;
+
+  const EntryHeader *last;
+  auto it = entries.find(name);
+  if(it != entries.end()) {
+    last = &it->second.rbegin()->second.header;
+  }else {
+    auto pit = pending.find(name);
+    if(pit == pending.end())
+      return size;
+    last = &pit->second.header;
+  }
+
+  const EntryHeader &header = *last;
+  if(header.record >= 0) {
+    // Time dimension first
+    size.push_back(lastRecord(name) + 1);
+  }
+  for(int i=0;i<3;i++)
+    if(header.size[i] > 0)
+      size.push_back(static_cast<int>(header.size[i]));
+
+  if(size.empty())
+    size.push_back(1); // Scalar
+
+  return size;
+}
+
+bool BinFormat::setGlobalOrigin(int x, int y, int z) {
+  x0 = x;
+  y0 = y;
+  z0 = z;
+
+  return true;
+}
+
+bool BinFormat::setRecord(int t) {
+  t0 = t;
+
+  return true;
+}
+
+bool BinFormat::read(int *var, const char *name, int lx, int ly, int lz) {
+  return readEntry(var, TYPE_INT, name, -1, lx, ly, lz);
+}
+
+bool BinFormat::read(int *var, const string &name, int lx, int ly, int lz) {
+  return readEntry(var, TYPE_INT, name, -1, lx, ly, lz);
+}
+
+bool BinFormat::read(BoutReal *var, const char *name, int lx, int ly, int lz) {
+  return readEntry(var, TYPE_REAL, name, -1, lx, ly, lz);
+}
+
+bool BinFormat::read(BoutReal *var, const string &name, int lx, int ly, int lz) {
+  return readEntry(var, TYPE_REAL, name, -1, lx, ly, lz);
+}
+
+bool BinFormat::write(int *var, const char *name, int lx, int ly, int lz) {
+  return writeEntry(var, TYPE_INT, name, -1, lx, ly, lz);
+}
+
+bool BinFormat::write(int *var, const string &name, int lx, int ly, int lz) {
+  return writeEntry(var, TYPE_INT, name, -1, lx, ly, lz);
+}
+
+bool BinFormat::write(BoutReal *var, const char *name, int lx, int ly, int lz) {
+  return writeEntry(var, TYPE_REAL, name, -1, lx, ly, lz);
+}
+
+bool BinFormat::write(BoutReal *var, const string &name, int lx, int ly, int lz) {
+  return writeEntry(var, TYPE_REAL, name, -1, lx, ly, lz);
+}
+
+bool BinFormat::read_rec(int *var, const char *name, int lx, int ly, int lz) {
+  return read_rec(var, string(name), lx, ly, lz);
+}
+
+bool BinFormat::read_rec(int *var, const string &name, int lx, int ly, int lz) {
+  int record = (t0 < 0) ? lastRecord(name) : t0;
+  if(record < 0)
+    return false;
+  return readEntry(var, TYPE_INT, name, record, lx, ly, lz);
+}
+
+bool BinFormat::read_rec(BoutReal *var, const char *name, int lx, int ly, int lz) {
+  return read_rec(var, string(name), lx, ly, lz);
+}
+
+bool BinFormat::read_rec(BoutReal *var, const string &name, int lx, int ly, int lz) {
+  int record = (t0 < 0) ? lastRecord(name) : t0;
+  if(record < 0)
+    return false;
+  return readEntry(var, TYPE_REAL, name, record, lx, ly, lz);
+}
+
+bool BinFormat::write_rec(int *var, const char *name, int lx, int ly, int lz) {
+  return write_rec(var, string(name), lx, ly, lz);
+}
+
+bool BinFormat::write_rec(int *var, const string &name, int lx, int ly, int lz) {
+  // Negative t0 means append a new record
+  int record = (t0 < 0) ? lastRecord(name) + 1 : t0;
+  return writeEntry(var, TYPE_INT, name, record, lx, ly, lz);
+}
+
+bool BinFormat::write_rec(BoutReal *var, const char *name, int lx, int ly, int lz) {
+  return write_rec(var, string(name), lx, ly, lz);
+}
+
+bool BinFormat::write_rec(BoutReal *var, const string &name, int lx, int ly, int lz) {
+  int record = (t0 < 0) ? lastRecord(name) + 1 : t0;
+  return writeEntry(var, TYPE_REAL, name, record, lx, ly, lz);
+}
+
+/***************************************************************************
+ * Private functions
+ ***************************************************************************/
+
+void BinFormat::readIndex() {
+  FileHeader fheader;
+  memcpy(&fheader, mapped, sizeof(fheader));
+  if(memcmp(fheader.magic, file_magic, sizeof(file_magic)) != 0)
+    throw BoutException("BinFormat: '%s' is not a BOUT++ binary file", fname.c_str());
+  if(fheader.byteorder != byteorder_mark)
+    throw BoutException("BinFormat: '%s' was written on a machine with a different byte order",
+                        fname.c_str());
+  if(fheader.version != file_version)
+    throw BoutException("BinFormat: '%s' has unknown version %lu", fname.c_str(),
+                        static_cast<unsigned long>(fheader.version));
+
+  entries.clear();
+  size_t pos = sizeof(fheader);
+  while(pos < mapsize) {
+    Entry e;
+    if(pos + sizeof(EntryHeader) > mapsize)
+      break; // Truncated below
+    memcpy(&e.header, mapped + pos, sizeof(EntryHeader));
+    if((memcmp(e.header.magic, entry_magic, sizeof(entry_magic)) != 0) || (e.header.nrecords < 1))
+      throw BoutException("BinFormat: '%s' is corrupted at byte %lu", fname.c_str(),
+                          static_cast<unsigned long>(pos));
+
+    e.offset = pos;
+    e.data = pos + sizeof(EntryHeader) + pad8(e.header.namelen);
+    e.stale = false;
+    e.checked = false;
+    if(e.data + e.header.nbytes > mapsize)
+      break;
+
+    string name(mapped + pos + sizeof(EntryHeader), e.header.namelen);
+    entries[name][e.header.record] = e;
+
+    pos = e.data + pad8(e.header.nbytes);
+  }
+  if(pos < mapsize) {
+    // Entries are only ever appended, so this is the last entry,
+    // interrupted while being written. Entries before it are complete
+    output.write("WARNING: BinFormat: '%s' is truncated. Ignoring incomplete last entry\n",
+                 fname.c_str());
+  }
+  fileend = pos;
+}
+
+BinFormat::Entry* BinFormat::find(const string &name, int record) {
+  auto it = entries.find(name);
+  if(it == entries.end())
+    return nullptr;
+
+  // Last entry starting at or before record
+  auto e = it->second.upper_bound(record);
+  if(e == it->second.begin())
+    return nullptr;
+  --e;
+  if(record >= e->second.header.record + e->second.header.nrecords)
+    return nullptr;
+  return &e->second;
+}
+
+int BinFormat::lastRecord(const string &name) {
+  int64_t last = -1;
+
+  // Entries don't overlap, so the last record is in the last entry
+  auto it = entries.find(name);
+  if(it != entries.end()) {
+    const EntryHeader &header = it->second.rbegin()->second.header;
+    if(header.record >= 0)
+      last = header.record + header.nrecords - 1;
+  }
+
+  auto pit = pending.find(name);
+  if(pit != pending.end()) {
+    const EntryHeader &header = pit->second.header;
+    last = std::max(last, header.record + header.nrecords - 1);
+  }
+
+  return static_cast<int>(last);
+}
+
+bool BinFormat::readEntry(void *var, int type, const string &name, int record, int lx, int ly, int lz) {
+  TRACE("BinFormat::readEntry");
+
+  if(!is_valid())
+    return false;
+
+  if((lx < 0) || (ly < 0) || (lz < 0))
+    return false;
+
+  if(mapped == nullptr)
+    throw BoutException("BinFormat: File '%s' not opened for reading", fname.c_str());
+
+  Entry *e = find(name, record);
+  if(e == nullptr)
+    return false;
+
+  const EntryHeader &header = e->header;
+  if(header.type != type)
+    throw BoutException("BinFormat: Variable '%s' in '%s' has a different type",
+                        name.c_str(), fname.c_str());
+
+  size_t elsize = (type == TYPE_INT) ? sizeof(int) : sizeof(BoutReal);
+  size_t recbytes = numElements(header.size[0], header.size[1], header.size[2])*elsize;
+  if(header.nbytes != header.nrecords*recbytes)
+    throw BoutException("BinFormat: Variable '%s' in '%s' is corrupted",
+                        name.c_str(), fname.c_str());
+
+  // Sizes of the variable in the file and of the region to read
+  int64_t nx = (header.size[0] > 0) ? header.size[0] : 1;
+  int64_t ny = (header.size[1] > 0) ? header.size[1] : 1;
+  int64_t nz = (header.size[2] > 0) ? header.size[2] : 1;
+  int cx = (lx > 0) ? lx : 1, cy = (ly > 0) ? ly : 1, cz = (lz > 0) ? lz : 1;
+
+  if((x0 < 0) || (y0 < 0) || (z0 < 0) || (x0 + cx > nx) || (y0 + cy > ny) || (z0 + cz > nz))
+    throw BoutException("BinFormat: Reading outside variable '%s' in '%s'",
+                        name.c_str(), fname.c_str());
+
+  if(!e->checked) {
+    // Check that the data is what was written. The checksum is of all
+    // the records in the entry, so only check once
+    uint64_t checksum[2];
+    calcChecksum(mapped + e->data, header.nbytes, checksum);
+    if((checksum[0] != header.checksum[0]) || (checksum[1] != header.checksum[1]))
+      throw BoutException("BinFormat: Checksum of variable '%s' in '%s' is incorrect",
+                          name.c_str(), fname.c_str());
+    e->checked = true;
+  }
+
+  const char *src = mapped + e->data;
+  if(record >= 0)
+    src += (record - header.record)*recbytes;
+
+  char *dest = static_cast<char*>(var);
+  if((cx == nx) && (cy == ny) && (cz == nz)) {
+    // Reading everything
+    memcpy(dest, src, recbytes);
+  }else {
+    // Copy lines in z
+    for(int x=0;x<cx;x++)
+      for(int y=0;y<cy;y++)
+        memcpy(dest + ((x*cy + y)*cz)*elsize,
+               src + (((x0 + x)*ny + y0 + y)*nz + z0)*elsize,
+               cz*elsize);
+  }
+
+  return true;
+}
+
+bool BinFormat::writeEntry(const void *var, int type, const string &name, int record, int lx, int ly, int lz) {
+  TRACE("BinFormat::writeEntry");
+
+  if(!is_valid() || !writable)
+    return false;
+
+  if((lx < 0) || (ly < 0) || (lz < 0))
+    return false;
+
+  if((x0 != 0) || (y0 != 0) || (z0 != 0))
+    throw BoutException("BinFormat: Can only write whole variables");
+
+  size_t elsize = (type == TYPE_INT) ? sizeof(int) : sizeof(BoutReal);
+  size_t recbytes = numElements(lx, ly, lz)*elsize;
+  const char *data = static_cast<const char*>(var);
+
+  auto sameShape = [&](const EntryHeader &h) {
+    return (h.type == type) && (h.size[0] == lx) && (h.size[1] == ly) && (h.size[2] == lz);
+  };
+
+  auto pit = pending.find(name);
+  if(pit != pending.end()) {
+    Pending &p = pit->second;
+    int64_t first = p.header.record, n = p.header.nrecords;
+    if((record >= first) && (record < first + n)) {
+      // Replace a record not yet written
+      if(!sameShape(p.header))
+        throw BoutException("BinFormat: Can't change the type or size of variable '%s' in '%s'",
+                            name.c_str(), fname.c_str());
+      memcpy(p.data.data() + (record - first)*recbytes, data, recbytes);
+      return true;
+    }
+    if((record == first + n) && sameShape(p.header)) {
+      // Next record
+      p.data.insert(p.data.end(), data, data + recbytes);
+      p.header.nrecords++;
+      if(p.data.size() >= batch_bytes)
+        writePending(name);
+      return true;
+    }
+    // Can't be added, so write the pending records first
+    writePending(name);
+  }
+
+  EntryHeader header;
+  memcpy(header.magic, entry_magic, sizeof(header.magic));
+  header.namelen = name.size();
+  header.type = type;
+  header.record = record;
+  header.nrecords = 1;
+  header.size[0] = lx;
+  header.size[1] = ly;
+  header.size[2] = lz;
+  header.nbytes = recbytes;
+
+  Entry *e = find(name, record);
+  if(e != nullptr) {
+    if(!sameShape(e->header))
+      throw BoutException("BinFormat: Can't change the type or size of variable '%s' in '%s'",
+                          name.c_str(), fname.c_str());
+
+    // Overwriting in place could leave the only copy half written
+    if(!rewriting && !startRewrite())
+      throw BoutException("BinFormat: Could not create '%s.tmp': %s", fname.c_str(),
+                          strerror(errno));
+
+    // Replace the one record in the entry's data
+    header = e->header;
+    vector<char> buffer;
+    if(header.nrecords > 1) {
+      buffer.resize(header.nbytes);
+      readAll(e->stale ? oldfd : fd, buffer.data(), header.nbytes, e->data);
+      memcpy(buffer.data() + (record - header.record)*recbytes, data, recbytes);
+      data = buffer.data();
+    }
+    calcChecksum(data, header.nbytes, header.checksum);
+
+    if(e->stale) {
+      // Only in the original file, so write a new entry
+      *e = appendEntry(header, name, data);
+      return true;
+    }
+
+    // Already in the temporary file, so overwrite the data and checksum
+    writeAll(data, header.nbytes, e->data);
+    writeAll(header.checksum, sizeof(header.checksum),
+             e->offset + offsetof(EntryHeader, checksum));
+    e->header = header;
+    return true;
+  }
+
+  if((record >= 0) && (recbytes < batch_bytes)) {
+    // Collect small records, to write several in one entry
+    Pending &p = pending[name];
+    p.header = header;
+    p.data.assign(data, data + recbytes);
+    return true;
+  }
+
+  calcChecksum(data, header.nbytes, header.checksum);
+  entries[name][record] = appendEntry(header, name, data);
+
+  return true;
+}
+
+BinFormat::Entry BinFormat::appendEntry(const EntryHeader &header, const string &name,
+                                        const char *data) {
+  // Header and name are written together, then the data in one write
+  vector<char> buffer(sizeof(EntryHeader) + pad8(name.size()), 0);
+  memcpy(buffer.data(), &header, sizeof(EntryHeader));
+  memcpy(buffer.data() + sizeof(EntryHeader), name.data(), name.size());
+
+  Entry e;
+  e.header = header;
+  e.offset = fileend;
+  e.data = fileend + buffer.size();
+  e.stale = false;
+  e.checked = true;
+
+  writeAll(buffer.data(), buffer.size(), e.offset);
+  writeAll(data, header.nbytes, e.data);
+
+  size_t padding = pad8(header.nbytes) - header.nbytes;
+  if(padding > 0) {
+    const char zeros[8] = {0};
+    writeAll(zeros, padding, e.data + header.nbytes);
+  }
+
+  fileend = e.data + pad8(header.nbytes);
+  return e;
+}
+
+void BinFormat::writePending(const string &name) {
+  auto it = pending.find(name);
+  if(it == pending.end())
+    return;
+
+  Pending &p = it->second;
+  p.header.nbytes = p.data.size();
+  calcChecksum(p.data.data(), p.header.nbytes, p.header.checksum);
+  entries[name][p.header.record] = appendEntry(p.header, name, p.data.data());
+
+  pending.erase(it);
+}
+
+bool BinFormat::startRewrite() {
+  string tmpname = fname + ".tmp";
+  int tmpfd = ::open(tmpname.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if(tmpfd < 0)
+    return false;
+
+  oldfd = fd;
+  fd = tmpfd;
+  rewriting = true;
+
+  FileHeader header;
+  memcpy(header.magic, file_magic, sizeof(header.magic));
+  header.version = file_version;
+  header.byteorder = byteorder_mark;
+  writeAll(&header, sizeof(header), 0);
+  fileend = sizeof(header);
+
+  // Everything is now only in the original file
+  for(auto &it : entries)
+    for(auto &e : it.second)
+      e.second.stale = true;
+
+  return true;
+}
+
+void BinFormat::commit() {
+  if(!writable || (fd < 0))
+    return;
+
+  while(!pending.empty())
+    writePending(pending.begin()->first);
+
+  if(rewriting) {
+    // Copy entries which were not written again from the original file
+    vector<char> buffer;
+    for(auto &it : entries)
+      for(auto &rec : it.second) {
+        Entry &e = rec.second;
+        if(!e.stale)
+          continue;
+        size_t length = e.data + pad8(e.header.nbytes) - e.offset;
+        buffer.resize(length);
+        readAll(oldfd, buffer.data(), length, e.offset);
+        writeAll(buffer.data(), length, fileend);
+
+        e.data = fileend + (e.data - e.offset);
+        e.offset = fileend;
+        e.stale = false;
+        fileend += length;
+      }
+  }
+
+  if(syncData(fd) != 0)
+    throw BoutException("BinFormat: Failed to write to '%s': %s", fname.c_str(), strerror(errno));
+
+  if(rewriting) {
+    // The new file is complete, so replace the original
+    string tmpname = fname + ".tmp";
+    if(std::rename(tmpname.c_str(), fname.c_str()) != 0)
+      throw BoutException("BinFormat: Failed to rename '%s' to '%s': %s", tmpname.c_str(),
+                          fname.c_str(), strerror(errno));
+    syncDirectory(fname);
+
+    if(oldfd >= 0) {
+      ::close(oldfd);
+      oldfd = -1;
+    }
+    rewriting = false;
+  }
+}
+
+void BinFormat::writeAll(const void *data, size_t length, size_t offset) {
+  const char *ptr = static_cast<const char*>(data);
+  while(length > 0) {
+    ssize_t n = pwrite(fd, ptr, length, offset);
+    if(n < 0) {
+      if(errno == EINTR)
+        continue;
+      throw BoutException("BinFormat: Failed to write to '%s': %s", fname.c_str(), strerror(errno));
+    }
+    ptr += n;
+    length -= n;
+    offset += n;
+  }
+}
+
+void BinFormat::readAll(int from, void *data, size_t length, size_t offset) {
+  char *ptr = static_cast<char*>(data);
+  while(length > 0) {
+    ssize_t n = pread(from, ptr, length, offset);
+    if(n < 0) {
+      if(errno == EINTR)
+        continue;
+      throw BoutException("BinFormat: Failed to read from '%s': %s", fname.c_str(), strerror(errno));
+    }
+    if(n == 0)
+      throw BoutException("BinFormat: '%s' is truncated", fname.c_str());
+    ptr += n;
+    length -= n;
+    offset += n;
+  }
+}
+
+void BinFormat::calcChecksum(const char *data, size_t length, uint64_t checksum[2]) {
+  // Fletcher-like sums of 32-bit words. The second sum depends on the
+  // order of the words, so detects swapped as well as changed data
+  uint64_t a = 0, b = 0;
+  size_t nwords = length / 4;
+  for(size_t i=0;i<nwords;i++) {
+    uint32_t word;
+    memcpy(&word, data + 4*i, 4);
+    a += word;
+    b += a;
+  }
+  for(size_t i=4*nwords;i<length;i++) {
+    a += static_cast<unsigned char>(data[i]);
+    b += a;
+  }
+  checksum[0] = a;
+  checksum[1] = b;
+}
@@ -0,0 +1,210 @@
+/*!
+ * \file bin_format.hxx
+ *
+ * \brief Native binary data format, mainly for restart files
+ *
+ * Restart files are large, and only ever read back by BOUT++, so
+ * they don't need the features of NetCDF or HDF5. This format is a
+ * short header, followed by one entry per variable (also readable
+ * from Python with boutdata.binfile):
+ *
+ *   - A fixed size header (BinFormat::EntryHeader) describing the
+ *     type, sizes, records and checksum of the data
+ *   - The variable name, padded to a multiple of 8 bytes
+ *   - The raw data, in the same layout as in memory, also padded
+ *
+ * Small records (e.g. diagnostics every timestep) are collected in
+ * memory, and consecutive records of a variable written as one entry
+ * on flush() or close(), or once they reach 1MB. This avoids a header
+ * for every record.
+ *
+ * Each array is written with a single large write, and files are
+ * read by mapping them into memory (mmap) and copying the data
+ * directly into the fields. Every entry has a checksum, which is
+ * checked when it is read, so that corrupted or partly written
+ * files are detected.
+ *
+ * Files are in the byte order of the machine which wrote them,
+ * and can't be read on machines with a different byte order.
+ *
+ * New variables and records are appended to the end of the file, so
+ * an interrupted write only leaves an incomplete last entry. Writing
+ * a variable which is already in the file (e.g. the restart file
+ * every output) would tear the only copy if interrupted, so the file
+ * is instead rewritten to a temporary file, NAME.tmp. Entries which
+ * are not written again are copied across, and the temporary file
+ * replaces the original with rename() on flush() or close(), once its
+ * data is on disk (fdatasync). Either the old or the new file is then
+ * always complete. Variables written again must have the same size.
+ *
+ **************************************************************************
+ * Copyright 2017 B.D.Dudson
+ *
+ * Contact: Ben Dudson, bd512@york.ac.uk
+ *
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+class BinFormat;
+
+#ifndef __BINFORMAT_H__
+#define __BINFORMAT_H__
+
+#include "dataformat.hxx"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::map;
+using std::vector;
+
+class BinFormat : public DataFormat {
+ public:
+  BinFormat();
+  BinFormat(const char *name);
+  BinFormat(const string &name) : BinFormat(name.c_str()) {}
+  ~BinFormat();
+
+  bool openr(const char *name);
+  bool openw(const char *name, bool append=false);
+
+  bool is_valid();
+
+  void close();
+
+  void flush();
+
+  const vector<int> getSize(const char *var);
+  const vector<int> getSize(const string &var);
+
+  // Set the origin for all subsequent calls
+  bool setGlobalOrigin(int x = 0, int y = 0, int z = 0);
+  bool setRecord(int t); // negative -> latest
+
+  // Read / Write simple variables up to 3D
+
+  bool read(int *var, const char *name, int lx = 1, int ly = 0, int lz = 0);
+  bool read(int *var, const string &name, int lx = 1, int ly = 0, int lz = 0);
+  bool read(BoutReal *var, const char *name, int lx = 1, int ly = 0, int lz = 0);
+  bool read(BoutReal *var, const string &name, int lx = 1, int ly = 0, int lz = 0);
+
+  bool write(int *var, const char *name, int lx = 0, int ly = 0, int lz = 0);
+  bool write(int *var, const string &name, int lx = 0, int ly = 0, int lz = 0);
+  bool write(BoutReal *var, const char *name, int lx = 0, int ly = 0, int lz = 0);
+  bool write(BoutReal *var, const string &name, int lx = 0, int ly = 0, int lz = 0);
+
+  // Read / Write record-based variables
+
+  bool read_rec(int *var, const char *name, int lx = 1, int ly = 0, int lz = 0);
+  bool read_rec(int *var, const string &name, int lx = 1, int ly = 0, int lz = 0);
+  bool read_rec(BoutReal *var, const char *name, int lx = 1, int ly = 0, int lz = 0);
+  bool read_rec(BoutReal *var, const string &name, int lx = 1, int ly = 0, int lz = 0);
+
+  bool write_rec(int *var, const char *name, int lx = 0, int ly = 0, int lz = 0);
+  bool write_rec(int *var, const string &name, int lx = 0, int ly = 0, int lz = 0);
+  bool write_rec(BoutReal *var, const char *name, int lx = 0, int ly = 0, int lz = 0);
+  bool write_rec(BoutReal *var, const string &name, int lx = 0, int ly = 0, int lz = 0);
+
+ private:
+  /// Type of the data in an entry
+  enum {TYPE_INT = 1, TYPE_REAL = 2};
+
+  /// Header at the start of each entry in the file
+  struct EntryHeader {
+    char magic[8];       ///< "BOUTVAR"
+    uint64_t namelen;    ///< Length of the name, without padding
+    int64_t type;        ///< TYPE_INT or TYPE_REAL
+    int64_t record;      ///< First record number, or -1 if not a record
+    int64_t nrecords;    ///< Number of records, 1 if not a record
+    int64_t size[3];     ///< Array sizes of one record, zero if dimension not used
+    uint64_t nbytes;     ///< Length of the data, without padding
+    uint64_t checksum[2];
+  };
+
+  /// An entry which is in the file
+  struct Entry {
+    EntryHeader header;
+    size_t offset;       ///< Position of the header in the file
+    size_t data;         ///< Position of the data in the file
+    bool stale;          ///< Still in the original file, not yet in the temporary file
+    bool checked;        ///< Checksum has been verified
+  };
+
+  /// Records of a variable not yet written to the file. The header
+  /// is for all the records, except for the checksum
+  struct Pending {
+    EntryHeader header;
+    vector<char> data;
+  };
+
+  string fname;
+  int fd;              ///< File descriptor, or -1 if not open
+  bool writable;
+
+  bool rewriting;      ///< Writing to a temporary file, rather than fname
+  int oldfd;           ///< Original file when rewriting, or -1 if none
+
+  char *mapped;        ///< Memory map of file when reading
+  size_t mapsize;
+  size_t fileend;      ///< Position to write new entries
+
+  int x0, y0, z0, t0; ///< Data origins
+
+  /// Entries for each variable, by first record (-1 if not a record)
+  map<string, map<int64_t, Entry> > entries;
+  map<string, Pending> pending; ///< Records not yet written, for each variable
+
+  /// Read the entries from the mapped file
+  void readIndex();
+
+  /// Find the entry containing \p record, which is -1 for non-record variables
+  Entry* find(const string &name, int record);
+
+  /// Last record of variable \p name, or -1 if there are none
+  int lastRecord(const string &name);
+
+  bool readEntry(void *var, int type, const string &name, int record, int lx, int ly, int lz);
+  bool writeEntry(const void *var, int type, const string &name, int record, int lx, int ly, int lz);
+
+  /// Write \p data as a new entry at the end of the file
+  Entry appendEntry(const EntryHeader &header, const string &name, const char *data);
+
+  /// Write the pending records of variable \p name
+  void writePending(const string &name);
+
+  /// Start writing to a temporary file, which will replace fname.
+  /// Returns false if the file can't be created
+  bool startRewrite();
+
+  /// Make everything written so far durable. When rewriting, copies
+  /// stale entries and renames the temporary file over fname
+  void commit();
+
+  /// Write all of \p data at \p offset in the file
+  void writeAll(const void *data, size_t length, size_t offset);
+
+  /// Read \p length bytes at \p offset in file descriptor \p from
+  void readAll(int from, void *data, size_t length, size_t offset);
+
+  /// Calculate a checksum of \p length bytes
+  static void calcChecksum(const char *data, size_t length, uint64_t checksum[2]);
+};
+
+#endif // __BINFORMAT_H__
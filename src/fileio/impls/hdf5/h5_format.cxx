@@ -27,6 +27,7 @@
 
 #include <utils.hxx>
 #include <cmath>
+#include <algorithm>
 #include <string>
 #include <mpi.h>
 
@@ -34,10 +35,41 @@
 #include <msg_stack.hxx>
 #include <boutcomm.hxx>
 
+/// Largest of the sizes of \p nproc processor domains, where
+/// \p offset(p) is the start of processor p's domain. Clears
+/// \p uniform if the sizes are not all the same
+template<typename F>
+static hsize_t largestProcSize(int nproc, F offset, bool &uniform) {
+  int first = offset(1) - offset(0), result = first;
+  for(int p=1;p<nproc;p++) {
+    int size = offset(p+1) - offset(p);
+    uniform &= (size == first);
+    result = std::max(result, size);
+  }
+  return result;
+}
+
+/// Largest chunk used when processor domains have different sizes
+static const hsize_t max_chunk_bytes = 1024*1024;
+
+/// In parallel, scalars such as MXSUB or OffsetX can be different on
+/// each processor, but there is only one copy in the shared file. Only
+/// processor 0 writes them; the others select nothing, but still take
+/// part in the collective write
+static void selectScalarWriter(hid_t mem_space, hid_t dataSpace) {
+  int rank;
+  MPI_Comm_rank(BoutComm::get(), &rank);
+  if (rank != 0) {
+    if ((H5Sselect_none(mem_space) < 0) || (H5Sselect_none(dataSpace) < 0))
+      throw BoutException("Failed to select none");
+  }
+}
+
 H5Format::H5Format(bool parallel_in) {
   parallel = parallel_in;
   x0 = y0 = z0 = t0 = 0;
   lowPrecision = false;
+  compression = 0;
   fname = NULL;
   dataFile = -1;
   chunk_length = 10; // could change this to try to optimize IO performance (i.e. allocate new chunks of disk space less often)
@@ -47,63 +79,57 @@ H5Format::H5Format(bool parallel_in) {
     throw BoutException("Failed to create dataFile_plist");
 
 #ifdef PHDF5
-  if (parallel)
+  if (parallel) {
     if (H5Pset_fapl_mpio(dataFile_plist, BoutComm::get(), MPI_INFO_NULL) < 0)
       throw BoutException("Failed to set dataFile_plist");
+#if H5_VERSION_GE(1,10,0)
+    // Read and write metadata collectively, rather than every processor
+    // accessing the file system
+    if (H5Pset_all_coll_metadata_ops(dataFile_plist, true) < 0)
+      throw BoutException("Failed to set collective metadata reads");
+    if (H5Pset_coll_metadata_write(dataFile_plist, true) < 0)
+      throw BoutException("Failed to set collective metadata writes");
 #endif
-
-  dataSet_plist = H5Pcreate(H5P_DATASET_XFER);
-  if (dataSet_plist < 0)
-    throw BoutException("Failed to create dataSet_plist");
-
-#ifdef PHDF5
-  if (parallel)
-    if (H5Pset_dxpl_mpio(dataSet_plist, H5FD_MPIO_INDEPENDENT) < 0) // Default, independent writes
-//     if (H5Pset_dxpl_mpio(dataSet_plist, H5FD_MPIO_COLLECTIVE) < 0) // Alternative, collective writes
-      throw BoutException("Failed to set dataSet_plist");
+  }
 #endif
 
-  if (H5Eset_auto(H5E_DEFAULT, NULL, NULL) < 0) // Disable automatic printing of error messages so that we can catch errors without printing error messages to stdout
-    throw BoutException("Failed to set error stack to not print errors");
-}
-
-H5Format::H5Format(const char *name, bool parallel_in) {
-  parallel = parallel_in;
-  x0 = y0 = z0 = t0 = 0;
-  lowPrecision = false;
-  fname = NULL;
-  dataFile = -1;
-  chunk_length = 10; // could change this to try to optimize IO performance (i.e. allocate new chunks of disk space less often)
-  
-  dataFile_plist = H5Pcreate(H5P_FILE_ACCESS);
-  if (dataFile_plist < 0)
-    throw BoutException("Failed to create dataFile_plist");
-
-#ifdef PHDF5
-  if (parallel)
-    if (H5Pset_fapl_mpio(dataFile_plist, BoutComm::get(), MPI_INFO_NULL) < 0)
-      throw BoutException("Failed to set dataFile_plist");
-#endif  
-
   dataSet_plist = H5Pcreate(H5P_DATASET_XFER);
   if (dataSet_plist < 0)
     throw BoutException("Failed to create dataSet_plist");
 
 #ifdef PHDF5
   if (parallel)
-    if (H5Pset_dxpl_mpio(dataSet_plist, H5FD_MPIO_COLLECTIVE) < 0)
+    if (H5Pset_dxpl_mpio(dataSet_plist, H5FD_MPIO_COLLECTIVE) < 0) // All processors write together
       throw BoutException("Failed to set dataSet_plist");
 #endif
 
   if (H5Eset_auto(H5E_DEFAULT, NULL, NULL) < 0) // Disable automatic printing of error messages so that we can catch errors without printing error messages to stdout
     throw BoutException("Failed to set error stack to not print errors");
+}
 
+H5Format::H5Format(const char *name, bool parallel_in) : H5Format(parallel_in) {
   openr(name);
 }
 
 H5Format::~H5Format() {
   close();
   H5Pclose(dataFile_plist);
+  H5Pclose(dataSet_plist);
+}
+
+bool H5Format::openr(const string &name, int mype) {
+  if(parallel) {
+    // One file shared by all processors
+    return openr(name.c_str());
+  }
+  return DataFormat::openr(name, mype);
+}
+
+bool H5Format::openw(const string &name, int mype, bool append) {
+  if(parallel) {
+    return openw(name.c_str(), append);
+  }
+  return DataFormat::openw(name, mype, append);
 }
 
 bool H5Format::openr(const char *name) {
@@ -270,6 +296,15 @@ bool H5Format::setLocalOrigin(int x, int y, int z, int offset_x, int offset_y, i
   return true;
 }
 
+void H5Format::removeGuards(int &lx, int &ly) {
+  if (parallel && (ly != 0)) {
+    // Sizes passed in are of the whole local array, but only
+    // the interior is written to the shared file
+    lx -= 2*x0_local;
+    ly -= 2*y0_local;
+  }
+}
+
 bool H5Format::setRecord(int t) {
   t0 = t;
 
@@ -299,6 +334,8 @@ bool H5Format::read(void *data, hid_t hdf5_type, const char *name, int lx, int l
   if((lx < 0) || (ly < 0) || (lz < 0))
     return false;
 
+  removeGuards(lx, ly);
+
 #ifdef CHECK
   msg_stack.push("H5Format::read(void)");
 #endif
@@ -312,10 +349,17 @@ bool H5Format::read(void *data, hid_t hdf5_type, const char *name, int lx, int l
   offset[0]=x0; offset[1]=y0; offset[2]=z0;
   offset_local[0]=x0_local;offset_local[1]=y0_local;offset_local[2]=z0_local;
   init_size_local[0]=offset_local[0]+counts[0]; init_size_local[1]=offset_local[1]+counts[1]; init_size_local[2]=offset_local[2]+counts[2]; // Want to be able to use without needing mesh to be initialised; makes hyperslab selection redundant
+  if (parallel && (nd > 1)) {
+    // Guard cells at both ends of the local array
+    init_size_local[0] += offset_local[0]; init_size_local[1] += offset_local[1];
+  }
   
   hid_t mem_space = H5Screate_simple(nd, init_size_local, init_size_local);
   if (mem_space < 0)
     throw BoutException("Failed to create mem_space");
+  if (parallel && (nd > 1))
+    if (H5Sselect_hyperslab(mem_space, H5S_SELECT_SET, offset_local, /*stride=*/NULL, counts, /*block=*/NULL) < 0)
+      throw BoutException("Failed to select hyperslab");
 //   if (nd > 0 && !(nd==1 && lx==1))
 //     if (H5Sselect_hyperslab(mem_space, H5S_SELECT_SET, offset_local, /*stride=*/NULL, counts, /*block=*/NULL) < 0)
 //       throw BoutException("Failed to select hyperslab");
@@ -334,7 +378,7 @@ bool H5Format::read(void *data, hid_t hdf5_type, const char *name, int lx, int l
     if (H5Sselect_hyperslab(dataSpace, H5S_SELECT_SET, offset, /*stride=*/NULL, counts, /*block=*/NULL) < 0)
       throw BoutException("Failed to select hyperslab");
   
-  if (H5Dread(dataSet, hdf5_type, mem_space, dataSpace, H5P_DEFAULT, data) < 0)
+  if (H5Dread(dataSet, hdf5_type, mem_space, dataSpace, dataSet_plist, data) < 0)
     throw BoutException("Failed to read data");
   
   if (H5Sclose(mem_space) < 0)
@@ -396,6 +440,8 @@ bool H5Format::write(void *data, hid_t mem_hdf5_type, hid_t write_hdf5_type, con
   if((lx < 0) || (ly < 0) || (lz < 0))
     return false;
 
+  removeGuards(lx, ly);
+
 //   // Check for valid name
 //   checkName(name);
   
@@ -413,11 +459,14 @@ bool H5Format::write(void *data, hid_t mem_hdf5_type, hid_t write_hdf5_type, con
   offset_local[0]=x0_local;offset_local[1]=y0_local;offset_local[2]=z0_local;
   if (parallel) {
     init_size[0]=mesh->GlobalNx-2*mesh->xstart; init_size[1]=mesh->GlobalNy-2*mesh->ystart; init_size[2]=mesh->GlobalNz;
+    init_size_local[0]=mesh->LocalNx; init_size_local[1]=mesh->LocalNy; init_size_local[2]=mesh->LocalNz;
   }
   else {
-    init_size[0]=mesh->LocalNx; init_size[1]=mesh->LocalNy; init_size[2]=mesh->LocalNz;
+    // One file per processor, sized by the data written. This may be
+    // smaller than the mesh, e.g. a reduced output region
+    init_size[0]=x0+lx; init_size[1]=y0+ly; init_size[2]=z0+lz;
+    init_size_local[0]=lx; init_size_local[1]=ly; init_size_local[2]=lz;
   }
-  init_size_local[0]=mesh->LocalNx; init_size_local[1]=mesh->LocalNy; init_size_local[2]=mesh->LocalNz;
   
   if (nd==0) {
     // Need to write a scalar, not a 0-d array
@@ -441,9 +490,21 @@ bool H5Format::write(void *data, hid_t mem_hdf5_type, hid_t write_hdf5_type, con
     hid_t init_space = H5Screate_simple(nd, init_size, init_size);
     if (init_space < 0)
       throw BoutException("Failed to create init_space");
-    dataSet = H5Dcreate(dataFile, name, write_hdf5_type, init_space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    hid_t propertyList = H5Pcreate(H5P_DATASET_CREATE);
+    if (propertyList < 0)
+      throw BoutException("Failed to create propertyList");
+    if ((compression > 0) && !parallel && (nd > 1)) {
+      // Filters need chunks. One chunk for the whole field
+      if (H5Pset_chunk(propertyList, nd, init_size) < 0)
+        throw BoutException("Failed to set chunk property");
+      if ((H5Pset_shuffle(propertyList) < 0) || (H5Pset_deflate(propertyList, compression) < 0))
+        throw BoutException("Failed to set compression");
+    }
+    dataSet = H5Dcreate(dataFile, name, write_hdf5_type, init_space, H5P_DEFAULT, propertyList, H5P_DEFAULT);
     if (dataSet < 0)
       throw BoutException("Failed to create dataSet");
+    if (H5Pclose(propertyList) < 0)
+      throw BoutException("Failed to close propertyList");
     
     // Add attribute to say what kind of field this is
     std::string datatype = "scalar";
@@ -486,6 +547,8 @@ bool H5Format::write(void *data, hid_t mem_hdf5_type, hid_t write_hdf5_type, con
     throw BoutException("Failed to create dataSpace");
   if (H5Sselect_hyperslab(dataSpace, H5S_SELECT_SET, offset, /*stride=*/NULL, counts, /*block=*/NULL) < 0)
     throw BoutException("Failed to select hyperslab");
+  if (parallel && (lx == 0))
+    selectScalarWriter(mem_space, dataSpace);
   
   if (H5Dwrite(dataSet, mem_hdf5_type, mem_space, dataSpace, dataSet_plist, data) < 0)
     throw BoutException("Failed to write data");
@@ -531,6 +594,8 @@ bool H5Format::read_rec(void *data, hid_t hdf5_type, const char *name, int lx, i
   if((lx < 0) || (ly < 0) || (lz < 0))
     return false;
 
+  removeGuards(lx, ly);
+
 //   // Check for valid name
 //   checkName(name);
   
@@ -556,14 +621,17 @@ bool H5Format::read_rec(void *data, hid_t hdf5_type, const char *name, int lx, i
     nd = 1;
     counts[1] = 1;
     offset[1] = 0;
+    offset_local[0] = 0;
     init_size[0] = 1;
     init_size_local[0] = 1;
   }
   
-  hid_t mem_space = H5Screate_simple(nd, init_size_local, init_size_local);
+  // Memory has no time dimension
+  int nd_local = (nd > 1) ? nd - 1 : 1;
+  hid_t mem_space = H5Screate_simple(nd_local, init_size_local, init_size_local);
   if (mem_space < 0)
     throw BoutException("Failed to create mem_space");
-  if (H5Sselect_hyperslab(mem_space, H5S_SELECT_SET, offset_local, /*stride=*/NULL, counts, /*block=*/NULL) < 0)
+  if (H5Sselect_hyperslab(mem_space, H5S_SELECT_SET, offset_local, /*stride=*/NULL, counts+1, /*block=*/NULL) < 0)
     throw BoutException("Failed to select hyperslab");
   
   hid_t dataSet = H5Dopen(dataFile, name, H5P_DEFAULT);
@@ -576,7 +644,7 @@ bool H5Format::read_rec(void *data, hid_t hdf5_type, const char *name, int lx, i
   if (H5Sselect_hyperslab(dataSpace, H5S_SELECT_SET, offset, /*stride=*/NULL, counts, /*block=*/NULL) < 0)
     throw BoutException("Failed to select hyperslab");
   
-  if (H5Dread(dataSet, hdf5_type, mem_space, dataSpace, H5P_DEFAULT, data) < 0)
+  if (H5Dread(dataSet, hdf5_type, mem_space, dataSpace, dataSet_plist, data) < 0)
     throw BoutException("Failed to read data");
   
   if (H5Sclose(mem_space) < 0)
@@ -631,6 +699,8 @@ bool H5Format::write_rec(void *data, hid_t mem_hdf5_type, hid_t write_hdf5_type,
   if((lx < 0) || (ly < 0) || (lz < 0))
     return false;
 
+  removeGuards(lx, ly);
+
 //   // Check for valid name
 //   checkName(name);
   
@@ -648,11 +718,13 @@ bool H5Format::write_rec(void *data, hid_t mem_hdf5_type, hid_t write_hdf5_type,
   offset_local[0]=x0_local;offset_local[1]=y0_local;offset_local[2]=z0_local;
   if (parallel) {
     init_size[0]=1;init_size[1]=mesh->GlobalNx-2*mesh->xstart; init_size[2]=mesh->GlobalNy-2*mesh->ystart; init_size[3]=mesh->GlobalNz;
+    init_size_local[0]=mesh->LocalNx; init_size_local[1]=mesh->LocalNy; init_size_local[2]=mesh->LocalNz;
   }
   else {
-    init_size[0]=1;init_size[1]=mesh->LocalNx; init_size[2]=mesh->LocalNy; init_size[3]=mesh->LocalNz;
+    // Sized by the data written, as in write()
+    init_size[0]=1;init_size[1]=x0+lx; init_size[2]=y0+ly; init_size[3]=z0+lz;
+    init_size_local[0]=lx; init_size_local[1]=ly; init_size_local[2]=lz;
   }
-  init_size_local[0]=mesh->LocalNx; init_size_local[1]=mesh->LocalNy; init_size_local[2]=mesh->LocalNz;
   
   if (nd_local==0) {
     nd_local = 1;
@@ -703,8 +775,46 @@ bool H5Format::write_rec(void *data, hid_t mem_hdf5_type, hid_t write_hdf5_type,
     hsize_t chunk_dims[4],max_dims[4];
     max_dims[0] = H5S_UNLIMITED; max_dims[1]=init_size[1]; max_dims[2]=init_size[2]; max_dims[3]=init_size[3];
     chunk_dims[0] = chunk_length; chunk_dims[1]=init_size[1]; chunk_dims[2]=init_size[2]; chunk_dims[3]=init_size[3];
+    if (parallel && (nd > 1)) {
+      // If processor domains are all the same size then chunks are one
+      // processor's block, so that processors don't write to the same
+      // chunks. Otherwise use the largest block, split until it is at
+      // most max_chunk_bytes; processors share chunks using collective I/O
+      bool uniform = true;
+      chunk_dims[0] = 1;
+      chunk_dims[1] = largestProcSize(mesh->getNXPE(), [](int p) { return mesh->getXProcOffset(p); }, uniform);
+      chunk_dims[2] = largestProcSize(mesh->getNYPE(), [](int p) { return mesh->getYProcOffset(p); }, uniform);
+      chunk_dims[3] = mesh->LocalNz;
+      if (!uniform) {
+        int nsplit = std::min(nd-1, 2); // Split in X, and Y if used
+        while (true) {
+          hsize_t bytes = H5Tget_size(write_hdf5_type);
+          for (int i=1;i<nd;i++)
+            bytes *= chunk_dims[i];
+          int largest = 1;
+          for (int i=2;i<=nsplit;i++)
+            if (chunk_dims[i] > chunk_dims[largest])
+              largest = i;
+          if ((bytes <= max_chunk_bytes) || (chunk_dims[largest] == 1))
+            break;
+          chunk_dims[largest] = (chunk_dims[largest] + 1) / 2;
+        }
+      }
+    }
     if (H5Pset_chunk(propertyList, nd, chunk_dims) < 0)
       throw BoutException("Failed to set chunk property");
+    // Every record is written, so there's no need to fill new chunks
+    if (H5Pset_fill_time(propertyList, H5D_FILL_TIME_NEVER) < 0)
+      throw BoutException("Failed to set fill time");
+    if ((compression > 0) && !parallel && (nd > 2)) {
+      // One record per chunk, so that each write compresses a
+      // complete chunk rather than re-reading a partly written one
+      chunk_dims[0] = 1;
+      if (H5Pset_chunk(propertyList, nd, chunk_dims) < 0)
+        throw BoutException("Failed to set chunk property");
+      if ((H5Pset_shuffle(propertyList) < 0) || (H5Pset_deflate(propertyList, compression) < 0))
+        throw BoutException("Failed to set compression");
+    }
     
     hid_t init_space = H5Screate_simple(nd, init_size, max_dims);
     if (init_space < 0)
@@ -763,6 +873,8 @@ bool H5Format::write_rec(void *data, hid_t mem_hdf5_type, hid_t write_hdf5_type,
     throw BoutException("Failed to create dataSpace");
   if (H5Sselect_hyperslab(dataSpace, H5S_SELECT_SET, offset, /*stride=*/NULL, counts, /*block=*/NULL) < 0)
     throw BoutException("Failed to select hyperslab");
+  if (parallel && (lx == 0))
+    selectScalarWriter(mem_space, dataSpace);
   
   if (H5Dwrite(dataSet, mem_hdf5_type, mem_space, dataSpace, dataSet_plist, data) < 0)
     throw BoutException("Failed to write data");
@@ -62,8 +62,14 @@ class H5Format : public DataFormat {
   H5Format(const string &name, bool parallel_in = false) : H5Format(name.c_str(), parallel_in) {}
   ~H5Format();
 
+  using DataFormat::openr;
+  using DataFormat::openw;
   bool openr(const char *name);
   bool openw(const char *name, bool append=false);
+  /// If parallel, all processors share one file, called \p name.
+  /// Otherwise each processor has its own file
+  bool openr(const string &name, int mype);
+  bool openw(const string &name, int mype, bool append=false);
   
   bool is_valid();
   
@@ -105,7 +111,8 @@ class H5Format : public DataFormat {
   bool write_rec(BoutReal *var, const char *name, int lx = 0, int ly = 0, int lz = 0);
   bool write_rec(BoutReal *var, const string &name, int lx = 0, int ly = 0, int lz = 0);
   
-  void setLowPrecision() { lowPrecision = true; }
+  void setLowPrecision(bool low = true) { lowPrecision = low; }
+  bool setCompression(int level) { compression = level; return !parallel; }
 
  private:
 
@@ -116,6 +123,7 @@ class H5Format : public DataFormat {
   hid_t dataSet_plist;
 
   bool lowPrecision; ///< When writing, down-convert to floats
+  int compression;   ///< Deflate level for new fields, 0 for none. Serial only
   bool parallel;
 
   int x0, y0, z0, t0; ///< Data origins for file access
@@ -123,6 +131,9 @@ class H5Format : public DataFormat {
   
   hsize_t chunk_length;
 
+  /// In parallel, reduce field sizes \p lx and \p ly to the interior
+  void removeGuards(int &lx, int &ly);
+
   bool read(void *var, hid_t hdf5_type, const char *name, int lx = 1, int ly = 0, int lz = 0);
   bool write(void *var, hid_t mem_hdf5_type, hid_t write_hdf5_type, const char *name, int lx = 0, int ly = 0, int lz = 0);
   bool read_rec(void *var, hid_t hdf5_type, const char *name, int lx = 1, int ly = 0, int lz = 0);
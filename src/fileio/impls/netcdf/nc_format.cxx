@@ -97,11 +97,6 @@ bool NcFormat::openr(const char *name) {
     return false;
     */
     xDim = NULL;
-  }else if(mesh != NULL) {
-    // Check that the dimension size is correct
-    if(xDim->size() != mesh->LocalNx) {
-      throw BoutException("X dimension incorrect. Expected %d, got %d", mesh->LocalNx, xDim->size());
-    }
   }
   
   if(!(yDim = dataFile->get_dim("y"))) {
@@ -112,11 +107,6 @@ bool NcFormat::openr(const char *name) {
     return false;
     */
     yDim = NULL;
-  }else if(mesh != NULL) {
-    // Check that the dimension size is correct
-    if(yDim->size() != mesh->LocalNy) {
-      throw BoutException("Y dimension incorrect. Expected %d, got %d", mesh->LocalNy, yDim->size());
-    }
   }
   
   if(!(zDim = dataFile->get_dim("z"))) {
@@ -473,7 +463,7 @@ bool NcFormat::write(int *data, const char *name, int lx, int ly, int lz) {
   NcVar *var;
   if(!(var = dataFile->get_var(name))) {
     // Variable not in file, so add it.
-    
+    setDims(lx, ly, lz);
     var = dataFile->add_var(name, ncInt, nd, dimList);
     if(var == NULL) {
       output.write("ERROR: NetCDF could not add int '%s' to file '%s'\n", name, fname);
@@ -528,6 +518,7 @@ bool NcFormat::write(BoutReal *data, const char *name, int lx, int ly, int lz) {
   NcVar *var;
   if(!(var = dataFile->get_var(name))) {
     // Variable not in file, so add it.
+    setDims(lx, ly, lz);
     if(lowPrecision) {
       var = dataFile->add_var(name, ncFloat, nd, dimList);
     }else
@@ -689,7 +680,7 @@ bool NcFormat::write_rec(int *data, const char *name, int lx, int ly, int lz) {
   // Try to find variable
   if(!(var = dataFile->get_var(name))) {
     // Need to add to file
-
+    setDims(lx, ly, lz);
     var = dataFile->add_var(name, ncInt, nd, recDimList);
 
     rec_nr[name] = default_rec; // Starting record
@@ -711,8 +702,6 @@ bool NcFormat::write_rec(int *data, const char *name, int lx, int ly, int lz) {
   if(!var->put_rec(data, rec_nr[name]))
     return false;
 
-  var->sync();
-  
   // Increment record number
   rec_nr[name] = rec_nr[name] + 1;
 
@@ -756,6 +745,7 @@ bool NcFormat::write_rec(BoutReal *data, const char *name, int lx, int ly, int l
     if(lowPrecision)
       vartype = ncFloat;
     
+    setDims(lx, ly, lz);
     var = dataFile->add_var(name, vartype, nd, recDimList);
     ASSERT1(var != 0);
     
@@ -806,8 +796,6 @@ bool NcFormat::write_rec(BoutReal *data, const char *name, int lx, int ly, int l
   if(!var->put_rec(data, t))
     return false;
 
-  var->sync();
-  
   // Increment record number
   rec_nr[name] = rec_nr[name] + 1;
   
@@ -833,5 +821,26 @@ void NcFormat::checkName(const char* name) {
   }
 }
 
+void NcFormat::setDims(int lx, int ly, int lz) {
+  dimList[0] = getDim("x", xDim, lx);
+  dimList[1] = getDim("y", yDim, ly);
+  dimList[2] = getDim("z", zDim, lz);
+}
+
+NcDim* NcFormat::getDim(const char *base, NcDim *dim, int size) {
+  if((size == 0) || (dim->size() == size))
+    return dim;
+
+  // A variable smaller than the mesh, e.g. a reduced output
+  std::string name = std::string(base) + "_" + std::to_string(size);
+  NcDim *d = dataFile->get_dim(name.c_str());
+  if(d == NULL) {
+    d = dataFile->add_dim(name.c_str(), size);
+    if(d == NULL)
+      throw BoutException("NetCDF could not add dimension '%s' to file '%s'", name.c_str(), fname);
+  }
+  return d;
+}
+
 #endif // NCDF
 
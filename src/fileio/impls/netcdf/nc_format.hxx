@@ -109,7 +109,7 @@ class NcFormat : public DataFormat {
   bool write_rec(BoutReal *var, const char *name, int lx = 0, int ly = 0, int lz = 0);
   bool write_rec(BoutReal *var, const string &name, int lx = 0, int ly = 0, int lz = 0);
   
-  void setLowPrecision() { lowPrecision = true; }
+  void setLowPrecision(bool low = true) { lowPrecision = low; }
 
  private:
 
@@ -131,6 +131,11 @@ class NcFormat : public DataFormat {
   int default_rec;  // Starting record. Useful when appending to existing file
 
   void checkName(const char* name); ///< Check if a name contains invalid characters
+
+  /// Set dimList to dimensions of size lx, ly, lz. Sizes which are not
+  /// the mesh size use dimensions named e.g. "x_12", added if needed
+  void setDims(int lx, int ly, int lz);
+  NcDim* getDim(const char *base, NcDim *dim, int size);
   
 };
 
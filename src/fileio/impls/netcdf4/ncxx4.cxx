@@ -45,6 +45,7 @@ Ncxx4::Ncxx4() {
   recDimList = new const NcDim*[4];
   dimList = recDimList+1;
   lowPrecision = false;
+  compression = 0;
 
   default_rec = 0;
   rec_nr.clear();
@@ -58,6 +59,7 @@ Ncxx4::Ncxx4(const char *name) {
   recDimList = new const NcDim*[4];
   dimList = recDimList+1;
   lowPrecision = false;
+  compression = 0;
 
   default_rec = 0;
   rec_nr.clear();
@@ -285,6 +287,10 @@ void Ncxx4::close() {
 }
 
 void Ncxx4::flush() {
+  if(!is_valid())
+    return;
+
+  nc_sync(dataFile->getId());
 }
 
 const vector<int> Ncxx4::getSize(const char *name) {
@@ -451,7 +457,7 @@ bool Ncxx4::write(int *data, const char *name, int lx, int ly, int lz) {
 #endif
     // Variable not in file, so add it.
 
-    var = dataFile->addVar(name, ncInt, getDimVec(nd));
+    var = dataFile->addVar(name, ncInt, getDimVec(nd, lx, ly, lz));
 
     if(var.isNull()) {
       output.write("ERROR: NetCDF could not add int '%s' to file '%s'\n", name, fname);
@@ -508,14 +514,16 @@ bool Ncxx4::write(BoutReal *data, const char *name, int lx, int ly, int lz) {
   if(var.isNull()) {
     // Variable not in file, so add it.
     if(lowPrecision) {
-      var = dataFile->addVar(name, ncFloat, getDimVec(nd));
+      var = dataFile->addVar(name, ncFloat, getDimVec(nd, lx, ly, lz));
     }else
-      var = dataFile->addVar(name, ncDouble, getDimVec(nd));
+      var = dataFile->addVar(name, ncDouble, getDimVec(nd, lx, ly, lz));
 
     if(var.isNull()) {
       output.write("ERROR: NetCDF could not add BoutReal '%s' to file '%s'\n", name, fname);
       return false;
     }
+    if((compression > 0) && (nd > 1))
+      var.setCompression(true, true, compression); // Shuffle and deflate
   }  
 
   vector<size_t> start(3);
@@ -647,7 +655,7 @@ bool Ncxx4::write_rec(int *data, const char *name, int lx, int ly, int lz) {
     if(nd == 1) {
       var = dataFile->addVar(name, ncInt, tDim);
     }else
-      var = dataFile->addVar(name, ncInt, getRecDimVec(nd));
+      var = dataFile->addVar(name, ncInt, getRecDimVec(nd, lx, ly, lz));
 
     rec_nr[name] = default_rec; // Starting record
 
@@ -711,10 +719,12 @@ bool Ncxx4::write_rec(BoutReal *data, const char *name, int lx, int ly, int lz)
     // Need to add to file
     
     if(lowPrecision) {
-      var = dataFile->addVar(name, ncFloat, getRecDimVec(nd));
+      var = dataFile->addVar(name, ncFloat, getRecDimVec(nd, lx, ly, lz));
     }else {
-      var = dataFile->addVar(name, ncDouble, getRecDimVec(nd));
+      var = dataFile->addVar(name, ncDouble, getRecDimVec(nd, lx, ly, lz));
     }
+    if(!var.isNull() && (compression > 0) && (nd > 2))
+      var.setCompression(true, true, compression); // Shuffle and deflate
     
     rec_nr[name] = default_rec; // Starting record
 
@@ -785,19 +795,34 @@ bool Ncxx4::write_rec(BoutReal *var, const string &name, int lx, int ly, int lz)
  * Private functions
  ***************************************************************************/
 
-vector<NcDim> Ncxx4::getDimVec(int nd) {
-  vector<NcDim> vec(nd);
-  for(int i=0;i<nd;i++)
-    vec[i] = *dimList[i];
-  return vec;
+vector<NcDim> Ncxx4::getDimVec(int nd, int lx, int ly, int lz) {
+  vector<NcDim> vec = getRecDimVec(nd + 1, lx, ly, lz);
+  return vector<NcDim>(vec.begin() + 1, vec.end());
 }
 
-vector<NcDim> Ncxx4::getRecDimVec(int nd) {
+vector<NcDim> Ncxx4::getRecDimVec(int nd, int lx, int ly, int lz) {
   vector<NcDim> vec(nd);
-  for(int i=0;i<nd;i++)
-    vec[i] = *recDimList[i];
+  if(nd > 0) vec[0] = tDim;
+  if(nd > 1) vec[1] = getDim("x", xDim, lx);
+  if(nd > 2) vec[2] = getDim("y", yDim, ly);
+  if(nd > 3) vec[3] = getDim("z", zDim, lz);
   return vec;
 }
 
+NcDim Ncxx4::getDim(const char *base, const NcDim &dim, int size) {
+  if(static_cast<int>(dim.getSize()) == size)
+    return dim;
+
+  // A variable smaller than the mesh, e.g. a reduced output
+  std::string name = std::string(base) + "_" + std::to_string(size);
+  NcDim d = dataFile->getDim(name);
+  if(d.isNull()) {
+    d = dataFile->addDim(name, size);
+    if(d.isNull())
+      throw BoutException("NetCDF could not add dimension '%s' to file '%s'", name.c_str(), fname);
+  }
+  return d;
+}
+
 #endif // NCDF
 
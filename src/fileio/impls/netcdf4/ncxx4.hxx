@@ -103,7 +103,8 @@ class Ncxx4 : public DataFormat {
   bool write_rec(BoutReal *var, const char *name, int lx = 0, int ly = 0, int lz = 0);
   bool write_rec(BoutReal *var, const std::string &name, int lx = 0, int ly = 0, int lz = 0);
   
-  void setLowPrecision() { lowPrecision = true; }
+  void setLowPrecision(bool low = true) { lowPrecision = low; }
+  bool setCompression(int level) { compression = level; return true; }
 
  private:
 
@@ -119,14 +120,18 @@ class Ncxx4 : public DataFormat {
 
   bool appending;
   bool lowPrecision; ///< When writing, down-convert to floats
+  int compression;   ///< Deflate level for new fields, 0 for none
 
   int x0, y0, z0, t0; ///< Data origins
 
   std::map<std::string, int> rec_nr; // Record number for each variable (bit nasty)
   int default_rec;  // Starting record. Useful when appending to existing file
   
-  std::vector<netCDF::NcDim> getDimVec(int nd);
-  std::vector<netCDF::NcDim> getRecDimVec(int nd);
+  /// Dimensions for a variable of size lx, ly, lz. Sizes which are not the
+  /// mesh size use dimensions named e.g. "x_12", added if needed
+  std::vector<netCDF::NcDim> getDimVec(int nd, int lx, int ly, int lz);
+  std::vector<netCDF::NcDim> getRecDimVec(int nd, int lx, int ly, int lz);
+  netCDF::NcDim getDim(const char *base, const netCDF::NcDim &dim, int size);
 };
 
 #endif // __NCFORMAT4_H__
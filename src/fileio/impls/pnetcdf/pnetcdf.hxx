@@ -105,7 +105,7 @@ class PncFormat : public DataFormat {
   bool write_rec(BoutReal *var, const char *name, int lx = 0, int ly = 0, int lz = 0);
   bool write_rec(BoutReal *var, const string &name, int lx = 0, int ly = 0, int lz = 0);
   
-  void setLowPrecision() { lowPrecision = true; }
+  void setLowPrecision(bool low = true) { lowPrecision = low; }
 
  private:
   
@@ -56,6 +56,7 @@ const FieldPerp LaplacePDD::solve(const FieldPerp &b) {
 }
 
 const Field3D LaplacePDD::solve(const Field3D &b) {
+  mesh->communicatePending(); // Guard cells needed
   Field3D x;
   x.allocate();
   FieldPerp xperp;
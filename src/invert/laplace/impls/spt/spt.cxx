@@ -113,6 +113,7 @@ const FieldPerp LaplaceSPT::solve(const FieldPerp &b, const FieldPerp &x0) {
  */
 const Field3D LaplaceSPT::solve(const Field3D &b) {
   Timer timer("invert");
+  mesh->communicatePending(); // Guard cells needed
   Field3D x;
   x.allocate();
   
@@ -147,6 +148,7 @@ const Field3D LaplaceSPT::solve(const Field3D &b) {
 }
 
 const Field3D LaplaceSPT::solve(const Field3D &b, const Field3D &x0) {
+  mesh->communicatePending(); // Guard cells needed
   if(  ((inner_boundary_flags & INVERT_SET) && mesh->firstX()) ||
        ((outer_boundary_flags & INVERT_SET) && mesh->lastX()) ) {
     Field3D bs = copy(b);
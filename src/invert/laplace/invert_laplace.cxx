@@ -128,6 +128,7 @@ const Field3D Laplacian::solve(const Field3D &b) {
 #ifdef CHECK
   msg_stack.push("Laplacian::solve(Field3D)");
 #endif
+  mesh->communicatePending(); // Guard cells needed
   int ys = mesh->ystart, ye = mesh->yend;
 
   if(mesh->hasBndryLowerY()) {
@@ -189,6 +190,7 @@ const Field3D Laplacian::solve(const Field3D &b, const Field3D &x0) {
 #ifdef CHECK
   msg_stack.push("Laplacian::solve(Field3D, Field3D)");
 #endif
+  mesh->communicatePending(); // Guard cells needed
 
   // Setting the start and end range of the y-slices
   int ys = mesh->ystart, ye = mesh->yend;
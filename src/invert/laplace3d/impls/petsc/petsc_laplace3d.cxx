@@ -12,6 +12,7 @@ Laplace3DPetsc::~Laplace3DPetsc() {
 }
 
 const Field3D Laplace3DPetsc::solve(const Field3D &b) {
+  mesh->communicatePending(); // Guard cells needed
   // Set matrix coefficients
   
   // Solve
@@ -512,6 +512,7 @@ LaplaceXY::~LaplaceXY() {
 
 const Field2D LaplaceXY::solve(const Field2D &rhs, const Field2D &x0) {
   Timer timer("invert");
+  mesh->communicatePending(); // Guard cells needed
   
   // Load initial guess x0 into xs and rhs into bs
   
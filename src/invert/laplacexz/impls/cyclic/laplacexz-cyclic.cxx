@@ -162,6 +162,10 @@ void LaplaceXZcyclic::setCoefs(const Field2D &A2D, const Field2D &B2D) {
 
 Field3D LaplaceXZcyclic::solve(const Field3D &rhs, const Field3D &x0) {
   Timer timer("invert");
+  mesh->communicatePending(); // Guard cells needed
+  
+  // Fourier coefficients are calculated and stored, if enabled
+  rhs.prepareZSpectrum();
   
   // Create the rhs array
   int ind = 0;
@@ -172,8 +176,8 @@ Field3D LaplaceXZcyclic::solve(const Field3D &rhs, const Field3D &x0) {
       
       if(inner_boundary_flags & INVERT_SET) {
         // Fourier transform x0 in Z at xstart-1 and xstart
-        rfft(&x0(mesh->xstart-1,y,0), mesh->LocalNz, k1d);
-        rfft(&x0(mesh->xstart,y,0), mesh->LocalNz, k1d_2);
+        x0.zSpectrum(mesh->xstart-1, y, k1d);
+        x0.zSpectrum(mesh->xstart, y, k1d_2);
         for(int kz = 0; kz < nmode; kz++) {
           // Use the same coefficients as applied to the solution
           // so can either set gradient or value
@@ -181,8 +185,8 @@ Field3D LaplaceXZcyclic::solve(const Field3D &rhs, const Field3D &x0) {
         }
       }else if(inner_boundary_flags & INVERT_RHS) {
         // Fourier transform rhs in Z at xstart-1 and xstart
-        rfft(&rhs(mesh->xstart-1,y,0), mesh->LocalNz, k1d);
-        rfft(&rhs(mesh->xstart,y,0), mesh->LocalNz, k1d_2);
+        rhs.zSpectrum(mesh->xstart-1, y, k1d);
+        rhs.zSpectrum(mesh->xstart, y, k1d_2);
         for(int kz = 0; kz < nmode; kz++) {
           // Use the same coefficients as applied to the solution
           // so can either set gradient or value
@@ -198,7 +202,7 @@ Field3D LaplaceXZcyclic::solve(const Field3D &rhs, const Field3D &x0) {
     // Bulk of the domain
     for(int x=mesh->xstart; x <= mesh->xend; x++) {
       // Fourier transform RHS
-      rfft(&rhs(x,y,0), mesh->LocalNz, k1d);
+      rhs.zSpectrum(x, y, k1d);
       for(int kz = 0; kz < nmode; kz++) {
         rhscmplx[ind + kz][x-xstart] = k1d[kz];
       }
@@ -209,8 +213,8 @@ Field3D LaplaceXZcyclic::solve(const Field3D &rhs, const Field3D &x0) {
       // Outer X boundary
       if(outer_boundary_flags & INVERT_SET) {
         // Fourier transform x0 in Z at xend and xend+1
-        rfft(&x0(mesh->xend,y,0), mesh->LocalNz, k1d);
-        rfft(&x0(mesh->xend+1,y,0), mesh->LocalNz, k1d_2);
+        x0.zSpectrum(mesh->xend, y, k1d);
+        x0.zSpectrum(mesh->xend+1, y, k1d_2);
         for(int kz = 0; kz < nmode; kz++) {
           // Use the same coefficients as applied to the solution
           // so can either set gradient or value
@@ -218,8 +222,8 @@ Field3D LaplaceXZcyclic::solve(const Field3D &rhs, const Field3D &x0) {
         }
       }else if(outer_boundary_flags & INVERT_RHS) {
         // Fourier transform rhs in Z at xstart-1 and xstart
-        rfft(&rhs(mesh->xend,y,0), mesh->LocalNz, k1d);
-        rfft(&rhs(mesh->xend+1,y,0), mesh->LocalNz, k1d_2);
+        rhs.zSpectrum(mesh->xend, y, k1d);
+        rhs.zSpectrum(mesh->xend+1, y, k1d_2);
         for(int kz = 0; kz < nmode; kz++) {
           // Use the same coefficients as applied to the solution
           // so can either set gradient or value
@@ -555,6 +555,7 @@ void LaplaceXZpetsc::setCoefs(const Field3D &Ain, const Field3D &Bin) {
 }
 
 Field3D LaplaceXZpetsc::solve(const Field3D &bin, const Field3D &x0in) {
+  mesh->communicatePending(); // Guard cells needed
   /* Function: LaplaceXZpetsc::solve
    * Purpose:  - Set the values of b in  Ax=b
    *           - Set the initial guess x0, and use this for x in  Ax=b
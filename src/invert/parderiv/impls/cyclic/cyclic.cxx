@@ -40,7 +40,6 @@
 #include "cyclic.hxx"
 #include <fft.hxx>
 #include <boutexception.hxx>
-#include <cyclic_reduction.hxx>
 #include <msg_stack.hxx>
 #include <bout/constants.hxx>
 
@@ -54,22 +53,46 @@ InvertParCR::InvertParCR(Options *opt) : InvertPar(opt), A(1.0), B(0.0), C(0.0),
 
   rhs = matrix<dcomplex>(mesh->LocalNy, nsys);
   
-  // Find out if we are on a boundary
-  int size = mesh->LocalNy-4;
+  // Count the flux surfaces
   SurfaceIter surf(mesh);
-  for(surf.first(); !surf.isDone(); surf.next()) {
-    BoutReal ts;
-    int n = mesh->LocalNy-4;
-    if(!surf.closed(ts)) {
+  nsurf = 0;
+  for(surf.first(); !surf.isDone(); surf.next())
+    nsurf++;
+  
+  surfaces = new Surface[nsurf];
+  
+  // Find out if we are on a boundary, and create a
+  // cyclic reduction object for each surface
+  int size = mesh->LocalNy-4;
+  int s = 0;
+  for(surf.first(); !surf.isDone(); surf.next(), s++) {
+    Surface &sf = surfaces[s];
+    sf.x = surf.xpos;
+    sf.closed = surf.closed(sf.ts);
+    sf.first = sf.last = false;
+    
+    // Number of rows
+    sf.y0 = 0;
+    sf.size = mesh->LocalNy-4; // If no boundaries
+    if(!sf.closed) {
       // Open field line
-      if(surf.firstY())
-        n += 2;
-      if(surf.lastY())
-        n += 2;
+      if(surf.firstY()) {
+        sf.first = true;
+        sf.y0 += 2;
+        sf.size += 2;
+      }
+      if(surf.lastY()) {
+        sf.last = true;
+        sf.size += 2;
+      }
       
-      if(n > size)
-        size = n; // Maximum size
+      if(sf.size > size)
+        size = sf.size; // Maximum size
     }
+    
+    sf.cr = new CyclicReduce<dcomplex>();
+    sf.cr->setup(surf.communicator(), sf.size);
+    sf.cr->setPeriodic(sf.closed);
   }
   
   rhsk = matrix<dcomplex>(nsys, size);
@@ -77,6 +100,8 @@ InvertParCR::InvertParCR(Options *opt) : InvertPar(opt), A(1.0), B(0.0), C(0.0),
   a = matrix<dcomplex>(nsys, size);
   b = matrix<dcomplex>(nsys, size);
   c = matrix<dcomplex>(nsys, size);
+  
+  coefs_set = false;
 }
 
 InvertParCR::~InvertParCR() {
@@ -87,47 +112,23 @@ InvertParCR::~InvertParCR() {
   free_matrix(a);
   free_matrix(b);
   free_matrix(c);
+  
+  for(int s=0;s<nsurf;s++)
+    delete surfaces[s].cr;
+  delete[] surfaces;
 }
 
-const Field3D InvertParCR::solve(const Field3D &f) {
-  TRACE("InvertParCR::solve(Field3D)");
-  
-  Field3D result;
-  result.allocate();
+void InvertParCR::setCoefs() {
+  TRACE("InvertParCR::setCoefs");
   
   Coordinates *coord = mesh->coordinates();
   
-  // Create cyclic reduction object
-  CyclicReduce<dcomplex> *cr = 
-    new CyclicReduce<dcomplex>();
-  
-  // Loop over flux-surfaces
   SurfaceIter surf(mesh);
-  for(surf.first(); !surf.isDone(); surf.next()) {
-    int x = surf.xpos;
-    
-    // Test if open or closed field-lines
-    BoutReal ts;
-    bool closed = surf.closed(ts);
-
-    // Number of rows
-    int y0 = 0, size = mesh->LocalNy-4; // If no boundaries
-    if(!closed) {
-      if(surf.firstY()) {
-        y0 += 2;
-        size += 2;
-      }
-      if(surf.lastY())
-        size += 2;
-    }
-      
-    // Setup CyclicReduce object
-    cr->setup(surf.communicator(), size);
-    cr->setPeriodic(closed);
-    
-    // Take Fourier transform 
-    for(int y=0;y<mesh->LocalNy-4;y++)
-      rfft(f(x,y+2), mesh->LocalNz, rhs[y+y0]);
+  int s = 0;
+  for(surf.first(); !surf.isDone(); surf.next(), s++) {
+    const Surface &sf = surfaces[s];
+    int x = sf.x;
+    int y0 = sf.y0, size = sf.size;
     
     // Set up tridiagonal system
     for(int k=0; k<nsys; k++) {
@@ -150,12 +151,10 @@ const Field3D InvertParCR::solve(const Field3D &f) {
 	a[k][y+y0] =            bcoef - 0.5*Im*kwave*ccoef                  -0.5*ecoef;
 	b[k][y+y0] = acoef - 2.*bcoef                     - SQ(kwave)*dcoef;
 	c[k][y+y0] =            bcoef + 0.5*Im*kwave*ccoef                  +0.5*ecoef;
-	
-	rhsk[k][y+y0] = rhs[y+y0][k]; // Transpose
       }
     }
 
-    if(closed) {
+    if(sf.closed) {
       // Twist-shift
       int rank, np;
       MPI_Comm_rank(surf.communicator(), &rank);
@@ -163,46 +162,96 @@ const Field3D InvertParCR::solve(const Field3D &f) {
       if(rank == 0) {
         for(int k=0; k<nsys; k++) {
           BoutReal kwave=k*2.0*PI/coord->zlength(); // wave number is 1/[rad]
-          dcomplex phase(cos(kwave*ts) , -sin(kwave*ts));
+          dcomplex phase(cos(kwave*sf.ts) , -sin(kwave*sf.ts));
           a[k][0] *= phase;
         }
       }
       if(rank == np-1) {
         for(int k=0; k<nsys; k++) {
           BoutReal kwave=k*2.0*PI/coord->zlength(); // wave number is 1/[rad]
-          dcomplex phase(cos(kwave*ts) , sin(kwave*ts));
+          dcomplex phase(cos(kwave*sf.ts) , sin(kwave*sf.ts));
           c[k][mesh->LocalNy-5] *= phase;
         }
       }
     }else {
       // Open surface, so may have boundaries
-      if(surf.firstY()) {
+      if(sf.first) {
         for(int k=0; k<nsys; k++) {
           for(int y=0;y<2;y++) {
             a[k][y] =  0.;
             b[k][y] =  1.;
             c[k][y] = -1.;
-            
-            rhsk[k][y] = 0.;
           }
         }
       }
-      if(surf.lastY()) {
+      if(sf.last) {
         for(int k=0; k<nsys; k++) {
           for(int y=size-2;y<size;y++) {
             a[k][y] = -1.;
             b[k][y] =  1.;
             c[k][y] =  0.;
-            
-            rhsk[k][y] = 0.;
           }
         }
       }
     }
     
-    // Solve cyclic tridiagonal system for each k
-    cr->setCoefs(nsys, a, b, c);
-    cr->solve(nsys, rhsk, xk);
+    // Coefficients are copied, so a,b,c can be re-used
+    sf.cr->setCoefs(nsys, a, b, c);
+  }
+  coefs_set = true;
+}
+
+const Field3D InvertParCR::solve(const Field3D &f) {
+  TRACE("InvertParCR::solve(Field3D)");
+  
+  if(!coefs_set)
+    setCoefs();
+  
+  Field3D result;
+  result.allocate();
+  
+  // The solve on each flux surface is split into stages, so that
+  // the communications for one surface overlap with work on the others
+  
+  // Transform and reduce the local equations, and start sending
+  // interface equations. The RHS is copied by solveStart so rhs
+  // and rhsk can be re-used for the next surface
+  for(int s=0;s<nsurf;s++) {
+    const Surface &sf = surfaces[s];
+    int x = sf.x, y0 = sf.y0;
+    
+    // Take Fourier transform 
+    for(int y=0;y<mesh->LocalNy-4;y++)
+      rfft(f(x,y+2), mesh->LocalNz, rhs[y+y0]);
+    
+    for(int k=0; k<nsys; k++) {
+      for(int y=0;y<mesh->LocalNy-4;y++)
+        rhsk[k][y+y0] = rhs[y+y0][k]; // Transpose
+      
+      // Boundary conditions
+      if(sf.first) {
+        for(int y=0;y<2;y++)
+          rhsk[k][y] = 0.;
+      }
+      if(sf.last) {
+        for(int y=sf.size-2;y<sf.size;y++)
+          rhsk[k][y] = 0.;
+      }
+    }
+    
+    sf.cr->solveStart(nsys, rhsk);
+  }
+  
+  // Solve the interface equations, start returning solutions
+  for(int s=0;s<nsurf;s++)
+    surfaces[s].cr->solveInterface();
+  
+  // Complete the solves and transform back
+  for(int s=0;s<nsurf;s++) {
+    const Surface &sf = surfaces[s];
+    int x = sf.x, y0 = sf.y0, size = sf.size;
+    
+    sf.cr->solveFinish(xk);
     
     // Put back into rhs array
     for(int k=0;k<nsys;k++) {
@@ -213,12 +262,7 @@ const Field3D InvertParCR::solve(const Field3D &f) {
     // Inverse Fourier transform 
     for(int y=0;y<size;y++)
       irfft(rhs[y], mesh->LocalNz, result(x,y+2-y0));
-    
   }
   
-  // Delete cyclic reduction object
-  delete cr;
-
   return result;
 }
-
@@ -41,6 +41,7 @@
 
 #include "invert_parderiv.hxx"
 #include "dcomplex.hxx"
+#include <cyclic_reduction.hxx>
 
 class InvertParCR : public InvertPar {
 public:
@@ -48,15 +49,31 @@ public:
   ~InvertParCR();
   const Field3D solve(const Field3D &f);
   
-  void setCoefA(const Field2D &f) {A = f;}
-  void setCoefB(const Field2D &f) {B = f;}
-  void setCoefC(const Field2D &f) {C = f;}
-  void setCoefD(const Field2D &f) {D = f;}
-  void setCoefE(const Field2D &f) {E = f;}
+  void setCoefA(const Field2D &f) {A = f; coefs_set = false;}
+  void setCoefB(const Field2D &f) {B = f; coefs_set = false;}
+  void setCoefC(const Field2D &f) {C = f; coefs_set = false;}
+  void setCoefD(const Field2D &f) {D = f; coefs_set = false;}
+  void setCoefE(const Field2D &f) {E = f; coefs_set = false;}
 private:
   Field2D A, B, C, D, E;
   
   int nsys;
+
+  /// A flux surface local to this processor
+  struct Surface {
+    int x;         ///< X index
+    bool closed;   ///< Closed field-lines?
+    BoutReal ts;   ///< Twist-shift angle if closed
+    bool first, last; ///< Contains lower, upper Y boundary?
+    int y0, size;  ///< Offset of first non-boundary point, number of rows
+    CyclicReduce<dcomplex> *cr; ///< Tridiagonal solver for this surface
+  };
+  int nsurf;          ///< Number of flux surfaces
+  Surface *surfaces;  ///< Array of flux surfaces
+  bool coefs_set;     ///< Have the matrix coefficients been given to the solvers?
+
+  /// Set the matrix coefficients of all surfaces from A,B,C,D,E
+  void setCoefs();
   
   dcomplex **rhs;
   dcomplex **rhsk;
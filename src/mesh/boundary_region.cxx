@@ -3,6 +3,24 @@
 #include <boundary_region.hxx>
 #include <utils.hxx>
 
+const std::vector<BoundaryPoint>& BoundaryRegion::points() {
+  if(!points_calculated) {
+    pts.clear();
+    for(first(); !isDone(); next1d()) {
+      BoundaryPoint p;
+      p.x = x;
+      p.y = y;
+      p.xnorm = 0.5*( mesh->GlobalX(x) + mesh->GlobalX(x - bx) );
+      p.ynorm = 0.5*( mesh->GlobalY(y) + mesh->GlobalY(y - by) );
+      pts.push_back(p);
+    }
+    points_calculated = true;
+  }
+  return pts;
+}
+
+///////////////////////////////////////////////////////////////
+
 BoundaryRegionXIn::BoundaryRegionXIn(const string &name, int ymin, int ymax)
   : BoundaryRegion(name, -1, 0), ys(ymin), ye(ymax)
 {
@@ -8,6 +8,7 @@
 #include <msg_stack.hxx>
 #include <bout/constants.hxx>
 #include <derivs.hxx>
+#include <bout/openmpwrap.hxx>
 
 // #define BOUNDARY_CONDITIONS_UPGRADE_EXTRAPOLATE_FOR_2ND_ORDER
 
@@ -103,6 +104,68 @@ void verifyNumPoints(BoundaryRegion *region, int ptsRequired) {
 
 ///////////////////////////////////////////////////////////////
 
+const BoutReal* BoundaryValues::get(BoundaryRegion *bndry, FieldGenerator *g, int layers, int n, BoutReal t) {
+  if(!g)
+    return nullptr;
+
+  // Programs are shared with FieldFactory, and are not thread-safe
+  BOUT_OMP(critical(FieldProgram))
+  {
+    FieldProgram *prog = FieldFactory::get()->program(g);
+
+    if(!valid || (g != gen) || (layers != nlayers) || (n != nz)
+       || (prog->timeDependent() && (t != time))) {
+      const std::vector<BoundaryPoint> &pts = bndry->points();
+      int np = static_cast<int>(pts.size());
+
+      data.resize(layers*np*n);
+
+      std::vector<BoutReal> zpos(n), xpos(np), ypos(np);
+      for(int k=0;k<n;k++)
+        zpos[k] = TWOPI*k / n;
+
+      for(int i=0;i<layers;i++) {
+        // Coordinates of each point in this layer
+        bool samex = true, samey = true;
+        for(int p=0;p<np;p++) {
+          if(i == 0) {
+            xpos[p] = pts[p].xnorm;
+            ypos[p] = TWOPI*pts[p].ynorm;
+          }else {
+            xpos[p] = mesh->GlobalX(pts[p].x + i*bndry->bx);
+            ypos[p] = TWOPI*mesh->GlobalY(pts[p].y + i*bndry->by);
+          }
+          samex &= (xpos[p] == xpos[0]);
+          samey &= (ypos[p] == ypos[0]);
+        }
+
+        BoutReal *out = data.data() + i*np*n;
+        if(np == 0) {
+          // Nothing to do
+        }else if(samex) {
+          // X boundary. Points are along Y
+          prog->evaluate(xpos.data(), 1, ypos.data(), np, zpos.data(), n, t, out);
+        }else if(samey) {
+          // Y boundary. Points are along X
+          prog->evaluate(xpos.data(), np, ypos.data(), 1, zpos.data(), n, t, out);
+        }else {
+          for(int p=0;p<np;p++)
+            prog->evaluate(&xpos[p], 1, &ypos[p], 1, zpos.data(), n, t, out + p*n);
+        }
+      }
+
+      gen = g;
+      nlayers = layers;
+      nz = n;
+      time = t;
+      valid = true;
+    }
+  }
+  return data.data();
+}
+
+///////////////////////////////////////////////////////////////
+
 BoundaryOp* BoundaryDirichlet::clone(BoundaryRegion *region, const list<string> &args){
   verifyNumPoints(region,1);
 
@@ -121,8 +184,6 @@ void BoundaryDirichlet::apply(Field2D &f){
 void BoundaryDirichlet::apply(Field2D &f,BoutReal t) {
   // Set (at 2nd order) the value at the mid-point between the guard cell and the grid cell to be val
   // N.B. Only first guard cells (closest to the grid) should ever be used
-  
-  bndry->first();
 
   // Decide which generator to use
   FieldGenerator* fg = gen;
@@ -137,6 +198,7 @@ void BoundaryDirichlet::apply(Field2D &f,BoutReal t) {
   CELL_LOC loc = f.getLocation();
   if(mesh->StaggerGrids && loc != CELL_CENTRE) {
     // Staggered. Need to apply slightly differently
+    bndry->first();
     
     if( loc == CELL_XLOW ) {
       // shifted in X
@@ -276,28 +338,24 @@ void BoundaryDirichlet::apply(Field2D &f,BoutReal t) {
     }
   } else {
     // Non-staggered, standard case
-    
-    for(; !bndry->isDone(); bndry->next1d()) {
-      
-      if(fg) {
-	// Calculate the X and Y normalised values half-way between the guard cell and grid cell 
-	BoutReal xnorm = 0.5*(   mesh->GlobalX(bndry->x)  // In the guard cell
-				 + mesh->GlobalX(bndry->x - bndry->bx) ); // the grid cell
-	
-	BoutReal ynorm = 0.5*(   mesh->GlobalY(bndry->y)  // In the guard cell
-				 + mesh->GlobalY(bndry->y - bndry->by) ); // the grid cell
-	
-	val = fg->generate(xnorm,TWOPI*ynorm,0.0, t);
-      }
-      
-      f(bndry->x,bndry->y) = 2*val - f(bndry->x-bndry->bx, bndry->y-bndry->by);
-			
+    const std::vector<BoundaryPoint> &pts = bndry->points();
+    int np = static_cast<int>(pts.size());
+    int bx = bndry->bx, by = bndry->by;
+
+    // Values half-way between the guard cell and grid cell, then in the other guard cells
+    const BoutReal *vals = values.get(bndry, fg, bndry->width, 1, t);
+
+    for(int p=0;p<np;p++) {
+      int x = pts[p].x, y = pts[p].y;
+      val = vals ? vals[p] : 0.0;
+      f(x,y) = 2*val - f(x-bx, y-by);
+
       // Need to set second guard cell, as may be used for interpolation or upwinding derivatives
       for(int i=1;i<bndry->width;i++) {
-	int xi = bndry->x + i*bndry->bx;
-	int yi = bndry->y + i*bndry->bx;						
-	f(xi, yi) = 2*f(xi - bndry->bx, yi - bndry->by) - f(xi - 2*bndry->bx, yi - 2*bndry->by);	
-      }	
+        int xi = x + i*bx;
+        int yi = y + i*by;
+        f(xi, yi) = 2*f(xi - bx, yi - by) - f(xi - 2*bx, yi - 2*by);
+      }
     }
   }
 }
@@ -311,8 +369,6 @@ void BoundaryDirichlet::apply(Field3D &f,BoutReal t) {
   // Set (at 2nd order) the value at the mid-point between the guard cell and the grid cell to be val
   // N.B. Only first guard cells (closest to the grid) should ever be used
 
-  bndry->first();
-
   // Decide which generator to use
   FieldGenerator* fg = gen;
   if(!fg)
@@ -325,6 +381,7 @@ void BoundaryDirichlet::apply(Field3D &f,BoutReal t) {
   CELL_LOC loc = f.getLocation();
   if(mesh->StaggerGrids && loc != CELL_CENTRE) {
     // Staggered. Need to apply slightly differently
+    bndry->first();
     
     if( loc == CELL_XLOW ) {
       // X boundary, and field is shifted in X
@@ -512,53 +569,46 @@ void BoundaryDirichlet::apply(Field3D &f,BoutReal t) {
   }
   else {
     // Standard (non-staggered) case
-    for(; !bndry->isDone(); bndry->next1d()) {
-      // Calculate the X and Y normalised values half-way between the guard cell and grid cell 
-      BoutReal xnorm = 0.5*(   mesh->GlobalX(bndry->x)  // In the guard cell
-			       + mesh->GlobalX(bndry->x - bndry->bx) ); // the grid cell
-
-      BoutReal ynorm = 0.5*(   mesh->GlobalY(bndry->y)  // In the guard cell
-			       + mesh->GlobalY(bndry->y - bndry->by) ); // the grid cell
-      
-      for(int zk=0;zk<mesh->LocalNz;zk++) {
-	if(fg){
-	  val = fg->generate(xnorm,TWOPI*ynorm,TWOPI*zk/(mesh->LocalNz), t);
-	}
-	f(bndry->x,bndry->y,zk) = 2*val - f(bndry->x-bndry->bx, bndry->y-bndry->by, zk);
-	// f(bndry->x,bndry->y,zk) = (8./3.)*val - 2.*f(bndry->x-bndry->bx, bndry->y-bndry->by,zk) + f(bndry->x-2*bndry->bx, bndry->y-2*bndry->by,zk)/3.;
-				
-				
-	// Need to set second guard cell, as may be used for interpolation or upwinding derivatives
-        /*
-	for(int i=1;i<bndry->width;i++) {
-	  int xi = bndry->x + i*bndry->bx;
-	  int yi = bndry->y + i*bndry->by;
-				
-	  f(xi, yi, zk) = 2*f(xi - bndry->bx, yi - bndry->by, zk) - f(xi - 2*bndry->bx, yi - 2*bndry->by, zk);
-	  // f(xi, yi, zk) = 3.0*f(xi - bndry->bx, yi - bndry->by, zk) - 3.0*f(xi - 2*bndry->bx, yi - 2*bndry->by, zk) + f(xi - 3*bndry->bx, yi - 3*bndry->by, zk);
-          
-	}
-        */			
-      }
-      
+    const std::vector<BoundaryPoint> &pts = bndry->points();
+    int np = static_cast<int>(pts.size());
+    int nz = mesh->LocalNz;
+    int bx = bndry->bx, by = bndry->by;
+
+    // Values half-way between the guard cell and grid cell, then in the other guard cells
+    const BoutReal *vals = values.get(bndry, fg, bndry->width, nz, t);
+
+    for(int p=0;p<np;p++) {
+      BoutReal *fb = f(pts[p].x, pts[p].y);           // In the guard cell
+      const BoutReal *fi = f(pts[p].x - bx, pts[p].y - by); // the grid cell
+
+      if(vals) {
+        const BoutReal *v = vals + p*nz;
+        BOUT_OMP_SIMD
+        for(int zk=0;zk<nz;zk++)
+          fb[zk] = 2*v[zk] - fi[zk];
+      }else {
+        BOUT_OMP_SIMD
+        for(int zk=0;zk<nz;zk++)
+          fb[zk] = -fi[zk];
+      }
+
+      // Set any other guard cells using the values on the cells
       for(int i=1;i<bndry->width;i++) {
-        // Set any other guard cells using the values on the cells
-        int xi = bndry->x + i*bndry->bx;
-        int yi = bndry->y + i*bndry->by;
-        xnorm = mesh->GlobalX(xi);
-        ynorm = mesh->GlobalY(yi);
-        for(int zk=0;zk<mesh->LocalNz;zk++) {
-          if(fg) {
-            val = fg->generate(xnorm,TWOPI*ynorm,TWOPI*zk/(mesh->LocalNz), t);
-          }
-          f(xi, yi, zk) = val;
+        BoutReal *fo = f(pts[p].x + i*bx, pts[p].y + i*by);
+        if(vals) {
+          const BoutReal *v = vals + (i*np + p)*nz;
+          BOUT_OMP_SIMD
+          for(int zk=0;zk<nz;zk++)
+            fo[zk] = v[zk];
+        }else {
+          for(int zk=0;zk<nz;zk++)
+            fo[zk] = 0.0;
         }
       }
     }
   }
 }
 
-
 void BoundaryDirichlet::apply_ddt(Field2D &f) {
   Field2D *dt = f.timeDeriv();
   for(bndry->first(); !bndry->isDone(); bndry->next())
@@ -567,9 +617,10 @@ void BoundaryDirichlet::apply_ddt(Field2D &f) {
 
 void BoundaryDirichlet::apply_ddt(Field3D &f) {
   Field3D *dt = f.timeDeriv();
-  for(bndry->first(); !bndry->isDone(); bndry->next())
+  // Loop over points() so that this can be used for several fields at once
+  for(const auto &pt : bndry->points())
     for(int z=0;z<mesh->LocalNz;z++)
-      (*dt)(bndry->x,bndry->y,z) = 0.; // Set time derivative to zero
+      (*dt)(pt.x,pt.y,z) = 0.; // Set time derivative to zero
 }
 
 
@@ -1829,8 +1880,6 @@ void BoundaryNeumann::apply(Field2D &f,BoutReal t) {
   
   Coordinates *metric = mesh->coordinates();
   
-  bndry->first();
-  
   // Decide which generator to use
   FieldGenerator* fg = gen;
   if(!fg)
@@ -1845,6 +1894,7 @@ void BoundaryNeumann::apply(Field2D &f,BoutReal t) {
     // Staggered. Need to apply slightly differently
     // Use one-sided differencing. Cell is now on
     // the boundary, so use one-sided differencing
+    bndry->first();
     
     if( loc == CELL_XLOW ) {
       // Field is shifted in X
@@ -1996,24 +2046,21 @@ void BoundaryNeumann::apply(Field2D &f,BoutReal t) {
   }
   else {
     // Non-staggered, standard case
-    
-    for(bndry->first(); !bndry->isDone(); bndry->next1d()) {
-      BoutReal delta = bndry->bx*metric->dx(bndry->x,bndry->y)+bndry->by*metric->dy(bndry->x,bndry->y);
-      
-      if(fg) {
-	// Calculate the X and Y normalised values half-way between the guard cell and grid cell 
-	BoutReal xnorm = 0.5*(   mesh->GlobalX(bndry->x)  // In the guard cell
-				 + mesh->GlobalX(bndry->x - bndry->bx) ); // the grid cell
-	
-	BoutReal ynorm = 0.5*(   mesh->GlobalY(bndry->y)  // In the guard cell
-				 + mesh->GlobalY(bndry->y - bndry->by) ); // the grid cell
-	
-	val = fg->generate(xnorm, TWOPI*ynorm, 0.0, t);
-      }
-      
-      f(bndry->x,bndry->y) = f(bndry->x-bndry->bx, bndry->y-bndry->by) + delta*val;
+    const std::vector<BoundaryPoint> &pts = bndry->points();
+    int np = static_cast<int>(pts.size());
+    int bx = bndry->bx, by = bndry->by;
+
+    // Gradient half-way between the guard cell and grid cell
+    const BoutReal *vals = values.get(bndry, fg, 1, 1, t);
+
+    for(int p=0;p<np;p++) {
+      int x = pts[p].x, y = pts[p].y;
+      BoutReal delta = bx*metric->dx(x,y) + by*metric->dy(x,y);
+      val = vals ? vals[p] : 0.0;
+
+      f(x,y) = f(x-bx, y-by) + delta*val;
       if (bndry->width == 2){
-	f(bndry->x + bndry->bx, bndry->y + bndry->by) = f(bndry->x - 2*bndry->bx, bndry->y - 2*bndry->by) + 3.0*delta*val;
+	f(x + bx, y + by) = f(x - 2*bx, y - 2*by) + 3.0*delta*val;
       }
     }
   }
@@ -2028,8 +2075,6 @@ void BoundaryNeumann::apply(Field3D &f) {
 void BoundaryNeumann::apply(Field3D &f,BoutReal t) {
   Coordinates *metric = mesh->coordinates();
   
-  bndry->first();
-  
   // Decide which generator to use
   FieldGenerator* fg = gen;
   if(!fg)
@@ -2044,6 +2089,7 @@ void BoundaryNeumann::apply(Field3D &f,BoutReal t) {
     // Staggered. Need to apply slightly differently
     // Use one-sided differencing. Cell is now on
     // the boundary, so use one-sided differencing
+    bndry->first();
     
     if( loc == CELL_XLOW ) {
       // Field is shifted in X
@@ -2203,24 +2249,42 @@ void BoundaryNeumann::apply(Field3D &f,BoutReal t) {
     }
   }
   else {
-    for(; !bndry->isDone(); bndry->next1d()) {
-      // Calculate the X and Y normalised values half-way between the guard cell and grid cell 
-      BoutReal xnorm = 0.5*(   mesh->GlobalX(bndry->x)  // In the guard cell
-			       + mesh->GlobalX(bndry->x - bndry->bx) ); // the grid cell
-      
-      BoutReal ynorm = 0.5*(   mesh->GlobalY(bndry->y)  // In the guard cell
-			       + mesh->GlobalY(bndry->y - bndry->by) ); // the grid cell
-      
-      BoutReal delta = bndry->bx*metric->dx(bndry->x,bndry->y)+bndry->by*metric->dy(bndry->x,bndry->y);
-      
-      for(int zk=0;zk<mesh->LocalNz;zk++) {
-	if(fg){
-	  val = fg->generate(xnorm,TWOPI*ynorm,TWOPI*zk/(mesh->LocalNz),t);
-	}
-	f(bndry->x,bndry->y, zk) = f(bndry->x-bndry->bx, bndry->y-bndry->by, zk) + delta*val;
-	if (bndry->width == 2){
-	  f(bndry->x + bndry->bx, bndry->y + bndry->by, zk) = f(bndry->x - 2*bndry->bx, bndry->y - 2*bndry->by, zk) + 3.0*delta*val;
-	}
+    const std::vector<BoundaryPoint> &pts = bndry->points();
+    int np = static_cast<int>(pts.size());
+    int nz = mesh->LocalNz;
+    int bx = bndry->bx, by = bndry->by;
+
+    // Gradient half-way between the guard cell and grid cell
+    const BoutReal *vals = values.get(bndry, fg, 1, nz, t);
+
+    for(int p=0;p<np;p++) {
+      int x = pts[p].x, y = pts[p].y;
+      BoutReal delta = bx*metric->dx(x,y) + by*metric->dy(x,y);
+
+      BoutReal *fb = f(x, y);
+      const BoutReal *fi = f(x - bx, y - by);
+      if(vals) {
+        const BoutReal *v = vals + p*nz;
+        BOUT_OMP_SIMD
+        for(int zk=0;zk<nz;zk++)
+          fb[zk] = fi[zk] + delta*v[zk];
+      }else {
+        for(int zk=0;zk<nz;zk++)
+          fb[zk] = fi[zk];
+      }
+
+      if (bndry->width == 2){
+        BoutReal *fo = f(x + bx, y + by);
+        const BoutReal *fi2 = f(x - 2*bx, y - 2*by);
+        if(vals) {
+          const BoutReal *v = vals + p*nz;
+          BOUT_OMP_SIMD
+          for(int zk=0;zk<nz;zk++)
+            fo[zk] = fi2[zk] + 3.0*delta*v[zk];
+        }else {
+          for(int zk=0;zk<nz;zk++)
+            fo[zk] = fi2[zk];
+        }
       }
     }
   }
@@ -2234,9 +2298,9 @@ void BoundaryNeumann::apply_ddt(Field2D &f) {
 
 void BoundaryNeumann::apply_ddt(Field3D &f) {
   Field3D *dt = f.timeDeriv();
-  for(bndry->first(); !bndry->isDone(); bndry->next())
+  for(const auto &pt : bndry->points())
     for(int z=0;z<mesh->LocalNz;z++)
-      (*dt)(bndry->x,bndry->y,z) = 0.; // Set time derivative to zero
+      (*dt)(pt.x,pt.y,z) = 0.; // Set time derivative to zero
 }
 
 ///////////////////////////////////////////////////////////////
@@ -3030,14 +3094,12 @@ void BoundaryFree_O2::apply(Field2D &f) {
 void BoundaryFree_O2::apply(Field3D &f) {
   // Extrapolate from the last evolved simulation cells into the guard cells at 3rd order.  
 
-  bndry->first();
-
-
   // Check for staggered grids
   
   CELL_LOC loc = f.getLocation();
   if(mesh->StaggerGrids && loc != CELL_CENTRE) {
     // Staggered. Need to apply slightly differently
+    bndry->first();
     
     if( loc == CELL_XLOW ) {
       // Field is shifted in X
@@ -3129,14 +3191,21 @@ void BoundaryFree_O2::apply(Field3D &f) {
   }
   else {
     // Standard (non-staggered) case
-    for(; !bndry->isDone(); bndry->next1d()) {
-			
-      for(int zk=0;zk<mesh->LocalNz;zk++) {
-	for(int i=0;i<bndry->width;i++) {
-	  int xi = bndry->x + i*bndry->bx;
-	  int yi = bndry->y + i*bndry->by;
-	  f(xi, yi, zk) = 2*f(xi - bndry->bx, yi -bndry->by, zk) - f(xi- 2*bndry->bx, yi - 2*bndry->by, zk);	
-	}
+    const std::vector<BoundaryPoint> &pts = bndry->points();
+    int np = static_cast<int>(pts.size());
+    int nz = mesh->LocalNz;
+    int bx = bndry->bx, by = bndry->by;
+
+    for(int p=0;p<np;p++) {
+      for(int i=0;i<bndry->width;i++) {
+        int xi = pts[p].x + i*bx;
+        int yi = pts[p].y + i*by;
+        BoutReal *fo = f(xi, yi);
+        const BoutReal *fi = f(xi - bx, yi - by);
+        const BoutReal *fi2 = f(xi - 2*bx, yi - 2*by);
+        BOUT_OMP_SIMD
+        for(int zk=0;zk<nz;zk++)
+          fo[zk] = 2*fi[zk] - fi2[zk];
       }
     }
   }
@@ -3150,10 +3219,9 @@ void BoundaryFree_O2::apply_ddt(Field2D &f) {
 
 void BoundaryFree_O2::apply_ddt(Field3D &f) {
   Field3D *dt = f.timeDeriv();
-  for(bndry->first(); !bndry->isDone(); bndry->next())
+  for(const auto &pt : bndry->points())
     for(int z=0;z<mesh->LocalNz;z++)
-      (*dt)(bndry->x,bndry->y,z) = 0.; // Set time derivative to zero
-
+      (*dt)(pt.x,pt.y,z) = 0.; // Set time derivative to zero
 }
 
 //////////////////////////////////
@@ -3268,14 +3336,12 @@ void BoundaryFree_O3::apply(Field2D &f) {
 void BoundaryFree_O3::apply(Field3D &f) {
   // Extrapolate from the last evolved simulation cells into the guard cells at 3rd order.  
 
-  bndry->first();
-
-
   // Check for staggered grids
   
   CELL_LOC loc = f.getLocation();
   if(mesh->StaggerGrids && loc != CELL_CENTRE) {
     // Staggered. Need to apply slightly differently
+    bndry->first();
     
     if( loc == CELL_XLOW ) {
       // Field is shifted in X
@@ -3374,15 +3440,22 @@ void BoundaryFree_O3::apply(Field3D &f) {
   }
   else {
     // Standard (non-staggered) case
-    for(; !bndry->isDone(); bndry->next1d()) {
-			
-      for(int zk=0;zk<mesh->LocalNz;zk++) {
-	for(int i=0;i<bndry->width;i++) {
-	  int xi = bndry->x + i*bndry->bx;
-	  int yi = bndry->y + i*bndry->by;
-	  f(xi, yi, zk) = 3.0*f(xi - bndry->bx, yi - bndry->by, zk) - 3.0*f(xi - 2*bndry->bx, yi - 2*bndry->by, zk) 
-	    + f(xi - 3*bndry->bx, yi - 3*bndry->by, zk);
-	}
+    const std::vector<BoundaryPoint> &pts = bndry->points();
+    int np = static_cast<int>(pts.size());
+    int nz = mesh->LocalNz;
+    int bx = bndry->bx, by = bndry->by;
+
+    for(int p=0;p<np;p++) {
+      for(int i=0;i<bndry->width;i++) {
+        int xi = pts[p].x + i*bx;
+        int yi = pts[p].y + i*by;
+        BoutReal *fo = f(xi, yi);
+        const BoutReal *fi = f(xi - bx, yi - by);
+        const BoutReal *fi2 = f(xi - 2*bx, yi - 2*by);
+        const BoutReal *fi3 = f(xi - 3*bx, yi - 3*by);
+        BOUT_OMP_SIMD
+        for(int zk=0;zk<nz;zk++)
+          fo[zk] = 3.0*fi[zk] - 3.0*fi2[zk] + fi3[zk];
       }
     }
   }
@@ -3396,10 +3469,9 @@ void BoundaryFree_O3::apply_ddt(Field2D &f) {
 
 void BoundaryFree_O3::apply_ddt(Field3D &f) {
   Field3D *dt = f.timeDeriv();
-  for(bndry->first(); !bndry->isDone(); bndry->next())
+  for(const auto &pt : bndry->points())
     for(int z=0;z<mesh->LocalNz;z++)
-      (*dt)(bndry->x,bndry->y,z) = 0.; // Set time derivative to zero
-
+      (*dt)(pt.x,pt.y,z) = 0.; // Set time derivative to zero
 }
 
 ///////////////////////////////////////////////////////////////
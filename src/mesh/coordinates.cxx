@@ -690,6 +690,7 @@ const Field2D Coordinates::Delp2(const Field2D &f) {
 
 const Field3D Coordinates::Delp2(const Field3D &f) {
   TRACE("Coordinates::Delp2( Field3D )");
+  mesh->communicatePending(); // Guard cells needed
 
   //return mesh->G1*DDX(f) + mesh->G3*DDZ(f) + mesh->g11*D2DX2(f) + mesh->g33*D2DZ2(f); //+ 2.0*mesh->g13*D2DXDZ(f)
 
@@ -707,13 +708,15 @@ const Field3D Coordinates::Delp2(const Field3D &f) {
     delft = matrix<dcomplex>(mesh->LocalNx, ncz/2 + 1);
   }
   
+  f.prepareZSpectrum(); // Calculate and store coefficients, if enabled
+  
   // Loop over all y indices
   for(int jy=0;jy<mesh->LocalNy;jy++) {
 
-    // Take forward FFT
+    // Take forward FFT (or use stored coefficients)
     
     for(int jx=0;jx<mesh->LocalNx;jx++)
-      rfft(&f(jx,jy,0), ncz, ft[jx]);
+      f.zSpectrum(jx, jy, ft[jx]);
 
     // Loop over kz
     for(int jz=0;jz<=ncz/2;jz++) {
@@ -46,6 +46,9 @@
 #include <bout/sys/timer.hxx>
 #include <msg_stack.hxx>
 #include <bout/constants.hxx>
+#include <field_factory.hxx>
+
+#include <algorithm>
 
 /// MPI type of BoutReal for communications
 #define PVEC_REAL_MPI_TYPE MPI_DOUBLE
@@ -85,6 +88,67 @@ BoutMesh::~BoutMesh() {
 
 }
 
+/// Offsets of processor domains from a comma-separated list of sizes.
+/// Returns an empty vector if the string is empty
+static vector<int> parseSizes(const string &str) {
+  vector<int> offset;
+  if(str.empty())
+    return offset;
+
+  offset.push_back(0);
+  for(const auto &size : strsplit(str, ',')) {
+    int n = stringToInt(trim(size));
+    if(n < 1)
+      throw BoutException("Invalid processor domain size '%s'", size.c_str());
+    offset.push_back(offset.back() + n);
+  }
+  return offset;
+}
+
+/// Offsets of nproc equally sized processor domains
+static vector<int> uniformSizes(int n, int nproc) {
+  vector<int> offset(nproc+1);
+  for(int i=0;i<=nproc;i++)
+    offset[i] = i * (n / nproc);
+  return offset;
+}
+
+/// Split cost.size() points into nproc blocks of at least minsize points,
+/// with approximately the same total cost in each block. Returns the
+/// start of each block, with the number of points as the last element
+static vector<int> balance(const vector<BoutReal> &cost, int nproc, int minsize) {
+  int n = cost.size();
+  if(n < nproc*minsize) {
+    throw BoutException("Can't split %d points between %d processors with at least %d points each",
+                        n, nproc, minsize);
+  }
+
+  vector<BoutReal> sum(n+1, 0.0); // Cumulative cost
+  for(int i=0;i<n;i++)
+    sum[i+1] = sum[i] + cost[i];
+
+  vector<int> offset(nproc+1);
+  offset[0] = 0;
+  offset[nproc] = n;
+  for(int k=1;k<nproc;k++) {
+    int j;
+    if(sum[n] > 0.0) {
+      // Boundary where the cumulative cost is closest to k/nproc of the total
+      BoutReal target = k*sum[n]/nproc;
+      j = std::lower_bound(sum.begin(), sum.end(), target) - sum.begin();
+      if((j > 0) && (target - sum[j-1] < sum[j] - target))
+        j--;
+    }else {
+      j = (k*n) / nproc;
+    }
+    // Leave enough points for this and the remaining processors
+    j = std::max(j, offset[k-1] + minsize);
+    j = std::min(j, n - (nproc-k)*minsize);
+    offset[k] = j;
+  }
+  return offset;
+}
+
 int BoutMesh::load() {
 #ifdef CHECK
   int msg = msg_stack.push("BoutMesh::load()");
@@ -196,104 +260,170 @@ int BoutMesh::load() {
     jyseps2_2 = ny - 1;
   }
 
-  if(options->isSet("NXPE")) { // Specified NXPE
-    options->get("NXPE", NXPE, 1); // Decomposition in the radial direction
-    if((NPES % NXPE) != 0) {
-      throw BoutException("Number of processors (%d) not divisible by NPs in x direction (%d)\n",
-                          NPES, NXPE);
-    }
+  /// MXG at each end needed for edge boundary regions
+  MX = nx - 2*MXG;
 
-    NYPE = NPES / NXPE;
-  }else {
-    // Choose NXPE
+  /// NOTE: No grid data reserved for Y boundary cells - copy from neighbours
+  MY = ny;
 
-    MX = nx - 2*MXG;
+  Options *meshopts = options->getSection("mesh");
+  bool load_balance;
+  OPTION(meshopts, load_balance, false); // Balance mesh:cost between processors
+  string xsizes, ysizes;
+  meshopts->get("xsizes", xsizes, ""); // Comma-separated sizes of X processor domains
+  meshopts->get("ysizes", ysizes, "");
+
+  if(!xsizes.empty() || !ysizes.empty()) {
+    // Sizes of processor domains given
+    xoffset = parseSizes(xsizes);
+    yoffset = parseSizes(ysizes);
+
+    if(xoffset.empty()) {
+      NYPE = yoffset.size() - 1;
+      if((NPES % NYPE) != 0) {
+        throw BoutException("Number of processors (%d) not divisible by NPs in y direction (%d)\n",
+                            NPES, NYPE);
+      }
+      xoffset = uniformSizes(MX, NPES / NYPE);
+    }
+    if(yoffset.empty()) {
+      NXPE = xoffset.size() - 1;
+      if((NPES % NXPE) != 0) {
+        throw BoutException("Number of processors (%d) not divisible by NPs in x direction (%d)\n",
+                            NPES, NXPE);
+      }
+      yoffset = uniformSizes(MY, NPES / NXPE);
+    }
+    NXPE = xoffset.size() - 1;
+    NYPE = yoffset.size() - 1;
 
-    NXPE = -1; // Best option
+    if(NXPE*NYPE != NPES) {
+      throw BoutException("mesh:xsizes and mesh:ysizes give %d x %d domains, but there are %d processors",
+                          NXPE, NYPE, NPES);
+    }
+    if(xoffset.back() != MX) {
+      throw BoutException("mesh:xsizes add up to %d, but there are %d X points", xoffset.back(), MX);
+    }
+    if(yoffset.back() != MY) {
+      throw BoutException("mesh:ysizes add up to %d, but there are %d Y points", yoffset.back(), MY);
+    }
+    for(int y : yCuts()) {
+      if(!std::binary_search(yoffset.begin(), yoffset.end(), y))
+        throw BoutException("mesh:ysizes must put a processor boundary at y = %d (branch cut)", y);
+    }
+  }else if(load_balance) {
+    loadBalance();
+  }else {
+    if(options->isSet("NXPE")) { // Specified NXPE
+      options->get("NXPE", NXPE, 1); // Decomposition in the radial direction
+      if((NPES % NXPE) != 0) {
+        throw BoutException("Number of processors (%d) not divisible by NPs in x direction (%d)\n",
+                            NPES, NXPE);
+      }
 
-    BoutReal ideal = sqrt(MX * NPES / ((double) ny)); // Results in square domains
+      NYPE = NPES / NXPE;
+    }else {
+      // Choose NXPE
 
-    output.write("Finding value for NXPE\n");
+      NXPE = -1; // Best option
 
-    for(int i=1; i<= NPES; i++) { // Loop over all possibilities
-      //output.write("Testing %d: %d, %d, %d, %d, %d\n",
-      //             i, NPES % i, MX % i, MX / i, ny % (NPES/i), ny / (NPES/i));
-      if( (NPES % i == 0) &&      // Processors divide equally
-          (MX % i == 0) &&        // Mesh in X divides equally
-    //      (MX / i >= MXG) &&      // Resulting mesh is large enough
-          (ny % (NPES/i) == 0) ) { // Mesh in Y divides equally
+      BoutReal ideal = sqrt(MX * NPES / ((double) ny)); // Results in square domains
 
-        output.write("\tCandidate value: %d\n", i);
+      output.write("Finding value for NXPE\n");
 
-        int nyp = NPES/i;
-        int ysub = ny / nyp;
+      for(int i=1; i<= NPES; i++) { // Loop over all possibilities
+        //output.write("Testing %d: %d, %d, %d, %d, %d\n",
+        //             i, NPES % i, MX % i, MX / i, ny % (NPES/i), ny / (NPES/i));
+        if( (NPES % i == 0) &&      // Processors divide equally
+            (MX % i == 0) &&        // Mesh in X divides equally
+      //      (MX / i >= MXG) &&      // Resulting mesh is large enough
+            (ny % (NPES/i) == 0) ) { // Mesh in Y divides equally
 
-        // Check size of Y mesh
-        if(ysub < MYG) {
-          output.write("\t -> ny/NYPE (%d/%d = %d) must be >= MYG (%d)\n", ny, nyp, ysub, MYG);
-          continue;
-        }
-        // Check branch cuts
-        if( (jyseps1_1+1) % ysub != 0 ) {
-          output.write("\t -> Leg region jyseps1_1+1 (%d) must be a multiple of MYSUB (%d)\n", jyseps1_1+1, ysub);
-          continue;
-        }
+          output.write("\tCandidate value: %d\n", i);
 
-        if(jyseps2_1 != jyseps1_2) {
-          // Double Null
+          int nyp = NPES/i;
+          int ysub = ny / nyp;
 
-          if( (jyseps2_1-jyseps1_1) % ysub != 0 ) {
-            output.write("\t -> Core region jyseps2_1-jyseps1_1 (%d-%d = %d) must be a multiple of MYSUB (%d)\n",
-                         jyseps2_1, jyseps1_1, jyseps2_1-jyseps1_1, ysub);
+          // Check size of Y mesh
+          if(ysub < MYG) {
+            output.write("\t -> ny/NYPE (%d/%d = %d) must be >= MYG (%d)\n", ny, nyp, ysub, MYG);
             continue;
           }
-
-          if( (jyseps2_2 - jyseps1_2) % ysub != 0 ) {
-            output.write("\t -> Core region jyseps2_2-jyseps1_2 (%d-%d = %d) must be a multiple of MYSUB (%d)\n",
-                         jyseps2_2, jyseps1_2, jyseps2_2-jyseps1_2, ysub);
+          // Check branch cuts
+          if( (jyseps1_1+1) % ysub != 0 ) {
+            output.write("\t -> Leg region jyseps1_1+1 (%d) must be a multiple of MYSUB (%d)\n", jyseps1_1+1, ysub);
             continue;
           }
 
-          // Check upper legs
-          if( (ny_inner - jyseps2_1-1) % ysub != 0 ) {
-            output.write("\t -> leg region ny_inner-jyseps2_1-1 (%d-%d-1 = %d) must be a multiple of MYSUB (%d)\n",
-                         ny_inner, jyseps2_1, ny_inner-jyseps2_1-1, ysub);
-            continue;
+          if(jyseps2_1 != jyseps1_2) {
+            // Double Null
+
+            if( (jyseps2_1-jyseps1_1) % ysub != 0 ) {
+              output.write("\t -> Core region jyseps2_1-jyseps1_1 (%d-%d = %d) must be a multiple of MYSUB (%d)\n",
+                           jyseps2_1, jyseps1_1, jyseps2_1-jyseps1_1, ysub);
+              continue;
+            }
+
+            if( (jyseps2_2 - jyseps1_2) % ysub != 0 ) {
+              output.write("\t -> Core region jyseps2_2-jyseps1_2 (%d-%d = %d) must be a multiple of MYSUB (%d)\n",
+                           jyseps2_2, jyseps1_2, jyseps2_2-jyseps1_2, ysub);
+              continue;
+            }
+
+            // Check upper legs
+            if( (ny_inner - jyseps2_1-1) % ysub != 0 ) {
+              output.write("\t -> leg region ny_inner-jyseps2_1-1 (%d-%d-1 = %d) must be a multiple of MYSUB (%d)\n",
+                           ny_inner, jyseps2_1, ny_inner-jyseps2_1-1, ysub);
+              continue;
+            }
+            if( (jyseps1_2-ny_inner+1) % ysub != 0 ) {
+              output.write("\t -> leg region jyseps1_2-ny_inner+1 (%d-%d+1 = %d) must be a multiple of MYSUB (%d)\n",
+                           jyseps1_2, ny_inner, jyseps1_2-ny_inner+1, ysub);
+              continue;
+            }
+          }else {
+            // Single Null
+            if( (jyseps2_2-jyseps1_1) % ysub != 0 ) {
+              output.write("\t -> Core region jyseps2_2-jyseps1_1 (%d-%d = %d) must be a multiple of MYSUB (%d)\n",
+                           jyseps2_2, jyseps1_1, jyseps2_2-jyseps1_1, ysub);
+              continue;
+            }
           }
-          if( (jyseps1_2-ny_inner+1) % ysub != 0 ) {
-            output.write("\t -> leg region jyseps1_2-ny_inner+1 (%d-%d+1 = %d) must be a multiple of MYSUB (%d)\n",
-                         jyseps1_2, ny_inner, jyseps1_2-ny_inner+1, ysub);
-            continue;
-          }
-        }else {
-          // Single Null
-          if( (jyseps2_2-jyseps1_1) % ysub != 0 ) {
-            output.write("\t -> Core region jyseps2_2-jyseps1_1 (%d-%d = %d) must be a multiple of MYSUB (%d)\n",
-                         jyseps2_2, jyseps1_1, jyseps2_2-jyseps1_1, ysub);
+
+          if( (ny - jyseps2_2 - 1) % ysub != 0) {
+            output.write("\t -> leg region ny-jyseps2_2-1 (%d-%d-1 = %d) must be a multiple of MYSUB (%d)\n",
+                         ny, jyseps2_2, ny - jyseps2_2 - 1, ysub);
             continue;
           }
+          output.write("\t -> Good value\n");
+          // Found an acceptable value
+          if((NXPE < 1) ||
+             (fabs(ideal - i) < fabs(ideal - NXPE)))
+            NXPE = i; // Keep value nearest to the ideal
         }
-
-        if( (ny - jyseps2_2 - 1) % ysub != 0) {
-          output.write("\t -> leg region ny-jyseps2_2-1 (%d-%d-1 = %d) must be a multiple of MYSUB (%d)\n",
-                       ny, jyseps2_2, ny - jyseps2_2 - 1, ysub);
-          continue;
-        }
-        output.write("\t -> Good value\n");
-        // Found an acceptable value
-        if((NXPE < 1) ||
-           (fabs(ideal - i) < fabs(ideal - NXPE)))
-          NXPE = i; // Keep value nearest to the ideal
       }
-    }
 
-    if(NXPE < 1)
-      throw BoutException("Could not find a valid value for NXPE");
+      if(NXPE < 1)
+        throw BoutException("Could not find a valid value for NXPE");
 
-    NYPE = NPES / NXPE;
+      NYPE = NPES / NXPE;
 
-    output.write("\tDomain split (%d, %d) into domains (%d, %d)\n",
-                 NXPE, NYPE, MX / NXPE, ny / NYPE);
+      output.write("\tDomain split (%d, %d) into domains (%d, %d)\n",
+                   NXPE, NYPE, MX / NXPE, ny / NYPE);
+    }
+
+    /// Split MX points between NXPE processors
+    if((MX % NXPE) != 0) {
+      throw BoutException("Cannot split %d X points equally between %d processors\n",
+                          MX, NXPE);
+    }
+    xoffset = uniformSizes(MX, NXPE);
+
+    if((MY % NYPE) != 0) {
+      throw BoutException("\tERROR: Cannot split %d Y points equally between %d processors\n",
+                          MY, NYPE);
+    }
+    yoffset = uniformSizes(MY, NYPE);
   }
 
   /// Get X and Y processor indices
@@ -302,23 +432,8 @@ int BoutMesh::load() {
 
   // Work out other grid size quantities
 
-  /// MXG at each end needed for edge boundary regions
-  MX = nx - 2*MXG;
-
-  /// Split MX points between NXPE processors
-  MXSUB = MX / NXPE;
-  if((MX % NXPE) != 0) {
-    throw BoutException("Cannot split %d X points equally between %d processors\n",
-                            MX, NXPE);
-  }
-
-  /// NOTE: No grid data reserved for Y boundary cells - copy from neighbours
-  MY = ny;
-  MYSUB = MY / NYPE;
-  if((MY % NYPE) != 0) {
-    throw BoutException("\tERROR: Cannot split %d Y points equally between %d processors\n",
-                        MY, NYPE);
-  }
+  MXSUB = xoffset[PE_XIND+1] - xoffset[PE_XIND];
+  MYSUB = yoffset[PE_YIND+1] - yoffset[PE_YIND];
 
   /// Get mesh options
   OPTION(options, IncIntShear,  false);
@@ -328,8 +443,8 @@ int BoutMesh::load() {
 
   // Set global offsets
 
-  OffsetX = PE_XIND*MXSUB;
-  OffsetY = PE_YIND*MYSUB;
+  OffsetX = xoffset[PE_XIND];
+  OffsetY = yoffset[PE_YIND];
   OffsetZ = 0;
   
   if(options->isSet("zperiod")) {
@@ -787,12 +902,13 @@ const int OUT_SENT_IN  = 5; ///< Data going in negative X direction (out to in)
 void BoutMesh::post_receive(CommHandle &ch) {
   BoutReal *inbuff;
   int len;
+  int xwidth = ch.xwidth, ywidth = ch.ywidth;
 
   /// Post receive data from above (y+1)
 
   len = 0;
-  if(UDATA_INDEST != -1) {
-    len = msg_len(ch.var_list.get(), 0, UDATA_XSPLIT, 0, MYG);
+  if((UDATA_INDEST != -1) && (ywidth > 0)) {
+    len = msg_len(ch.var_list.get(), 0, UDATA_XSPLIT, 0, ywidth);
     MPI_Irecv(ch.umsg_recvbuff,
               len,
               PVEC_REAL_MPI_TYPE,
@@ -801,10 +917,10 @@ void BoutMesh::post_receive(CommHandle &ch) {
               BoutComm::get(),
               &ch.request[0]);
   }
-  if(UDATA_OUTDEST != -1) {
+  if((UDATA_OUTDEST != -1) && (ywidth > 0)) {
     inbuff = &ch.umsg_recvbuff[len]; // pointer to second half of the buffer
     MPI_Irecv(inbuff,
-              msg_len(ch.var_list.get(), UDATA_XSPLIT, LocalNx, 0, MYG),
+              msg_len(ch.var_list.get(), UDATA_XSPLIT, LocalNx, 0, ywidth),
               PVEC_REAL_MPI_TYPE,
               UDATA_OUTDEST,
               OUT_SENT_DOWN,
@@ -816,8 +932,8 @@ void BoutMesh::post_receive(CommHandle &ch) {
 
   len = 0;
 
-  if(DDATA_INDEST != -1) { // If sending & recieving data from a processor
-    len = msg_len(ch.var_list.get(), 0, DDATA_XSPLIT, 0, MYG);
+  if((DDATA_INDEST != -1) && (ywidth > 0)) { // If sending & recieving data from a processor
+    len = msg_len(ch.var_list.get(), 0, DDATA_XSPLIT, 0, ywidth);
     MPI_Irecv(ch.dmsg_recvbuff,
               len,
               PVEC_REAL_MPI_TYPE,
@@ -826,10 +942,10 @@ void BoutMesh::post_receive(CommHandle &ch) {
               BoutComm::get(),
               &ch.request[2]);
   }
-  if(DDATA_OUTDEST != -1) {
+  if((DDATA_OUTDEST != -1) && (ywidth > 0)) {
     inbuff = &ch.dmsg_recvbuff[len];
     MPI_Irecv(inbuff,
-              msg_len(ch.var_list.get(), DDATA_XSPLIT, LocalNx, 0, MYG),
+              msg_len(ch.var_list.get(), DDATA_XSPLIT, LocalNx, 0, ywidth),
               PVEC_REAL_MPI_TYPE,
               DDATA_OUTDEST,
               OUT_SENT_UP,
@@ -839,9 +955,9 @@ void BoutMesh::post_receive(CommHandle &ch) {
 
   /// Post receive data from left (x-1)
 
-  if(IDATA_DEST != -1) {
+  if((IDATA_DEST != -1) && (xwidth > 0)) {
     MPI_Irecv(ch.imsg_recvbuff,
-              msg_len(ch.var_list.get(), 0, MXG, 0, MYSUB),
+              msg_len(ch.var_list.get(), 0, xwidth, 0, MYSUB),
               PVEC_REAL_MPI_TYPE,
               IDATA_DEST,
               OUT_SENT_IN,
@@ -851,9 +967,9 @@ void BoutMesh::post_receive(CommHandle &ch) {
 
   // Post receive data from right (x+1)
 
-  if(ODATA_DEST != -1) {
+  if((ODATA_DEST != -1) && (xwidth > 0)) {
     MPI_Irecv(ch.omsg_recvbuff,
-              msg_len(ch.var_list.get(), 0, MXG, 0, MYSUB),
+              msg_len(ch.var_list.get(), 0, xwidth, 0, MYSUB),
               PVEC_REAL_MPI_TYPE,
               ODATA_DEST,
               IN_SENT_OUT,
@@ -863,16 +979,27 @@ void BoutMesh::post_receive(CommHandle &ch) {
 }
 
 comm_handle BoutMesh::send(FieldGroup &g) {
+  return sendWidth(g, MXG, MYG);
+}
+
+comm_handle BoutMesh::sendWidth(FieldGroup &g, int xwidth, int ywidth) {
+  if((xwidth < 0) || (xwidth > MXG) || (ywidth < 0) || (ywidth > MYG)) {
+    throw BoutException("BoutMesh::sendWidth: Can't send %d X and %d Y guard cells (MXG = %d, MYG = %d)",
+                        xwidth, ywidth, MXG, MYG);
+  }
+  
   /// Start timer
   Timer timer("comms");
   
   /// Work out length of buffer needed
-  int xlen = msg_len(g.get(), 0, MXG, 0, MYSUB);
-  int ylen = msg_len(g.get(), 0, LocalNx, 0, MYG);
+  int xlen = msg_len(g.get(), 0, xwidth, 0, MYSUB);
+  int ylen = msg_len(g.get(), 0, LocalNx, 0, ywidth);
 
   /// Get a communications handle of (at least) the needed size
   CommHandle *ch = get_handle(xlen, ylen);
   ch->var_list = g; // Group of fields to send
+  ch->xwidth = xwidth;
+  ch->ywidth = ywidth;
 
   /// Post receives
   post_receive(*ch);
@@ -884,8 +1011,8 @@ comm_handle BoutMesh::send(FieldGroup &g) {
   int len = 0;
   BoutReal *outbuff;
 
-  if(UDATA_INDEST != -1) { // If there is a destination for inner x data
-    len = pack_data(ch->var_list.get(), 0, UDATA_XSPLIT, MYSUB, MYSUB+MYG, ch->umsg_sendbuff);
+  if((UDATA_INDEST != -1) && (ywidth > 0)) { // If there is a destination for inner x data
+    len = pack_data(ch->var_list.get(), 0, UDATA_XSPLIT, MYSUB+MYG-ywidth, MYSUB+MYG, ch->umsg_sendbuff);
     // Send the data to processor UDATA_INDEST
 
     if(async_send) {
@@ -904,10 +1031,10 @@ comm_handle BoutMesh::send(FieldGroup &g) {
                IN_SENT_UP,
                BoutComm::get());
   }
-  if(UDATA_OUTDEST != -1) { // if destination for outer x data
+  if((UDATA_OUTDEST != -1) && (ywidth > 0)) { // if destination for outer x data
     outbuff = &(ch->umsg_sendbuff[len]); // A pointer to the start of the second part
                                    // of the buffer
-    len = pack_data(ch->var_list.get(), UDATA_XSPLIT, LocalNx, MYSUB, MYSUB+MYG, outbuff);
+    len = pack_data(ch->var_list.get(), UDATA_XSPLIT, LocalNx, MYSUB+MYG-ywidth, MYSUB+MYG, outbuff);
     // Send the data to processor UDATA_OUTDEST
     if(async_send) {
       MPI_Isend(outbuff,
@@ -929,8 +1056,8 @@ comm_handle BoutMesh::send(FieldGroup &g) {
   /// Send data going down (y-1)
 
   len = 0;
-  if(DDATA_INDEST != -1) { // If there is a destination for inner x data
-    len = pack_data(ch->var_list.get(), 0, DDATA_XSPLIT, MYG, 2*MYG, ch->dmsg_sendbuff);
+  if((DDATA_INDEST != -1) && (ywidth > 0)) { // If there is a destination for inner x data
+    len = pack_data(ch->var_list.get(), 0, DDATA_XSPLIT, MYG, MYG+ywidth, ch->dmsg_sendbuff);
     // Send the data to processor DDATA_INDEST
     if(async_send) {
       MPI_Isend(ch->dmsg_sendbuff,
@@ -948,10 +1075,10 @@ comm_handle BoutMesh::send(FieldGroup &g) {
                IN_SENT_DOWN,
                BoutComm::get());
   }
-  if(DDATA_OUTDEST != -1) { // if destination for outer x data
+  if((DDATA_OUTDEST != -1) && (ywidth > 0)) { // if destination for outer x data
     outbuff = &(ch->dmsg_sendbuff[len]); // A pointer to the start of the second part
                                    // of the buffer
-    len = pack_data(ch->var_list.get(), DDATA_XSPLIT, LocalNx, MYG, 2*MYG, outbuff);
+    len = pack_data(ch->var_list.get(), DDATA_XSPLIT, LocalNx, MYG, MYG+ywidth, outbuff);
     // Send the data to processor DDATA_OUTDEST
 
     if(async_send) {
@@ -973,8 +1100,8 @@ comm_handle BoutMesh::send(FieldGroup &g) {
 
   /// Send to the left (x-1)
 
-  if(IDATA_DEST != -1) {
-    len = pack_data(ch->var_list.get(), MXG, 2*MXG, MYG, MYG+MYSUB, ch->imsg_sendbuff);
+  if((IDATA_DEST != -1) && (xwidth > 0)) {
+    len = pack_data(ch->var_list.get(), MXG, MXG+xwidth, MYG, MYG+MYSUB, ch->imsg_sendbuff);
     if(async_send) {
       MPI_Isend(ch->imsg_sendbuff,
                 len,
@@ -994,8 +1121,8 @@ comm_handle BoutMesh::send(FieldGroup &g) {
 
   /// Send to the right (x+1)
 
-  if(ODATA_DEST != -1) {
-    len = pack_data(ch->var_list.get(), MXSUB, MXSUB+MXG, MYG, MYG+MYSUB, ch->omsg_sendbuff);
+  if((ODATA_DEST != -1) && (xwidth > 0)) {
+    len = pack_data(ch->var_list.get(), MXSUB+MXG-xwidth, MXSUB+MXG, MYG, MYG+MYSUB, ch->omsg_sendbuff);
     if(async_send) {
       MPI_Isend(ch->omsg_sendbuff,
                 len,
@@ -1047,33 +1174,34 @@ int BoutMesh::wait(comm_handle handle) {
     return 0;
   }
 
+  int xwidth = ch->xwidth, ywidth = ch->ywidth;
   do {
     MPI_Waitany(6, ch->request, &ind, &status);
     switch(ind) {
     case 0: { // Up, inner
-      unpack_data(ch->var_list.get(), 0, UDATA_XSPLIT, MYSUB+MYG, MYSUB+2*MYG, ch->umsg_recvbuff);
+      unpack_data(ch->var_list.get(), 0, UDATA_XSPLIT, MYSUB+MYG, MYSUB+MYG+ywidth, ch->umsg_recvbuff);
       break;
     }
     case 1: { // Up, outer
-      len = msg_len(ch->var_list.get(), 0, UDATA_XSPLIT, 0, MYG);
-      unpack_data(ch->var_list.get(), UDATA_XSPLIT, LocalNx, MYSUB+MYG, MYSUB+2*MYG, &(ch->umsg_recvbuff[len]));
+      len = msg_len(ch->var_list.get(), 0, UDATA_XSPLIT, 0, ywidth);
+      unpack_data(ch->var_list.get(), UDATA_XSPLIT, LocalNx, MYSUB+MYG, MYSUB+MYG+ywidth, &(ch->umsg_recvbuff[len]));
       break;
     }
     case 2: { // Down, inner
-      unpack_data(ch->var_list.get(), 0, DDATA_XSPLIT, 0, MYG, ch->dmsg_recvbuff);
+      unpack_data(ch->var_list.get(), 0, DDATA_XSPLIT, MYG-ywidth, MYG, ch->dmsg_recvbuff);
       break;
     }
     case 3: { // Down, outer
-      len = msg_len(ch->var_list.get(), 0, DDATA_XSPLIT, 0, MYG);
-      unpack_data(ch->var_list.get(), DDATA_XSPLIT, LocalNx, 0, MYG, &(ch->dmsg_recvbuff[len]));
+      len = msg_len(ch->var_list.get(), 0, DDATA_XSPLIT, 0, ywidth);
+      unpack_data(ch->var_list.get(), DDATA_XSPLIT, LocalNx, MYG-ywidth, MYG, &(ch->dmsg_recvbuff[len]));
       break;
     }
     case 4: { // inner
-      unpack_data(ch->var_list.get(), 0, MXG, MYG, MYG+MYSUB, ch->imsg_recvbuff);
+      unpack_data(ch->var_list.get(), MXG-xwidth, MXG, MYG, MYG+MYSUB, ch->imsg_recvbuff);
       break;
     }
     case 5: { // outer
-      unpack_data(ch->var_list.get(), MXSUB+MXG, MXSUB+2*MXG, MYG, MYG+MYSUB, ch->omsg_recvbuff);
+      unpack_data(ch->var_list.get(), MXSUB+MXG, MXSUB+MXG+xwidth, MYG, MYG+MYSUB, ch->omsg_recvbuff);
       break;
     }
     }
@@ -1083,24 +1211,12 @@ int BoutMesh::wait(comm_handle handle) {
 
   if(async_send) {
     /// Asyncronous sending: Need to check if sends have completed (frees MPI memory)
-    MPI_Status status;
-
-    if(UDATA_INDEST != -1)
-      MPI_Wait(ch->sendreq, &status);
-    if(UDATA_OUTDEST != -1)
-      MPI_Wait(ch->sendreq+1, &status);
-    if(DDATA_INDEST != -1)
-      MPI_Wait(ch->sendreq+2, &status);
-    if(DDATA_OUTDEST != -1)
-      MPI_Wait(ch->sendreq+3, &status);
-    if(IDATA_DEST != -1)
-      MPI_Wait(ch->sendreq+4, &status);
-    if(ODATA_DEST != -1)
-      MPI_Wait(ch->sendreq+5, &status);
+    /// Requests for messages which were not sent are MPI_REQUEST_NULL
+    MPI_Waitall(6, ch->sendreq, MPI_STATUSES_IGNORE);
   }
 
   // TWIST-SHIFT CONDITION
-  if(TwistShift) {
+  if(TwistShift && (ywidth > 0)) {
     int jx, jy;
 
     // Perform Twist-shift using shifting method 
@@ -1109,24 +1225,24 @@ int BoutMesh::wait(comm_handle handle) {
       // Lower boundary
       if(TS_down_in && (DDATA_INDEST  != -1)) {
         for(jx=0;jx<DDATA_XSPLIT;jx++)
-          for(jy=0;jy != MYG; jy++)
+          for(jy=MYG-ywidth;jy != MYG; jy++)
             shiftZ(*var, jx, jy, ShiftAngle[jx]);
       }
       if(TS_down_out && (DDATA_OUTDEST  != -1)) {
         for(jx=DDATA_XSPLIT;jx<LocalNx; jx++)
-          for(jy=0;jy != MYG; jy++)
+          for(jy=MYG-ywidth;jy != MYG; jy++)
             shiftZ(*var, jx, jy, ShiftAngle[jx]);
       }
       
       // Upper boundary
       if(TS_up_in && (UDATA_INDEST  != -1)) {
         for(jx=0;jx<UDATA_XSPLIT; jx++)
-          for(jy=LocalNy-MYG;jy != LocalNy; jy++)
+          for(jy=LocalNy-MYG;jy != LocalNy-MYG+ywidth; jy++)
             shiftZ(*var, jx, jy, -ShiftAngle[jx]);
       }
       if(TS_up_out && (UDATA_OUTDEST  != -1)) {
         for(jx=UDATA_XSPLIT;jx<LocalNx; jx++)
-          for(jy=LocalNy-MYG;jy != LocalNy; jy++)
+          for(jy=LocalNy-MYG;jy != LocalNy-MYG+ywidth; jy++)
             shiftZ(*var, jx, jy, -ShiftAngle[jx]);
       }
     }
@@ -1138,6 +1254,12 @@ int BoutMesh::wait(comm_handle handle) {
     var->doneComms();
 #endif
 
+  if((xwidth == MXG) && (ywidth == MYG)) {
+    // All guard cells now up to date
+    for(const auto& var : ch->var_list)
+      var->setGuardsValid(true);
+  }
+
   free_handle(ch);
 
   return 0;
@@ -1525,60 +1647,220 @@ int BoutMesh::PROC_NUM(int xind, int yind)
 /// Returns true if the given grid-point coordinates are in this processor
 bool BoutMesh::IS_MYPROC(int xind, int yind)
 {
-  return ((xind / MXSUB) == PE_XIND) && ((yind / MYSUB) == PE_YIND);
+  return (xind >= xoffset[PE_XIND]) && (xind < xoffset[PE_XIND+1])
+    && (yind >= yoffset[PE_YIND]) && (yind < yoffset[PE_YIND+1]);
 }
 
 /// Returns the global X index given a local index
 int BoutMesh::XGLOBAL(int xloc) const {
-  return xloc + PE_XIND * MXSUB;
+  return xloc + OffsetX;
 }
 
 /// Returns the global X index given a local index
 int BoutMesh::XGLOBAL(BoutReal xloc, BoutReal &xglo) const {
-  xglo = xloc + PE_XIND * MXSUB;
+  xglo = xloc + OffsetX;
   return xglo;
 }
 
 /// Returns a local X index given a global index
 int BoutMesh::XLOCAL(int xglo) const {
-  return xglo - PE_XIND * MXSUB;
+  return xglo - OffsetX;
 }
 
 /// Returns the global Y index given a local index
 int BoutMesh::YGLOBAL(int yloc) const {
-  return yloc + PE_YIND*MYSUB - MYG;
+  return yloc + OffsetY - MYG;
 }
 
 /// Returns the global Y index given a local index
 int BoutMesh::YGLOBAL(BoutReal yloc, BoutReal &yglo) const {
-  yglo = yloc + PE_YIND*MYSUB - MYG;
+  yglo = yloc + OffsetY - MYG;
   return yglo;
 }
 
 /// Global Y index given local index and processor
 int BoutMesh::YGLOBAL(int yloc, int yproc) const {
-  return yloc + yproc*MYSUB - MYG;
+  return yloc + yoffset[yproc] - MYG;
 }
 
 /// Returns a local Y index given a global index
 int BoutMesh::YLOCAL(int yglo) const {
-  return yglo - PE_YIND*MYSUB + MYG;
+  return yglo - OffsetY + MYG;
 }
 
 int BoutMesh::YLOCAL(int yglo, int yproc) const {
-  return yglo - yproc*MYSUB + MYG;
+  return yglo - yoffset[yproc] + MYG;
 }
 
 /// Return the Y processor number given a global Y index
 int BoutMesh::YPROC(int yind) {
   if((yind < 0) || (yind > ny))
     return -1;
-  return yind / MYSUB;
+  return std::upper_bound(yoffset.begin(), yoffset.end(), yind) - yoffset.begin() - 1;
 }
 
 /// Return the X processor number given a global X index
 int BoutMesh::XPROC(int xind) {
-  return (xind >= MXG) ? (xind - MXG) / MXSUB : 0;
+  if(xind < MXG)
+    return 0;
+  return std::upper_bound(xoffset.begin(), xoffset.end(), xind - MXG) - xoffset.begin() - 1;
+}
+
+/****************************************************************
+ *                 NON-UNIFORM DECOMPOSITION
+ ****************************************************************/
+
+/// Choose processor domains so that each has about the same total
+/// cost, given by the mesh:cost expression. This is a function of the
+/// global x index (including boundary cells) and global y index.
+/// Domains in X are the same for all Y processors, and vice versa,
+/// so neighbouring processors always have matching boundaries.
+void BoutMesh::loadBalance() {
+  Options *meshopts = Options::getRoot()->getSection("mesh");
+  string cost_str;
+  meshopts->get("cost", cost_str, "1");
+
+  output.write("Load balancing with cost = %s\n", cost_str.c_str());
+
+  // Cost of each point, in the order [x][y]
+  vector<BoutReal> xind(nx), yind(ny), cost(nx*ny);
+  for(int i=0;i<nx;i++)
+    xind[i] = i;
+  for(int j=0;j<ny;j++)
+    yind[j] = j;
+  BoutReal zind = 0.0;
+
+  FieldProgram prog(FieldFactory::get()->parse(cost_str));
+  prog.evaluate(xind.data(), nx, yind.data(), ny, &zind, 1, 0.0, cost.data());
+
+  // Total cost of each X and Y index in the domain
+  vector<BoutReal> xcost(MX, 0.0), ycost(MY, 0.0);
+  for(int i=0;i<MX;i++)
+    for(int j=0;j<MY;j++) {
+      BoutReal c = cost[(i+MXG)*ny + j];
+      if(!(c >= 0.0))
+        throw BoutException("mesh:cost must be >= 0, but is %e at x = %d, y = %d", c, i+MXG, j);
+      xcost[i] += c;
+      ycost[j] += c;
+    }
+
+  // Y processor domains can't cross branch cuts
+  vector<int> cuts = yCuts();
+  int nregions = cuts.size() - 1;
+  for(int r=0;r<nregions;r++) {
+    if(cuts[r+1] - cuts[r] < MYG)
+      throw BoutException("Y region %d <= y < %d is smaller than MYG (%d)", cuts[r], cuts[r+1], MYG);
+  }
+
+  Options *options = Options::getRoot();
+  if(options->isSet("NXPE")) {
+    options->get("NXPE", NXPE, 1);
+    if((NPES % NXPE) != 0) {
+      throw BoutException("Number of processors (%d) not divisible by NPs in x direction (%d)\n",
+                          NPES, NXPE);
+    }
+  }else {
+    // Choose NXPE nearest to the value which gives square domains
+    BoutReal ideal = sqrt(MX * NPES / ((double) ny));
+    NXPE = -1;
+    for(int i=1; i<= NPES; i++) {
+      if(NPES % i != 0)
+        continue;
+      int nyp = NPES / i;
+      if((nyp < nregions) || (MY < nyp*MYG))
+        continue; // Not enough Y points
+      if((MX < i) || ((i > 1) && (MX < i*MXG)))
+        continue; // Not enough X points
+      if((NXPE < 1) || (fabs(ideal - i) < fabs(ideal - NXPE)))
+        NXPE = i;
+    }
+    if(NXPE < 1)
+      throw BoutException("Could not find a valid value for NXPE");
+  }
+  NYPE = NPES / NXPE;
+
+  xoffset = balance(xcost, NXPE, (NXPE > 1) ? MXG : 1);
+
+  // Share Y processors between regions, adding processors one at a
+  // time to the region with the highest cost per processor
+  if(NYPE < nregions) {
+    throw BoutException("Need at least %d processors in Y (one for each region between branch cuts), but NYPE = %d",
+                        nregions, NYPE);
+  }
+  vector<BoutReal> rcost(nregions, 0.0);
+  vector<int> rproc(nregions, 1);
+  for(int r=0;r<nregions;r++)
+    for(int j=cuts[r];j<cuts[r+1];j++)
+      rcost[r] += ycost[j];
+
+  for(int p=nregions;p<NYPE;p++) {
+    int best = -1;
+    for(int r=0;r<nregions;r++) {
+      if(cuts[r+1] - cuts[r] < (rproc[r]+1)*MYG)
+        continue; // No room for another processor
+      if((best < 0) || (rcost[r]*rproc[best] > rcost[best]*rproc[r]))
+        best = r;
+    }
+    if(best < 0)
+      throw BoutException("Can't split %d Y points between %d processors", MY, NYPE);
+    rproc[best]++;
+  }
+
+  yoffset.assign(1, 0);
+  for(int r=0;r<nregions;r++) {
+    vector<BoutReal> c(ycost.begin() + cuts[r], ycost.begin() + cuts[r+1]);
+    vector<int> off = balance(c, rproc[r], MYG);
+    for(int k=1;k<=rproc[r];k++)
+      yoffset.push_back(cuts[r] + off[k]);
+  }
+
+  // Report the cost of the most expensive processor
+  BoutReal total = 0.0, maxcost = 0.0;
+  for(int xp=0;xp<NXPE;xp++)
+    for(int yp=0;yp<NYPE;yp++) {
+      BoutReal c = 0.0;
+      for(int i=xoffset[xp];i<xoffset[xp+1];i++)
+        for(int j=yoffset[yp];j<yoffset[yp+1];j++)
+          c += cost[(i+MXG)*ny + j];
+      total += c;
+      maxcost = std::max(maxcost, c);
+    }
+
+  output.write("\tDomain split (%d, %d). X sizes:", NXPE, NYPE);
+  for(int i=0;i<NXPE;i++)
+    output.write(" %d", xoffset[i+1] - xoffset[i]);
+  output.write(", Y sizes:");
+  for(int j=0;j<NYPE;j++)
+    output.write(" %d", yoffset[j+1] - yoffset[j]);
+  output.write("\n\tMaximum cost / mean cost = %e\n", (total > 0.0) ? maxcost*NPES/total : 1.0);
+}
+
+/// Y indices where processor domains must start: branch cuts,
+/// X-points and targets, plus 0 and ny
+vector<int> BoutMesh::yCuts() const {
+  vector<int> cuts = {0, jyseps1_1+1, jyseps2_2+1, ny};
+  if(jyseps2_1 != jyseps1_2) {
+    // Double null: upper X-point and upper targets
+    cuts.push_back(jyseps2_1+1);
+    cuts.push_back(ny_inner);
+    cuts.push_back(jyseps1_2+1);
+  }
+  std::sort(cuts.begin(), cuts.end());
+  cuts.erase(std::unique(cuts.begin(), cuts.end()), cuts.end());
+  cuts.erase(std::remove_if(cuts.begin(), cuts.end(),
+                            [this](int y) { return (y < 0) || (y > ny); }),
+             cuts.end());
+  return cuts;
+}
+
+bool BoutMesh::isUniform() const {
+  for(int i=0;i<NXPE;i++)
+    if(xoffset[i+1] - xoffset[i] != xoffset[1])
+      return false;
+  for(int j=0;j<NYPE;j++)
+    if(yoffset[j+1] - yoffset[j] != yoffset[1])
+      return false;
+  return true;
 }
 
 /****************************************************************
@@ -1638,10 +1920,12 @@ void BoutMesh::set_connection(int ypos1, int ypos2, int xge, int xlt, bool ts) {
   yind2 = YLOCAL(ypos2, ype2);
 
   /* Check which boundary the connection is on */
-  if((yind1 == MYG) && (yind2 == MYSUB+MYG-1)) {
+  int ysub1 = yoffset[ype1+1] - yoffset[ype1];
+  int ysub2 = yoffset[ype2+1] - yoffset[ype2];
+  if((yind1 == MYG) && (yind2 == ysub2+MYG-1)) {
     ypeup = ype2; /* processor sending data up (+ve y) */
     ypedown = ype1; /* processor sending data down (-ve y) */
-  }else if((yind2 == MYG) && (yind1 == MYSUB+MYG-1)) {
+  }else if((yind2 == MYG) && (yind1 == ysub1+MYG-1)) {
     ypeup = ype1;
     ypedown = ype2;
   }else {
@@ -1806,18 +2090,22 @@ void BoutMesh::topology() {
     throw BoutException("\tTopology error: npes=%d is not equal to NXPE*NYPE=%d\n",
                             NPES,NXPE*NYPE);
   }
-  if(MYSUB * NYPE != MY) {
-    throw BoutException("\tTopology error: MYSUB[%d] * NYPE[%d] != MY[%d]\n",MYSUB,NYPE,MY);
+  if(yoffset.back() != MY) {
+    throw BoutException("\tTopology error: Y domains add up to %d != MY[%d]\n", yoffset.back(), MY);
   }
-  if(MXSUB * NXPE != MX) {
-    throw BoutException("\tTopology error: MXSUB[%d] * NXPE[%d] != MX[%d]\n",MXSUB,NXPE,MX);
+  if(xoffset.back() != MX) {
+    throw BoutException("\tTopology error: X domains add up to %d != MX[%d]\n", xoffset.back(), MX);
   }
 
-  if((NXPE > 1) && (MXSUB < MXG)) {
-    throw BoutException("\tERROR: Grid X size must be >= guard cell size\n");
+  for(int i=0;i<NXPE;i++) {
+    if((NXPE > 1) && (xoffset[i+1] - xoffset[i] < MXG)) {
+      throw BoutException("\tERROR: Grid X size must be >= guard cell size\n");
+    }
   }
-  if(MYSUB < MYG) {
-    throw BoutException("\tERROR: Grid Y size must be >= guard cell size\n");
+  for(int j=0;j<NYPE;j++) {
+    if(yoffset[j+1] - yoffset[j] < MYG) {
+      throw BoutException("\tERROR: Grid Y size must be >= guard cell size\n");
+    }
   }
 
   if(jyseps2_1 == jyseps1_2) {
@@ -1836,10 +2124,10 @@ void BoutMesh::topology() {
     /* UPPER LEGS: Do not have to be the same length as each
        other or lower legs, but do have to have an integer number
        of processors */
-    if((ny_inner-jyseps2_1-1) % MYSUB != 0) {
+    if(YPROC(ny_inner) == YPROC(ny_inner-1)) {
       throw BoutException("\tTopology error: Upper inner leg does not have integer number of processors\n");
     }
-    if((jyseps1_2-ny_inner+1) % MYSUB != 0) {
+    if(YPROC(jyseps1_2+1) == YPROC(jyseps1_2)) {
       output.write("\tTopology error: Upper outer leg does not have integer number of processors\n");
     }
 
@@ -1877,7 +2165,7 @@ void BoutMesh::topology() {
   }
 
   MYPE_IN_CORE = 0; // processor not in core
-  if( (ixseps_inner > 0) && ( ((PE_YIND*MYSUB > jyseps1_1) && (PE_YIND*MYSUB <= jyseps2_1)) || ((PE_YIND*MYSUB > jyseps1_2) && (PE_YIND*MYSUB <= jyseps2_2)) ) ) {
+  if( (ixseps_inner > 0) && ( ((OffsetY > jyseps1_1) && (OffsetY <= jyseps2_1)) || ((OffsetY > jyseps1_2) && (OffsetY <= jyseps2_2)) ) ) {
     MYPE_IN_CORE = 1; /* processor is in the core */
   }
 
@@ -1917,7 +2205,7 @@ BoutMesh::CommHandle* BoutMesh::get_handle(int xlen, int ylen) {
 
     CommHandle* ch = new CommHandle;
     for(int i=0;i<6;i++)
-      ch->request[i] = MPI_REQUEST_NULL;
+      ch->request[i] = ch->sendreq[i] = MPI_REQUEST_NULL;
 
     if(ylen > 0) {
       ch->umsg_sendbuff = new BoutReal[ylen];
@@ -2348,6 +2636,8 @@ void BoutMesh::outputVars(Datafile &file) {
   file.add(LocalNz,"MZ",    0);
   file.add(NXPE,  "NXPE",  0);
   file.add(NYPE,  "NYPE",  0);
+  file.add(OffsetX, "OffsetX", 0); // Processor domains can have different sizes
+  file.add(OffsetY, "OffsetY", 0);
   file.add(ZMAX,  "ZMAX",  0);
   file.add(ZMIN,  "ZMIN",  0);
   
@@ -2384,6 +2674,9 @@ void BoutMesh::set_ri( dcomplex * ayn, int ncy, BoutReal * ayn_Real, BoutReal *
 // Lowpass filter for n=0 mode, keeping poloidal mode number 0<=m<=mmax
 const Field2D BoutMesh::lowPass_poloidal(const Field2D &var,int mmax)
 {
+  if(!isUniform())
+    throw BoutException("lowPass_poloidal needs all processors to have the same size domain");
+
   Field2D result;
   static BoutReal *f1d = (BoutReal *) NULL;
   static dcomplex *aynall = (dcomplex*)NULL;
@@ -2469,6 +2762,9 @@ const Field2D BoutMesh::lowPass_poloidal(const Field2D &var,int mmax)
 //================================================================*/
 
 const Field3D BoutMesh::Switch_YZ(const Field3D &var) {
+  if(!isUniform())
+    throw BoutException("Switch_YZ needs all processors to have the same size domain");
+
   static BoutReal **ayz = (BoutReal **) NULL;
   static BoutReal **ayz_all = (BoutReal **) NULL;
   Field3D  result;
@@ -2507,6 +2803,9 @@ const Field3D BoutMesh::Switch_YZ(const Field3D &var) {
 }
 
 const Field3D BoutMesh::Switch_XZ(const Field3D &var) {   
+    if(!isUniform())
+      throw BoutException("Switch_XZ needs all processors to have the same size domain");
+
     if(MX != LocalNz){
         throw new BoutException("X and Z dimension must be the same to use Switch_XZ");
     }
@@ -44,6 +44,7 @@ class BoutMesh : public Mesh {
   /// mesh->wait(handle);
   ///
   comm_handle send(FieldGroup &g);
+  comm_handle sendWidth(FieldGroup &g, int xwidth, int ywidth);
 
   /// Wait for a send operation to complete
   /// @param[in] handle  The handle returned by send()
@@ -59,6 +60,8 @@ class BoutMesh : public Mesh {
   int getNYPE(); ///< The number of processors in the Y direction
   int getXProcIndex();  ///< This processor's index in X direction
   int getYProcIndex();  ///< This processor's index in Y direction
+  int getXProcOffset(int xproc) { return xoffset[xproc]; } ///< First interior X index on processor xproc
+  int getYProcOffset(int yproc) { return yoffset[yproc]; } ///< First Y index on processor yproc
   
   /////////////////////////////////////////////
   // X communications
@@ -167,6 +170,12 @@ class BoutMesh : public Mesh {
   int MX, MY;        ///< size of the grid excluding boundary regions
   
   int MYSUB, MXSUB;  ///< Size of the grid on this processor
+
+  /// Global index of the first grid point on each X and Y processor,
+  /// with the total number of points as the last element. Processors can
+  /// have different sized domains if mesh:load_balance is set, or
+  /// mesh:xsizes / mesh:ysizes are given
+  vector<int> xoffset, yoffset;
   
   int NPES; ///< Number of processors
   int MYPE; ///< Rank of this processor
@@ -192,6 +201,11 @@ class BoutMesh : public Mesh {
   int YLOCAL(int yglo, int yproc) const;
   int YPROC(int yind);
   int XPROC(int xind);
+
+  // Non-uniform domain decomposition
+  void loadBalance(); ///< Set NXPE, NYPE, xoffset and yoffset from mesh:cost
+  vector<int> yCuts() const; ///< Y indices where a processor domain must start
+  bool isUniform() const; ///< True if all processors have the same size domain
   
   // Twist-shift switches
   bool TS_up_in, TS_up_out, TS_down_in, TS_down_out;
@@ -236,6 +250,7 @@ class BoutMesh : public Mesh {
     BoutReal *umsg_sendbuff, *dmsg_sendbuff, *imsg_sendbuff, *omsg_sendbuff; ///< Sending buffers
     BoutReal *umsg_recvbuff, *dmsg_recvbuff, *imsg_recvbuff, *omsg_recvbuff; ///< Receiving buffers
     bool in_progress; ///< Is the communication still going?
+    int xwidth, ywidth; ///< Number of guard cells being communicated in X and Y
     
     /// List of fields being communicated
     FieldGroup var_list;
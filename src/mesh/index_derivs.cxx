@@ -1000,6 +1000,7 @@ void Mesh::derivs_init(Options* options) {
 // X derivative
 
 const Field2D Mesh::applyXdiff(const Field2D &var, Mesh::deriv_func func, Mesh::inner_boundary_deriv_func func_in, Mesh::outer_boundary_deriv_func func_out, CELL_LOC loc) {
+  communicatePending(); // Guard cells needed
   Field2D result;
   result.allocate(); // Make sure data allocated
 
@@ -1076,6 +1077,7 @@ const Field2D Mesh::applyXdiff(const Field2D &var, Mesh::deriv_func func, Mesh::
 }
 
 const Field3D Mesh::applyXdiff(const Field3D &var, Mesh::deriv_func func, Mesh::inner_boundary_deriv_func func_in, Mesh::outer_boundary_deriv_func func_out, CELL_LOC loc) {
+  communicatePending(); // Guard cells needed
   Field3D result;
   result.allocate(); // Make sure data allocated
 
@@ -1160,6 +1162,7 @@ const Field3D Mesh::applyXdiff(const Field3D &var, Mesh::deriv_func func, Mesh::
 // Y derivative
 
 const Field2D Mesh::applyYdiff(const Field2D &var, Mesh::deriv_func func, Mesh::inner_boundary_deriv_func func_in, Mesh::outer_boundary_deriv_func func_out, CELL_LOC loc) {
+  communicatePending(); // Guard cells needed
   Field2D result;
   result.allocate(); // Make sure data allocated
   
@@ -1236,6 +1239,7 @@ const Field2D Mesh::applyYdiff(const Field2D &var, Mesh::deriv_func func, Mesh::
 }
 
 const Field3D Mesh::applyYdiff(const Field3D &var, Mesh::deriv_func func, Mesh::inner_boundary_deriv_func func_in, Mesh::outer_boundary_deriv_func func_out, CELL_LOC loc) {
+  communicatePending(); // Guard cells needed
   Field3D result;
   result.allocate(); // Make sure data allocated
   
@@ -1629,6 +1633,8 @@ const Field3D Mesh::indexDDZ(const Field3D &f, CELL_LOC outloc, DIFF_METHOD meth
 
     int ncz = mesh->LocalNz;
     
+    f.prepareZSpectrum(); // Calculate and store coefficients, if enabled
+    
 #ifndef _OPENMP
     static dcomplex *cv = (dcomplex*) NULL;
 #else
@@ -1680,7 +1686,7 @@ const Field3D Mesh::indexDDZ(const Field3D &f, CELL_LOC outloc, DIFF_METHOD meth
       #pragma omp for
       for(int jx=xs;jx<=xe;jx++) {
         for(int jy=ys;jy<=ye;jy++) {
-          rfft(f(jx, jy), ncz, cv); // Forward FFT
+          f.zSpectrum(jx, jy, cv); // Forward FFT (or stored)
           
         for(int jz=0;jz<=ncz/2;jz++) {
             BoutReal kwave=jz*2.0*PI/ncz; // wave number is 1/[rad]
@@ -2004,6 +2010,8 @@ const Field3D Mesh::indexD2DZ2(const Field3D &f, CELL_LOC outloc, DIFF_METHOD me
 
     int ncz = mesh->LocalNz;
     
+    f.prepareZSpectrum(); // Calculate and store coefficients, if enabled
+    
     static dcomplex *cv = (dcomplex*) NULL;
     
     // Serial, so can have a single static array
@@ -2030,7 +2038,7 @@ const Field3D Mesh::indexD2DZ2(const Field3D &f, CELL_LOC outloc, DIFF_METHOD me
     for(int jx=xs;jx<=xe;jx++) {
       for(int jy=ys;jy<=ye;jy++) {
           
-	rfft(f(jx,jy), ncz, cv); // Forward FFT
+	f.zSpectrum(jx, jy, cv); // Forward FFT (or stored)
 	
 	for(int jz=0;jz<=ncz/2;jz++) {
 	  BoutReal kwave=jz*2.0*PI/ncz; // wave number is 1/[rad]
@@ -2124,6 +2132,7 @@ const Field3D Mesh::indexD4DZ4(const Field3D &f) {
 
 /// Special case where both arguments are 2D. Output location ignored for now
 const Field2D Mesh::indexVDDX(const Field2D &v, const Field2D &f, CELL_LOC UNUSED(outloc), DIFF_METHOD method) {
+  communicatePending(); // Guard cells needed
   Mesh::upwind_func func = fVDDX;
 
   if(method != DIFF_DEFAULT) {
@@ -2153,6 +2162,7 @@ const Field2D Mesh::indexVDDX(const Field2D &v, const Field2D &f, CELL_LOC UNUSE
 
 /// General version for 2 or 3-D objects
 const Field3D Mesh::indexVDDX(const Field &v, const Field &f, CELL_LOC outloc, DIFF_METHOD method) {
+  communicatePending(); // Guard cells needed
   TRACE("Mesh::indexVDDX(Field, Field)");
   
   Field3D result;
@@ -2240,6 +2250,7 @@ const Field3D Mesh::indexVDDX(const Field &v, const Field &f, CELL_LOC outloc, D
 
 // special case where both are 2D
 const Field2D Mesh::indexVDDY(const Field2D &v, const Field2D &f, CELL_LOC outloc, DIFF_METHOD method) {
+  communicatePending(); // Guard cells needed
   TRACE("Mesh::indexVDDY");
   
   Field2D result;
@@ -2323,6 +2334,7 @@ const Field2D Mesh::indexVDDY(const Field2D &v, const Field2D &f, CELL_LOC outlo
 
 // general case
 const Field3D Mesh::indexVDDY(const Field &v, const Field &f, CELL_LOC outloc, DIFF_METHOD method) {
+  communicatePending(); // Guard cells needed
   TRACE("Mesh::indexVDDY(Field, Field)");
   
   Field3D result;
@@ -2499,6 +2511,7 @@ const Field3D Mesh::indexVDDZ(const Field &v, const Field &f, CELL_LOC outloc, D
  *******************************************************************************/
 
 const Field2D Mesh::indexFDDX(const Field2D &v, const Field2D &f, CELL_LOC outloc, DIFF_METHOD method) {
+  communicatePending(); // Guard cells needed
   TRACE("Mesh::::indexFDDX(Field2D, Field2D)");
   
   if( (method == DIFF_SPLIT) || ((method == DIFF_DEFAULT) && (fFDDX == NULL)) ) {
@@ -2534,6 +2547,7 @@ const Field2D Mesh::indexFDDX(const Field2D &v, const Field2D &f, CELL_LOC outlo
 }
 
 const Field3D Mesh::indexFDDX(const Field3D &v, const Field3D &f, CELL_LOC outloc, DIFF_METHOD method) {
+  communicatePending(); // Guard cells needed
   TRACE("Mesh::indexFDDX");
   
   if( (method == DIFF_SPLIT) || ((method == DIFF_DEFAULT) && (fFDDX == NULL)) ) {
@@ -2609,6 +2623,7 @@ const Field3D Mesh::indexFDDX(const Field3D &v, const Field3D &f, CELL_LOC outlo
 /////////////////////////////////////////////////////////////////////////
 
 const Field2D Mesh::indexFDDY(const Field2D &v, const Field2D &f, CELL_LOC outloc, DIFF_METHOD method) {
+  communicatePending(); // Guard cells needed
   TRACE("Mesh::indexFDDY(Field2D, Field2D)");
   
   if( (method == DIFF_SPLIT) || ((method == DIFF_DEFAULT) && (fFDDY == NULL)) ) {
@@ -2644,6 +2659,7 @@ const Field2D Mesh::indexFDDY(const Field2D &v, const Field2D &f, CELL_LOC outlo
 }
 
 const Field3D Mesh::indexFDDY(const Field3D &v, const Field3D &f, CELL_LOC outloc, DIFF_METHOD method) {
+  communicatePending(); // Guard cells needed
   TRACE("Mesh::indexFDDY");
   
   if( (method == DIFF_SPLIT) || ((method == DIFF_DEFAULT) && (fFDDY == NULL)) ) {
@@ -52,6 +52,7 @@ BoutReal interp(const stencil &s)
 const Field3D interp_to(const Field3D &var, CELL_LOC loc)
 {
   if(mesh->StaggerGrids && (var.getLocation() != loc)) {
+    mesh->communicatePending(); // Guard cells needed
     
     //output.write("\nINTERPOLATING %s -> %s\n", strLocation(var.getLocation()), strLocation(loc));
 
@@ -105,13 +105,18 @@ Field3D HermiteSpline::interpolate(const Field3D& f) const {
   f_interp.allocate();
 
   // Derivatives are used for tension and need to be on dimensionless
-  // coordinates
+  // coordinates. They are read at y + y_offset, so the X guard cells
+  // and |y_offset| Y guard cells are exchanged. The guard cells of f
+  // must already be set. Calls send() rather than communicate(), since
+  // the parallel transform may use this interpolation
+  int ywidth = abs(y_offset);
   Field3D fx = mesh->indexDDX(f, CELL_DEFAULT, DIFF_DEFAULT);
-  mesh->communicateXZ(fx);
   Field3D fz = mesh->indexDDZ(f, CELL_DEFAULT, DIFF_DEFAULT, true);
-  mesh->communicateXZ(fz);
+  FieldGroup g(fx, fz);
+  mesh->wait(mesh->sendWidth(g, mesh->xstart, ywidth));
   Field3D fxz = mesh->indexDDX(fz, CELL_DEFAULT, DIFF_DEFAULT);
-  mesh->communicateXZ(fxz);
+  FieldGroup gxz(fxz);
+  mesh->wait(mesh->sendWidth(gxz, mesh->xstart, ywidth));
 
   for(int x=mesh->xstart;x<=mesh->xend;x++) {
     for(int y=mesh->ystart; y<=mesh->yend;y++) {
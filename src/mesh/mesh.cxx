@@ -5,8 +5,10 @@
 #include <utils.hxx>
 #include <derivs.hxx>
 #include <msg_stack.hxx>
+#include <boutcomm.hxx>
 
 #include <cmath>
+#include <set>
 
 #include "meshfactory.hxx"
 
@@ -28,6 +30,7 @@ Mesh::Mesh(GridDataSource *s, Options* opt) : source(s), coords(0), options(opt)
   
   /// Get mesh options
   OPTION(options, StaggerGrids,   false); // Stagger grids
+  OPTION(options, lazy_comms,     false); // Communicate when guard cells are needed
 
   // Will be set to true if any variable has a free boundary condition applied to the corresponding boundary
   freeboundary_xin = false;
@@ -40,6 +43,9 @@ Mesh::Mesh(GridDataSource *s, Options* opt) : source(s), coords(0), options(opt)
 }
 
 Mesh::~Mesh() {
+  for(const auto &f : pending_comms)
+    f->setCommsPending(false);
+  
   delete source;
 
   if(coords) {
@@ -171,18 +177,45 @@ bool Mesh::sourceHasVar(const string &name) {
  **************************************************************************/
 
 void Mesh::communicateXZ(FieldGroup &g) {
-  TRACE("Mesh::communicate(FieldGroup&)");
+  TRACE("Mesh::communicateXZ(FieldGroup&)");
+
+  communicate(g, xstart, 0);
+}
+
+void Mesh::communicate(FieldGroup &g, int xwidth, int ywidth) {
+  TRACE("Mesh::communicate(FieldGroup&, int, int)");
 
   // Send data
-  comm_handle h = send(g);
+  comm_handle h = sendWidth(g, xwidth, ywidth);
 
   // Wait for data from other processors
   wait(h);
+
+  if(ywidth > 0) {
+    // Calculate yup and ydown fields for 3D fields
+    for(const auto& fptr : g.field3d())
+      getParallelTransform().calcYUpDown(*fptr);
+  }
 }
 
 void Mesh::communicate(FieldGroup &g) {
   TRACE("Mesh::communicate(FieldGroup&)");
 
+  if(lazy_comms) {
+    // Add to the list, to be communicated when needed
+    for(const auto &f : g) {
+      if(f->guardsValid() || f->commsPending())
+        continue; // Nothing to do
+      Field3D *f3d = dynamic_cast<Field3D*>(f);
+      if(f3d) {
+        pending_comms.add(*f3d); // So that yup/ydown fields are calculated
+      }else
+        pending_comms.add(*f);
+      f->setCommsPending(true);
+    }
+    return;
+  }
+
   // Send data
   comm_handle h = send(g);
 
@@ -194,6 +227,82 @@ void Mesh::communicate(FieldGroup &g) {
     getParallelTransform().calcYUpDown(*fptr);
 }
 
+/// Start of the data in a Field2D or Field3D, used to find copies
+/// which share data. nullptr for other fields, or if not allocated
+static const BoutReal* dataStart(FieldData *f) {
+  Field3D *f3d = dynamic_cast<Field3D*>(f);
+  if(f3d)
+    return f3d->isAllocated() ? &static_cast<const Field3D&>(*f3d)(0,0,0) : nullptr;
+  Field2D *f2d = dynamic_cast<Field2D*>(f);
+  if(f2d)
+    return f2d->isAllocated() ? &static_cast<const Field2D&>(*f2d)(0,0) : nullptr;
+  return nullptr;
+}
+
+void Mesh::sendPending() {
+  TRACE("Mesh::sendPending()");
+
+  // Empty the list first, since communicate() might be called again
+  FieldGroup all = pending_comms;
+  pending_comms.clear();
+
+  // Copies of a field which haven't been modified share its data, so
+  // are only sent once. Copies may be made on some processors and not
+  // others, so this keeps the fields sent the same on all processors
+  FieldGroup g, copies;
+  std::set<const BoutReal*> sent;
+  for(const auto &f : all) {
+    f->setCommsPending(false);
+    const BoutReal *start = dataStart(f);
+    FieldGroup &dest = (start && !sent.insert(start).second) ? copies : g;
+    Field3D *f3d = dynamic_cast<Field3D*>(f);
+    if(f3d) {
+      dest.add(*f3d);
+    }else
+      dest.add(*f);
+  }
+
+#if CHECK > 2
+  // All processors must communicate the same number of fields,
+  // otherwise the messages won't match
+  int n[2] = {g.size(), -g.size()}, nmax[2];
+  MPI_Allreduce(n, nmax, 2, MPI_INT, MPI_MAX, BoutComm::get());
+  if((nmax[0] != n[0]) || (nmax[1] != n[1])) {
+    throw BoutException("Lazy communication of %d fields, but between %d and %d on other processors. "
+                        "Fields must be modified in the same way on all processors",
+                        n[0], -nmax[1], nmax[0]);
+  }
+#endif
+
+  comm_handle h = send(g);
+  wait(h);
+
+  for(const auto& fptr : g.field3d())
+    getParallelTransform().calcYUpDown(*fptr);
+
+  // Copies now have the same guard cells
+  for(const auto &f : copies)
+    f->setGuardsValid(true);
+  for(const auto& fptr : copies.field3d())
+    getParallelTransform().calcYUpDown(*fptr);
+}
+
+void Mesh::cancelCommunication(FieldData &f) {
+  // Remove from the list, keeping the remaining fields
+  FieldGroup g = pending_comms;
+  pending_comms.clear();
+  for(const auto &fp : g) {
+    if(fp == &f)
+      continue;
+    Field3D *f3d = dynamic_cast<Field3D*>(fp);
+    if(f3d) {
+      pending_comms.add(*f3d);
+    }else
+      pending_comms.add(*fp);
+  }
+  f.setCommsPending(false);
+}
+
 /// This is a bit of a hack for now to get FieldPerp communications
 /// The FieldData class needs to be changed to accomodate FieldPerp objects
 void Mesh::communicate(FieldPerp &f) {
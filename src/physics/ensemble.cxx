@@ -0,0 +1,177 @@
+/**************************************************************************
+ * Ensemble runs: many independent cases in one job
+ *
+ **************************************************************************
+ * Copyright 2017 B.D.Dudson
+ *
+ * Contact: Ben Dudson, bd512@york.ac.uk
+ *
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+#include <bout/ensemble.hxx>
+
+#include <boutcomm.hxx>
+#include <boutexception.hxx>
+#include <optionsreader.hxx>
+#include <field_factory.hxx>
+#include <output.hxx>
+#include <msg_stack.hxx>
+
+#include <sys/stat.h>
+#include <errno.h>
+#include <string.h>
+#include <stdio.h>
+
+namespace {
+/// MPI was initialised by BoutEnsemble::initialise, so must be
+/// finalised if it fails
+int initialiseFailed(int err) {
+  MPI_Finalize();
+  return err;
+}
+}
+
+int BoutEnsemble::nmembers = 1;
+int BoutEnsemble::ngroups = 1;
+int BoutEnsemble::mygroup = 0;
+bool BoutEnsemble::mpi_initialised = false;
+std::string BoutEnsemble::base_dir = DEFAULT_DIR;
+
+int BoutEnsemble::initialise(int &argc, char **&argv) {
+  const char *data_dir = DEFAULT_DIR;
+  const char *opt_file = DEFAULT_OPT;
+
+  for (int i=1;i<argc;i++) {
+    string arg(argv[i]);
+    if ((arg == "-h") || (arg == "--help")) {
+      // Let BoutInitialise print the help message
+      return BoutInitialise(argc, argv);
+    }
+    if ((arg == "-d") && (i+1 < argc)) {
+      data_dir = argv[++i];
+    }else if ((arg == "-f") && (i+1 < argc)) {
+      opt_file = argv[++i];
+    }
+  }
+  base_dir = data_dir;
+
+  MPI_Init(&argc, &argv);
+  mpi_initialised = true;
+
+  int NPES, MYPE;
+  MPI_Comm_size(MPI_COMM_WORLD, &NPES);
+  MPI_Comm_rank(MPI_COMM_WORLD, &MYPE);
+
+  // Read the ensemble settings. Reading into a separate Options tree
+  // so that BoutInitialise reads the input as normal
+  Options opts;
+  try {
+    OptionsReader *reader = OptionsReader::getInstance();
+    reader->read(&opts, "%s/%s", data_dir, opt_file);
+    reader->parseCommandLine(&opts, argc, argv);
+  }catch(BoutException &e) {
+    if (MYPE == 0)
+      fprintf(stderr, "Error encountered reading options: %s\n", e.what());
+    return initialiseFailed(1);
+  }
+  Options *ensopts = opts.getSection("ensemble");
+
+  ensopts->get("members", nmembers, 1);
+  if (nmembers < 1) {
+    if (MYPE == 0)
+      fprintf(stderr, "ensemble:members must be at least 1\n");
+    return initialiseFailed(1);
+  }
+  // By default, as many groups as possible up to one per member
+  int default_groups = (nmembers < NPES) ? nmembers : NPES;
+  while (NPES % default_groups != 0)
+    default_groups--;
+  ensopts->get("groups", ngroups, default_groups);
+  if ((ngroups < 1) || (NPES % ngroups != 0)) {
+    if (MYPE == 0)
+      fprintf(stderr, "ensemble:groups = %d must divide the number of processors (%d)\n",
+              ngroups, NPES);
+    return initialiseFailed(1);
+  }
+
+  // Expressions were cached from the temporary options
+  FieldFactory::get()->cleanCache();
+
+  // Split into groups of consecutive processors
+  mygroup = MYPE / (NPES / ngroups);
+
+  MPI_Comm comm;
+  MPI_Comm_split(MPI_COMM_WORLD, mygroup, MYPE, &comm);
+  BoutComm::getInstance()->setComm(comm); // Duplicates communicator
+  MPI_Comm_free(&comm);
+
+  // Tells BoutInitialise not to open the dump file
+  Options::getRoot()->getSection("ensemble")->set("group", mygroup, "ensemble");
+
+  int init_err = BoutInitialise(argc, argv);
+  if (init_err != 0)
+    return initialiseFailed(init_err);
+
+  output.write("Ensemble of %d members on %d groups of %d processors. This is group %d\n",
+               nmembers, ngroups, NPES / ngroups, mygroup);
+  return 0;
+}
+
+int BoutEnsemble::finalise() {
+  int err = BoutFinalise();
+
+  // BoutComm only finalises MPI if it initialised it
+  if (mpi_initialised) {
+    MPI_Finalize();
+    mpi_initialised = false;
+  }
+  return err;
+}
+
+void BoutEnsemble::beginMember(int m) {
+  MsgStackItem trace("Starting ensemble member");
+
+  Options *root = Options::getRoot();
+  root->getSection("ensemble")->set("member", m, "ensemble");
+
+  // Expressions may depend on ensemble:member, so must be re-evaluated
+  FieldFactory::get()->cleanCache();
+
+  // Output directory for this member
+  char member_dir[512];
+  snprintf(member_dir, 512, "%s/member%d", base_dir.c_str(), m);
+
+  if (BoutComm::rank() == 0) {
+    if ((mkdir(member_dir, 0755) != 0) && (errno != EEXIST)) {
+      throw BoutException("Couldn't create ensemble directory '%s': %s",
+                          member_dir, strerror(errno));
+    }
+  }
+  MPI_Barrier(BoutComm::get());
+
+  // Restart files are read from and written to datadir
+  root->set("datadir", string(member_dir), "ensemble");
+
+  output.write("\n========== Ensemble member %d of %d ==========\n", m+1, nmembers);
+
+  bout_open_dump(member_dir);
+}
+
+void BoutEnsemble::endMember() {
+  dump.close();
+}
@@ -37,6 +37,10 @@ int PhysicsModel::runRHS(BoutReal time) {
   return rhs(time);
 }
 
+int PhysicsModel::runRHS(BoutReal time, int group) {
+  return rhs_group(time, group);
+}
+
 bool PhysicsModel::splitOperator() {
   return splitop;
 }
@@ -38,29 +38,40 @@
 #include <msg_stack.hxx>
 
 #include <utils.hxx>
+#include <unused.hxx>
 #include <bout/constants.hxx>
+#include <bout/assert.hxx>
+#include <bout/openmpwrap.hxx>
 
 // Smooth using simple 1-2-1 filter
-const Field3D smooth_x(const Field3D &f, bool BoutRealspace) {
+const Field3D smooth_x(const Field3D &f, bool UNUSED(BoutRealspace)) {
   TRACE("smooth_x");
+  mesh->communicatePending(); // Guard cells needed
+  
+  int ngx = mesh->LocalNx, ngy = mesh->LocalNy, ngz = mesh->LocalNz;
   
   Field3D result;
   result.allocate();
+  BoutReal *r = &result(0,0,0);
+  const BoutReal *fd = &f(0,0,0);
   
   // Copy boundary region
-  for(int jy=0;jy<mesh->LocalNy;jy++)
-    for(int jz=0;jz<mesh->LocalNz;jz++) {
-      result(0,jy,jz) = f(0,jy,jz);
-      result(mesh->LocalNx-1,jy,jz) = f(mesh->LocalNx-1,jy,jz);
-    }
+  for(int i=0;i<ngy*ngz;i++) {
+    r[i] = fd[i];
+    r[(ngx-1)*ngy*ngz + i] = fd[(ngx-1)*ngy*ngz + i];
+  }
 
   // Smooth using simple 1-2-1 filter
-
-  for(int jx=1;jx<mesh->LocalNx-1;jx++)
-    for(int jy=0;jy<mesh->LocalNy;jy++)
-      for(int jz=0;jz<mesh->LocalNz;jz++) {
-	result(jx,jy,jz) = 0.5*f(jx,jy,jz) + 0.25*( f(jx-1,jy,jz) + f(jx+1,jy,jz) );
-      }
+  BOUT_OMP(parallel for)
+  for(int jx=1;jx<ngx-1;jx++) {
+    const BoutReal *fm = fd + (jx-1)*ngy*ngz;
+    const BoutReal *fc = fd + jx*ngy*ngz;
+    const BoutReal *fp = fd + (jx+1)*ngy*ngz;
+    BoutReal *rc = r + jx*ngy*ngz;
+    BOUT_OMP_SIMD
+    for(int i=0;i<ngy*ngz;i++)
+      rc[i] = 0.5*fc[i] + 0.25*( fm[i] + fp[i] );
+  }
 
   // Need to communicate boundaries
   mesh->communicate(result);
@@ -71,24 +82,34 @@ const Field3D smooth_x(const Field3D &f, bool BoutRealspace) {
 
 const Field3D smooth_y(const Field3D &f) {
   TRACE("smooth_y");
+  mesh->communicatePending(); // Guard cells needed
+  
+  int ngx = mesh->LocalNx, ngy = mesh->LocalNy, ngz = mesh->LocalNz;
   
   Field3D result;
   result.allocate();
+  BoutReal *r = &result(0,0,0);
   
-  // Copy boundary region
-  for(int jx=0;jx<mesh->LocalNx;jx++)
-    for(int jz=0;jz<mesh->LocalNz;jz++) {
-      result(jx,0,jz) = f(jx,0,jz);
-      result(jx,mesh->LocalNy-1,jz) = f(jx,mesh->LocalNy-1,jz);
-    }
+  const Field3D &fdown = f.ydown();
+  const Field3D &fup = f.yup();
   
-  // Smooth using simple 1-2-1 filter
-
-  for(int jx=0;jx<mesh->LocalNx;jx++)
-    for(int jy=1;jy<mesh->LocalNy-1;jy++)
-      for(int jz=0;jz<mesh->LocalNz;jz++) {
-	result(jx,jy,jz) = 0.5*f(jx,jy,jz) + 0.25*( f.ydown()(jx,jy-1,jz) + f.yup()(jx,jy+1,jz) );
-      }
+  // Smooth using simple 1-2-1 filter, copying the boundary region
+  BOUT_OMP(parallel for)
+  for(int jx=0;jx<ngx;jx++) {
+    for(int jz=0;jz<ngz;jz++) {
+      r[(jx*ngy)*ngz + jz] = f(jx,0,jz);
+      r[(jx*ngy + ngy-1)*ngz + jz] = f(jx,ngy-1,jz);
+    }
+    for(int jy=1;jy<ngy-1;jy++) {
+      const BoutReal *fc = f(jx,jy);
+      const BoutReal *fm = fdown(jx,jy-1);
+      const BoutReal *fp = fup(jx,jy+1);
+      BoutReal *rc = r + (jx*ngy + jy)*ngz;
+      BOUT_OMP_SIMD
+      for(int jz=0;jz<ngz;jz++)
+	rc[jz] = 0.5*fc[jz] + 0.25*( fm[jz] + fp[jz] );
+    }
+  }
 
   // Need to communicate boundaries
   mesh->communicate(result);
@@ -115,13 +136,14 @@ const Field2D averageX(const Field2D &f) {
   Array<BoutReal> input(ngy), result(ngy);
   
   // Average on this processor
+  BOUT_OMP(parallel for)
   for(int y=0;y<ngy;y++) {
-    input[y] = 0.;
+    BoutReal sum = 0.;
     // Sum values, not including boundaries
     for(int x=mesh->xstart;x<=mesh->xend;x++) {
-      input[y] += f(x,y);
+      sum += f(x,y);
     }
-    input[y] /= (mesh->xend - mesh->xstart + 1);
+    input[y] = sum / (mesh->xend - mesh->xstart + 1);
   }
 
   Field2D r;
@@ -146,67 +168,83 @@ const Field2D averageX(const Field2D &f) {
   return r;
 }
 
+const Field3D averageX(const Field3D &f) {
+  TRACE("averageX(Field3D)");
+  return averageX(std::vector<Field3D>{f})[0];
+}
+
 /*!
 
   Issues
   ======
 
-  Creates static arrays
-  
-  Not thread safe
-  
   Assumes every processor has the same domain shape
   
   Will only work if X communicator is constant in Y
   so no processor/branch cuts in X
   
  */
-const Field3D averageX(const Field3D &f) {
-  static BoutReal **input = NULL, **result;
-
-  TRACE("averageX(Field3D)");
+std::vector<Field3D> averageX(const std::vector<Field3D> &fields) {
+  TRACE("averageX(vector<Field3D>)");
 
+  int nf = fields.size();
   int ngx = mesh->LocalNx;
   int ngy = mesh->LocalNy;
   int ngz = mesh->LocalNz;
-
-  if(input == NULL) {
-    input = matrix<BoutReal>(ngy, ngz);
-    result = matrix<BoutReal>(ngy, ngz);
-  }
+  int nyz = ngy*ngz;
+  
+  // Workspace, from the Array store
+  Array<BoutReal> input(nf*nyz), result(nf*nyz);
   
   // Average on this processor
-  for(int y=0;y<ngy;y++)
-    for(int z=0;z<ngz;z++) {
-      input[y][z] = 0.;
+  for(int i=0;i<nf;i++) {
+    const Field3D &f = fields[i];
+    ASSERT1(f.isAllocated());
+    BoutReal *in = &input[i*nyz];
+    
+    BOUT_OMP(parallel for)
+    for(int y=0;y<ngy;y++) {
+      BoutReal *iny = in + y*ngz;
+      for(int z=0;z<ngz;z++)
+        iny[z] = 0.;
       // Sum values, not including boundaries
       for(int x=mesh->xstart;x<=mesh->xend;x++) {
-        input[y][z] += f(x,y,z);
+        const BoutReal *fxy = f(x,y);
+        BOUT_OMP_SIMD
+        for(int z=0;z<ngz;z++)
+          iny[z] += fxy[z];
       }
-      input[y][z] /= (mesh->xend - mesh->xstart + 1);
+      for(int z=0;z<ngz;z++)
+        iny[z] /= (mesh->xend - mesh->xstart + 1);
     }
-  
-  Field3D r;
-  r.allocate();
+  }
   
   MPI_Comm comm_x = mesh->getXcomm();
  
   int np;
   MPI_Comm_size(comm_x, &np);
+  BoutReal *avg = input.begin();
   if(np > 1) {
-    MPI_Allreduce(*input, *result, ngy*ngz, MPI_DOUBLE, MPI_SUM, comm_x);
+    // One communication for all fields
+    MPI_Allreduce(input.begin(), result.begin(), nf*nyz, MPI_DOUBLE, MPI_SUM, comm_x);
+    avg = result.begin();
+    BOUT_OMP(parallel for)
+    for(int j=0;j<nf*nyz;j++)
+      avg[j] /= (BoutReal) np;
+  }
+  
+  std::vector<Field3D> r(nf);
+  for(int i=0;i<nf;i++) {
+    r[i].allocate();
+    BoutReal *rd = &r[i](0,0,0);
+    const BoutReal *ai = avg + i*nyz;
     
-    for(int x=0;x<ngx;x++)
-      for(int y=0;y<ngy;y++)
-        for(int z=0;z<ngz;z++) {
-          r(x,y,z) = result[y][z] / (BoutReal) np;
-        }
-  }else {
-    for(int x=0;x<ngx;x++)
-      for(int y=0;y<ngy;y++)
-        for(int z=0;z<ngz;z++) {
-          r(x,y,z) = input[y][z];
-        }
+    BOUT_OMP(parallel for)
+    for(int x=0;x<ngx;x++) {
+      BoutReal *rx = rd + x*nyz;
+      for(int j=0;j<nyz;j++)
+        rx[j] = ai[j];
+    }
   }
   
   return r;
@@ -221,13 +259,14 @@ const Field2D averageY(const Field2D &f) {
   Array<BoutReal> input(ngx), result(ngx);
   
   // Average on this processor
+  BOUT_OMP(parallel for)
   for(int x=0;x<ngx;x++) {
-    input[x] = 0.;
+    BoutReal sum = 0.;
     // Sum values, not including boundaries
     for(int y=mesh->ystart;y<=mesh->yend;y++) {
-      input[x] += f(x,y);
+      sum += f(x,y);
     }
-    input[x] /= (mesh->yend - mesh->ystart + 1);
+    input[x] = sum / (mesh->yend - mesh->ystart + 1);
   }
 
   Field2D r;
@@ -254,62 +293,79 @@ const Field2D averageY(const Field2D &f) {
 }
 
 const Field3D averageY(const Field3D &f) {
-  static BoutReal **input = NULL, **result;
-    
-  msg_stack.push("averageY(Field3D)");
+  TRACE("averageY(Field3D)");
+  return averageY(std::vector<Field3D>{f})[0];
+}
+
+std::vector<Field3D> averageY(const std::vector<Field3D> &fields) {
+  TRACE("averageY(vector<Field3D>)");
 
+  int nf = fields.size();
   int ngx = mesh->LocalNx;
   int ngy = mesh->LocalNy;
   int ngz = mesh->LocalNz;
+  int nxz = ngx*ngz;
   
-  if(input == NULL) {
-    input = matrix<BoutReal>(ngx, ngz);
-    result = matrix<BoutReal>(ngx, ngz);
-  }
+  // Workspace, from the Array store
+  Array<BoutReal> input(nf*nxz), result(nf*nxz);
   
   // Average on this processor
-  for(int x=0;x<ngx;x++)
-    for(int z=0;z<ngz;z++) {
-      input[x][z] = 0.;
+  for(int i=0;i<nf;i++) {
+    const Field3D &f = fields[i];
+    ASSERT1(f.isAllocated());
+    BoutReal *in = &input[i*nxz];
+    
+    BOUT_OMP(parallel for)
+    for(int x=0;x<ngx;x++) {
+      BoutReal *inx = in + x*ngz;
+      for(int z=0;z<ngz;z++)
+        inx[z] = 0.;
       // Sum values, not including boundaries
       for(int y=mesh->ystart;y<=mesh->yend;y++) {
-        input[x][z] += f(x,y,z);
+        const BoutReal *fxy = f(x,y);
+        BOUT_OMP_SIMD
+        for(int z=0;z<ngz;z++)
+          inx[z] += fxy[z];
       }
-      input[x][z] /= (mesh->yend - mesh->ystart + 1);
+      for(int z=0;z<ngz;z++)
+        inx[z] /= (mesh->yend - mesh->ystart + 1);
     }
-  
-  Field3D r;
-  r.allocate();
+  }
 
   /// NOTE: This only works if there are no branch-cuts
   MPI_Comm comm_inner = mesh->getYcomm(0);
   
   int np;
   MPI_Comm_size(comm_inner, &np);
+  BoutReal *avg = input.begin();
   if(np > 1) {
-    MPI_Allreduce(*input, *result, ngx*ngz, MPI_DOUBLE, MPI_SUM, comm_inner);
+    // One communication for all fields
+    MPI_Allreduce(input.begin(), result.begin(), nf*nxz, MPI_DOUBLE, MPI_SUM, comm_inner);
+    avg = result.begin();
+    BOUT_OMP(parallel for)
+    for(int j=0;j<nf*nxz;j++)
+      avg[j] /= (BoutReal) np;
+  }
+  
+  std::vector<Field3D> r(nf);
+  for(int i=0;i<nf;i++) {
+    r[i].allocate();
+    BoutReal *rd = &r[i](0,0,0);
+    const BoutReal *ai = avg + i*nxz;
     
-    for(int x=0;x<ngx;x++)
-      for(int y=0;y<ngy;y++)
-        for(int z=0;z<ngz;z++) {
-          r(x,y,z) = result[x][z] / (BoutReal) np;
-        }
-  }else {
-    for(int x=0;x<ngx;x++)
-      for(int y=0;y<ngy;y++)
-        for(int z=0;z<ngz;z++) {
-          r(x,y,z) = input[x][z];
-        }
+    BOUT_OMP(parallel for)
+    for(int x=0;x<ngx;x++) {
+      for(int y=0;y<ngy;y++) {
+        BoutReal *rxy = rd + (x*ngy + y)*ngz;
+        for(int z=0;z<ngz;z++)
+          rxy[z] = ai[x*ngz + z];
+      }
+    }
   }
-
-#ifdef CHECK
-  msg_stack.pop();
-#endif
   
   return r;
 }
 
-
 BoutReal Average_XY(const Field2D &var) {
   Field2D result;
   BoutReal Vol_Loc, Vol_Glb;
@@ -347,13 +403,19 @@ BoutReal Vol_Integral(const Field2D &var) {
 }
 
 const Field3D smoothXY(const Field3D &f) {
+  TRACE("smoothXY");
+  mesh->communicatePending(); // Guard cells needed
+  
   Field3D result;
   result.allocate();
+  BoutReal *r = &result(0,0,0);
+  int ngy = mesh->LocalNy, ngz = mesh->LocalNz;
 
+  BOUT_OMP(parallel for)
   for(int x=2;x<mesh->LocalNx-2;x++)
     for(int y=2;y<mesh->LocalNy-2;y++)
       for(int z=0;z<mesh->LocalNz;z++) {
-        result(x,y,z) = 0.5*f(x,y,z) + 0.125*( 0.5*f(x+1,y,z) + 0.125*(f(x+2,y,z) + f(x,y,z) + f(x+1,y-1,z) + f(x+1,y+1,z)) +
+        r[(x*ngy + y)*ngz + z] = 0.5*f(x,y,z) + 0.125*( 0.5*f(x+1,y,z) + 0.125*(f(x+2,y,z) + f(x,y,z) + f(x+1,y-1,z) + f(x+1,y+1,z)) +
                                                    0.5*f(x-1,y,z) + 0.125*(f(x,y,z) + f(x-2,y,z) + f(x-1,y-1,z) + f(x-1,y+1,z)) +
                                                    0.5*f(x,y-1,z) + 0.125*(f(x+1,y-1,z) + f(x-1,y-1,z) + f(x,y-2,z) + f(x,y,z)) +
                                                    0.5*f(x,y+1,z) + 0.125*(f(x+1,y+1,z) + f(x-1,y+1,z) + f(x,y,z) + f(x,y+2,z)));
@@ -391,34 +453,57 @@ void nl_filter(rvec &f, BoutReal w) {
 }
 
 const Field3D nl_filter_x(const Field3D &f, BoutReal w) {
-
   TRACE("nl_filter_x( Field3D )");
+  mesh->communicatePending(); // Guard cells needed
+  
+  int ngx = mesh->LocalNx, ngy = mesh->LocalNy, ngz = mesh->LocalNz;
   
-    Field3D result;
-  rvec v;
+  Field3D result;
+  result.allocate();
+  BoutReal *r = &result(0,0,0);
   
-  for(int jy=0;jy<mesh->LocalNy;jy++)
-    for(int jz=0;jz<mesh->LocalNz;jz++) {
-      f.getXArray(jy, jz, v);
+  BOUT_OMP(parallel)
+  {
+    rvec v(ngx); // Workspace for each thread
+    
+    BOUT_OMP(for)
+    for(int j=0;j<ngy*ngz;j++) {
+      // j = jy*ngz + jz
+      for(int jx=0;jx<ngx;jx++)
+        v[jx] = f(jx, j / ngz, j % ngz);
       nl_filter(v, w);
-      result.setXArray(jy, jz, v);
+      for(int jx=0;jx<ngx;jx++)
+        r[jx*ngy*ngz + j] = v[jx];
     }
+  }
   
   return result;
 }
 
 const Field3D nl_filter_y(const Field3D &fs, BoutReal w) {
-  TRACE("nl_filter_x( Field3D )");
+  TRACE("nl_filter_y( Field3D )");
+  mesh->communicatePending(); // Guard cells needed
+  
+  int ngx = mesh->LocalNx, ngy = mesh->LocalNy, ngz = mesh->LocalNz;
   
   Field3D result;
-  rvec v;
+  result.allocate();
+  BoutReal *r = &result(0,0,0);
   
-  for(int jx=0;jx<mesh->LocalNx;jx++)
-    for(int jz=0;jz<mesh->LocalNz;jz++) {
-      fs.getYArray(jx, jz, v);
-      nl_filter(v, w);
-      result.setYArray(jx, jz, v);
-    }
+  BOUT_OMP(parallel)
+  {
+    rvec v(ngy); // Workspace for each thread
+    
+    BOUT_OMP(for)
+    for(int jx=0;jx<ngx;jx++)
+      for(int jz=0;jz<ngz;jz++) {
+        for(int jy=0;jy<ngy;jy++)
+          v[jy] = fs(jx, jy, jz);
+        nl_filter(v, w);
+        for(int jy=0;jy<ngy;jy++)
+          r[(jx*ngy + jy)*ngz + jz] = v[jy];
+      }
+  }
   
   return result;
 }
@@ -426,15 +511,26 @@ const Field3D nl_filter_y(const Field3D &fs, BoutReal w) {
 const Field3D nl_filter_z(const Field3D &fs, BoutReal w) {
   TRACE("nl_filter_z( Field3D )");
   
+  int ngx = mesh->LocalNx, ngy = mesh->LocalNy, ngz = mesh->LocalNz;
+  
   Field3D result;
-  rvec v;
+  result.allocate();
+  BoutReal *r = &result(0,0,0);
   
-  for(int jx=0;jx<mesh->LocalNx;jx++)
-    for(int jy=0;jy<mesh->LocalNy;jy++) {
-      fs.getZArray(jx, jy, v);
+  BOUT_OMP(parallel)
+  {
+    rvec v(ngz); // Workspace for each thread
+    
+    BOUT_OMP(for)
+    for(int j=0;j<ngx*ngy;j++) {
+      const BoutReal *fz = &fs(0,0,0) + j*ngz;
+      for(int jz=0;jz<ngz;jz++)
+        v[jz] = fz[jz];
       nl_filter(v, w);
-      result.setZArray(jx, jy, v);
+      for(int jz=0;jz<ngz;jz++)
+        r[j*ngz + jz] = v[jz];
     }
+  }
 
   return result;
 }
@@ -0,0 +1,183 @@
+/**************************************************************************
+ * In-memory checkpoints, copied to a partner processor
+ *
+ **************************************************************************
+ * Copyright 2017 B.D.Dudson
+ *
+ * Contact: Ben Dudson, bd512@york.ac.uk
+ *
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+#include <bout/checkpoint.hxx>
+
+#include <boutexception.hxx>
+#include <msg_stack.hxx>
+#include <output.hxx>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+/// Position of the data in a copy
+const int HEADER = 3;
+}
+
+void MemoryCheckpoint::save(MPI_Comm c, const BoutReal *data, int n, BoutReal simtime, int iteration) {
+  TRACE("MemoryCheckpoint::save");
+
+  if(c != comm) {
+    comm = c;
+    findBuddy();
+  }
+
+  local.resize(HEADER + n);
+  local[0] = simtime;
+  local[1] = iteration;
+  std::copy(data, data + n, local.begin() + HEADER);
+  local[2] = checksum(local);
+
+  if(send_to >= 0)
+    exchange(local, send_to, buddy, recv_from);
+}
+
+int MemoryCheckpoint::iteration() const {
+  if(local.empty())
+    return -1;
+  return static_cast<int>(local[1]);
+}
+
+bool MemoryCheckpoint::restore(BoutReal *data, int n, BoutReal &simtime, int &iteration) {
+  TRACE("MemoryCheckpoint::restore");
+
+  if(local.empty())
+    throw BoutException("MemoryCheckpoint: No checkpoint to restore");
+
+  if(!check(local))
+    return false;
+
+  unpack(local, data, n, simtime, iteration);
+  return true;
+}
+
+void MemoryCheckpoint::recover(BoutReal *data, int n, BoutReal &simtime, int &iteration) {
+  TRACE("MemoryCheckpoint::recover");
+
+  if(local.empty())
+    throw BoutException("MemoryCheckpoint: No checkpoint to restore");
+
+  // Usually all copies are fine, and nothing needs to be sent
+  int ok = check(local), allok = ok;
+  if(send_to >= 0)
+    MPI_Allreduce(&ok, &allok, 1, MPI_INT, MPI_MIN, comm);
+
+  if(!allok && (send_to >= 0)) {
+    // Buddies return the copies they hold
+    std::vector<BoutReal> returned;
+    exchange(buddy, recv_from, returned, send_to);
+
+    if(!ok && check(returned)) {
+      output.write("WARNING: In-memory checkpoint corrupted. Using copy from processor %d\n", send_to);
+      unpack(returned, data, n, simtime, iteration);
+      return;
+    }
+  }
+
+  if(!ok)
+    throw BoutException("MemoryCheckpoint: Checkpoint is corrupted, and has no valid copy");
+
+  unpack(local, data, n, simtime, iteration);
+}
+
+void MemoryCheckpoint::findBuddy() {
+  int npes, mype;
+  MPI_Comm_size(comm, &npes);
+  MPI_Comm_rank(comm, &mype);
+
+  if(npes == 1) {
+    // Only one copy
+    send_to = recv_from = -1;
+    return;
+  }
+
+  // Processors on a node usually have consecutive ranks, so offset by
+  // the number on this node to reach the next node
+  int offset = 1;
+#if MPI_VERSION >= 3
+  MPI_Comm node;
+  MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, mype, MPI_INFO_NULL, &node);
+  MPI_Comm_size(node, &offset);
+  MPI_Comm_free(&node);
+  // Nodes may have different numbers of processors. Use the
+  // largest, so that all processors agree on the offset
+  MPI_Allreduce(MPI_IN_PLACE, &offset, 1, MPI_INT, MPI_MAX, comm);
+  if(offset >= npes) {
+    output.write("WARNING: All processors on one node. In-memory checkpoints are copied to the same node\n");
+    offset = 1;
+  }
+#endif
+
+  send_to = (mype + offset) % npes;
+  recv_from = (mype - offset + npes) % npes;
+}
+
+void MemoryCheckpoint::exchange(const std::vector<BoutReal> &out, int dest,
+                                std::vector<BoutReal> &in, int source) {
+  int nout = out.size(), nin;
+  MPI_Sendrecv(&nout, 1, MPI_INT, dest, 0,
+               &nin, 1, MPI_INT, source, 0, comm, MPI_STATUS_IGNORE);
+  in.resize(nin);
+  MPI_Sendrecv(out.data(), nout, MPI_DOUBLE, dest, 1,
+               in.data(), nin, MPI_DOUBLE, source, 1, comm, MPI_STATUS_IGNORE);
+}
+
+BoutReal MemoryCheckpoint::checksum(const std::vector<BoutReal> &copy) {
+  // Fletcher-like sums of the bits of each value
+  uint64_t a = 0, b = 0;
+  for(size_t i=0;i<copy.size();i++) {
+    if(i == 2)
+      continue; // The checksum
+    uint64_t v;
+    std::memcpy(&v, &copy[i], sizeof(v));
+    a += v;
+    b += a;
+  }
+  uint64_t sum = a ^ (b << 1);
+  sum &= ~(UINT64_C(0x7ff) << 52); // Clear the exponent, so the value is finite
+  BoutReal result;
+  std::memcpy(&result, &sum, sizeof(result));
+  return result;
+}
+
+bool MemoryCheckpoint::check(const std::vector<BoutReal> &copy) {
+  if(copy.size() < HEADER)
+    return false;
+  BoutReal sum = checksum(copy);
+  return std::memcmp(&sum, &copy[2], sizeof(sum)) == 0;
+}
+
+void MemoryCheckpoint::unpack(const std::vector<BoutReal> &copy, BoutReal *data, int n,
+                              BoutReal &simtime, int &iteration) {
+  if(static_cast<int>(copy.size()) != HEADER + n)
+    throw BoutException("MemoryCheckpoint: Checkpoint has %d values, not %d",
+                        static_cast<int>(copy.size()) - HEADER, n);
+
+  simtime = copy[0];
+  iteration = static_cast<int>(copy[1]);
+  std::copy(copy.begin() + HEADER, copy.end(), data);
+}
@@ -0,0 +1,232 @@
+
+#include "multirate.hxx"
+
+#include <boutcomm.hxx>
+#include <utils.hxx>
+#include <boutexception.hxx>
+#include <msg_stack.hxx>
+
+#include <cmath>
+#include <map>
+
+#include <output.hxx>
+
+MultirateSolver::MultirateSolver(Options *opt) : Solver(opt), f(0) {
+  
+}
+
+MultirateSolver::~MultirateSolver() {
+  if(f != 0) {
+    delete[] f;
+    delete[] L;
+  }
+}
+
+void MultirateSolver::setMaxTimestep(BoutReal dt) {
+  if(dt > timestep)
+    return; // Already less than this
+  
+  timestep = dt; // Won't be used this time, but next
+}
+
+int MultirateSolver::init(bool restarting, int nout, BoutReal tstep) {
+
+  int msg_point = msg_stack.push("Initialising multirate solver");
+  
+  /// Call the generic initialisation first
+  if(Solver::init(restarting, nout, tstep))
+    return 1;
+  
+  output << "\n\tMultirate SSP-RK3 solver\n";
+
+  nsteps = nout; // Save number of output steps
+  out_timestep = tstep;
+  max_dt = tstep;
+  
+  // Calculate number of variables
+  nlocal = getLocalN();
+  
+  // Get total problem size
+  int ntmp;
+  if(MPI_Allreduce(&nlocal, &ntmp, 1, MPI_INT, MPI_SUM, BoutComm::get())) {
+    throw BoutException("MPI_Allreduce failed!");
+  }
+  neq = ntmp;
+  
+  output.write("\t3d fields = %d, 2d fields = %d neq=%d, local_N=%d\n",
+	       n3Dvars(), n2Dvars(), neq, nlocal);
+  
+  // Allocate memory
+  f = new BoutReal[nlocal];
+  L = new BoutReal[nlocal];
+  
+  // Put starting values into f
+  save_vars(f);
+  
+  // Get options
+  OPTION(options, max_timestep, tstep); // Maximum timestep
+  OPTION(options, timestep, max_timestep); // Starting timestep
+  OPTION(options, subcycles, 4); // Timestep ratio between rate groups
+  if(subcycles < 1)
+    throw BoutException("Multirate solver: subcycles must be >= 1\n");
+  
+  // Sort the state vector into rate groups. Use L as temporary storage
+  set_group(L);
+  std::map<int, std::vector<int> > groups;
+  for(int i=0;i<nlocal;i++)
+    groups[ROUND(L[i])].push_back(i);
+  
+  // All processors must agree on the levels, even if some groups
+  // have no points locally. Gather the list of groups in use
+  int maxgroup = 0;
+  for(const auto &g : groups) {
+    if(g.first < 0)
+      throw BoutException("Multirate solver: rate_group must be >= 0\n");
+    maxgroup = BOUTMAX(maxgroup, g.first);
+  }
+  int ngroups;
+  MPI_Allreduce(&maxgroup, &ngroups, 1, MPI_INT, MPI_MAX, BoutComm::get());
+  ngroups++;
+  
+  std::vector<int> local_used(ngroups, 0), used(ngroups);
+  for(const auto &g : groups)
+    local_used[g.first] = 1;
+  MPI_Allreduce(local_used.data(), used.data(), ngroups, MPI_INT, MPI_MAX, BoutComm::get());
+  
+  // Levels ordered slowest to fastest, skipping empty groups
+  for(int g=0;g<ngroups;g++) {
+    if(!used[g])
+      continue;
+    RateLevel level;
+    level.group = g;
+    level.index = groups[g];
+    level.start.resize(level.index.size());
+    levels.push_back(level);
+  }
+  
+  output.write("\t%d rate groups, subcycles = %d\n", static_cast<int>(levels.size()), subcycles);
+  
+  if(levels.size() > 1) {
+    // Subcycling only saves work if the model can calculate a
+    // single group. Call the fastest group once to find out
+    bool allow_full_rhs;
+    OPTION(options, allow_full_rhs, false);
+    
+    load_vars(f);
+    run_rhs(simtime, levels.back().group);
+    if(!have_group_rhs()) {
+      if(!allow_full_rhs)
+        throw BoutException("Multirate solver: The model does not implement rhs_group(t, group), so all time derivatives would be calculated on every substep. Implement rhs_group(t, group), or set solver:allow_full_rhs = true\n");
+      output.write("\tWARNING: Model does not implement rhs_group(t, group). All time derivatives are calculated on every substep\n");
+    }
+  }
+  
+  msg_stack.pop(msg_point);
+
+  return 0;
+}
+
+int MultirateSolver::run() {
+  int msg_point = msg_stack.push("MultirateSolver::run()");
+  
+  for(int s=0;s<nsteps;s++) {
+    BoutReal target = simtime + out_timestep;
+    
+    BoutReal dt;
+    bool running = true;
+    do {
+      // Take a single time step
+      
+      dt = timestep;
+      running = true;
+      if((simtime + dt) >= target) {
+        dt = target - simtime; // Make sure the last timestep is on the output 
+        running = false;
+      }
+      
+      advance(0, simtime, dt);
+      
+      simtime += dt;
+      
+      call_timestep_monitors(simtime, dt);
+    }while(running);
+    
+    load_vars(f); // Put result into variables
+    // Call rhs function to get extra variables at this time
+    run_rhs(simtime);
+ 
+    iteration++; // Advance iteration number
+    
+    /// Call the monitor function
+    
+    if(call_monitors(simtime, s, nsteps)) {
+      // User signalled to quit
+      break;
+    }
+    
+    // Reset iteration and wall-time count
+    rhs_ncalls = 0;
+  }
+  
+  msg_stack.pop(msg_point);
+  
+  return 0;
+}
+
+void MultirateSolver::advance(int level, BoutReal curtime, BoutReal dt) {
+  if(level == static_cast<int>(levels.size()) - 1) {
+    // Fastest level
+    take_step(level, curtime, dt);
+    return;
+  }
+  
+  // Strang splitting: faster levels are subcycled for half
+  // the step either side of this level's step
+  BoutReal half = 0.5*dt;
+  int n1 = BOUTMAX((subcycles+1)/2, 1);
+  int n2 = BOUTMAX(subcycles/2, 1);
+  
+  for(int k=0;k<n1;k++)
+    advance(level+1, curtime + k*half/n1, half/n1);
+  
+  take_step(level, curtime, dt);
+  
+  for(int k=0;k<n2;k++)
+    advance(level+1, curtime + half + k*half/n2, half/n2);
+}
+
+void MultirateSolver::take_step(int level, BoutReal curtime, BoutReal dt) {
+  RateLevel &lev = levels[level];
+  const int n = lev.index.size();
+  const int *ind = lev.index.data();
+  BoutReal *u0 = lev.start.data();
+  
+  // Only this level's variables are updated, in place
+  #pragma omp parallel for
+  for(int j=0;j<n;j++)
+    u0[j] = f[ind[j]];
+  
+  load_vars(f);
+  run_rhs(curtime, lev.group);
+  save_derivs(L);
+  
+  #pragma omp parallel for
+  for(int j=0;j<n;j++)
+    f[ind[j]] = u0[j] + dt*L[ind[j]];
+  
+  load_vars(f);
+  run_rhs(curtime + dt, lev.group);
+  save_derivs(L);
+  
+  #pragma omp parallel for 
+  for(int j=0;j<n;j++)
+    f[ind[j]] = 0.75*u0[j] + 0.25*f[ind[j]] + 0.25*dt*L[ind[j]];
+  
+  load_vars(f);
+  run_rhs(curtime + 0.5*dt, lev.group);
+  save_derivs(L);
+ 
+  #pragma omp parallel for
+  for(int j=0;j<n;j++)
+    f[ind[j]] = (1./3)*u0[j] + (2./3.)*(f[ind[j]] + dt*L[ind[j]]);
+}
@@ -0,0 +1,89 @@
+/**************************************************************************
+ * Multirate explicit solver, subcycling fast variables
+ *
+ * Each evolving variable is put into a rate group with the
+ * "rate_group" option (default 0, the slowest). The slowest group
+ * is advanced with SSP-RK3 steps of size timestep; each faster group
+ * is subcycled with steps about "subcycles" times smaller, using
+ * Strang splitting between groups: half the faster groups, a step of
+ * this group with the faster groups held fixed, then the other half.
+ *
+ * Models can implement rhs_group(t, group) to calculate only the time
+ * derivatives of a single group, so that slow terms are not
+ * evaluated on every fast substep.
+ *
+ * Always available, since doesn't depend on external library
+ *
+ **************************************************************************
+ *
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+class MultirateSolver;
+
+#ifndef __MULTIRATE_SOLVER_H__
+#define __MULTIRATE_SOLVER_H__
+
+#include "mpi.h"
+
+#include <bout_types.hxx>
+#include <bout/solver.hxx>
+
+#include <vector>
+
+class MultirateSolver : public Solver {
+ public:
+  MultirateSolver(Options *opt = NULL);
+  ~MultirateSolver();
+  
+  void setMaxTimestep(BoutReal dt);
+  BoutReal getCurrentTimestep() {return timestep; }
+  
+  int init(bool restarting, int nout, BoutReal tstep);
+  
+  int run();
+ private:
+
+  BoutReal max_timestep; // Maximum timestep
+  int subcycles; // Ratio of timesteps between successive rate groups
+  
+  BoutReal out_timestep; // The output timestep
+  int nsteps; // Number of output steps
+  
+  BoutReal timestep; // The internal (slowest) timestep
+
+  int nlocal, neq; // Number of variables on local processor and in total
+  
+  BoutReal *f; // State vector
+  BoutReal *L; // Time derivatives
+  
+  /// A set of variables advanced with the same timestep
+  struct RateLevel {
+    int group;              // The rate_group option value
+    std::vector<int> index; // Indices into the state vector
+    std::vector<BoutReal> start; // State at the start of a step
+  };
+  std::vector<RateLevel> levels; // Ordered slowest to fastest
+  
+  /// Advance levels >= level by dt, with a single step of this level
+  void advance(int level, BoutReal curtime, BoutReal dt);
+  
+  /// SSP-RK3 step of one level, all other variables held fixed
+  void take_step(int level, BoutReal curtime, BoutReal dt);
+};
+
+#endif // __MULTIRATE_SOLVER_H__
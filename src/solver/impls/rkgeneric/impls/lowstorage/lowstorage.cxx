@@ -0,0 +1,101 @@
+#include "lowstorage.hxx"
+
+LowStorageRKScheme::LowStorageRKScheme(Options *options):RKScheme(options){
+  numOrders = 1; //No embedded error estimate
+  followHighOrder = true;
+
+  lsA = (BoutReal*)NULL;
+  lsB = (BoutReal*)NULL;
+}
+
+LowStorageRKScheme::~LowStorageRKScheme(){
+  delete[] lsA;
+  delete[] lsB;
+}
+
+bool LowStorageRKScheme::lowStorageCoeffs(const int curStage, BoutReal &a, BoutReal &b){
+  a = lsA[curStage];
+  b = lsB[curStage];
+  return true;
+}
+
+void LowStorageRKScheme::allocateStorage(){
+  //No embedded error estimate, so never adaptive
+  adaptive = false;
+
+  //The solver holds the two registers, so nothing to store per stage
+}
+
+//Expand the 2N form into the equivalent (lower triangular) Butcher tableau.
+//This is only used for the diagnostics in RKScheme, not for stepping.
+void LowStorageRKScheme::setButcherTableau(){
+  stageCoeffs = matrix<BoutReal>(numStages,numStages);
+  resultCoeffs = matrix<BoutReal>(numStages,numOrders);
+
+  for(int k=0;k<=numStages;k++){
+    for(int j=0;j<numStages;j++){
+      BoutReal coeff = 0.;
+      for(int i=j;i<k;i++){
+	BoutReal prod = lsB[i];
+	for(int m=j+1;m<=i;m++){
+	  prod *= lsA[m];
+	}
+	coeff += prod;
+      }
+
+      if(k<numStages){
+	stageCoeffs[k][j] = coeff;
+      }else{
+	resultCoeffs[j][0] = coeff;
+      }
+    }
+  }
+}
+
+LSRK3Scheme::LSRK3Scheme(Options *options):LowStorageRKScheme(options){
+  //Set characteristics of scheme
+  numStages = 3;
+  order = 3;
+  label = "lsrk3";
+
+  lsA = new BoutReal[numStages];
+  lsB = new BoutReal[numStages];
+  timeCoeffs = new BoutReal[numStages];
+
+  lsA[0] = 0.0;         lsB[0] = 1.0/3.0;    timeCoeffs[0] = 0.0;
+  lsA[1] = -5.0/9.0;    lsB[1] = 15.0/16.0;  timeCoeffs[1] = 1.0/3.0;
+  lsA[2] = -153.0/128.0; lsB[2] = 8.0/15.0;  timeCoeffs[2] = 3.0/4.0;
+
+  setButcherTableau();
+}
+
+LSRK4Scheme::LSRK4Scheme(Options *options):LowStorageRKScheme(options){
+  //Set characteristics of scheme
+  numStages = 5;
+  order = 4;
+  label = "lsrk4";
+
+  lsA = new BoutReal[numStages];
+  lsB = new BoutReal[numStages];
+  timeCoeffs = new BoutReal[numStages];
+
+  lsA[0] = 0.0;
+  lsA[1] = -567301805773.0/1357537059087.0;
+  lsA[2] = -2404267990393.0/2016746695238.0;
+  lsA[3] = -3550918686646.0/2091501179385.0;
+  lsA[4] = -1275806237668.0/842570457699.0;
+
+  lsB[0] = 1432997174477.0/9575080441755.0;
+  lsB[1] = 5161836677717.0/13612068292357.0;
+  lsB[2] = 1720146321549.0/2090206949498.0;
+  lsB[3] = 3134564353537.0/4481467310338.0;
+  lsB[4] = 2277821191437.0/14882151754819.0;
+
+  timeCoeffs[0] = 0.0;
+  timeCoeffs[1] = 1432997174477.0/9575080441755.0;
+  timeCoeffs[2] = 2526269341429.0/6820363962896.0;
+  timeCoeffs[3] = 2006345519317.0/3224310063776.0;
+  timeCoeffs[4] = 2802321613138.0/2924317926251.0;
+
+  setButcherTableau();
+}
@@ -0,0 +1,52 @@
+
+class LowStorageRKScheme;
+class LSRK3Scheme;
+class LSRK4Scheme;
+
+#ifndef __LOWSTORAGE_SCHEME_H__
+#define __LOWSTORAGE_SCHEME_H__
+
+#include <bout/rkscheme.hxx>
+#include <utils.hxx>
+
+/// Low-storage (2N-register) Runge-Kutta schemes in Williamson form
+///
+/// Each stage performs
+///     du = A[i]*du + dt*F(u)
+///     u  = u + B[i]*du
+/// so only the state u and the du register are needed. The scheme
+/// stores no stage data itself: RKGenericSolver steps these schemes
+/// in place using the coefficients from lowStorageCoeffs. These
+/// schemes have no embedded error estimate, so cannot be used with
+/// adaptive timestepping.
+class LowStorageRKScheme : public RKScheme{
+ public:
+  LowStorageRKScheme(Options *options);
+  ~LowStorageRKScheme();
+
+  bool lowStorageCoeffs(int curStage, BoutReal &a, BoutReal &b);
+
+ protected:
+  //The 2N coefficients, of length numStages
+  BoutReal *lsA;
+  BoutReal *lsB;
+
+  //Fill the equivalent Butcher tableau from lsA and lsB
+  void setButcherTableau();
+
+  void allocateStorage();
+};
+
+/// Williamson (1980) three stage, third order scheme
+class LSRK3Scheme : public LowStorageRKScheme{
+ public:
+  LSRK3Scheme(Options *options);
+};
+
+/// Carpenter & Kennedy (1994) five stage, fourth order scheme
+class LSRK4Scheme : public LowStorageRKScheme{
+ public:
+  LSRK4Scheme(Options *options);
+};
+
+#endif // __LOWSTORAGE_SCHEME_H__
@@ -108,35 +108,28 @@ RK4SIMPLEScheme::~RK4SIMPLEScheme(){
 }
 
 BoutReal RK4SIMPLEScheme::setOutputStates(const BoutReal *start, const BoutReal dt, BoutReal *resultFollow){
-  //return RKScheme::setOutputStates(start,dt,resultFollow);
-  if(followHighOrder){
-    for(int i=0;i<nlocal;i++){
-      if(adaptive){
-	resultAlt[i]=start[i]+dt*(resultCoeffs[0][1]*steps[0][i]+resultCoeffs[1][1]*steps[1][i]
+  //Build both solutions and the local error in one pass
+  BoutReal local_err = 0.;
+  #pragma omp parallel for reduction(+: local_err)
+  for(int i=0;i<nlocal;i++){
+    //Single large step
+    BoutReal large = start[i]+dt*(resultCoeffs[0][1]*steps[0][i]+resultCoeffs[1][1]*steps[1][i]
 				  +resultCoeffs[2][1]*steps[2][i]+resultCoeffs[3][1]*steps[3][i]);
-      }
 
-      resultFollow[i]=start[i]+dt*(resultCoeffs[0][0]*steps[0][i]+resultCoeffs[4][0]*steps[4][i]
-				   +resultCoeffs[5][0]*steps[5][i]+resultCoeffs[6][0]*steps[6][i]);
-
-      resultFollow[i]=resultFollow[i]+dt*(resultCoeffs[7][0]*steps[7][i]+resultCoeffs[8][0]*steps[8][i]
-				   +resultCoeffs[9][0]*steps[9][i]+resultCoeffs[10][0]*steps[10][i]);
-    }
-  }else{
-    for(int i=0;i<nlocal;i++){
+    //Two half steps
+    BoutReal small = start[i]+dt*(resultCoeffs[0][0]*steps[0][i]+resultCoeffs[4][0]*steps[4][i]
+				  +resultCoeffs[5][0]*steps[5][i]+resultCoeffs[6][0]*steps[6][i]);
+    small = small+dt*(resultCoeffs[7][0]*steps[7][i]+resultCoeffs[8][0]*steps[8][i]
+		      +resultCoeffs[9][0]*steps[9][i]+resultCoeffs[10][0]*steps[10][i]);
 
-      resultFollow[i]=start[i]+dt*(resultCoeffs[0][1]*steps[0][i]+resultCoeffs[1][1]*steps[1][i]
-				   +resultCoeffs[2][1]*steps[2][i]+resultCoeffs[3][1]*steps[3][i]);
+    resultFollow[i] = followHighOrder ? small : large;
 
-      if(adaptive) {
-	resultAlt[i]=start[i]+dt*(resultCoeffs[0][0]*steps[0][i]+resultCoeffs[4][0]*steps[4][i]
-				  +resultCoeffs[5][0]*steps[5][i]+resultCoeffs[6][0]*steps[6][i]);
-	
-	resultAlt[i]=resultAlt[i]+dt*(resultCoeffs[7][0]*steps[7][i]+resultCoeffs[8][0]*steps[8][i]
-				      +resultCoeffs[9][0]*steps[9][i]+resultCoeffs[10][0]*steps[10][i]);
-      }
+    if(adaptive){
+      local_err += fabs(small - large) / ( fabs(small) + fabs(large) + atol );
     }
   }
+
+  if(!adaptive) return 0.;
   
-  return getErr(resultFollow,resultAlt);
+  return globalErr(local_err);
 }
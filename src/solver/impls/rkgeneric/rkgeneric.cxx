@@ -14,6 +14,9 @@
 
 RKGenericSolver::RKGenericSolver(Options *options) : Solver(options) {
   f0 = 0; // Mark as uninitialised
+  f2 = 0;
+  tmpState = 0;
+  du = 0;
 
   //Create scheme
   scheme=RKSchemeFactory::getInstance()->createRKScheme(options);
@@ -22,11 +25,11 @@ RKGenericSolver::RKGenericSolver(Options *options) : Solver(options) {
 RKGenericSolver::~RKGenericSolver() {
   delete scheme;
 
-  if(f0 != 0) {
-    delete[] f0;
-    delete[] f2;
-    delete[] tmpState;
-  }
+  // Low-storage schemes only allocate f0 and du
+  delete[] f0;
+  delete[] f2;
+  delete[] tmpState;
+  delete[] du;
 }
 
 void RKGenericSolver::setMaxTimestep(BoutReal dt) {
@@ -74,12 +77,28 @@ int RKGenericSolver::init(bool restarting, int nout, BoutReal tstep) {
   OPTION(options, max_timestep, tstep); // Maximum timestep
   OPTION(options, timestep, max_timestep); // Starting timestep
   OPTION(options, mxstep, 500); // Maximum number of steps between outputs
-  OPTION(options, adaptive, true); // Prefer adaptive scheme
+  // Schemes with no embedded error estimate (e.g. low-storage schemes)
+  // can't adapt, so default to a fixed timestep
+  bool can_adapt = scheme->getNumOrders() >= 2;
+  OPTION(options, adaptive, can_adapt); // Prefer adaptive scheme
+
+  if(adaptive && !can_adapt) {
+    output << "\tWARNING: Scheme "<<scheme->getType()<<" is not adaptive, using fixed timestep\n";
+    adaptive = false;
+  }
+
+  BoutReal a, b;
+  lowStorage = scheme->lowStorageCoeffs(0, a, b);
 
   // Allocate memory
   f0 = new BoutReal[nlocal]; //Input
-  f2 = new BoutReal[nlocal]; //Result--follow order
-  tmpState = new BoutReal[nlocal];
+  if(lowStorage) {
+    // Stepped in place, so only the state and update registers
+    du = new BoutReal[nlocal];
+  }else {
+    f2 = new BoutReal[nlocal]; //Result--follow order
+    tmpState = new BoutReal[nlocal];
+  }
 
   // Put starting values into f0
   save_vars(f0);
@@ -116,6 +135,10 @@ int RKGenericSolver::run() {
 	BoutReal err;
 
 	//Take a step
+	if(lowStorage) {
+	  take_lowstorage_step(simtime, dt, f0);
+	  break; // Never adaptive
+	}
 	err = take_step(simtime, dt, f0, f2);
 
 	//Calculate and check error if adaptive
@@ -149,7 +172,8 @@ int RKGenericSolver::run() {
       }while(true);
       
       // Taken a step, swap buffers to put result into f0
-      swap(f2, f0);
+      if(!lowStorage)
+        swap(f2, f0);
       simtime += dt;
 
       //Call the per internal timestep monitors
@@ -193,3 +217,34 @@ BoutReal RKGenericSolver::take_step(const BoutReal timeIn, const BoutReal dt, co
 
   return scheme->setOutputStates(start, dt, resultFollow);
 }
+
+//Advance the state u in place with a low-storage (2N) scheme. The
+//du register is held divided by dt, so the derivatives can be added
+//to it directly from the time-derivative fields
+void RKGenericSolver::take_lowstorage_step(const BoutReal timeIn, const BoutReal dt, BoutReal *u){
+  const int nstages = scheme->getStageCount();
+  
+  for(int curStage=0;curStage<nstages;curStage++){
+    BoutReal curTime=scheme->setCurTime(timeIn,dt,curStage);
+
+    load_vars(u);
+    run_rhs(curTime);
+
+    if(curStage == 0) {
+      save_derivs(du); // First coefficient a is zero
+    }else
+      add_derivs(du);  // Already multiplied by a
+
+    //Update the state, and scale du ready for the next stage
+    BoutReal a, b, anext = 0., bnext;
+    scheme->lowStorageCoeffs(curStage, a, b);
+    if(curStage < nstages-1)
+      scheme->lowStorageCoeffs(curStage+1, anext, bnext);
+    const BoutReal fac = b*dt;
+    #pragma omp parallel for
+    for(int i=0;i<nlocal;i++){
+      u[i] += fac*du[i];
+      du[i] *= anext;
+    }
+  }
+}
@@ -54,9 +54,15 @@ class RKGenericSolver : public Solver {
   BoutReal take_step(BoutReal timeIn,BoutReal dt, const BoutReal *start, 
 		     BoutReal *resultFollow);
 
+  //Take a step in place using a low-storage scheme
+  void take_lowstorage_step(BoutReal timeIn, BoutReal dt, BoutReal *u);
+
   //Used for storing current state and next step
   BoutReal *f0, *f2;
   BoutReal *tmpState;
+  BoutReal *du; //Update register for low-storage schemes
+
+  bool lowStorage; //Is the scheme stepped in place with two registers?
 
   //Inputs
   BoutReal atol, rtol;   // Tolerances for adaptive timestepping
@@ -4,6 +4,8 @@
 #include <cmath>
 #include <boutcomm.hxx>
 
+#include <vector>
+
 ////////////////////
 // PUBLIC
 ////////////////////
@@ -33,13 +35,12 @@ RKScheme::~RKScheme(){
   //resultCoeffs
   free_matrix(resultCoeffs);
 
-  //steps
-  free_matrix(steps);
+  //steps, not allocated by low-storage schemes
+  if(steps != NULL)
+    free_matrix(steps);
 
   //timeCoeffs
   delete[] timeCoeffs;
-  
-  if(adaptive) delete[] resultAlt;
 }
 
 //Finish generic initialisation
@@ -58,11 +59,7 @@ void RKScheme::init(const int nlocalIn, const int neqIn, const bool adaptiveIn,
   adaptive = adaptiveIn;
 
   //Allocate storage for stages
-  steps = matrix<BoutReal>(getStageCount(),nlocal);
-  zeroSteps();
-
-  //Allocate array for storing alternative order result
-  if(adaptive) resultAlt = new BoutReal[nlocal]; //Result--alternative order
+  allocateStorage();
 
   //Will probably only want the following when debugging, but leave it on for now
   if(diagnose){
@@ -80,29 +77,30 @@ BoutReal RKScheme::setCurTime(const BoutReal timeIn, const BoutReal dt, const in
 void RKScheme::setCurState(const BoutReal *start, BoutReal *out, const int curStage, 
 			   const BoutReal dt){
 
-  //Set the initial stage
-  for(int i=0;i<nlocal;i++){
-    out[i] = start[i];
+  //Collect the contributing stages, so the state is built in one pass
+  std::vector<const BoutReal*> stageData;
+  std::vector<BoutReal> stageFacs;
+  for(int j=0;j<curStage;j++){
+    if(fabs(stageCoeffs[curStage][j]) < atol) continue;
+    stageData.push_back(steps[j]);
+    stageFacs.push_back(stageCoeffs[curStage][j]*dt);
   }
+  const int nterms = stageData.size();
+  const BoutReal* const *data = stageData.data();
+  const BoutReal *facs = stageFacs.data();
 
-  //If on the first stage we don't need to modify the state
-  if(curStage==0) return;//Don't realy need this as below loop won't execute
-  
-  //Construct the current state from previous results -- This is expensive
-  for(int j=0;j<curStage;j++){
-    if(abs(stageCoeffs[curStage][j]) < atol) continue;
-    BoutReal fac=stageCoeffs[curStage][j]*dt;
-    for(int i=0;i<nlocal;i++){
-      out[i] = out[i] + fac*steps[j][i];
+  #pragma omp parallel for
+  for(int i=0;i<nlocal;i++){
+    BoutReal val = start[i];
+    for(int j=0;j<nterms;j++){
+      val += facs[j]*data[j][i];
     }
+    out[i] = val;
   }
 }
 
 //Construct the system state at the next time
 BoutReal RKScheme::setOutputStates(const BoutReal *start, const BoutReal dt, BoutReal *resultFollow){
-  //Only really need resultAlt in order to calculate the error, so if not adaptive could avoid it
-  //*and* technically we can write resultFollow-resultAlt in terms of resultCoeffs and steps.
-
   int followInd, altInd;
   if(followHighOrder){
     followInd=0; altInd=1;
@@ -110,52 +108,85 @@ BoutReal RKScheme::setOutputStates(const BoutReal *start, const BoutReal dt, Bou
     followInd=1; altInd=0;
   }
 
-  //NOTE: It's slightly slower to split construction of output
-  //      into two separate loops as we're doing below *when*
-  //      we want both solutions, but it's faster when not adaptive.
-  //      To get the best of both worlds we could probably do something
-  //      like:
-  /*      
-	  if(adapative){
-	    constructOutputs;
-	  }else{
-            constructOutput;
-	  }
-   */
-
-  //Get the result
-  constructOutput(start,dt,followInd,resultFollow);
-
-  //If adaptive get the second state
-  if(adaptive){
-    constructOutput(start,dt,altInd,resultAlt);
+  if(!adaptive){
+    //Only need the result
+    constructOutput(start,dt,followInd,resultFollow);
+    return 0.;
+  }
+
+  //The alternative solution is only needed for the error, so build both
+  //solutions and the local error in a single pass without storing it
+  std::vector<const BoutReal*> folData, altData;
+  std::vector<BoutReal> folFacs, altFacs;
+  for(int curStage=0;curStage<getStageCount();curStage++){
+    if(resultCoeffs[curStage][followInd] != 0.){
+      folData.push_back(steps[curStage]);
+      folFacs.push_back(dt*resultCoeffs[curStage][followInd]);
+    }
+    if(resultCoeffs[curStage][altInd] != 0.){
+      altData.push_back(steps[curStage]);
+      altFacs.push_back(dt*resultCoeffs[curStage][altInd]);
+    }
+  }
+  const int nfol = folData.size(), nalt = altData.size();
+  const BoutReal* const *fdata = folData.data();
+  const BoutReal* const *adata = altData.data();
+  const BoutReal *ffacs = folFacs.data(), *afacs = altFacs.data();
+
+  BoutReal local_err = 0.;
+  #pragma omp parallel for reduction(+: local_err)
+  for(int i=0;i<nlocal;i++){
+    BoutReal fol = start[i];
+    for(int j=0;j<nfol;j++){
+      fol += ffacs[j]*fdata[j][i];
+    }
+    BoutReal alt = start[i];
+    for(int j=0;j<nalt;j++){
+      alt += afacs[j]*adata[j][i];
+    }
+    resultFollow[i] = fol;
+    local_err += fabs(fol - alt) / ( fabs(fol) + fabs(alt) + atol );
   }
 
-  //Get the error coefficient
-  return getErr(resultFollow,resultAlt);
+  return globalErr(local_err);
 }
 
 BoutReal RKScheme::updateTimestep(const BoutReal dt, const BoutReal err){
   return dtfac*dt*pow(rtol/(2.0*err),1.0/(order+1.0));
 }
 
+////////////////////
+// PROTECTED
+////////////////////
+
+//Allocate one array per stage
+void RKScheme::allocateStorage(){
+  steps = matrix<BoutReal>(getStageCount(),nlocal);
+  zeroSteps();
+}
+
 ////////////////////
 // PRIVATE
 ////////////////////
 
 //Estimate the error, given two solutions
 BoutReal RKScheme::getErr(BoutReal *solA, BoutReal *solB){
-  BoutReal err=0.;
-
   //If not adaptive don't care about the error
-  if(!adaptive){return err;}
+  if(!adaptive){return 0.;}
 
   //Get local part of relative error
   BoutReal local_err = 0.;
+  #pragma omp parallel for reduction(+: local_err)
   for(int i=0;i<nlocal;i++) {
     local_err += fabs(solA[i] - solB[i]) / ( fabs(solA[i]) + fabs(solB[i]) + atol );
   }
-  //Reduce over procs
+
+  return globalErr(local_err);
+}
+
+//Reduce the local error over procs and normalise
+BoutReal RKScheme::globalErr(BoutReal local_err){
+  BoutReal err;
   if(MPI_Allreduce(&local_err, &err, 1, MPI_DOUBLE, MPI_SUM, BoutComm::get())) {
     throw BoutException("MPI_Allreduce failed");
   }
@@ -167,42 +198,27 @@ BoutReal RKScheme::getErr(BoutReal *solA, BoutReal *solB){
 
 void RKScheme::constructOutput(const BoutReal *start, const BoutReal dt, 
 			       const int index, BoutReal *sol){
-  //Initialise the return data
-  for(int i=0;i<nlocal;i++){
-    sol[i]=start[i];
-  }
-
-  //Construct the solution
+  //Collect the contributing stages
+  std::vector<const BoutReal*> stageData;
+  std::vector<BoutReal> stageFacs;
   for(int curStage=0;curStage<getStageCount();curStage++){
     if(resultCoeffs[curStage][index] == 0.) continue; //Real comparison not great
-    BoutReal fac=dt*resultCoeffs[curStage][index];
-    for(int i=0;i<nlocal;i++){
-      sol[i]=sol[i]+fac*steps[curStage][i];
-    }
-  }
-  
-}
-
-void RKScheme::constructOutputs(const BoutReal *start, const BoutReal dt, 
-				const int indexFollow, const int indexAlt, 
-				BoutReal *solFollow, BoutReal *solAlt){
-  //Initialise the return data
-  for(int i=0;i<nlocal;i++){
-    solFollow[i]=start[i];
-    solAlt[i]=start[i];
+    stageData.push_back(steps[curStage]);
+    stageFacs.push_back(dt*resultCoeffs[curStage][index]);
   }
+  const int nterms = stageData.size();
+  const BoutReal* const *data = stageData.data();
+  const BoutReal *facs = stageFacs.data();
 
   //Construct the solution
-  for(int curStage=0;curStage<getStageCount();curStage++){
-    BoutReal facFol=dt*resultCoeffs[curStage][indexFollow];
-    BoutReal facAlt=dt*resultCoeffs[curStage][indexAlt];
-
-    for(int i=0;i<nlocal;i++){
-      solFollow[i]=solFollow[i]+facFol*steps[curStage][i];
-      solAlt[i]=solAlt[i]+facAlt*steps[curStage][i];
+  #pragma omp parallel for
+  for(int i=0;i<nlocal;i++){
+    BoutReal val = start[i];
+    for(int j=0;j<nterms;j++){
+      val += facs[j]*data[j][i];
     }
+    sol[i] = val;
   }
-  
 }
 
 //Check that the coefficients are consistent
@@ -4,6 +4,7 @@
 #include "impls/cashkarp/cashkarp.hxx"
 #include "impls/rk4simple/rk4simple.hxx"
 #include "impls/rkf34/rkf34.hxx"
+#include "impls/lowstorage/lowstorage.hxx"
 
 #include <boutexception.hxx>
 
@@ -49,6 +50,10 @@ RKScheme* RKSchemeFactory::createRKScheme(RKSchemeType &type, Options *options)
     return new RK4SIMPLEScheme(options);
   }else if(!strcasecmp(type, RKSCHEME_RKF34)) {
     return new RKF34Scheme(options);
+  }else if(!strcasecmp(type, RKSCHEME_LSRK3)) {
+    return new LSRK3Scheme(options);
+  }else if(!strcasecmp(type, RKSCHEME_LSRK4)) {
+    return new LSRK4Scheme(options);
   };
 
   // Need to throw an error saying 'Supplied option "type"' was not found
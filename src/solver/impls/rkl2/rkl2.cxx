@@ -0,0 +1,332 @@
+
+#include "rkl2.hxx"
+
+#include <boutcomm.hxx>
+#include <utils.hxx>
+#include <boutexception.hxx>
+#include <msg_stack.hxx>
+
+#include <cmath>
+#include <cfloat>
+
+#include <output.hxx>
+
+RKL2Solver::RKL2Solver(Options *opt) : Solver(opt), f(0) {
+  
+}
+
+RKL2Solver::~RKL2Solver() {
+  if(f != 0) {
+    delete[] f;
+    
+    delete[] MY0;
+    delete[] Y1;
+    delete[] Y2;
+    delete[] L;
+  }
+}
+
+void RKL2Solver::setMaxTimestep(BoutReal dt) {
+  if(dt > timestep)
+    return; // Already less than this
+  
+  timestep = dt; // Won't be used this time, but next
+}
+
+int RKL2Solver::init(bool restarting, int nout, BoutReal tstep) {
+
+  int msg_point = msg_stack.push("Initialising RKL2 solver");
+  
+  /// Call the generic initialisation first
+  if(Solver::init(restarting, nout, tstep))
+    return 1;
+  
+  output << "\n\tRunge-Kutta-Legendre (RKL2) super time-stepping solver\n";
+  if(splitOperator()) {
+    output << "\tStrang split: RKL2 diffusive, SSP-RK3 convective\n";
+  }else {
+    output << "\tModel not split: treating whole RHS as diffusive\n";
+  }
+
+  nsteps = nout; // Save number of output steps
+  out_timestep = tstep;
+  max_dt = tstep;
+  
+  // Calculate number of variables
+  nlocal = getLocalN();
+  
+  // Get total problem size
+  int ntmp;
+  if(MPI_Allreduce(&nlocal, &ntmp, 1, MPI_INT, MPI_SUM, BoutComm::get())) {
+    throw BoutException("MPI_Allreduce failed!");
+  }
+  neq = ntmp;
+  
+  output.write("\t3d fields = %d, 2d fields = %d neq=%d, local_N=%d\n",
+	       n3Dvars(), n2Dvars(), neq, nlocal);
+  
+  // Allocate memory
+  f = new BoutReal[nlocal];
+  
+  // memory for taking a single time step
+  MY0 = new BoutReal[nlocal];
+  Y1 = new BoutReal[nlocal];
+  Y2 = new BoutReal[nlocal];
+  L = new BoutReal[nlocal];
+
+  // Put starting values into f
+  save_vars(f);
+  
+  // Get options
+  OPTION(options, max_timestep, tstep); // Maximum timestep
+  OPTION(options, timestep, max_timestep); // Starting timestep
+  OPTION(options, diffusive_timestep, -1.0); // Explicit diffusive limit (<= 0 to estimate)
+  OPTION(options, safety, 1.1); // Safety factor on spectral radius
+  OPTION(options, max_power_its, 20); // Power iterations for spectral radius
+  OPTION(options, update_radius, 1); // Re-estimate spectral radius every N steps
+  OPTION(options, max_stages, 1000); // Maximum number of stages
+  OPTION(options, diagnose, false); // Print stage counts
+
+  if(diffusive_timestep > 0.0) {
+    // Forward Euler stable for dt*radius <= 2
+    radius = 2.0 / diffusive_timestep;
+  }
+  steps_since_radius = update_radius; // Estimate on first step
+
+  msg_stack.pop(msg_point);
+
+  return 0;
+}
+
+int RKL2Solver::run() {
+  int msg_point = msg_stack.push("RKL2Solver::run()");
+  
+  for(int s=0;s<nsteps;s++) {
+    BoutReal target = simtime + out_timestep;
+    
+    BoutReal dt;
+    bool running = true;
+    do {
+      // Take a single time step
+      
+      dt = timestep;
+      running = true;
+      if((simtime + dt) >= target) {
+        dt = target - simtime; // Make sure the last timestep is on the output 
+        running = false;
+      }
+
+      if(diffusive_timestep <= 0.0) {
+        if(steps_since_radius >= update_radius) {
+          radius = estimateRadius(simtime, f);
+          steps_since_radius = 0;
+        }
+        steps_since_radius++;
+      }
+
+      if(splitOperator()) {
+        // Strang splitting
+        diffusive_step(simtime, 0.5*dt, f);
+        convective_step(simtime, dt, f);
+        diffusive_step(simtime + 0.5*dt, 0.5*dt, f);
+      }else {
+        diffusive_step(simtime, dt, f);
+      }
+      
+      simtime += dt;
+      
+      call_timestep_monitors(simtime, dt);
+    }while(running);
+    
+    load_vars(f); // Put result into variables
+    // Call rhs function to get extra variables at this time
+    run_rhs(simtime);
+ 
+    iteration++; // Advance iteration number
+    
+    /// Call the monitor function
+    
+    if(call_monitors(simtime, s, nsteps)) {
+      // User signalled to quit
+      break;
+    }
+    
+    // Reset iteration and wall-time count
+    rhs_ncalls = 0;
+  }
+  
+  msg_stack.pop(msg_point);
+  
+  return 0;
+}
+
+void RKL2Solver::diffusive_rhs(BoutReal curtime, BoutReal *u, BoutReal *ddt) {
+  load_vars(u);
+  if(splitOperator()) {
+    run_diffusive(curtime, false);
+  }else
+    run_rhs(curtime);
+  save_derivs(ddt);
+}
+
+BoutReal RKL2Solver::norm(const BoutReal *v) {
+  BoutReal local = 0.;
+  #pragma omp parallel for reduction(+: local)
+  for(int i=0;i<nlocal;i++)
+    local += v[i]*v[i];
+  
+  BoutReal result;
+  if(MPI_Allreduce(&local, &result, 1, MPI_DOUBLE, MPI_SUM, BoutComm::get())) {
+    throw BoutException("MPI_Allreduce failed!");
+  }
+  return sqrt(result);
+}
+
+/// Nonlinear power iteration, using differences of the RHS
+/// to approximate Jacobian-vector products (as in RKC codes)
+BoutReal RKL2Solver::estimateRadius(BoutReal curtime, BoutReal *u) {
+  // RHS at the current state
+  diffusive_rhs(curtime, u, MY0);
+  
+  BoutReal unorm = norm(u);
+  
+  // Starting direction. Use the RHS unless it vanishes
+  #pragma omp parallel for
+  for(int i=0;i<nlocal;i++)
+    Y1[i] = MY0[i];
+  BoutReal vnorm = norm(Y1);
+  if(vnorm == 0.0) {
+    #pragma omp parallel for
+    for(int i=0;i<nlocal;i++)
+      Y1[i] = (i % 2 == 0) ? 1.0 : -1.0;
+    vnorm = norm(Y1);
+  }
+  
+  // Size of the perturbation
+  BoutReal eps = sqrt(DBL_EPSILON)*(1.0 + unorm);
+  
+  BoutReal rho = 0.0;
+  int it;
+  for(it=0;it<max_power_its;it++) {
+    BoutReal fac = eps / vnorm;
+    #pragma omp parallel for
+    for(int i=0;i<nlocal;i++)
+      Y2[i] = u[i] + fac*Y1[i];
+    
+    diffusive_rhs(curtime, Y2, L);
+    
+    // Y1 = J * (eps * v/|v|)
+    #pragma omp parallel for
+    for(int i=0;i<nlocal;i++)
+      Y1[i] = L[i] - MY0[i];
+    
+    vnorm = norm(Y1);
+    BoutReal rho_new = vnorm / eps;
+    if(vnorm == 0.0) {
+      // Operator is zero in this direction
+      rho = 0.0;
+      break;
+    }
+    bool converged = fabs(rho_new - rho) < 0.01*rho_new;
+    rho = rho_new;
+    if(converged)
+      break;
+  }
+  
+  if(diagnose)
+    output.write("\tRKL2: spectral radius %e after %d iterations\n", rho, it+1);
+  
+  return safety*rho;
+}
+
+int RKL2Solver::getStages(BoutReal dt) {
+  // RKL2 stable for dt*radius <= (s^2 + s - 2)/2
+  BoutReal z = dt*radius;
+  int s = static_cast<int>(ceil(0.5*(-1.0 + sqrt(9.0 + 8.0*z))));
+  if(s < 2)
+    s = 2;
+  if(s > max_stages) {
+    throw BoutException("RKL2 needs %d stages for timestep %e, more than max_stages = %d\n", 
+                        s, dt, max_stages);
+  }
+  return s;
+}
+
+void RKL2Solver::diffusive_step(BoutReal curtime, BoutReal dt, BoutReal *u) {
+  int s = getStages(dt);
+  
+  if(diagnose)
+    output.write("\tRKL2: t = %e, dt = %e, %d stages\n", curtime, dt, s);
+  
+  BoutReal w1 = 4. / (s*s + s - 2.);
+  
+  // Legendre coefficients b_j, with b_0 = b_1 = b_2 = 1/3
+  BoutReal bjm2 = 1./3., bjm1 = 1./3.;
+  
+  // Stage times, as a fraction of dt
+  BoutReal cjm2 = 0.0, cjm1 = w1/3.;
+  
+  diffusive_rhs(curtime, u, MY0);
+  
+  // First stage
+  BoutReal mu1 = w1/3.;
+  #pragma omp parallel for
+  for(int i=0;i<nlocal;i++) {
+    Y2[i] = u[i];
+    Y1[i] = u[i] + mu1*dt*MY0[i];
+  }
+  
+  for(int j=2;j<=s;j++) {
+    BoutReal bj = (j == 2) ? 1./3. : (j*j + j - 2.) / (2.*j*(j + 1.));
+    BoutReal mu = (2.*j - 1.)/j * bj/bjm1;
+    BoutReal nu = -(j - 1.)/j * bj/bjm2;
+    BoutReal mut = mu*w1;
+    BoutReal gt = -(1. - bjm1)*mut;
+    
+    diffusive_rhs(curtime + cjm1*dt, Y1, L);
+    
+    BoutReal a = 1. - mu - nu;
+    if(j < s) {
+      // Overwrite the stage j-2 with stage j, then swap
+      #pragma omp parallel for
+      for(int i=0;i<nlocal;i++)
+        Y2[i] = mu*Y1[i] + nu*Y2[i] + a*u[i] + dt*(mut*L[i] + gt*MY0[i]);
+      swap(Y1, Y2);
+    }else {
+      // Last stage goes straight into the result
+      #pragma omp parallel for
+      for(int i=0;i<nlocal;i++)
+        u[i] = mu*Y1[i] + nu*Y2[i] + a*u[i] + dt*(mut*L[i] + gt*MY0[i]);
+    }
+    
+    BoutReal cj = mu*cjm1 + nu*cjm2 + mut + gt;
+    cjm2 = cjm1; cjm1 = cj;
+    bjm2 = bjm1; bjm1 = bj;
+  }
+}
+
+void RKL2Solver::convective_step(BoutReal curtime, BoutReal dt, BoutReal *u) {
+  load_vars(u);
+  run_convective(curtime);
+  save_derivs(L);
+  
+  #pragma omp parallel for
+  for(int i=0;i<nlocal;i++)
+    Y1[i] = u[i] + dt*L[i];
+  
+  load_vars(Y1);
+  run_convective(curtime + dt);
+  save_derivs(L);
+  
+  #pragma omp parallel for 
+  for(int i=0;i<nlocal;i++)
+    Y2[i] = 0.75*u[i] + 0.25*Y1[i] + 0.25*dt*L[i];
+  
+  load_vars(Y2);
+  run_convective(curtime + 0.5*dt);
+  save_derivs(L);
+ 
+  #pragma omp parallel for
+  for(int i=0;i<nlocal;i++)
+    u[i] = (1./3)*u[i] + (2./3.)*(Y2[i] + dt*L[i]);
+}
@@ -0,0 +1,102 @@
+/**************************************************************************
+ * Runge-Kutta-Legendre (RKL2) super time-stepping solver
+ *
+ * The diffusive (parabolic) part of the model is advanced with an
+ * s-stage second order RKL2 step, where s is chosen so that the step is
+ * stable for the whole timestep. The timestep can then be set by the
+ * explicit (hyperbolic) limit rather than dt ~ dx^2.
+ *
+ * If the model is split into convective and diffusive parts, Strang
+ * splitting is used: half a diffusive RKL2 step, a full convective
+ * SSP-RK3 step, then another half diffusive step. If not split, the
+ * whole RHS is treated as parabolic.
+ *
+ * C.D.Meyer, D.S.Balsara and T.D.Aslam, "A stabilized Runge-Kutta-Legendre
+ * method for explicit super-time-stepping of parabolic and mixed equations",
+ * J. Comput. Phys. 257 (2014) 594-626
+ *
+ * Always available, since doesn't depend on external library
+ *
+ **************************************************************************
+ *
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+class RKL2Solver;
+
+#ifndef __RKL2_SOLVER_H__
+#define __RKL2_SOLVER_H__
+
+#include "mpi.h"
+
+#include <bout_types.hxx>
+#include <bout/solver.hxx>
+
+class RKL2Solver : public Solver {
+ public:
+  RKL2Solver(Options *opt = NULL);
+  ~RKL2Solver();
+
+  void setMaxTimestep(BoutReal dt);
+  BoutReal getCurrentTimestep() {return timestep; }
+
+  int init(bool restarting, int nout, BoutReal tstep);
+
+  int run();
+ private:
+  BoutReal max_timestep; // Maximum timestep
+  BoutReal diffusive_timestep; // Explicit diffusive limit. If <= 0, estimated
+  BoutReal safety;   // Safety factor on the spectral radius
+  int max_power_its; // Maximum number of power iterations
+  int update_radius; // Re-estimate the spectral radius every N steps
+  int max_stages;    // Maximum number of RKL2 stages
+  bool diagnose;     // Print stage counts
+
+  BoutReal out_timestep; // The output timestep
+  int nsteps; // Number of output steps
+
+  BoutReal timestep; // The internal timestep
+  BoutReal radius;   // Spectral radius of the diffusive operator
+  int steps_since_radius; // Steps since radius last estimated
+
+  int nlocal, neq; // Number of variables on local processor and in total
+
+  BoutReal *f;   // State vector
+  BoutReal *MY0; // Diffusive RHS at the start of the step
+  BoutReal *Y1, *Y2; // Previous two stages (or SSP-RK3 stages)
+  BoutReal *L;   // RHS work array
+
+  /// Evaluate the diffusive RHS (whole RHS if not split) at u
+  void diffusive_rhs(BoutReal curtime, BoutReal *u, BoutReal *ddt);
+
+  /// Global L2 norm of a state-sized vector
+  BoutReal norm(const BoutReal *v);
+
+  /// Estimate the spectral radius of the diffusive operator at u
+  BoutReal estimateRadius(BoutReal curtime, BoutReal *u);
+
+  /// Number of RKL2 stages needed for a stable step of dt
+  int getStages(BoutReal dt);
+
+  /// Advance u in place through dt using the diffusive operator
+  void diffusive_step(BoutReal curtime, BoutReal dt, BoutReal *u);
+
+  /// Advance u in place through dt using the convective operator (SSP-RK3)
+  void convective_step(BoutReal curtime, BoutReal dt, BoutReal *u);
+};
+
+#endif // __RKL2_SOLVER_H__
@@ -24,6 +24,7 @@
 #include <bout/solver.hxx>
 #include <string.h>
 #include <time.h>
+#include <cmath>
 
 #include <initialprofiles.hxx>
 #include <interpolation.hxx>
@@ -57,6 +58,7 @@ Solver::Solver(Options *opts) : options(opts), model(0), prefunc(0) {
   has_constraints = false;
   initialised = false;
   canReset = false;
+  cacheLocalN = -1;
 
   // Zero timing
   rhs_ncalls = 0;
@@ -80,6 +82,15 @@ Solver::Solver(Options *opts) : options(opts), model(0), prefunc(0) {
 
   // Set up restart options
   restart = Datafile(Options::getRoot()->getSection("restart"));
+  options->get("restart_interval", restart_interval, 1);
+  if(restart_interval < 1)
+    throw BoutException("Solver: restart_interval must be at least 1 (got %d)", restart_interval);
+  restart_iteration = -1;
+
+  // In-memory checkpoints
+  options->get("checkpoint_interval", checkpoint_interval, 0.0);
+  last_checkpoint = MPI_Wtime();
+  error_agreed = false;
   
   // Split operator
   split_operator = false;
@@ -167,6 +178,10 @@ void Solver::add(Field2D &v, const char* name) {
   Options::getRoot()->getSection("all")->get("evolve_bndry", d.evolve_bndry, false);
   Options::getRoot()->getSection(name)->get("evolve_bndry", d.evolve_bndry, d.evolve_bndry);
 
+  // Rate group, used by multirate solvers. 0 is the slowest
+  Options::getRoot()->getSection("all")->get("rate_group", d.rate_group, 0);
+  Options::getRoot()->getSection(name)->get("rate_group", d.rate_group, d.rate_group);
+
   v.applyBoundary(true);
 
   f2d.push_back(d);
@@ -228,6 +243,10 @@ void Solver::add(Field3D &v, const char* name) {
   Options::getRoot()->getSection("all")->get("evolve_bndry", d.evolve_bndry, false);
   Options::getRoot()->getSection(name)->get("evolve_bndry", d.evolve_bndry, d.evolve_bndry);
 
+  // Rate group, used by multirate solvers. 0 is the slowest
+  Options::getRoot()->getSection("all")->get("rate_group", d.rate_group, 0);
+  Options::getRoot()->getSection(name)->get("rate_group", d.rate_group, d.rate_group);
+
   v.applyBoundary(true); // Make sure initial profile obeys boundary conditions
   v.setLocation(d.location); // Restore location if changed
   
@@ -349,6 +368,7 @@ void Solver::constraint(Field2D &v, Field2D &C_v, const char* name) {
   d.constraint = true;
   d.var = &v;
   d.F_var = &C_v;
+  d.rate_group = 0;
   d.name = string(name);
 
   f2d.push_back(d);
@@ -381,6 +401,7 @@ void Solver::constraint(Field3D &v, Field3D &C_v, const char* name) {
   d.constraint = true;
   d.var = &v;
   d.F_var = &C_v;
+  d.rate_group = 0;
   d.location = v.getLocation();
   d.name = string(name);
   
@@ -534,6 +555,11 @@ int Solver::solve(int NOUT, BoutReal TIMESTEP) {
   try {
     status = run();
 
+    if(enablerestart && (iteration != restart_iteration)) {
+      // Restart files not written every output, so write the final state
+      restart.write();
+    }
+
     time_t end_time = time((time_t*) NULL);
     output.write("\nRun finished at  : %s\n", ctime(&end_time));
     output.write("Run time : ");
@@ -557,6 +583,51 @@ int Solver::solve(int NOUT, BoutReal TIMESTEP) {
     if(enablerestart) {
       // Write restart to a different file
       restart.write("%s/BOUT.failed.%s", restartdir.c_str(), restartext.c_str());
+
+      if(checkpoint.valid()) {
+        Array<BoutReal> tmp(getLocalN());
+        BoutReal chk_time;
+        int chk_iteration;
+        if(error_agreed) {
+          // All processors are here, so roll back together, using the
+          // buddy copies if needed. Restart files are only rewritten if
+          // every processor recovered, so they stay from one iteration
+          int ok = 1, allok;
+          try {
+            checkpoint.recover(tmp.begin(), getLocalN(), chk_time, chk_iteration);
+          }catch(BoutException &re) {
+            output << re.what() << endl;
+            ok = 0;
+          }
+          MPI_Allreduce(&ok, &allok, 1, MPI_INT, MPI_MIN, BoutComm::get());
+          if(!allok) {
+            output.write("WARNING: In-memory checkpoint corrupted. Restart files not rolled back\n");
+          }else if(chk_iteration > restart_iteration) {
+            // In-memory checkpoint more recent than the restart files
+            simtime = chk_time;
+            iteration = chk_iteration;
+            load_vars(tmp.begin());
+            restart.write();
+            output.write("Restart files rolled back to in-memory checkpoint at iteration %d, time %e\n",
+                         iteration, simtime);
+          }
+        }else {
+          // The error may not have been seen by other processors, so
+          // this mustn't communicate. Rolling back only some restart
+          // files would leave a set which can't be used, so write this
+          // processor's own copy to separate files
+          if(!checkpoint.restore(tmp.begin(), getLocalN(), chk_time, chk_iteration)) {
+            output.write("WARNING: In-memory checkpoint corrupted. Not written\n");
+          }else {
+            simtime = chk_time;
+            iteration = chk_iteration;
+            load_vars(tmp.begin());
+            restart.write("%s/BOUT.checkpoint.%s", restartdir.c_str(), restartext.c_str());
+            output.write("In-memory checkpoint at iteration %d, time %e written to BOUT.checkpoint\n",
+                         iteration, simtime);
+          }
+        }
+      }
     }
     
     throw e;
@@ -642,10 +713,32 @@ int Solver::init(bool restarting, int nout, BoutReal tstep) {
     /// Load restart file
     if(!restart.openr("%s/BOUT.restart.%s", restartdir.c_str(), restartext.c_str()))
       throw BoutException("Error: Could not open restart file\n");
-    if(!restart.read())
+
+    // Check if the files are from a different number of processors
+    int file_NP, file_NX;
+    if(restart.readFromProc0("NPES", file_NP) && restart.readFromProc0("NXPE", file_NX) &&
+       (file_NP > 0) && ((file_NP != tmp_NP) || (file_NX != tmp_NX))) {
+      output.write("Restart files are from %d processors (%d in X). Redistributing onto %d (%d in X)\n",
+                   file_NP, file_NX, tmp_NP, tmp_NX);
+      if(!restart.readRedistributed(file_NP, file_NX))
+        throw BoutException("Error: Could not read restart file\n");
+      // Now running on the new processors
+      NPES = tmp_NP;
+      mesh->NXPE = tmp_NX;
+    }else if(!restart.read()) {
       throw BoutException("Error: Could not read restart file\n");
+    }
     restart.close();
 
+    // Restart files must all be from the same output, for example not
+    // a mixture of BOUT.restart and BOUT.checkpoint files
+    int min_iteration, max_iteration;
+    MPI_Allreduce(&iteration, &min_iteration, 1, MPI_INT, MPI_MIN, BoutComm::get());
+    MPI_Allreduce(&iteration, &max_iteration, 1, MPI_INT, MPI_MAX, BoutComm::get());
+    if(min_iteration != max_iteration)
+      throw BoutException("Error: Restart files are from different iterations (%d to %d)\n",
+                          min_iteration, max_iteration);
+
     if(NPES == 0) {
       // Old restart file
       output.write("WARNING: Cannot verify processor numbers\n");
@@ -715,18 +808,33 @@ void Solver::removeMonitor(MonitorFunc f) {
 }
 
 int Solver::call_monitors(BoutReal simtime, int iter, int NOUT) {
+  // Complete any delayed communications, so guard cells are valid in the output
+  mesh->communicatePending();
+  
   if(mms) {
     // Calculate MMS errors
     calculate_mms_error(simtime);
   }
   
   if( enablerestart ) {
-    /// Write the restart file
-    restart.write();
+    if((checkpoint_interval > 0.0) && !state_finite()) {
+      // All processors know, so can roll back together
+      error_agreed = true;
+      throw BoutException("Solution is not finite at iteration %d, time %e\n", iteration, simtime);
+    }
+
+    if(iteration % restart_interval == 0) {
+      /// Write the restart file
+      restart.write();
+      restart_iteration = iteration;
+    }
     
     if((archive_restart > 0) && (iteration % archive_restart == 0)) {
       restart.write("%s/BOUT.restart_%04d.%s", restartdir.c_str(), iteration, restartext.c_str());
     }
+
+    if(checkpoint_interval > 0.0)
+      take_checkpoint(simtime);
   }
   
   try {
@@ -762,6 +870,38 @@ int Solver::call_monitors(BoutReal simtime, int iter, int NOUT) {
   return 0;
 }
 
+void Solver::take_checkpoint(BoutReal simtime) {
+  TRACE("Solver::take_checkpoint");
+
+  // Processor 0 decides, so that all processors agree
+  MPI_Comm comm = BoutComm::get();
+  int save = (MPI_Wtime() - last_checkpoint) >= checkpoint_interval;
+  MPI_Bcast(&save, 1, MPI_INT, 0, comm);
+  if(!save || (iteration == restart_iteration))
+    return; // Restart file is as recent
+
+  Array<BoutReal> tmp(getLocalN());
+  save_vars(tmp.begin());
+  checkpoint.save(comm, tmp.begin(), getLocalN(), simtime, iteration);
+  last_checkpoint = MPI_Wtime();
+}
+
+bool Solver::state_finite() {
+  TRACE("Solver::state_finite");
+
+  Array<BoutReal> tmp(getLocalN());
+  save_vars(tmp.begin());
+  int ok = 1, allok;
+  for(const auto &val : tmp) {
+    if(!std::isfinite(val)) {
+      ok = 0;
+      break;
+    }
+  }
+  MPI_Allreduce(&ok, &allok, 1, MPI_INT, MPI_MIN, BoutComm::get());
+  return allok;
+}
+
 /////////////////////////////////////////////////////
 
 void Solver::addTimestepMonitor(TimestepMonitorFunc f) {
@@ -804,7 +944,6 @@ int Solver::getLocalN() {
 
   /// Cache the value, so this is not repeatedly called.
   /// This value should not change after initialisation
-  static int cacheLocalN = -1;
   if(cacheLocalN != -1) {
     return cacheLocalN;
   }
@@ -986,6 +1125,30 @@ void Solver::loop_vars_op(int jx, int jy, BoutReal *udata, int &p, SOLVER_VAR_OP
     }
     break;
   }
+  case SET_GROUP: {
+    /// Set the rate group of each variable (for multirate solvers)
+    
+    // Loop over 2D variables
+    for(const auto& f : f2d) {
+      if(bndry && !f.evolve_bndry)
+        continue;
+      udata[p] = f.rate_group;
+      p++;
+    }
+    
+    for (jz=0; jz < mesh->LocalNz; jz++) {
+      
+      // Loop over 3D variables
+      for(const auto& f : f3d) {
+        if(bndry && !f.evolve_bndry)
+          continue;
+        udata[p] = f.rate_group;
+        p++;
+      }
+    }
+    
+    break;
+  }
     /// Save time-derivatives from BOUT++ into CVODE (returning RHS result)
   case SAVE_DERIVS: {
     
@@ -1008,6 +1171,29 @@ void Solver::loop_vars_op(int jx, int jy, BoutReal *udata, int &p, SOLVER_VAR_OP
       }
     }
     break;
+  }
+    /// Add time-derivatives from BOUT++ to an accumulated update
+  case ADD_DERIVS: {
+    
+    // Loop over 2D variables
+    for(const auto& f : f2d) {
+      if(bndry && !f.evolve_bndry)
+        continue;
+      udata[p] += (*f.F_var)(jx, jy);
+      p++;
+    }
+    
+    for (jz=0; jz < mesh->LocalNz; jz++) {
+      
+      // Loop over 3D variables
+      for(const auto& f : f3d) {
+        if(bndry && !f.evolve_bndry)
+          continue;
+        udata[p] += (*f.F_var)(jx, jy, jz);
+        p++;
+      }
+    }
+    break;
   }
   }
 }
@@ -1117,6 +1303,16 @@ void Solver::save_vars(BoutReal *udata) {
 }
 
 void Solver::save_derivs(BoutReal *dudata) {
+  prepare_derivs();
+  loop_vars(dudata, SAVE_DERIVS);
+}
+
+void Solver::add_derivs(BoutReal *dudata) {
+  prepare_derivs();
+  loop_vars(dudata, ADD_DERIVS);
+}
+
+void Solver::prepare_derivs() {
   // Make sure vectors in correct basis
   for(const auto& v : v2d) {
     if(v.covariant) {
@@ -1138,14 +1334,16 @@ void Solver::save_derivs(BoutReal *dudata) {
       *(f.F_var) = interp_to(*(f.F_var), f.location);
     }
   }
-
-  loop_vars(dudata, SAVE_DERIVS);
 }
 
 void Solver::set_id(BoutReal *udata) {
   loop_vars(udata, SET_ID);
 }
 
+void Solver::set_group(BoutReal *udata) {
+  loop_vars(udata, SET_GROUP);
+}
+
 
 /*!
  * Returns a Field3D containing the global indices
@@ -1311,6 +1509,36 @@ int Solver::run_rhs(BoutReal t) {
   return status;
 }
 
+int Solver::run_rhs(BoutReal t, int group) {
+  int status;
+  
+  Timer timer("rhs");
+
+  // Time derivatives of other groups are not used, and may not be
+  // set by the model. Only zero them if not yet allocated, so that
+  // they are not reset on every call
+  for(const auto& f : f3d)
+    if((f.rate_group != group) && !f.F_var->isAllocated())
+      *(f.F_var) = 0.0;
+  for(const auto& f : f2d)
+    if((f.rate_group != group) && !f.F_var->isAllocated())
+      *(f.F_var) = 0.0;
+  
+  pre_rhs(t);
+  if(model) {
+    status = model->runRHS(t, group);
+  }else
+    status = (*phys_run)(t);
+  post_rhs(t);
+  
+  // If using Method of Manufactured Solutions
+  add_mms_sources(t);
+  
+  rhs_ncalls++;
+  rhs_ncalls_e++;
+  return status;
+}
+
 /// NOTE: This calls add_mms_sources
 int Solver::run_convective(BoutReal t) {
   int status;
@@ -1371,11 +1599,13 @@ void Solver::pre_rhs(BoutReal t) {
       f.var->applyBoundary(t);
   }
   
+  // 3D fields are done together, so that they can be threaded
+  vector<Field3D*> vars;
   for(const auto& f : f3d) {
     if(!f.constraint)
-      f.var->applyBoundary(t);
+      vars.push_back(f.var);
   }
-  
+  Field3D::applyBoundaries(vars, t);
 }
 
 void Solver::post_rhs(BoutReal t) {
@@ -1413,10 +1643,12 @@ void Solver::post_rhs(BoutReal t) {
       f.var->applyTDerivBoundary();
   }
   
+  vector<Field3D*> vars;
   for(const auto& f : f3d) {
     if(!f.constraint && f.evolve_bndry)
-      f.var->applyTDerivBoundary();
+      vars.push_back(f.var);
   }
+  Field3D::applyTDerivBoundaries(vars);
 #if CHECK > 2
   msg_stack.push("Solver checking time derivatives");
   for(const auto& f : f3d) {
@@ -1459,6 +1691,13 @@ bool Solver::have_user_precon() {
   return prefunc != 0;
 }
 
+bool Solver::have_group_rhs() {
+  if(model)
+    return model->hasGroupRHS();
+  
+  return false; // C-style models only have a single RHS function
+}
+
 int Solver::run_precon(BoutReal t, BoutReal gamma, BoutReal delta) {
   if(!have_user_precon())
     return 1;
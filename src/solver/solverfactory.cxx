@@ -20,6 +20,8 @@
 #include "impls/imex-bdf2/imex-bdf2.hxx"
 #include "impls/snes/snes.hxx"
 #include "impls/rkgeneric/rkgeneric.hxx"
+#include "impls/rkl2/rkl2.hxx"
+#include "impls/multirate/multirate.hxx"
 
 #include <boutexception.hxx>
 
@@ -95,6 +97,10 @@ Solver* SolverFactory::createSolver(SolverType &type, Options *options) {
     return new SNESSolver(options);
   } else if(!strcasecmp(type, SOLVERRKGENERIC)){
     return new RKGenericSolver(options);
+  } else if(!strcasecmp(type, SOLVERRKL2)) {
+    return new RKL2Solver(options);
+  } else if(!strcasecmp(type, SOLVERMULTIRATE)) {
+    return new MultirateSolver(options);
   }
 
   // Need to throw an error saying 'Supplied option "type"' was not found
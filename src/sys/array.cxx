@@ -13,12 +13,24 @@ std::map< int, std::vector<Array<double>::ArrayData* > > Array<double>::store =
 template<>
 bool Array<double>::use_store = true;
 
+template<>
+long Array<double>::nalloc = 0;
+
+template<>
+long Array<double>::nnew = 0;
+
 template<>
 std::map< int, std::vector<Array<dcomplex>::ArrayData* > > Array<dcomplex>::store = {};
 
 template<>
 bool Array<dcomplex>::use_store = true;
 
+template<>
+long Array<dcomplex>::nalloc = 0;
+
+template<>
+long Array<dcomplex>::nnew = 0;
+
 
 #ifdef UNIT
 /*
@@ -33,8 +45,12 @@ using std::cout;
 #include <assert.h>
 
 int main() {
+  long nalloc = Array<double>::allocations();
+  
   Array<double> a(10);
 
+  assert(Array<double>::allocations() == nalloc + 1); // Counted
+
   assert(!a.empty());      // Not empty
   assert(a.size() == 10);  // Correct size
   assert(a.unique());      // Should be unique
@@ -75,7 +91,9 @@ int main() {
   assert(a.size() == 0);
 
   // Construct, retrieve from store, and move assign
+  long nnew = Array<double>::newAllocations();
   a = Array<double>(10);
+  assert(Array<double>::newAllocations() == nnew); // From the store
 
   assert(!a.empty());
   assert(a.size() == 10);
@@ -23,6 +23,7 @@
  **************************************************************************/
 
 #include <bout/sys/expressionparser.hxx>
+#include <bout/sys/fieldprogram.hxx>
 
 #include <utils.hxx> // for lowercase
 
@@ -48,6 +49,7 @@ namespace { // These classes only visible in this file
     double generate(double x, double UNUSED(y), double UNUSED(z), double UNUSED(t)) {
       return x;
     }
+    int compile(FieldProgram &prog) { return prog.coordinate(FieldProgram::DEP_X); }
     const std::string str() {return std::string("x");}
   };
   
@@ -57,6 +59,7 @@ namespace { // These classes only visible in this file
     double generate(double UNUSED(x), double y, double UNUSED(z), double UNUSED(t)) {
       return y;
     }
+    int compile(FieldProgram &prog) { return prog.coordinate(FieldProgram::DEP_Y); }
     const std::string str() {return std::string("y");}
   };
 
@@ -66,6 +69,7 @@ namespace { // These classes only visible in this file
     double generate(double UNUSED(x), double UNUSED(y), double z, double UNUSED(t)) {
       return z;
     }
+    int compile(FieldProgram &prog) { return prog.coordinate(FieldProgram::DEP_Z); }
     const std::string str() {return std::string("z");}
   };
   
@@ -75,6 +79,7 @@ namespace { // These classes only visible in this file
     double generate(double UNUSED(x), double UNUSED(y), double UNUSED(z), double t) {
       return t;
     }
+    int compile(FieldProgram &prog) { return prog.coordinate(FieldProgram::DEP_T); }
     const std::string str() {return std::string("t");}
   };
 
@@ -92,9 +97,11 @@ namespace { // These classes only visible in this file
     double generate(double x, double y, double z, double t) {
       return -gen->generate(x,y,z,t);
     }
+    int compile(FieldProgram &prog) { return prog.unary(negate, prog.compile(gen)); }
     const std::string str() {return std::string("(-")+gen->str()+std::string(")");}
   private:
     FieldGenerator *gen;
+    static double negate(double x) { return -x; }
   };
 }
 
@@ -119,6 +126,14 @@ BoutReal FieldBinary::generate(double x, double y, double z, double t) {
   return 0.;
 }
 
+int FieldBinary::compile(FieldProgram &prog) {
+  return prog.binary(op, prog.compile(lhs), prog.compile(rhs));
+}
+
+int FieldValue::compile(FieldProgram &prog) {
+  return prog.constant(value);
+}
+
 /////////////////////////////////////////////
 
 ExpressionParser::ExpressionParser() {
@@ -145,8 +160,13 @@ ExpressionParser::~ExpressionParser() {
     delete it.second.first;
   
   // Delete allocated generators
+  freeGenerators();
+}
+
+void ExpressionParser::freeGenerators() {
   for(const auto& it : genheap)
     delete it;
+  genheap.clear();
 }
 
 void ExpressionParser::addGenerator(string name, FieldGenerator* g) {
@@ -0,0 +1,305 @@
+/**************************************************************************
+ * Compiles trees of FieldGenerator objects into a list of operations
+ *
+ **************************************************************************
+ * Copyright 2017 B.D.Dudson
+ *
+ * Contact: Ben Dudson, bd512@york.ac.uk
+ *
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+#include <bout/sys/fieldprogram.hxx>
+
+#include <cmath>
+#include <sstream>
+
+/// Generators without their own compile() are called at every point
+int FieldGenerator::compile(FieldProgram &prog) {
+  return prog.generator(this);
+}
+
+FieldProgram::FieldProgram(FieldGenerator *gen) : calculated(false) {
+  if(!gen)
+    throw ParseException("FieldProgram: Can't compile a null generator");
+  result = compile(gen);
+  compiled.clear(); // Only needed while compiling
+
+  // Time-independent registers are only calculated once for each
+  // grid. Of those, only the ones used by time-dependent operations,
+  // or containing the result, are read again, so only these are kept.
+  // The others are released, so that full-grid workspace isn't held
+  // between calls
+  keep.assign(size(), false);
+  for(const auto &ins : code) {
+    if(!(ins.deps & DEP_T))
+      continue;
+    for(int in : {ins.a, ins.b})
+      if((in >= 0) && !(code[in].deps & DEP_T))
+        keep[in] = true;
+  }
+  if(!timeDependent())
+    keep[result] = true;
+}
+
+int FieldProgram::compile(FieldGenerator *gen) {
+  auto it = compiled.find(gen);
+  if(it != compiled.end())
+    return it->second; // Already compiled
+
+  int r = gen->compile(*this);
+  compiled[gen] = r;
+  return r;
+}
+
+int FieldProgram::add(const Instruction &ins) {
+  if((ins.op != OpCode::constant) && (ins.deps == 0)) {
+    // All inputs are constant, so evaluate now
+    return constant(fold(ins));
+  }
+  code.push_back(ins);
+  reg.push_back(std::vector<double>());
+  return size() - 1;
+}
+
+int FieldProgram::constant(double value) {
+  Instruction ins = {OpCode::constant, -1, -1, 0, value, nullptr, nullptr, nullptr};
+  code.push_back(ins);
+  reg.push_back(std::vector<double>(1, value));
+  return size() - 1;
+}
+
+int FieldProgram::coordinate(int dep) {
+  if((dep != DEP_X) && (dep != DEP_Y) && (dep != DEP_Z) && (dep != DEP_T))
+    throw ParseException("FieldProgram: Invalid coordinate %d", dep);
+  Instruction ins = {OpCode::coordinate, -1, -1, dep, 0.0, nullptr, nullptr, nullptr};
+  return add(ins);
+}
+
+int FieldProgram::unary(FieldFunc1 func, int a) {
+  Instruction ins = {OpCode::func1, a, -1, code[a].deps, 0.0, func, nullptr, nullptr};
+  return add(ins);
+}
+
+int FieldProgram::binary(char op, int a, int b) {
+  OpCode opcode;
+  switch(op) {
+  case '+': opcode = OpCode::add; break;
+  case '-': opcode = OpCode::sub; break;
+  case '*': opcode = OpCode::mul; break;
+  case '/': opcode = OpCode::div; break;
+  case '^': opcode = OpCode::pow; break;
+  default:
+    throw ParseException("FieldProgram: Unknown binary operator '%c'", op);
+  }
+  Instruction ins = {opcode, a, b, code[a].deps | code[b].deps, 0.0, nullptr, nullptr, nullptr};
+  return add(ins);
+}
+
+int FieldProgram::binary(FieldFunc2 func, int a, int b) {
+  Instruction ins = {OpCode::func2, a, b, code[a].deps | code[b].deps, 0.0, nullptr, func, nullptr};
+  return add(ins);
+}
+
+int FieldProgram::generator(FieldGenerator *gen) {
+  // Don't know what the generator depends on, so assume everything
+  Instruction ins = {OpCode::call, -1, -1, DEP_X | DEP_Y | DEP_Z | DEP_T, 0.0, nullptr, nullptr, gen};
+  return add(ins);
+}
+
+double FieldProgram::fold(const Instruction &ins) const {
+  double a = (ins.a >= 0) ? code[ins.a].value : 0.0;
+  double b = (ins.b >= 0) ? code[ins.b].value : 0.0;
+  switch(ins.op) {
+  case OpCode::add: return a + b;
+  case OpCode::sub: return a - b;
+  case OpCode::mul: return a * b;
+  case OpCode::div: return a / b;
+  case OpCode::pow: return ::pow(a, b);
+  case OpCode::func1: return ins.func1(a);
+  case OpCode::func2: return ins.func2(a, b);
+  default: break;
+  }
+  throw ParseException("FieldProgram: Can't evaluate operation as a constant");
+}
+
+void FieldProgram::evaluate(const double *x, int nx, const double *y, int ny,
+                            const double *z, int nz, double t, double *res) {
+  // Check if time-independent registers can be re-used
+  bool same_grid = calculated &&
+    (gridx.size() == static_cast<size_t>(nx)) && std::equal(x, x+nx, gridx.begin()) &&
+    (gridy.size() == static_cast<size_t>(ny)) && std::equal(y, y+ny, gridy.begin()) &&
+    (gridz.size() == static_cast<size_t>(nz)) && std::equal(z, z+nz, gridz.begin());
+
+  for(int i=0;i<size();i++) {
+    const Instruction &ins = code[i];
+    if(ins.op == OpCode::constant)
+      continue; // Calculated when compiled
+    if(same_grid && !(ins.deps & DEP_T))
+      continue; // Not changed since last time, and only used if kept
+
+    // Size of this register in each dimension
+    int sx = (ins.deps & DEP_X) ? nx : 1;
+    int sy = (ins.deps & DEP_Y) ? ny : 1;
+    int sz = (ins.deps & DEP_Z) ? nz : 1;
+    std::vector<double> &out = reg[i];
+    out.resize(sx*sy*sz);
+
+    if(ins.op == OpCode::coordinate) {
+      switch(ins.deps) {
+      case DEP_X: std::copy(x, x+nx, out.begin()); break;
+      case DEP_Y: std::copy(y, y+ny, out.begin()); break;
+      case DEP_Z: std::copy(z, z+nz, out.begin()); break;
+      default: out[0] = t;
+      }
+      continue;
+    }
+
+    if(ins.op == OpCode::call) {
+      for(int ix=0;ix<nx;ix++)
+        for(int iy=0;iy<ny;iy++)
+          for(int iz=0;iz<nz;iz++)
+            out[(ix*ny + iy)*nz + iz] = ins.gen->generate(x[ix], y[iy], z[iz], t);
+      continue;
+    }
+
+    // Inputs. Each is indexed over its own dimensions, broadcasting along the others
+    const Instruction &ia = code[ins.a];
+    const std::vector<double> &ra = reg[ins.a];
+    int ay = (ia.deps & DEP_Y) ? ny : 1, az = (ia.deps & DEP_Z) ? nz : 1;
+    int bay = 1, baz = 1;
+    const double *rb = nullptr;
+    int bdeps = 0;
+    if(ins.b >= 0) {
+      bdeps = code[ins.b].deps;
+      rb = reg[ins.b].data();
+      bay = (bdeps & DEP_Y) ? ny : 1;
+      baz = (bdeps & DEP_Z) ? nz : 1;
+    }
+
+    for(int ix=0;ix<sx;ix++)
+      for(int iy=0;iy<sy;iy++) {
+        // Line along z
+        const double *pa = ra.data() +
+          (((ia.deps & DEP_X) ? ix : 0)*ay + ((ia.deps & DEP_Y) ? iy : 0))*az;
+        int da = (ia.deps & DEP_Z) ? 1 : 0; // Stride along z
+        const double *pb = rb ? rb + (((bdeps & DEP_X) ? ix : 0)*bay + ((bdeps & DEP_Y) ? iy : 0))*baz : nullptr;
+        int db = (bdeps & DEP_Z) ? 1 : 0;
+        double *po = out.data() + (ix*sy + iy)*sz;
+
+        switch(ins.op) {
+        case OpCode::add: {
+          for(int k=0;k<sz;k++) po[k] = pa[k*da] + pb[k*db];
+          break;
+        }
+        case OpCode::sub: {
+          for(int k=0;k<sz;k++) po[k] = pa[k*da] - pb[k*db];
+          break;
+        }
+        case OpCode::mul: {
+          for(int k=0;k<sz;k++) po[k] = pa[k*da] * pb[k*db];
+          break;
+        }
+        case OpCode::div: {
+          for(int k=0;k<sz;k++) po[k] = pa[k*da] / pb[k*db];
+          break;
+        }
+        case OpCode::pow: {
+          for(int k=0;k<sz;k++) po[k] = ::pow(pa[k*da], pb[k*db]);
+          break;
+        }
+        case OpCode::func1: {
+          for(int k=0;k<sz;k++) po[k] = ins.func1(pa[k*da]);
+          break;
+        }
+        case OpCode::func2: {
+          for(int k=0;k<sz;k++) po[k] = ins.func2(pa[k*da], pb[k*db]);
+          break;
+        }
+        default:
+          break;
+        }
+      }
+  }
+
+  if(!same_grid) {
+    gridx.assign(x, x+nx);
+    gridy.assign(y, y+ny);
+    gridz.assign(z, z+nz);
+    calculated = true;
+  }
+
+  // Copy result, broadcasting over any dimensions it doesn't depend on
+  const Instruction &ir = code[result];
+  const std::vector<double> &rr = reg[result];
+  int ry = (ir.deps & DEP_Y) ? ny : 1, rz = (ir.deps & DEP_Z) ? nz : 1;
+  for(int ix=0;ix<nx;ix++)
+    for(int iy=0;iy<ny;iy++) {
+      const double *pr = rr.data() +
+        (((ir.deps & DEP_X) ? ix : 0)*ry + ((ir.deps & DEP_Y) ? iy : 0))*rz;
+      double *po = res + (ix*ny + iy)*nz;
+      if(ir.deps & DEP_Z) {
+        for(int iz=0;iz<nz;iz++)
+          po[iz] = pr[iz];
+      }else {
+        for(int iz=0;iz<nz;iz++)
+          po[iz] = pr[0];
+      }
+    }
+
+  // Release workspace
+  for(int i=0;i<size();i++)
+    if((code[i].op != OpCode::constant) && !keep[i])
+      std::vector<double>().swap(reg[i]);
+}
+
+double FieldProgram::evaluate(double x, double y, double z, double t) {
+  double value;
+  evaluate(&x, 1, &y, 1, &z, 1, t, &value);
+  return value;
+}
+
+std::string FieldProgram::str() const {
+  std::stringstream ss;
+  for(int i=0;i<size();i++) {
+    const Instruction &ins = code[i];
+    ss << "r" << i << " = ";
+    switch(ins.op) {
+    case OpCode::constant: ss << ins.value; break;
+    case OpCode::coordinate: {
+      switch(ins.deps) {
+      case DEP_X: ss << "x"; break;
+      case DEP_Y: ss << "y"; break;
+      case DEP_Z: ss << "z"; break;
+      default: ss << "t";
+      }
+      break;
+    }
+    case OpCode::add: ss << "r" << ins.a << " + r" << ins.b; break;
+    case OpCode::sub: ss << "r" << ins.a << " - r" << ins.b; break;
+    case OpCode::mul: ss << "r" << ins.a << " * r" << ins.b; break;
+    case OpCode::div: ss << "r" << ins.a << " / r" << ins.b; break;
+    case OpCode::pow: ss << "r" << ins.a << " ^ r" << ins.b; break;
+    case OpCode::func1: ss << "func(r" << ins.a << ")"; break;
+    case OpCode::func2: ss << "func(r" << ins.a << ", r" << ins.b << ")"; break;
+    case OpCode::call: ss << "call " << ins.gen->str(); break;
+    }
+    ss << "\n";
+  }
+  ss << "result in r" << result << "\n";
+  return ss.str();
+}
@@ -0,0 +1,84 @@
+"""Read files in the BOUT++ native binary ("bin") format
+
+This format is used for restart files (restart_format = bin) and
+for reduced diagnostics (BOUT.diag.bin). See
+src/fileio/impls/binary/bin_format.hxx for the layout.
+"""
+
+from __future__ import print_function
+from __future__ import division
+
+import numpy as np
+
+_file_header = np.dtype([("magic", "S8"), ("version", "u8"), ("byteorder", "u8")])
+
+_entry_header = np.dtype([("magic", "S8"),
+                          ("namelen", "u8"),
+                          ("type", "i8"),
+                          ("record", "i8"),
+                          ("nrecords", "i8"),
+                          ("size", "i8", (3,)),
+                          ("nbytes", "u8"),
+                          ("checksum", "u8", (2,))])
+
+_types = {1: np.dtype("i4"), 2: np.dtype("f8")}
+
+
+def _pad8(n):
+    return (n + 7) // 8 * 8
+
+
+def readbin(filename):
+    """Read all variables from a binary file
+
+    Returns a dictionary of numpy arrays. Variables written as
+    records (e.g. every output or diagnostic step) have time as
+    their first dimension.
+
+    Checksums are not checked, but a truncated file raises an error.
+    """
+    data = np.fromfile(filename, dtype=np.uint8)
+
+    header = np.frombuffer(data[:_file_header.itemsize], dtype=_file_header)[0]
+    if header["magic"] != b"BOUTBIN":
+        raise ValueError("'{}' is not a BOUT++ binary file".format(filename))
+    if header["byteorder"] != 0x0102030405060708:
+        raise ValueError("'{}' was written with a different byte order".format(filename))
+    if header["version"] != 2:
+        raise ValueError("'{}' has unknown version {}".format(filename, header["version"]))
+
+    variables = {}  # name -> {record: array}
+    pos = _file_header.itemsize
+    while pos < len(data):
+        if pos + _entry_header.itemsize > len(data):
+            raise ValueError("'{}' is truncated".format(filename))
+        entry = np.frombuffer(data[pos:pos + _entry_header.itemsize], dtype=_entry_header)[0]
+        if entry["magic"] != b"BOUTVAR":
+            raise ValueError("'{}' is corrupted at byte {}".format(filename, pos))
+
+        pos += _entry_header.itemsize
+        name = data[pos:pos + entry["namelen"]].tobytes().decode()
+        pos += _pad8(entry["namelen"])
+
+        nbytes = int(entry["nbytes"])
+        if pos + nbytes > len(data):
+            raise ValueError("'{}' is truncated".format(filename))
+        # An entry can contain several consecutive records
+        nrecords = int(entry["nrecords"])
+        shape = [nrecords] + [int(s) for s in entry["size"] if s > 0]
+        value = np.frombuffer(data[pos:pos + nbytes],
+                              dtype=_types[int(entry["type"])]).reshape(shape)
+        pos += _pad8(nbytes)
+
+        records = variables.setdefault(name, {})
+        for i in range(nrecords):
+            records[int(entry["record"]) + i] = value[i]
+
+    result = {}
+    for name, records in variables.items():
+        if -1 in records:
+            # Not a record variable
+            result[name] = records[-1]
+        else:
+            result[name] = np.stack([records[r] for r in sorted(records)])
+    return result
@@ -64,6 +64,69 @@ def findVar(varname, varlist):
         print("Variable '"+varname+"' not found, and is ambiguous. Could be one of: "+str(v))
     raise ValueError("Variable '"+varname+"' not found")
 
+def _collect_region(varname, file_list, tind=None, info=True):
+    """Collect a variable written with an output region
+
+    Variables with an output region (see "Output regions" in the
+    manual) are written by each processor as the selected points it
+    owns, together with <varname>_region = [x, xstride, y, ystride],
+    the global indices of its first point and the strides. Processors
+    which own none of the points don't write the variable.
+
+    Returns the selected points, indexed [t,x,y,z] as usual. Point i in
+    X is at global index x + i*xstride, with the smallest x of any file.
+    """
+    pieces = []
+    evolving = False
+    for filename in file_list:
+        f = DataFile(filename)
+        if varname+"_region" in f.list():
+            region = f.read(varname+"_region")
+            evolving = f.dimensions(varname)[0] == 't'
+            pieces.append((region, f.read(varname)))
+        f.close()
+
+    if pieces == []:
+        raise ValueError("Variable '"+varname+"' not found")
+
+    xstride = pieces[0][0][1]
+    ystride = pieces[0][0][3]
+    x0 = min([region[0] for region, data in pieces])
+    y0 = min([region[2] for region, data in pieces])
+
+    # X and Y are the first dimensions after time
+    xdim = 1 if evolving else 0
+    shape = list(pieces[0][1].shape)
+    shape[xdim] = max([(region[0] - x0)//xstride + data.shape[xdim] for region, data in pieces])
+    shape[xdim+1] = max([(region[2] - y0)//ystride + data.shape[xdim+1] for region, data in pieces])
+
+    if info:
+        print("Collecting %s from %d files: X from %d, stride %d, Y from %d, stride %d"
+              % (varname, len(pieces), x0, xstride, y0, ystride))
+
+    result = np.zeros(shape)
+    for region, data in pieces:
+        ix = (region[0] - x0)//xstride
+        iy = (region[2] - y0)//ystride
+        index = [slice(None)]*len(shape)
+        index[xdim] = slice(ix, ix + data.shape[xdim])
+        index[xdim+1] = slice(iy, iy + data.shape[xdim+1])
+        result[tuple(index)] = data
+
+    if evolving and tind is not None:
+        try:
+            tmin, tmax = tind
+        except TypeError:
+            tmin = tmax = tind
+        nt = shape[0]
+        if tmin < 0:
+            tmin += nt
+        if tmax < 0:
+            tmax += nt
+        result = result[tmin:tmax+1]
+
+    return result
+
 def collect(varname, xind=None, yind=None, zind=None, tind=None, path=".",yguards=False, xguards=True, info=True,prefix="BOUT.dmp",strict=False):
     """Collect a variable from a set of BOUT++ outputs.
 
@@ -86,6 +149,11 @@ def collect(varname, xind=None, yind=None, zind=None, tind=None, path=".",yguard
                            definition of nx)
     info    = True         Print information about collect?
     strict  = False        Fail if the exact variable name is not found?
+
+    Variables written with an output region are reassembled from the
+    files which contain them, and only the selected points returned
+    (xind, yind, zind, xguards and yguards are ignored). See
+    _collect_region.
     """
 
     # Search for BOUT++ dump files in NetCDF format
@@ -126,6 +194,19 @@ def collect(varname, xind=None, yind=None, zind=None, tind=None, path=".",yguard
     # Read data from the first file
     f = DataFile(file_list[0])
 
+    # Variables with an output region may not be in the first file
+    has_region = varname+"_region" in f.list()
+    if (not has_region) and (varname not in f.list()):
+        for filename in file_list[1:]:
+            fpe = DataFile(filename)
+            has_region = varname+"_region" in fpe.list()
+            fpe.close()
+            if has_region:
+                break
+    if has_region:
+        f.close()
+        return _collect_region(varname, file_list, tind=tind, info=info)
+
     try:
         dimens = f.dimensions(varname)
         #ndims = len(dimens)
@@ -209,15 +290,29 @@ def collect(varname, xind=None, yind=None, zind=None, tind=None, path=".",yguard
         elif npe > nfiles:
             print("WARNING: Some files missing. Expected " + str(npe))
 
+    # Start of each processor's domain. Processors can have
+    # different sized domains, in which case read each size
+    xoffset = [pe * mxsub for pe in range(nxpe+1)]
+    yoffset = [pe * mysub for pe in range(nype+1)]
+    if "OffsetX" in f.list():
+        for pe in range(nxpe):
+            fpe = DataFile(os.path.join(path, prefix+"." + str(pe) + suffix))
+            xoffset[pe+1] = xoffset[pe] + fpe.read("MXSUB")
+            fpe.close()
+        for pe in range(nype):
+            fpe = DataFile(os.path.join(path, prefix+"." + str(pe*nxpe) + suffix))
+            yoffset[pe+1] = yoffset[pe] + fpe.read("MYSUB")
+            fpe.close()
+
     if xguards:
-        nx = nxpe * mxsub + 2*mxg
+        nx = xoffset[nxpe] + 2*mxg
     else:
-        nx = nxpe * mxsub
+        nx = xoffset[nxpe]
 
     if yguards:
-        ny = mysub * nype + 2*myg
+        ny = yoffset[nype] + 2*myg
     else:
-        ny = mysub * nype
+        ny = yoffset[nype]
 
     f.close();
 
@@ -281,12 +376,16 @@ def collect(varname, xind=None, yind=None, zind=None, tind=None, path=".",yguard
         pe_yind = int(i/nxpe)
         pe_xind = i % nxpe
 
+        # Size of this processor's domain
+        mxsub = xoffset[pe_xind+1] - xoffset[pe_xind]
+        mysub = yoffset[pe_yind+1] - yoffset[pe_yind]
+
         inrange = True
 
         if yguards:
             # Get local ranges
-            ymin = yind[0] - pe_yind*mysub
-            ymax = yind[1] - pe_yind*mysub
+            ymin = yind[0] - yoffset[pe_yind]
+            ymax = yind[1] - yoffset[pe_yind]
 
             # Check lower y boundary
             if pe_yind == 0:
@@ -307,13 +406,13 @@ def collect(varname, xind=None, yind=None, zind=None, tind=None, path=".",yguard
                 if ymax >= (mysub + myg): ymax = (mysub+myg-1)
 
             # Calculate global indices
-            ygmin = ymin + pe_yind * mysub
-            ygmax = ymax + pe_yind * mysub
+            ygmin = ymin + yoffset[pe_yind]
+            ygmax = ymax + yoffset[pe_yind]
 
         else:
             # Get local ranges
-            ymin = yind[0] - pe_yind*mysub + myg
-            ymax = yind[1] - pe_yind*mysub + myg
+            ymin = yind[0] - yoffset[pe_yind] + myg
+            ymax = yind[1] - yoffset[pe_yind] + myg
 
             if (ymin >= (mysub + myg)) or (ymax < myg):
                 inrange = False # Y out of range
@@ -324,13 +423,13 @@ def collect(varname, xind=None, yind=None, zind=None, tind=None, path=".",yguard
                 ymax = myg + mysub - 1
 
             # Calculate global indices
-            ygmin = ymin + pe_yind * mysub - myg
-            ygmax = ymax + pe_yind * mysub - myg
+            ygmin = ymin + yoffset[pe_yind] - myg
+            ygmax = ymax + yoffset[pe_yind] - myg
 
         if xguards:
             # Get local ranges
-            xmin = xind[0] - pe_xind*mxsub
-            xmax = xind[1] - pe_xind*mxsub
+            xmin = xind[0] - xoffset[pe_xind]
+            xmax = xind[1] - xoffset[pe_xind]
 
             # Check lower x boundary
             if pe_xind == 0:
@@ -351,13 +450,13 @@ def collect(varname, xind=None, yind=None, zind=None, tind=None, path=".",yguard
                 if xmax >= (mxsub + mxg): xmax = (mxsub+mxg-1)
 
             # Calculate global indices
-            xgmin = xmin + pe_xind * mxsub
-            xgmax = xmax + pe_xind * mxsub
+            xgmin = xmin + xoffset[pe_xind]
+            xgmax = xmax + xoffset[pe_xind]
 
         else:
             # Get local ranges
-            xmin = xind[0] - pe_xind*mxsub + mxg
-            xmax = xind[1] - pe_xind*mxsub + mxg
+            xmin = xind[0] - xoffset[pe_xind] + mxg
+            xmax = xind[1] - xoffset[pe_xind] + mxg
 
             if (xmin >= (mxsub + mxg)) or (xmax < mxg):
                 inrange = False # X out of range
@@ -368,8 +467,8 @@ def collect(varname, xind=None, yind=None, zind=None, tind=None, path=".",yguard
                 xmax = mxg + mxsub - 1
 
             # Calculate global indices
-            xgmin = xmin + pe_xind * mxsub - mxg
-            xgmax = xmax + pe_xind * mxsub - mxg
+            xgmin = xmin + xoffset[pe_xind] - mxg
+            xgmax = xmax + xoffset[pe_xind] - mxg
 
 
         # Number of local values